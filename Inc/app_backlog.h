@@ -0,0 +1,103 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_backlog.h
+ * Brief:   Bounded store-and-forward ring of sequence-numbered frames
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_BACKLOG_H
+#define APP_BACKLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* AppBacklogDesc.flags */
+#define APP_BACKLOG_F_SENT      (1U << 0)   /* already handed to the transport */
+#define APP_BACKLOG_F_JSON      (1U << 1)   /* JSON line (else binary frame)   */
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t off;
+  uint16_t len;
+  uint32_t seq;
+  uint8_t  flags;           /* APP_BACKLOG_F_* */
+} AppBacklogDesc;
+
+/*
+ * Entries are kept in push (= sequence) order between tail and head.
+ * Frames are evicted from the tail when the ring is full, or released when
+ * the gateway acknowledges their sequence number. 'cursor' is the replay
+ * position; entries flagged SENT are skipped.
+ */
+typedef struct
+{
+  uint8_t        *buf;
+  uint16_t        size;       /* ring size in bytes */
+  AppBacklogDesc *desc;
+  uint16_t        ndesc;      /* descriptor slots (power of two) */
+
+  uint16_t        tail;       /* oldest entry */
+  uint16_t        cursor;     /* next entry to consider for replay */
+  uint16_t        head;       /* next descriptor to commit */
+  uint16_t        unsent;     /* entries without APP_BACKLOG_F_SENT */
+  uint16_t        wr;         /* byte offset after the newest frame */
+  uint16_t        res_off;    /* offset handed out by the last reserve */
+} AppBacklog;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void APP_BACKLOG_Init(AppBacklog *b, uint8_t *buf, uint16_t size,
+                      AppBacklogDesc *desc, uint16_t ndesc);
+
+/* producer: reserve (evicting the oldest entries if needed), then commit */
+uint8_t *APP_BACKLOG_Reserve(AppBacklog *b, uint16_t max_len, uint16_t *evicted);
+void     APP_BACKLOG_Commit(AppBacklog *b, uint16_t len, uint32_t seq, uint8_t flags);
+
+/* replay: next entry not yet sent, mark it sent */
+bool APP_BACKLOG_PeekUnsent(AppBacklog *b, const uint8_t **data, uint16_t *len,
+                            uint32_t *seq, uint8_t *flags);
+void APP_BACKLOG_MarkSent(AppBacklog *b);
+
+/* release: sent entries up to and including seq / leading sent entries */
+uint16_t APP_BACKLOG_ReleaseUpTo(AppBacklog *b, uint32_t seq);
+uint16_t APP_BACKLOG_ReleaseSent(AppBacklog *b);
+
+/* after a reconnect: everything still stored is replayed again */
+void APP_BACKLOG_Rewind(AppBacklog *b);
+
+/* occupancy */
+uint16_t APP_BACKLOG_Depth(const AppBacklog *b);
+uint16_t APP_BACKLOG_Unsent(const AppBacklog *b);
+uint16_t APP_BACKLOG_Bytes(const AppBacklog *b);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_BACKLOG_H */
@@ -0,0 +1,154 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_cmd.h
+ * Brief:   Framed request/response commands on the telemetry TCP link
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_CMD_H
+#define APP_CMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_frame.h"     /* frame header, APP_FRAME_TYPE_CMD/RSP */
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/*
+ * Request (gateway -> controller), APP_FRAME_TYPE_CMD:
+ *   [frame header]  nfields = opcode, seq = request id, ts_us ignored
+ *   [args]          opcode specific, little-endian
+ *
+ * Response (controller -> gateway), APP_FRAME_TYPE_RSP, interleaved with
+ * telemetry on the same stream:
+ *   [frame header]  nfields = opcode, seq = request id, ts_us = now
+ *   [status u8]     APP_CMD_ST_*
+ *   [data]          opcode specific
+ *
+ *  opcode            args                      response data
+ *  PING              -                         -
+ *  SET_RATE          ch u8, value u32          value u32 (after clamping)
+ *  SET_ENCODING      enc u8 (AppFrameEncoding) enc u8
+ *  CAPTURE           hz u32, duration_ms u32   hz u32, duration_ms u32
+ *  GET_COUNTERS      -                         count u8, u32 x count (APP_CMD_CTR_*)
+ *  ACK               seq u32                   (no response)
+ *
+ * The text line "ACK <seq>\n" is accepted as well and reported as
+ * APP_CMD_OP_ACK (request id 0).
+ */
+#define APP_CMD_OP_PING           0x01U
+#define APP_CMD_OP_SET_RATE       0x02U
+#define APP_CMD_OP_SET_ENCODING   0x03U
+#define APP_CMD_OP_CAPTURE        0x04U
+#define APP_CMD_OP_GET_COUNTERS   0x05U
+#define APP_CMD_OP_ACK            0x06U
+
+/* SET_RATE channels */
+#define APP_CMD_CH_SAMPLE_HZ      0U   /* sampling rate (Hz)               */
+#define APP_CMD_CH_UDP_LATENCY    1U   /* UDP batch max latency (ms)       */
+#define APP_CMD_CH_TCP_DIVIDER    2U   /* TCP carries every Nth sample     */
+#define APP_CMD_CH_MQTT_INTERVAL  3U   /* MQTT burst interval (ms)         */
+
+/* Response status */
+#define APP_CMD_ST_OK             0U
+#define APP_CMD_ST_BAD_OPCODE     1U
+#define APP_CMD_ST_BAD_ARGS       2U   /* wrong length or value            */
+
+/* GET_COUNTERS order */
+#define APP_CMD_CTR_UDP_DATAGRAMS     0U
+#define APP_CMD_CTR_UDP_SAMPLES       1U
+#define APP_CMD_CTR_UDP_ERRORS        2U
+#define APP_CMD_CTR_TCP_QUEUED        3U
+#define APP_CMD_CTR_TCP_ACKED         4U
+#define APP_CMD_CTR_TCP_DROPPED       5U
+#define APP_CMD_CTR_BACKLOG_DEPTH     6U
+#define APP_CMD_CTR_BACKLOG_EVICTED   7U
+#define APP_CMD_CTR_CAN_PUSH_FRAMES   8U
+#define APP_CMD_CTR_CAN_OVERFLOW      9U
+#define APP_CMD_CTR_MQTT_PUBLISHES   10U
+#define APP_CMD_CTR_CMD_RX           11U
+#define APP_CMD_CTR_CMD_ERRORS       12U
+#define APP_CMD_CTR_SAMPLE_HZ        13U
+#define APP_CMD_CTR_COUNT            14U
+
+/* Largest argument block accepted / response frame produced */
+#define APP_CMD_ARGS_MAX          16U
+#define APP_CMD_RSP_MAX           (APP_FRAME_HDR_LEN + 2U + 4U * APP_CMD_CTR_COUNT)
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint8_t  opcode;
+  uint32_t id;                        /* request id, echoed in the response */
+  uint8_t  status;                    /* APP_CMD_ST_BAD_ARGS if truncated   */
+  uint8_t  nargs;
+  uint8_t  args[APP_CMD_ARGS_MAX];
+} AppCmd;
+
+typedef void (*AppCmdHandler)(const AppCmd *cmd, void *ctx);
+
+/*
+ * Byte-wise state machine: header fields are decoded as they arrive, so a
+ * request may be split anywhere across pbufs / TCP segments.
+ */
+typedef struct
+{
+  uint8_t       state;
+  uint8_t       type;                 /* frame type from the header         */
+  uint16_t      pos;                  /* bytes consumed of the current item */
+  uint16_t      len;                  /* frame length from the header       */
+  uint32_t      num;                  /* "ACK <seq>" value                  */
+  AppCmd        cmd;
+
+  AppCmdHandler handler;
+  void         *ctx;
+
+  uint32_t      frames;               /* requests delivered                 */
+  uint32_t      errors;               /* resyncs / malformed input          */
+} AppCmdParser;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void APP_CMD_Init(AppCmdParser *p, AppCmdHandler handler, void *ctx);
+void APP_CMD_Reset(AppCmdParser *p);
+
+/* feed received bytes; complete requests are passed to the handler */
+void APP_CMD_Feed(AppCmdParser *p, const uint8_t *data, uint16_t len);
+
+/* response frame; returns bytes written, 0 if cap is too small */
+uint16_t APP_CMD_EncodeResponse(const AppCmd *cmd, uint8_t status,
+                                const uint8_t *data, uint16_t dlen,
+                                uint64_t ts_us, uint8_t *out, uint16_t cap);
+
+/* little-endian argument helpers */
+uint32_t APP_CMD_ArgU32(const AppCmd *cmd, uint8_t off);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_CMD_H */
@@ -0,0 +1,107 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_fbuf.h
+ * Brief:   Reference-counted sample buffers with per-encoding frame cache
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_FBUF_H
+#define APP_FBUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_frame.h"     /* AppTelemetry, AppFrameEncoding, encoders */
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Buffers in the pool: latest sample + readers holding an older one */
+#ifndef APP_FBUF_COUNT
+#define APP_FBUF_COUNT          4U
+#endif
+
+/* Largest JSON line kept per sample */
+#ifndef APP_FBUF_JSON_MAX
+#define APP_FBUF_JSON_MAX       256U
+#endif
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+/*
+ * One sample and its encodings. Each encoding is produced at most once, on
+ * first request, and then shared by every consumer (UDP, TCP, backlog, USB,
+ * UI). The pool keeps a reference on the latest buffer; readers that hold a
+ * buffer across main-loop passes take their own.
+ */
+typedef struct
+{
+  AppTelemetry t;
+
+  uint8_t  refs;
+  uint8_t  cached;                    /* bit per AppFrameEncoding encoded */
+
+  uint16_t json_len;
+  uint16_t bin_len;
+  uint8_t  json[APP_FBUF_JSON_MAX];
+  uint8_t  bin[APP_FRAME_BIN_MAX];
+} AppFrameBuf;
+
+typedef struct
+{
+  uint32_t published;       /* samples committed                          */
+  uint32_t encodes;         /* encoder runs                               */
+  uint32_t hits;            /* requests served from an existing encoding  */
+  uint32_t no_buf;          /* every buffer still referenced              */
+} AppFbufStats;
+
+/* Fills the pre-formatted text fields of a sample (CAN text) */
+typedef void (*AppFbufTextFn)(AppTelemetry *t);
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void APP_FBUF_Init(void);
+
+/* producer: take a free buffer, fill ->t, publish as the latest sample */
+AppFrameBuf *APP_FBUF_Begin(void);
+void         APP_FBUF_Commit(AppFrameBuf *f);
+
+/* readers */
+AppFrameBuf *APP_FBUF_AcquireLatest(void);       /* NULL before the first sample */
+void         APP_FBUF_Release(AppFrameBuf *f);
+
+/* encoded frame (JSON or binary; DELTA maps to binary), encoded on first use */
+const uint8_t *APP_FBUF_Frame(AppFrameBuf *f, AppFrameEncoding enc, uint16_t *len);
+
+/* sample with its text fields, filled on first use (JSON, status line) */
+void                APP_FBUF_SetTextSource(AppFbufTextFn fn);
+const AppTelemetry *APP_FBUF_Text(AppFrameBuf *f);
+
+void APP_FBUF_GetStats(AppFbufStats *out);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_FBUF_H */
@@ -0,0 +1,145 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_frame.h
+ * Brief:   Telemetry sample type and wire encoders (JSON / binary)
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_FRAME_H
+#define APP_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/*
+ * Binary frame layout (version 1, all fields little-endian):
+ *
+ *  off  size  field
+ *    0     1  magic    (APP_FRAME_MAGIC)
+ *    1     1  version  (APP_FRAME_VERSION)
+ *    2     1  type     (APP_FRAME_TYPE_*)
+ *    3     1  nfields  (number of typed fields that follow)
+ *    4     2  length   (total frame length in bytes, header included)
+ *    6     4  seq      (sample sequence number)
+ *   10     8  ts_us    (sample timestamp in microseconds since boot)
+ *   18     .  fields   ([id u8][value], repeated nfields times)
+ *
+ * Field id byte: bits 7..6 = value size class (0:1, 1:2, 2:4, 3:8 bytes),
+ * bits 5..0 = channel number. Decoders can skip unknown channels by size.
+ * A field is only present if its source is valid (fresh) at sample time.
+ */
+#define APP_FRAME_MAGIC             0xA5U
+#define APP_FRAME_VERSION           1U
+#define APP_FRAME_HDR_LEN           18U
+
+#define APP_FRAME_TYPE_SAMPLE       0x01U
+#define APP_FRAME_TYPE_BLOCK        0x02U   /* compressed batch, see app_tsc.h */
+#define APP_FRAME_TYPE_CAN_EVENT    0x03U   /* raw CAN frames, see below        */
+#define APP_FRAME_TYPE_CMD          0x10U   /* gateway request, see app_cmd.h   */
+#define APP_FRAME_TYPE_RSP          0x11U   /* controller response              */
+
+#define APP_FRAME_FIELD(size_class, ch)  ((uint8_t)(((size_class) << 6) | ((ch) & 0x3FU)))
+#define APP_FRAME_FIELD_SIZE(id)         ((uint8_t)(1U << ((id) >> 6)))
+
+#define APP_FRAME_FIELD_I2C_TEMP    APP_FRAME_FIELD(1U, 1U)  /* int16  degC      */
+#define APP_FRAME_FIELD_CAN_HB_SEQ  APP_FRAME_FIELD(0U, 2U)  /* uint8  0x101 seq */
+#define APP_FRAME_FIELD_CAN_LUX     APP_FRAME_FIELD(2U, 3U)  /* uint32 lux*100   */
+#define APP_FRAME_FIELD_CAN_FULL    APP_FRAME_FIELD(1U, 4U)  /* uint16           */
+#define APP_FRAME_FIELD_CAN_IR      APP_FRAME_FIELD(1U, 5U)  /* uint16           */
+
+/*
+ * CAN event frame (APP_FRAME_TYPE_CAN_EVENT): header with nfields = number of
+ * records, seq = event counter, ts_us = arrival of the first record, then
+ *   [dt_us u32][id u16][dlc u8][data, dlc bytes]   (repeated)
+ * dt_us is relative to the header timestamp.
+ */
+#define APP_FRAME_CAN_REC_HDR       7U
+#define APP_FRAME_CAN_REC_MAX       (APP_FRAME_CAN_REC_HDR + 8U)
+
+/* Largest binary sample frame (header + all fields present) */
+#define APP_FRAME_BIN_MAX           (APP_FRAME_HDR_LEN + 3U + 2U + 5U + 3U + 3U)
+
+/* AppTelemetry.valid bits */
+#define APP_TLM_VALID_I2C           (1U << 0)
+#define APP_TLM_VALID_CAN101        (1U << 1)
+#define APP_TLM_VALID_CAN120        (1U << 2)
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  APP_FRAME_ENC_JSON = 0,
+  APP_FRAME_ENC_BIN,
+  APP_FRAME_ENC_DELTA       /* UDP: compressed blocks; single frames as BIN */
+} AppFrameEncoding;
+
+typedef struct
+{
+  uint32_t now_ms;
+  int32_t  i2c_temp_c;
+  char     can_0x101[64];   /* pre-formatted text, filled on demand (APP_FBUF_Text) */
+  char     can_0x120[64];
+
+  /* typed fields (binary encoding) */
+  uint32_t seq;
+  uint64_t ts_us;
+  uint8_t  valid;           /* APP_TLM_VALID_* */
+  float    i2c_temp_f;      /* full-resolution temperature (delta blocks) */
+  uint8_t  can_hb_seq;
+  uint32_t can_lux_x100;
+  uint16_t can_full;
+  uint16_t can_ir;
+} AppTelemetry;
+
+/* One raw CAN frame for the event frame encoder */
+typedef struct
+{
+  uint64_t ts_us;
+  uint16_t id;
+  uint8_t  dlc;
+  uint8_t  data[8];
+} AppCanEvent;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* encoders: return number of bytes written, 0 on error / no space */
+uint16_t APP_FRAME_EncodeJSON(const AppTelemetry *t, uint8_t *out, uint16_t cap);
+uint16_t APP_FRAME_EncodeBinary(const AppTelemetry *t, uint8_t *out, uint16_t cap);
+uint16_t APP_FRAME_Encode(AppFrameEncoding enc, const AppTelemetry *t,
+                          uint8_t *out, uint16_t cap);
+
+/* n raw CAN frames as one event frame (always binary) */
+uint16_t APP_FRAME_EncodeCanEvents(const AppCanEvent *ev, uint8_t n, uint32_t seq,
+                                   uint8_t *out, uint16_t cap);
+
+const char *APP_FRAME_EncodingName(AppFrameEncoding enc);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_FRAME_H */
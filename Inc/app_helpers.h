@@ -46,6 +46,7 @@ uint8_t App_USBLog_IsEmpty(void);
 /* I2C getters for UI */
 uint8_t     App_I2C_IsOk(void);
 int         App_I2C_GetTempInt(void);
+float       App_I2C_GetTemp(void);
 const char *App_I2C_GetLastErr(void);
 
 /* UI line manager */
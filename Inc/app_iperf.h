@@ -0,0 +1,118 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_iperf.h
+ * Brief:   iperf2-compatible TCP/UDP throughput source and sink
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_IPERF_H
+#define APP_IPERF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* iperf2 default port (server listens here, client connects here by default) */
+#ifndef APP_IPERF_PORT
+#define APP_IPERF_PORT            5001U
+#endif
+
+/* Client defaults: iperf2 -t 10, -l 1470 (UDP), -b 1M (UDP) */
+#define APP_IPERF_DEFAULT_MS      10000U
+#define APP_IPERF_DEFAULT_LEN     1470U
+#define APP_IPERF_DEFAULT_KBPS    1000U
+
+/* Largest UDP datagram payload on a 1500 byte MTU */
+#define APP_IPERF_LEN_MAX         1472U
+
+/* Longest client run */
+#define APP_IPERF_MAX_MS          600000U
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  APP_IPERF_IDLE = 0,
+  APP_IPERF_TCP_SERVER,        /* sink: counts received bytes              */
+  APP_IPERF_UDP_SERVER,        /* sink: loss / order / jitter, FIN report  */
+  APP_IPERF_TCP_CLIENT,        /* source: pattern stream to a server       */
+  APP_IPERF_UDP_CLIENT         /* source: paced datagrams, FIN handshake   */
+} AppIperfMode;
+
+/*
+ * Counters of the current (or last) run. Byte and packet counts are what
+ * this side sent or received; lost / out_of_order / jitter come from the
+ * UDP sink, or from the server report for a UDP client run.
+ */
+typedef struct
+{
+  AppIperfMode mode;
+  bool         running;
+  bool         report;          /* UDP client: server report received     */
+
+  uint32_t     elapsed_ms;
+  uint64_t     bytes;
+  uint32_t     packets;         /* datagrams, or TCP segments (pbufs)     */
+  uint32_t     kbps;            /* bytes * 8 / elapsed_ms                 */
+  uint32_t     pps;
+
+  uint32_t     retransmits;     /* TCP segments retransmitted (lwIP stats) */
+  uint32_t     lost;
+  uint32_t     out_of_order;
+  uint32_t     jitter_us;
+
+  uint32_t     rx_pool_empty;   /* RX_POOL empty / DMA ring unavailable    */
+  uint32_t     tx_busy;         /* ETH TX ring full (ERR_MEM to lwIP)      */
+  uint32_t     mem_err;         /* lwIP pool / heap allocation failures    */
+  uint32_t     errors;          /* connect errors, datagrams not queued    */
+} AppIperfStats;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void APP_IPERF_Init(void);
+
+/* sink on APP_IPERF_PORT; a new client restarts the counters */
+bool APP_IPERF_StartServer(bool udp);
+
+/* source; kbps (UDP pacing, 0 = as fast as possible) and len are clamped */
+bool APP_IPERF_StartClient(bool udp, const char *ip_str, uint16_t port,
+                           uint32_t duration_ms, uint32_t kbps, uint16_t len);
+
+void APP_IPERF_Stop(void);
+
+/* main loop: UDP pacing, TCP refill, end of run, FIN retries */
+void APP_IPERF_Service(uint32_t now_ms);
+
+/* ms until APP_IPERF_Service() has work (0 = now, UINT32_MAX = idle) */
+uint32_t APP_IPERF_SleepTime(uint32_t now_ms);
+
+void APP_IPERF_GetStats(AppIperfStats *out);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_IPERF_H */
@@ -0,0 +1,90 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_membench.h
+ * Brief:   lwIP heap benchmark: allocation latency and fragmentation
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_MEMBENCH_H
+#define APP_MEMBENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Default and largest run (operations = allocations attempted) */
+#define APP_MEMBENCH_OPS_DEFAULT  20000U
+#define APP_MEMBENCH_OPS_MAX      500000U
+
+/* Blocks held at once, and their total size (leaves room for the stack) */
+#ifndef APP_MEMBENCH_SLOTS
+#define APP_MEMBENCH_SLOTS        32U
+#endif
+
+#ifndef APP_MEMBENCH_LIVE_MAX
+#define APP_MEMBENCH_LIVE_MAX     8192U
+#endif
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+/*
+ * Result of one run. Cycle counts are per mem_malloc() / mem_free() call
+ * (DWT). 'frag_fails' are failed allocations while the heap still had at
+ * least the requested number of bytes free: memory lost to fragmentation
+ * (heap) or to the wrong size class (pools).
+ */
+typedef struct
+{
+  bool     pools;             /* MEM_USE_POOLS build                      */
+  uint32_t ops;
+  uint32_t allocs;
+  uint32_t fails;
+  uint32_t frag_fails;
+  uint32_t skipped;           /* no slot / over APP_MEMBENCH_LIVE_MAX     */
+  uint32_t live_peak;         /* bytes held at once                       */
+
+  uint32_t alloc_min;
+  uint32_t alloc_max;
+  uint64_t alloc_total;
+  uint32_t free_min;
+  uint32_t free_max;
+  uint64_t free_total;
+  uint32_t frees;
+
+  uint32_t free_bytes;        /* at the end of the run, blocks still held */
+  uint32_t largest;           /* largest block that could be allocated    */
+} AppMemBench;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* replay the firmware's heap traffic profile for ops allocations (blocking) */
+void APP_MEMBENCH_Run(uint32_t ops, AppMemBench *out);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_MEMBENCH_H */
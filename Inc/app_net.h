@@ -24,6 +24,9 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "app_frame.h"     /* AppTelemetry, AppFrameEncoding */
+#include "app_fbuf.h"      /* AppFrameBuf */
+
 /* USER CODE BEGIN Includes */
 /* USER CODE END Includes */
 
@@ -41,17 +44,168 @@ extern "C" {
 #define APP_RASPI_IP        "192.168.1.50"
 #endif
 
+/* TCP TX queue: ring bytes and frame slots (slots must be a power of two) */
+#ifndef APP_NET_TCP_TXQ_BYTES
+#define APP_NET_TCP_TXQ_BYTES   4096U
+#endif
+
+#ifndef APP_NET_TCP_TXQ_FRAMES
+#define APP_NET_TCP_TXQ_FRAMES  64U
+#endif
+
+/* Store-and-forward backlog: ring bytes and frame slots (power of two) */
+#ifndef APP_NET_BACKLOG_BYTES
+#define APP_NET_BACKLOG_BYTES   16384U
+#endif
+
+#ifndef APP_NET_BACKLOG_FRAMES
+#define APP_NET_BACKLOG_FRAMES  512U
+#endif
+
+/* Max replayed frames in the TCP TX queue at once (rest is left for live) */
+#ifndef APP_NET_REPLAY_FRAMES_MAX
+#define APP_NET_REPLAY_FRAMES_MAX  (APP_NET_TCP_TXQ_FRAMES / 4U)
+#endif
+
+/* CAN push: frames drained per datagram, coalesce above this many pending */
+#ifndef APP_NET_CAN_PUSH_BATCH
+#define APP_NET_CAN_PUSH_BATCH     32U
+#endif
+
+#ifndef APP_NET_CAN_COALESCE_MIN
+#define APP_NET_CAN_COALESCE_MIN   4U
+#endif
+
+/* Telemetry sampling rate (Hz) */
+#ifndef APP_NET_SAMPLE_HZ_DEFAULT
+#define APP_NET_SAMPLE_HZ_DEFAULT       10U
+#endif
+#define APP_NET_SAMPLE_HZ_MIN           10U
+#define APP_NET_SAMPLE_HZ_MAX           1000U
+
+/* Longest high-rate capture window (APP_NET_StartCapture) */
+#define APP_NET_CAPTURE_MAX_MS          60000U
+
+/* UDP batch: largest payload for a 1500 byte MTU */
+#ifndef APP_NET_UDP_BATCH_MAX
+#define APP_NET_UDP_BATCH_MAX           1472U
+#endif
+
+/* Telemetry TX pbuf pool: one buffer per in-progress/queued datagram
+   (spares cover frames held by ARP while the gateway MAC resolves and
+   frames still in the ETH TX ring) */
+#ifndef APP_NET_TLM_PBUF_CNT
+#define APP_NET_TLM_PBUF_CNT            6U
+#endif
+
+/* Default max age of the oldest sample before a partial batch is sent */
+#ifndef APP_NET_UDP_LATENCY_DEFAULT_MS
+#define APP_NET_UDP_LATENCY_DEFAULT_MS  100U
+#endif
+
+/* MQTT publisher (lwIP apps/mqtt): broker, identity, topic root */
+#ifndef APP_MQTT_BROKER_IP
+#define APP_MQTT_BROKER_IP      APP_RASPI_IP
+#endif
+
+#ifndef APP_MQTT_PORT
+#define APP_MQTT_PORT           1883U
+#endif
+
+#ifndef APP_NET_MQTT_CLIENT_ID
+#define APP_NET_MQTT_CLIENT_ID      "nucleo-f767"
+#endif
+
+#ifndef APP_NET_MQTT_TOPIC_PREFIX
+#define APP_NET_MQTT_TOPIC_PREFIX   "nucleo-f767"
+#endif
+
+/* Publisher starts enabled (1) or waits for "mqtt on" (0) */
+#ifndef APP_NET_MQTT_DEFAULT_ON
+#define APP_NET_MQTT_DEFAULT_ON     0
+#endif
+
+#ifndef APP_NET_MQTT_KEEPALIVE_S
+#define APP_NET_MQTT_KEEPALIVE_S    30U
+#endif
+
+/* One burst of per-sensor topics per interval */
+#ifndef APP_NET_MQTT_INTERVAL_DEFAULT_MS
+#define APP_NET_MQTT_INTERVAL_DEFAULT_MS  1000U
+#endif
+#define APP_NET_MQTT_INTERVAL_MIN_MS      10U
+
+/* Reconnect: give up a pending connect after the timeout, then back off */
+#define APP_NET_MQTT_CONNECT_TIMEOUT_MS   5000U
+#define APP_NET_MQTT_BACKOFF_MIN_MS       2000U
+#define APP_NET_MQTT_BACKOFF_MAX_MS       30000U
+
 /* USER CODE BEGIN EC */
 /* USER CODE END EC */
 
 /* Exported types ------------------------------------------------------------*/
 typedef struct
 {
-  uint32_t now_ms;
-  int32_t  i2c_temp_c;
-  char     can_0x101[64];
-  char     can_0x120[64];
-} AppTelemetry;
+  uint16_t queued;          /* frames waiting for send buffer space */
+  uint16_t inflight;        /* frames written to TCP, not yet ACKed  */
+  uint32_t total_queued;
+  uint32_t total_acked;
+  uint32_t total_dropped;   /* lost from the queue on disconnect     */
+  uint32_t tcp_divider;     /* TCP carries every Nth sample          */
+  uint32_t cmds;            /* gateway requests received             */
+  uint32_t cmd_errors;      /* malformed input / response not queued */
+} AppNetTcpStats;
+
+typedef struct
+{
+  uint16_t depth;           /* frames stored                          */
+  uint16_t unsent;          /* frames waiting for (re)play            */
+  uint16_t bytes;
+  bool     gw_ack_mode;     /* gateway has sent at least one ACK      */
+  uint32_t gw_acked_seq;    /* last sequence persisted by the gateway */
+  uint32_t stored;
+  uint32_t evicted;         /* overwritten because the ring was full  */
+  uint32_t replayed;
+  uint32_t discarded;       /* other encoding than the stream, not replayed */
+} AppNetBacklogStats;
+
+typedef struct
+{
+  uint16_t pending_samples; /* samples in the current (unsent) batch */
+  uint16_t pending_bytes;
+  uint32_t datagrams;       /* datagrams sent                        */
+  uint32_t samples;         /* samples carried by those datagrams    */
+  uint32_t flush_full;      /* flushes because the MTU was reached   */
+  uint32_t flush_timer;     /* flushes because of the latency limit  */
+  uint32_t errors;          /* udp_sendto failures                   */
+  uint32_t no_pbuf;         /* telemetry pool exhausted              */
+  uint32_t dropped;         /* samples lost: no pbuf, encode or send */
+} AppNetUdpStats;
+
+typedef struct
+{
+  bool     enabled;
+  uint16_t pending;         /* frames waiting in the CAN RX ring       */
+  uint32_t frames;          /* frames taken from the ring              */
+  uint32_t coalesced;       /* superseded by a newer frame, same ID    */
+  uint32_t datagrams;
+  uint32_t errors;          /* no pbuf / udp_sendto failed             */
+  uint32_t overflow;        /* ring full in the ISR                    */
+} AppNetCanPushStats;
+
+typedef struct
+{
+  bool     enabled;
+  bool     connected;
+  char     broker[16];      /* dotted IPv4                             */
+  uint16_t broker_port;
+  uint32_t connects;        /* CONNACK accepted                        */
+  uint32_t disconnects;     /* established session lost                */
+  uint32_t errors;          /* connect failed / refused / timed out    */
+  uint32_t bursts;          /* samples published                       */
+  uint32_t publishes;       /* PUBLISH messages queued                 */
+  uint32_t dropped;         /* output ring or request pool full        */
+} AppNetMqttStats;
 
 /* USER CODE BEGIN ET */
 /* USER CODE END ET */
@@ -61,24 +215,63 @@ typedef struct
 void APP_NET_Init(void);
 void APP_NET_Poll(uint32_t now_ms);
 
-/* main-loop service (lwIP tick + periodic send) */
+/* main-loop service (lwIP pump + periodic send) */
 void APP_NET_Service(uint32_t now_ms);
 
-/* send primitives */
-bool APP_NET_SendUDP(const AppTelemetry *t);
-bool APP_NET_SendTCP(const AppTelemetry *t);
+/* ms until APP_NET_Service() has work (0 = do not sleep) */
+uint32_t APP_NET_SleepTime(uint32_t now_ms);
+
+/* send primitives for a shared sample (UDP appends to the current batch) */
+bool APP_NET_SendUDP(AppFrameBuf *f);
+bool APP_NET_FlushUDP(void);
+bool APP_NET_SendTCP(AppFrameBuf *f);
+
+/* sampling rate + UDP batching */
+void     APP_NET_SetSampleRate(uint32_t hz);
+uint32_t APP_NET_GetSampleRate(void);
+void     APP_NET_StartCapture(uint32_t hz, uint32_t duration_ms, uint32_t now_ms);
+bool     APP_NET_CaptureActive(void);
+void     APP_NET_SetUdpMaxLatency(uint32_t ms);
+uint32_t APP_NET_GetUdpMaxLatency(void);
+void     APP_NET_GetUdpStats(AppNetUdpStats *out);
 
 /* TCP status */
 bool APP_NET_TcpIsConnected(void);
+void APP_NET_GetTcpStats(AppNetTcpStats *out);
+void APP_NET_GetBacklogStats(AppNetBacklogStats *out);
+
+/* event-driven CAN push (opt-in) */
+void APP_NET_SetCanPush(bool on);
+bool APP_NET_GetCanPush(void);
+void APP_NET_GetCanPushStats(AppNetCanPushStats *out);
+
+/* MQTT publisher (opt-in) */
+void     APP_NET_SetMqtt(bool on);
+bool     APP_NET_GetMqtt(void);
+bool     APP_NET_MqttIsConnected(void);
+bool     APP_NET_SetMqttBroker(const char *ip_str, uint16_t port);
+void     APP_NET_SetMqttInterval(uint32_t ms);
+uint32_t APP_NET_GetMqttInterval(void);
+void     APP_NET_GetMqttStats(AppNetMqttStats *out);
+
+/* network statistics channel: JSON line on the UDP port every ms (0 = off) */
+void     APP_NET_SetNetstatPeriod(uint32_t ms);
+uint32_t APP_NET_GetNetstatPeriod(void);
+void     APP_NET_GetNetstatCounts(uint32_t *sent, uint32_t *errors);
+
+/* CAN statistics channel (can_stats.c): JSON line on the UDP port every ms (0 = off) */
+void     APP_NET_SetCanStatsPeriod(uint32_t ms);
+uint32_t APP_NET_GetCanStatsPeriod(void);
+void     APP_NET_GetCanStatsCounts(uint32_t *sent, uint32_t *errors);
 
 /* remote config */
 bool APP_NET_SetRemote(const char *ip_str,
                         uint16_t udp_port,
                         uint16_t tcp_port);
 
-/* UI helpers: last payload snippets */
-const char *APP_NET_GetLastUDP(void);
-const char *APP_NET_GetLastTCP(void);
+/* wire encoding (JSON line or binary frame), applies to UDP and TCP */
+void             APP_NET_SetEncoding(AppFrameEncoding enc);
+AppFrameEncoding APP_NET_GetEncoding(void);
 
 /* USER CODE BEGIN EFP */
 /* USER CODE END EFP */
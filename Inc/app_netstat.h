@@ -0,0 +1,113 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_netstat.h
+ * Brief:   Network stack statistics: pools, protocols, ETH DMA, drops
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_NETSTAT_H
+#define APP_NETSTAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Rows of the pool table: heap + lwIP pools + private pools (RX, TLM) */
+#ifndef APP_NETSTAT_POOLS_MAX
+#define APP_NETSTAT_POOLS_MAX     32U
+#endif
+
+/* Rows of the protocol table: link, etharp, ip, icmp, udp, tcp */
+#define APP_NETSTAT_PROTOS_MAX    6U
+
+/* Telemetry channel period limits (0 = off) */
+#define APP_NETSTAT_PERIOD_MIN_MS 100U
+#define APP_NETSTAT_PERIOD_MAX_MS 3600000U
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+/*
+ * One memory pool (or the heap). 'avail' is the capacity in elements (bytes
+ * for the heap); 'peak' is the high-water mark since boot or the last
+ * APP_NETSTAT_ResetPeaks(); 'fail' counts allocations that found it empty.
+ */
+typedef struct
+{
+  const char *name;
+  uint32_t    avail;
+  uint32_t    used;
+  uint32_t    peak;
+  uint32_t    fail;
+} AppNetstatPool;
+
+/* Per-protocol packet counters (lwIP stats) */
+typedef struct
+{
+  const char *name;
+  uint32_t    xmit;
+  uint32_t    recv;
+  uint32_t    drop;
+  uint32_t    memerr;           /* out of pbufs / pool elements           */
+  uint32_t    err;              /* checksum, length, routing, protocol     */
+} AppNetstatProto;
+
+/* Ingress / egress loss outside the lwIP counters */
+typedef struct
+{
+  uint32_t rx_pool_empty;       /* RX_POOL empty at descriptor refill      */
+  uint32_t rx_buf_unavail;      /* DMA suspended: no free RX descriptor    */
+  uint32_t rx_missed;           /* frames missed by the DMA (no descriptor) */
+  uint32_t rx_fifo_overflow;    /* frames lost to an RX FIFO overflow      */
+  uint32_t rx_crc_errors;       /* MMC: frames with a CRC error            */
+  uint32_t rx_align_errors;     /* MMC: frames with an alignment error     */
+  uint32_t dma_errors;          /* other abnormal DMA interrupts           */
+  uint32_t tx_busy;             /* TX ring full (ERR_MEM to lwIP)          */
+
+  uint32_t tcp_retrans;         /* TCP fast retransmits (MIB2)             */
+  uint32_t udp_dropped;         /* telemetry samples not sent              */
+  uint32_t udp_no_pbuf;         /* TLM_POOL exhausted                      */
+  uint32_t tcp_dropped;         /* queued frames lost on disconnect        */
+  uint32_t backlog_evicted;     /* backlog frames overwritten              */
+} AppNetstatDrops;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* fill up to cap rows; return the number of rows */
+uint8_t APP_NETSTAT_GetPools(AppNetstatPool *out, uint8_t cap);
+uint8_t APP_NETSTAT_GetProtos(AppNetstatProto *out, uint8_t cap);
+void    APP_NETSTAT_GetDrops(AppNetstatDrops *out);
+
+/* restart the high-water marks at the current usage */
+void    APP_NETSTAT_ResetPeaks(void);
+
+/* one JSON line {"netstat":{...}}\n; 0 if it does not fit */
+uint16_t APP_NETSTAT_EncodeJSON(uint32_t now_ms, char *out, uint16_t cap);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_NETSTAT_H */
@@ -26,12 +26,50 @@ extern "C" {
 /* USER CODE BEGIN Includes */
 /* USER CODE END Includes */
 
+/* Exported constants --------------------------------------------------------*/
+/*
+ * Non-cacheable SRAM for DMA buffers: MPU region 1 (MPU_Config()) and the
+ * RAM_NC memory of STM32F767ZITX_FLASH.ld: the ETH descriptors, RX_POOL and
+ * every APP_DMA_BUFFER object, the lwIP heap (or its malloc pools) included
+ * (lwipopts.h). The section is NOLOAD: contents are not zeroed at startup.
+ */
+#define APP_DMA_RAM_BASE        0x20060000UL
+#define APP_DMA_RAM_SIZE        0x00020000UL        /* 128 KB */
+
+#define APP_DMA_BUFFER          __attribute__((section(".dma_buffer"), aligned(32)))
+#define APP_IS_DMA_RAM(p)       (((uint32_t)(p) - APP_DMA_RAM_BASE) < APP_DMA_RAM_SIZE)
+
+/*
+ * Tightly coupled memories (zero wait state, never cached), see the linker
+ * script for the vendor functions (CAN/ETH HAL, lwIP checksum) placed there
+ * by name:
+ *  - APP_ITCM       function copied from flash to ITCM by the startup code
+ *  - APP_DTCM       zero-initialized hot state in DTCM
+ *  - APP_DTCM_DATA  initialized hot state in DTCM
+ * The main stack and the heap are in DTCM as well. The post-build placement
+ * report (cmake/placement_report.cmake) lists what landed where.
+ */
+#define APP_ITCM                __attribute__((section(".itcm_text"), noinline))
+#define APP_DTCM                __attribute__((section(".dtcm_bss")))
+#define APP_DTCM_DATA           __attribute__((section(".dtcm_data")))
+
 /* Exported functions prototypes ---------------------------------------------*/
 /* Platform-level functions expected by CubeMX-generated code */
 void SystemClock_Config(void);
 void MPU_Config(void);
 void Error_Handler(void);
 
+/* Microseconds since boot (HAL tick + SysTick sub-millisecond count) */
+uint64_t App_GetMicros(void);
+
+/* DWT cycle counter (benchmarks) */
+void     App_CycleCounterInit(void);
+uint32_t App_GetCycles(void);
+
+/* D-cache maintenance for DMA buffers outside APP_DMA_RAM (no-op inside) */
+void App_DCacheClean(const void *addr, uint32_t len);
+void App_DCacheInvalidate(void *addr, uint32_t len);
+
 /* USER CODE BEGIN EFP */
 /* USER CODE END EFP */
 
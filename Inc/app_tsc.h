@@ -0,0 +1,125 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_tsc.h
+ * Brief:   Streaming time-series compression for batched telemetry
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_TSC_H
+#define APP_TSC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_frame.h"     /* AppTelemetry, frame header */
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/*
+ * Compressed block (APP_FRAME_TYPE_BLOCK), one per UDP datagram:
+ *
+ *   [frame header]  nfields = APP_TSC_CHANNELS, seq/ts_us = first sample
+ *   [count u16]     number of samples in the block
+ *   [sample] x count
+ *
+ * Each sample:
+ *   ctrl u8         bit0..4: channel value present and changed (APP_TSC_CH_*)
+ *                   bit5: valid mask byte follows
+ *                   bit6: sequence gap follows
+ *   dod  varint     zigzag(delta-of-delta of ts_us)
+ *   [valid u8]      AppTelemetry.valid, if ctrl bit5
+ *   [gap varint]    seq - (prev seq + 1), if ctrl bit6
+ *   [values]        changed channels in bit order:
+ *                     float channel : Gorilla-style XOR with previous bits
+ *                                     (byte aligned: [tz<<2 | (nbytes-1)] + nbytes)
+ *                     int channels  : zigzag varint of (value - previous)
+ *
+ * The predictor state starts at zero in every block, so each datagram can be
+ * decoded on its own. Unchanged channels cost nothing.
+ */
+#define APP_TSC_CH_I2C_TEMP     (1U << 0)   /* float degC (XOR)   */
+#define APP_TSC_CH_CAN_HB_SEQ   (1U << 1)   /* uint8              */
+#define APP_TSC_CH_CAN_LUX      (1U << 2)   /* uint32 lux*100     */
+#define APP_TSC_CH_CAN_FULL     (1U << 3)   /* uint16             */
+#define APP_TSC_CH_CAN_IR       (1U << 4)   /* uint16             */
+#define APP_TSC_CTRL_VALID      (1U << 5)
+#define APP_TSC_CTRL_SEQ_GAP    (1U << 6)
+
+#define APP_TSC_CHANNELS        5U
+
+/* Block overhead (header + count) and worst-case bytes per sample */
+#define APP_TSC_BLOCK_HDR_LEN   (APP_FRAME_HDR_LEN + 2U)
+#define APP_TSC_SAMPLE_MAX      (1U + 10U + 1U + 5U + 5U + (4U * 5U))
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint8_t  *out;
+  uint16_t  cap;
+  uint16_t  len;
+  uint16_t  count;
+
+  /* predictor state */
+  uint32_t  prev_seq;
+  uint64_t  prev_ts;
+  int64_t   prev_delta;
+  uint8_t   prev_valid;
+  uint32_t  prev_temp_bits;
+  uint8_t   prev_hb_seq;
+  uint32_t  prev_lux;
+  uint16_t  prev_full;
+  uint16_t  prev_ir;
+} AppTscEncoder;
+
+typedef struct
+{
+  uint16_t samples;
+  uint32_t bytes_delta;     /* compressed block(s)          */
+  uint32_t bytes_bin;       /* same samples as binary frames */
+  uint32_t bytes_json;      /* same samples as JSON lines    */
+  uint32_t cycles;          /* APP_TSC_Append total          */
+} AppTscBench;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* start a block in out[0..cap) with t as the first sample's reference */
+bool     APP_TSC_Begin(AppTscEncoder *e, uint8_t *out, uint16_t cap,
+                       const AppTelemetry *t);
+
+/* append one sample; returns bytes added, 0 if the block is full */
+uint16_t APP_TSC_Append(AppTscEncoder *e, const AppTelemetry *t);
+
+/* patch header length/count; returns total block length */
+uint16_t APP_TSC_Finish(AppTscEncoder *e);
+
+/* on-target benchmark over a synthetic slowly-varying signal */
+void     APP_TSC_Benchmark(uint16_t nsamples, uint32_t sample_hz, AppTscBench *out);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_TSC_H */
@@ -0,0 +1,94 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    app_txq.h
+ * Brief:   Frame ring for zero-copy TCP transmit with ACK-driven release
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_TXQ_H
+#define APP_TXQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported types ------------------------------------------------------------*/
+/* One encoded frame inside the byte ring */
+typedef struct
+{
+  uint16_t off;
+  uint16_t len;
+} AppTxqDesc;
+
+/*
+ * Frame life cycle (descriptor indices are free-running counters):
+ *
+ *   tail ........ sent ........ head
+ *   [ in flight  ][  queued    ][ free ]
+ *
+ *  - queued   : committed, not yet handed to tcp_write()
+ *  - in flight: handed to lwIP (no-copy), memory pinned until ACKed
+ */
+typedef struct
+{
+  uint8_t    *buf;
+  uint16_t    size;       /* ring size in bytes */
+  AppTxqDesc *desc;
+  uint16_t    ndesc;      /* descriptor slots */
+
+  uint16_t    tail;       /* oldest frame not fully ACKed */
+  uint16_t    sent;       /* first frame not yet written to TCP */
+  uint16_t    head;       /* next descriptor to commit */
+  uint16_t    acked;      /* ACKed bytes of the tail frame (partial ACK) */
+  uint16_t    wr;         /* byte offset after the newest frame */
+  uint16_t    res_off;    /* offset handed out by the last reserve */
+} AppTxQueue;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void APP_TXQ_Init(AppTxQueue *q, uint8_t *buf, uint16_t size,
+                  AppTxqDesc *desc, uint16_t ndesc);
+
+/* producer: reserve contiguous space, encode into it, then commit */
+uint8_t *APP_TXQ_Reserve(AppTxQueue *q, uint16_t max_len);
+void     APP_TXQ_Commit(AppTxQueue *q, uint16_t len);
+
+/* transmitter: next queued frame, mark it handed to TCP */
+bool APP_TXQ_PeekUnsent(const AppTxQueue *q, const uint8_t **data, uint16_t *len);
+void APP_TXQ_MarkSent(AppTxQueue *q);
+
+/* release ACKed bytes (in transmit order); returns frames released */
+uint16_t APP_TXQ_Ack(AppTxQueue *q, uint32_t bytes);
+
+/* drop everything; returns number of frames discarded */
+uint16_t APP_TXQ_Reset(AppTxQueue *q);
+
+/* occupancy */
+uint16_t APP_TXQ_Queued(const AppTxQueue *q);
+uint16_t APP_TXQ_InFlight(const AppTxQueue *q);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_TXQ_H */
@@ -29,11 +29,105 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 #include "main.h"
+#include "can_filter.h"
 
 /* USER CODE BEGIN Includes */
 /* USER CODE END Includes */
 
+/* Exported constants --------------------------------------------------------*/
+/* RX ring (RX ISR -> CAN1_Service()), must be a power of two. 256 frames
+   cover ~60 ms of a fully loaded 500 kbit/s bus between two service calls */
+#ifndef CAN1_RX_RING_SIZE
+#define CAN1_RX_RING_SIZE   256U
+#endif
+
+/* RX ring of FIFO1 (high-priority IDs of the table), power of two */
+#ifndef CAN1_RX1_RING_SIZE
+#define CAN1_RX1_RING_SIZE  32U
+#endif
+
+/* Rejected-frame survey: the accept-all filter bank is opened for WINDOW
+   every PERIOD and what it lets in is scaled up to the period */
+#ifndef CAN1_FILTER_SURVEY_PERIOD_MS
+#define CAN1_FILTER_SURVEY_PERIOD_MS  10000U
+#endif
+#ifndef CAN1_FILTER_SURVEY_WINDOW_MS
+#define CAN1_FILTER_SURVEY_WINDOW_MS  100U
+#endif
+
+/* TX queue (CAN1_Send() -> 3 mailboxes), ordered by ID priority */
+#ifndef CAN1_TX_QUEUE_SIZE
+#define CAN1_TX_QUEUE_SIZE  32U
+#endif
+
+/* Raw capture ring (CAN1_Service() -> telemetry push), must be a power of two */
+#ifndef CAN1_RAW_RING_SIZE
+#define CAN1_RAW_RING_SIZE  32U
+#endif
+
 /* Exported types ------------------------------------------------------------*/
+/* One received standard data frame with its arrival time */
+typedef struct
+{
+  uint64_t ts_us;           /* start of frame, App_GetMicros() time base     */
+  uint16_t hw_ts;           /* bxCAN timer at start of frame (bit times)     */
+  uint16_t id;
+  uint8_t  dlc;
+  uint8_t  data[8];
+} CAN1_RawFrame;
+
+/* Receive path counters of one RX FIFO and its ring */
+typedef struct
+{
+  uint32_t frames;          /* frames handled by CAN1_Service()              */
+  uint32_t ignored;         /* extended / remote frames                      */
+  uint32_t ring_overflow;   /* RX ring full in the ISR: frame dropped        */
+  uint32_t fifo_overrun;    /* FIFO overran: frames lost in hardware         */
+  uint16_t pending;         /* frames waiting in the RX ring                 */
+  uint16_t max_pending;     /* high-water mark of 'pending'                  */
+  uint16_t size;            /* ring capacity                                 */
+  uint8_t  max_batch;       /* most frames taken from the FIFO in one IRQ    */
+} CAN1_RxFifoStats;
+
+typedef struct
+{
+  CAN1_RxFifoStats fifo[2]; /* [0] FIFO0, [1] FIFO1 (high-priority IDs)      */
+  uint32_t bit_ns;          /* nominal bit time (hw_ts unit)                 */
+} CAN1_RxStats;
+
+/* Hardware filter state */
+typedef struct
+{
+  uint8_t  banks;           /* banks programmed from the table               */
+  uint8_t  list_banks;
+  uint8_t  mask_banks;
+  uint8_t  fifo1_banks;
+  uint16_t ids;             /* table IDs                                     */
+  uint16_t extra_ids;       /* other IDs the mask banks let through          */
+  bool     accept_all;      /* table not packable: every frame accepted      */
+  bool     open;            /* accept-all bank active (survey / capture)     */
+  uint32_t outside;         /* frames only the accept-all bank let in        */
+  uint32_t surveys;         /* survey windows accounted                      */
+  uint32_t rejected_est;    /* frames rejected in hardware (extrapolated)    */
+} CAN1_FilterStats;
+
+/* Transmit path counters */
+typedef struct
+{
+  uint32_t queued;          /* frames accepted by CAN1_Send()                */
+  uint32_t sent;            /* frames ACKed on the bus                       */
+  uint32_t rejected;        /* CAN1_Send() refused: queue full, all better   */
+  uint32_t dropped;         /* lost to a full queue of better frames         */
+  uint32_t expired;         /* deadline passed (queue or mailbox)            */
+  uint32_t preempted;       /* mailbox aborted for a better frame, re-queued */
+  uint32_t errors;          /* mailbox finished without TXOK, no abort asked */
+  uint16_t pending;         /* frames in the queue                           */
+  uint16_t max_pending;     /* high-water mark of 'pending'                  */
+  uint8_t  in_flight;       /* mailboxes in use                              */
+  uint32_t last_latency_us; /* CAN1_Send() to TX complete                    */
+  uint32_t max_latency_us;
+} CAN1_TxStats;
+
 /* USER CODE BEGIN ET */
 /* USER CODE END ET */
 
@@ -48,8 +142,22 @@ extern CAN_HandleTypeDef hcan1;
 void MX_CAN1_Init(void);
 void CAN1_Start(void);
 
-/* service hook (called by App_CAN_Service()) */
-void CAN1_Service(void);
+/* decode the frames queued by the RX ISR (called by App_CAN_Service()) */
+void     CAN1_Service(void);
+uint16_t CAN1_RxPending(void);
+void     CAN1_GetRxStats(CAN1_RxStats *out);
+
+/* hardware filters (programmed by CAN1_Start() from can_db_table.h) */
+void     CAN1_GetFilterStats(CAN1_FilterStats *out);
+uint8_t  CAN1_GetFilterBank(uint8_t bank, CanFltBank *out);
+
+/* transmit (never blocks; deadline_ms 0 = none) */
+uint8_t  CAN1_Send(uint16_t id, const uint8_t *data, uint8_t dlc, uint32_t deadline_ms);
+void     CAN1_GetTxStats(CAN1_TxStats *out);
+void     CAN1_TxMailboxIRQ(void);   /* called by CAN1_TX_IRQHandler() */
+
+/* error interrupt (bus statistics: can_stats.h) */
+void     CAN1_SceIRQ(void);         /* called by CAN1_SCE_IRQHandler() */
 
 /* text/status API (used by app_helpers.c / CLI / UI) */
 const char *CAN1_GetLastText(void);
@@ -58,10 +166,18 @@ const char *CAN1_GetText_0x120(void);
 
 /* structured 0x101 access */
 uint8_t CAN1_101_IsValid(void);
+uint8_t CAN1_101_GetSeq(void);
+
+/* raw frame capture (opt-in, filled by CAN1_Service()) */
+void     CAN1_SetRawCapture(uint8_t on);
+uint8_t  CAN1_PopRaw(CAN1_RawFrame *out);
+uint16_t CAN1_RawPending(void);
+uint32_t CAN1_GetRawOverflow(void);
 
 /* structured 0x120 access */
 uint8_t  CAN1_120_IsValid(void);
 uint32_t CAN1_120_GetLux(void);   /* lux (integer, not x100) */
+uint32_t CAN1_120_GetLuxX100(void);
 uint16_t CAN1_120_GetFull(void);
 uint16_t CAN1_120_GetIR(void);
 
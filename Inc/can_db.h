@@ -0,0 +1,115 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    can_db.h
+ * Brief:   Table-driven CAN signal decoder (table: can_db_table.h)
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CAN_DB_H
+#define CAN_DB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Byte order and signedness of a signal (SIG rows) */
+#define CAN_DB_LE           0U    /* Intel    */
+#define CAN_DB_BE           1U    /* Motorola */
+#define CAN_DB_UNSIGNED     0U
+#define CAN_DB_SIGNED       1U
+
+/* Standard IDs covered by the O(1) index */
+#define CAN_DB_ID_SPACE     2048U
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+#include "can_db_table.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Messages of the table: CAN_DB_MSG_<name> */
+typedef enum
+{
+#define CAN_DB_X_MSG(name, id, dlc, timeout_ms, fifo, label)  CAN_DB_MSG_##name,
+#define CAN_DB_X_SIG(msg, name, start, len, order, sign, num, den, offset, key)
+  CAN_DB_TABLE(CAN_DB_X_MSG, CAN_DB_X_SIG)
+#undef CAN_DB_X_MSG
+#undef CAN_DB_X_SIG
+  CAN_DB_MSG_COUNT
+} CanDbMsg;
+
+/*
+ * Signals of the table: CAN_DB_SIG_<msg>_<name>, numbered in table order.
+ * CAN_DB_SIG_FIRST_<msg> is the number of the first signal of a message
+ * (the next entry re-uses its value, so markers take no number).
+ */
+typedef enum
+{
+#define CAN_DB_X_MSG(name, id, dlc, timeout_ms, fifo, label) \
+  CAN_DB_SIG_FIRST_##name, CAN_DB_SIG_MARK_##name = CAN_DB_SIG_FIRST_##name - 1,
+#define CAN_DB_X_SIG(msg, name, start, len, order, sign, num, den, offset, key) \
+  CAN_DB_SIG_##msg##_##name,
+  CAN_DB_TABLE(CAN_DB_X_MSG, CAN_DB_X_SIG)
+#undef CAN_DB_X_MSG
+#undef CAN_DB_X_SIG
+  CAN_DB_SIG_COUNT
+} CanDbSig;
+
+/* Per-message reception state */
+typedef struct
+{
+  uint16_t    id;
+  uint8_t     fifo;         /* RX FIFO the filters route the ID to     */
+  const char *label;
+  uint32_t    frames;       /* frames decoded                          */
+  uint32_t    dlc_errors;   /* frames shorter than the table's DLC     */
+  uint32_t    last_ms;      /* HAL tick of the last decoded frame      */
+  bool        fresh;        /* decoded within the message's timeout    */
+} CanDbMsgInfo;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* decode one standard data frame; returns its CanDbMsg, -1 if not decoded */
+int16_t CAN_DB_Decode(uint16_t id, uint8_t dlc, const uint8_t *data, uint32_t now_ms);
+
+/* message state */
+bool     CAN_DB_MsgFresh(CanDbMsg m, uint32_t now_ms);
+uint32_t CAN_DB_MsgFrames(CanDbMsg m);     /* changes with every decoded frame */
+void     CAN_DB_GetMsgInfo(CanDbMsg m, uint32_t now_ms, CanDbMsgInfo *out);
+uint32_t CAN_DB_GetUnknown(void);          /* frames with an ID not in the table */
+bool     CAN_DB_IsKnownId(uint16_t id);    /* ID has a MSG row */
+
+/* signal values of the last decoded frame */
+uint32_t CAN_DB_GetRaw(CanDbSig s);        /* raw bits (sign-extended if signed) */
+int32_t  CAN_DB_GetPhys(CanDbSig s);       /* raw * num / den + offset, truncated */
+float    CAN_DB_GetPhysF(CanDbSig s);
+
+/* "<label> key=value ..." with integer physical values; returns the length */
+uint16_t CAN_DB_FormatMsg(CanDbMsg m, char *out, uint16_t cap);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_DB_H */
@@ -0,0 +1,60 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    can_db_table.h
+ * Brief:   CAN message / signal table (DBC-like), read by can_db.h/.c
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CAN_DB_TABLE_H
+#define CAN_DB_TABLE_H
+
+/*
+ * Every frame the controller understands is one MSG row followed by the
+ * SIG rows of its signals. Adding a sensor node means adding rows here;
+ * can_db.c builds the ID index, the decoder and the text from this table
+ * at compile time.
+ *
+ * MSG(name, id, dlc, timeout_ms, fifo, label)
+ *   name        C identifier, enum CAN_DB_MSG_<name>
+ *   id          11-bit standard ID, unique (a duplicate is reported by
+ *               -Woverride-init, part of -Wextra)
+ *   dlc         minimum data length; shorter frames are counted, not decoded
+ *   timeout_ms  values older than this are stale (CAN_DB_MsgFresh())
+ *   fifo        RX FIFO: 0, or 1 for high-priority IDs (own interrupt,
+ *               serviced first); the table's IDs also program the hardware
+ *               filters, so frames of other IDs never interrupt the CPU
+ *   label       first word of the text ("<label> key=value ...")
+ *
+ * SIG(msg, name, start, len, order, sign, num, den, offset, key)
+ *   name        enum CAN_DB_SIG_<msg>_<name>
+ *   start, len  DBC bit position and length (1..32 bits): start is the
+ *               least significant bit for CAN_DB_LE (Intel) and the most
+ *               significant bit for CAN_DB_BE (Motorola)
+ *   sign        CAN_DB_UNSIGNED or CAN_DB_SIGNED (two's complement)
+ *   num, den    scale as a fraction, offset an integer:
+ *               physical = raw * num / den + offset
+ *   key         text key, NULL to leave the signal out of the text
+ *
+ * The signals must lie within the first 'dlc' bytes (checked at compile
+ * time).
+ */
+#define CAN_DB_TABLE(MSG, SIG)                                                          \
+  /* ESP32 node: heartbeat */                                                           \
+  MSG(HB,    0x101u, 1u, 2000u, 1u, "HB")                                               \
+  SIG(HB,    SEQ,       0u,  8u, CAN_DB_LE, CAN_DB_UNSIGNED, 1, 1,   0, "seq")          \
+                                                                                        \
+  /* ESP32 node: light sensor */                                                        \
+  MSG(LIGHT, 0x120u, 8u, 2000u, 0u, "LIGHT")                                            \
+  SIG(LIGHT, LUX_X100,  0u, 32u, CAN_DB_LE, CAN_DB_UNSIGNED, 1, 100, 0, "lux")          \
+  SIG(LIGHT, FULL,     32u, 16u, CAN_DB_LE, CAN_DB_UNSIGNED, 1, 1,   0, "full")         \
+  SIG(LIGHT, IR,       48u, 16u, CAN_DB_LE, CAN_DB_UNSIGNED, 1, 1,   0, "ir")
+
+#endif /* CAN_DB_TABLE_H */
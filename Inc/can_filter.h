@@ -0,0 +1,102 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    can_filter.h
+ * Brief:   bxCAN filter bank packing for a set of standard IDs
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CAN_FILTER_H
+#define CAN_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Filter banks of CAN1 (CAN2 starts at SlaveStartFilterBank = 14) */
+#define CAN_FLT_BANKS_MAX   14U
+
+/* IDs handled by one CAN_FLT_Pack() call */
+#define CAN_FLT_IDS_MAX     256U
+
+/* Standard ID mask with every bit compared */
+#define CAN_FLT_MASK_EXACT  0x7FFU
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+/* One subscribed standard ID and the RX FIFO it should land in */
+typedef struct
+{
+  uint16_t id;
+  uint8_t  fifo;            /* 0 or 1 */
+} CanFltId;
+
+/*
+ * One 16-bit scale filter bank (standard data frames):
+ *  - list mode: four exact IDs (id[0..3]; unused slots repeat an ID)
+ *  - mask mode: two id/mask pairs (id[0]/mask[0], id[1]/mask[1]);
+ *    a frame passes if (frame_id & mask) == id
+ */
+typedef struct
+{
+  uint8_t  fifo;
+  bool     mask_mode;
+  uint16_t id[4];
+  uint16_t mask[2];
+} CanFltBank;
+
+typedef struct
+{
+  uint8_t  banks;           /* banks used                                */
+  uint8_t  list_banks;
+  uint8_t  mask_banks;
+  uint8_t  fifo1_banks;     /* banks routing to FIFO1 (placed first)     */
+  uint16_t ids;             /* distinct subscribed IDs                   */
+  uint16_t extra_ids;       /* other IDs the mask banks let through      */
+} CanFltResult;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * Pack the IDs into at most max_banks banks: exact lists while they fit,
+ * then masks merging the IDs that cost the fewest extra IDs. FIFO1 banks
+ * come first (lower bank numbers win ties against FIFO0 masks).
+ * Returns false if the IDs cannot be packed (too many, or both FIFOs
+ * needed with a single bank).
+ */
+bool CAN_FLT_Pack(const CanFltId *ids, uint16_t n, uint8_t max_banks,
+                  CanFltBank *out, CanFltResult *res);
+
+/* true if the bank passes the standard ID */
+bool CAN_FLT_Match(const CanFltBank *b, uint16_t id);
+
+/* bank register values (FilterIdHigh/Low, FilterMaskIdHigh/Low, 16-bit scale) */
+void CAN_FLT_BankRegs(const CanFltBank *b, uint32_t regs[4]);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_FILTER_H */
@@ -0,0 +1,130 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    can_stats.h
+ * Brief:   CAN bus load, error and per-ID rate / jitter statistics
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CAN_STATS_H
+#define CAN_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* IDs with their own rate / jitter row (power of two) */
+#ifndef CAN_STATS_IDS_MAX
+#define CAN_STATS_IDS_MAX         32U
+#endif
+
+/* Load and rate measurement window */
+#ifndef CAN_STATS_WINDOW_MS
+#define CAN_STATS_WINDOW_MS       1000U
+#endif
+
+/* Telemetry channel period limits (0 = off) */
+#define CAN_STATS_PERIOD_MIN_MS   100U
+#define CAN_STATS_PERIOD_MAX_MS   3600000U
+
+/* bxCAN last error codes (ESR.LEC), index of CanStatsBus.lec_count */
+#define CAN_STATS_LEC_STUFF       1U
+#define CAN_STATS_LEC_FORM        2U
+#define CAN_STATS_LEC_ACK         3U
+#define CAN_STATS_LEC_BIT1        4U      /* recessive bit read dominant */
+#define CAN_STATS_LEC_BIT0        5U      /* dominant bit read recessive */
+#define CAN_STATS_LEC_CRC         6U
+#define CAN_STATS_LEC_COUNT       7U
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+/* Frame rate and inter-arrival time of one ID (received frames) */
+typedef struct
+{
+  uint16_t id;
+  uint32_t frames;
+  uint32_t rate_x10;        /* frames/s * 10, last window              */
+  uint32_t period_us;       /* mean interval (EWMA 1/16)                */
+  uint32_t jitter_us;       /* mean |interval - period| (EWMA 1/16)     */
+  uint32_t min_us;          /* shortest / longest interval since reset  */
+  uint32_t max_us;
+} CanStatsId;
+
+/* Bus load and error state */
+typedef struct
+{
+  uint16_t load_permille;     /* received + sent frames, last window         */
+  uint16_t peak_permille;     /* highest window since boot / reset           */
+  uint16_t rejected_permille; /* traffic the filters drop (last survey)      */
+  uint32_t rx_fps;            /* frames per second, last window              */
+  uint32_t tx_fps;
+  uint32_t rx_frames;         /* totals                                      */
+  uint32_t tx_frames;
+  uint16_t ids;               /* IDs with a row                              */
+  uint32_t untracked;         /* frames of IDs that found the table full     */
+
+  uint8_t  tec;               /* transmit / receive error counters           */
+  uint8_t  rec;
+  uint8_t  last_lec;          /* last error code seen (CAN_STATS_LEC_*)      */
+  bool     warning;           /* current state: TEC or REC >= 96             */
+  bool     passive;           /*                TEC or REC >= 128            */
+  bool     bus_off;           /*                TEC > 255                    */
+  uint32_t err_irqs;          /* error interrupts                            */
+  uint32_t lec_count[CAN_STATS_LEC_COUNT];
+  uint32_t warning_events;    /* entries into each state                     */
+  uint32_t passive_events;
+  uint32_t busoff_events;
+  uint32_t recoveries;        /* bus-off left (automatic bus-off management) */
+  uint32_t fifo_overruns;     /* RX FIFO0 + FIFO1                            */
+} CanStatsBus;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* bits a standard data frame occupies on the wire: stuffing, CRC, IFS */
+uint16_t CAN_STATS_FrameBits(uint16_t id, uint8_t dlc, const uint8_t *data);
+
+/* feeding (can.c) */
+void CAN_STATS_Configure(uint32_t bit_ns);
+void CAN_STATS_OnRx(uint16_t id, uint8_t dlc, const uint8_t *data, uint64_t ts_us);
+void CAN_STATS_OnTx(uint16_t id, uint8_t dlc, const uint8_t *data);      /* TX ISR  */
+void CAN_STATS_OnErrorIrq(uint32_t esr);                                  /* SCE ISR */
+void CAN_STATS_OnOverrun(void);
+void CAN_STATS_OnRejected(uint16_t id, uint8_t dlc, const uint8_t *data); /* survey  */
+void CAN_STATS_OnSurvey(uint32_t window_ms);  /* 0: nothing is being rejected    */
+void CAN_STATS_Service(uint32_t now_ms, uint32_t esr);
+
+/* reading */
+void     CAN_STATS_GetBus(CanStatsBus *out);
+uint8_t  CAN_STATS_GetIds(CanStatsId *out, uint8_t cap);  /* sorted by ID */
+void     CAN_STATS_ResetPeaks(void);
+
+/* one JSON line {"canstats":{...}}\n; 0 if it does not fit */
+uint16_t CAN_STATS_EncodeJSON(uint32_t now_ms, char *out, uint16_t cap);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_STATS_H */
@@ -43,6 +43,63 @@ u32_t sys_jiffies(void);
 u32_t sys_now(void);
 
 /* USER CODE BEGIN 1 */
+/* RX / TX path counters (interrupt-driven DMA) */
+typedef struct
+{
+  u32_t rx_irq;             /* RX complete interrupts                     */
+  u32_t rx_frames;          /* frames passed to netif->input()            */
+  u32_t rx_pool_empty;      /* descriptor refill found RX_POOL empty      */
+  u32_t rx_buf_unavail;     /* DMA suspended: no free descriptor          */
+  u32_t dma_errors;         /* other abnormal DMA interrupts              */
+  u32_t rx_missed;          /* frames missed by the DMA: no descriptor    */
+  u32_t rx_fifo_overflow;   /* frames lost to an RX FIFO overflow         */
+  u32_t rx_crc_errors;      /* MMC: frames received with a CRC error      */
+  u32_t rx_align_errors;    /* MMC: frames received with alignment error  */
+
+  u32_t tx_frames;          /* frames handed to the TX DMA                */
+  u32_t tx_released;        /* frames the TX DMA has released, in order   */
+  u32_t tx_busy;            /* ERR_MEM returned: ring full / no memory    */
+  u32_t tx_linearized;      /* chains copied to fit the descriptor ring   */
+  u32_t tx_inuse;           /* TX descriptors owned by queued frames      */
+  u32_t tx_inuse_max;       /* high-water mark of tx_inuse                */
+
+  u32_t rx_mcast;           /* multicast frames passed by the hash table  */
+  u32_t rx_bcast;           /* broadcast frames received                  */
+  u32_t rx_bcast_dropped;   /* broadcasts over the per-second budget      */
+  u32_t rx_bcast_blocks;    /* storms: broadcasts disabled in the MAC     */
+  u32_t rx_budget_hits;     /* passes stopped at the per-pass frame cap   */
+  u8_t  bcast_blocked;      /* MAC currently discards broadcasts          */
+  u32_t mcast_hash[2];      /* MACHTHR, MACHTLR                           */
+} ethernetif_stats_t;
+
+/* MAC receive filter and ingress limits (unicast is always perfect-filtered) */
+typedef struct
+{
+  u8_t  promiscuous;        /* MAC passes every frame (diagnostics)       */
+  u8_t  pass_all_multicast; /* bypass the multicast hash table            */
+  u16_t bcast_per_sec;      /* broadcasts passed to lwIP, 0 = unlimited   */
+  u16_t rx_budget;          /* frames per ethernetif_input(), 0 = no cap  */
+} ethernetif_filter_t;
+
+/* non-zero when ethernetif_input() has RX frames or sent TX frames to handle */
+u8_t ethernetif_pending(void);
+
+/* ms until ethernetif_input() has work (0 = now) */
+#define ETHERNETIF_SLEEPTIME_INFINITE  0xFFFFFFFFUL
+u32_t ethernetif_sleeptime(void);
+void ethernetif_get_stats(ethernetif_stats_t *out);
+
+/* TX frames complete in submission order: buffers referenced by frames
+   submitted up to ethernetif_tx_mark() are no longer read by the DMA once
+   ethernetif_tx_released(mark) is non-zero (no-copy sources, PBUF_ROM) */
+u32_t ethernetif_tx_mark(void);
+u8_t  ethernetif_tx_released(u32_t mark);
+
+void  ethernetif_get_filter(ethernetif_filter_t *out);
+void  ethernetif_set_filter(const ethernetif_filter_t *cfg);
+
+/* multicast MAC address in/out of the hash table (lwIP IGMP/MLD use it too) */
+err_t ethernetif_mcast_filter(const u8_t *mac, u8_t add);
 /* USER CODE END 1 */
 
 #ifdef __cplusplus
@@ -60,6 +60,7 @@ void App_I2C_Service(uint32_t now_ms);
 /* UI-compatible getters */
 uint8_t     App_I2C_IsOk(void);
 int         App_I2C_GetTempInt(void);
+float       App_I2C_GetTemp(void);
 const char *App_I2C_GetLastErr(void);
 
 /* USER CODE BEGIN EFP */
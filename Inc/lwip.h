@@ -54,6 +54,11 @@ void MX_LWIP_Process(void);
 #endif /* !WITH_RTOS */
 
 /* USER CODE BEGIN 1 */
+/* single-pass pump: returns 1 if any work was done */
+uint8_t  MX_LWIP_Pump(uint32_t now_ms);
+
+/* ms until MX_LWIP_Pump() has work (0 = now) */
+uint32_t MX_LWIP_SleepTime(uint32_t now_ms);
 /* USER CODE END 1 */
 
 #ifdef __cplusplus
@@ -60,19 +60,29 @@
 /*----- Default Value for MEM_SIZE: 1600 ---*/
 #define MEM_SIZE 16384
 /*----- Default Value for F7 devices: 0x20048000 -----*/
-#define LWIP_RAM_HEAP_POINTER 0x20048000
+/* LWIP_RAM_HEAP_POINTER not set: ram_heap (or the MEM_USE_POOLS pools) is
+   placed in RAM_NC by the linker, see USER CODE 1 */
 /*----- Value in opt.h for LWIP_ETHERNET: LWIP_ARP || PPPOE_SUPPORT -*/
 #define LWIP_ETHERNET 1
 /*----- Value in opt.h for LWIP_DNS_SECURE: (LWIP_DNS_SECURE_RAND_XID | LWIP_DNS_SECURE_NO_MULTIPLE_OUTSTANDING | LWIP_DNS_SECURE_RAND_SRC_PORT) -*/
 #define LWIP_DNS_SECURE 7
+/*----- Default Value for TCP_MSS: 536 ---*/
+#define TCP_MSS 1460
+/*----- Default Value for TCP_SND_BUF: 2*TCP_MSS ---*/
+#define TCP_SND_BUF (4*TCP_MSS)
 /*----- Value in opt.h for TCP_SND_QUEUELEN: (4*TCP_SND_BUF + (TCP_MSS - 1))/TCP_MSS -----*/
-#define TCP_SND_QUEUELEN 9
+/*      raised for the no-copy telemetry queue (one PBUF_ROM per ring wrap)   */
+#define TCP_SND_QUEUELEN 24
 /*----- Value in opt.h for TCP_SNDLOWAT: LWIP_MIN(LWIP_MAX(((TCP_SND_BUF)/2), (2 * TCP_MSS) + 1), (TCP_SND_BUF) - 1) -*/
-#define TCP_SNDLOWAT 1071
+#define TCP_SNDLOWAT 2921
 /*----- Value in opt.h for TCP_SNDQUEUELOWAT: LWIP_MAX(TCP_SND_QUEUELEN)/2, 5) -*/
-#define TCP_SNDQUEUELOWAT 5
+#define TCP_SNDQUEUELOWAT 12
 /*----- Value in opt.h for TCP_WND_UPDATE_THRESHOLD: LWIP_MIN(TCP_WND/4, TCP_MSS*4) -----*/
-#define TCP_WND_UPDATE_THRESHOLD 536
+#define TCP_WND_UPDATE_THRESHOLD 1460
+/*----- Default Value for MEMP_NUM_TCP_SEG: 16 (must be >= TCP_SND_QUEUELEN) ---*/
+#define MEMP_NUM_TCP_SEG 24
+/*----- Default Value for MEMP_NUM_PBUF: 16 (PBUF_ROM/REF headers) ---*/
+#define MEMP_NUM_PBUF 32
 /*----- Default Value for LWIP_NETIF_STATUS_CALLBACK: 0 ---*/
 #define LWIP_NETIF_STATUS_CALLBACK 1
 /*----- Value in opt.h for LWIP_NETIF_LINK_CALLBACK: 0 -----*/
@@ -84,7 +94,7 @@
 /*----- Value in opt.h for RECV_BUFSIZE_DEFAULT: INT_MAX -----*/
 #define RECV_BUFSIZE_DEFAULT 2000000000
 /*----- Value in opt.h for LWIP_STATS: 1 -----*/
-#define LWIP_STATS 0
+#define LWIP_STATS 1
 /*----- Value in opt.h for CHECKSUM_GEN_IP: 1 -----*/
 #define CHECKSUM_GEN_IP 0
 /*----- Value in opt.h for CHECKSUM_GEN_UDP: 1 -----*/
@@ -107,7 +117,41 @@
 #define CHECKSUM_CHECK_ICMP6 0
 /*-----------------------------------------------------------------------------*/
 /* USER CODE BEGIN 1 */
+/* MQTT client (apps/mqtt): one extra sys timeout for its cyclic timer,
+   room for several QoS0 bursts waiting for send buffer space */
+#define MEMP_NUM_SYS_TIMEOUT      (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1)
+#define MQTT_OUTPUT_RINGBUF_SIZE  1024
+#define MQTT_REQ_MAX_IN_FLIGHT    16
 
+/* Counters read by the iperf benchmark (app_iperf.c) and "netstat"
+   (app_netstat.c): pool / heap use and errors (LWIP_STATS) and TCP fast
+   retransmits (MIB2); 32-bit counters, 16-bit ones wrap within minutes */
+#define MIB2_STATS                1
+#define LWIP_STATS_LARGE          1
+
+/* mem_malloc() (PBUF_RAM, copied TCP data): first-fit MEM_SIZE heap by
+   default; APP_LWIP_MEM_POOLS=1 (CMake LWIP_MEM_POOLS=ON) switches to the
+   fixed-size pools of lwippools.h: O(1) and no fragmentation */
+#if defined(APP_LWIP_MEM_POOLS) && (APP_LWIP_MEM_POOLS != 0)
+#define MEM_USE_POOLS                   1
+#define MEMP_USE_CUSTOM_POOLS           1
+#define MEM_USE_POOLS_TRY_BIGGER_POOL   1
+#endif
+
+/* PBUF_RAM payloads are read by the ETH TX DMA: the heap / malloc pools go to
+   the non-cacheable .dma_buffer section (RAM_NC), placed by the linker */
+#include "app_platform.h"  /* APP_DMA_BUFFER */
+#if defined(APP_LWIP_MEM_POOLS) && (APP_LWIP_MEM_POOLS != 0)
+#define LWIP_MALLOC_MEMPOOL_START
+#define LWIP_MALLOC_MEMPOOL(num, size)  extern uint8_t memp_memory_POOL_##size##_base[] APP_DMA_BUFFER;
+#define LWIP_MALLOC_MEMPOOL_END
+#include "lwippools.h"
+#undef LWIP_MALLOC_MEMPOOL_START
+#undef LWIP_MALLOC_MEMPOOL
+#undef LWIP_MALLOC_MEMPOOL_END
+#else
+extern uint8_t ram_heap[] APP_DMA_BUFFER;
+#endif
 /* USER CODE END 1 */
 
 #ifdef __cplusplus
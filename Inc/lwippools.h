@@ -0,0 +1,45 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    lwippools.h
+ * Brief:   lwIP mem_malloc() pools (MEM_USE_POOLS configuration)
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/*
+ * Included several times by lwip/priv/memp_std.h (and once by lwipopts.h to
+ * place the pools), each time with a different LWIP_MALLOC_MEMPOOL(): no
+ * include guard, nothing but the pool list.
+ *
+ * Only used with APP_LWIP_MEM_POOLS=1 (CMake option LWIP_MEM_POOLS). Every
+ * mem_malloc() then takes one element of the smallest pool that fits (or the
+ * next larger one if that is empty): O(1), no fragmentation. Sizes are user
+ * bytes; lwIP adds its 4 byte pool index to each element.
+ *
+ * Heap users of this firmware (PBUF_RAM: 16 byte struct pbuf, headers,
+ * payload) and the pool they land in:
+ *  - 128:  TCP ACK / header pbufs of no-copy telemetry segments (72 B, one
+ *          per segment in flight, TCP_SND_QUEUELEN), ARP, iperf UDP headers,
+ *          DNS queries
+ *  - 512:  MQTT bursts and gateway command responses (copied TCP writes)
+ *  - 1536: full-MSS copied segments and ARP-queued datagrams
+ *          (72 + TCP_MSS = 1532 B)
+ *
+ * Counts: 128 covers a full TCP send queue (24) plus ACKs, ARP and iperf
+ * headers in flight; 512 a few MQTT bursts and responses; 1536 the copied
+ * segments of one MQTT output ring. About MEM_SIZE in total. Size them for
+ * production from the "netstat" peaks (POOL_128 ...) of a worst-case run,
+ * and compare with "net membench".
+ */
+
+LWIP_MALLOC_MEMPOOL_START
+LWIP_MALLOC_MEMPOOL(48, 128)
+LWIP_MALLOC_MEMPOOL(8,  512)
+LWIP_MALLOC_MEMPOOL(4,  1536)
+LWIP_MALLOC_MEMPOOL_END
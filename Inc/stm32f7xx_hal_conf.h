@@ -215,6 +215,10 @@
 #define ETH_RXBUFNB                    ((uint32_t)4U)       /* 4 Rx buffers of size ETH_RX_BUF_SIZE  */
 #define ETH_TXBUFNB                    ((uint32_t)4U)       /* 4 Tx buffers of size ETH_TX_BUF_SIZE  */
 
+/* TX DMA descriptors: frames are queued without waiting (HAL_ETH_Transmit_IT),
+   one descriptor per pbuf of a chain */
+#define ETH_TX_DESC_CNT                8U
+
 /* Section 2: PHY configuration section */
 
 /* DP83848_PHY_ADDRESS Address*/
@@ -52,7 +52,10 @@ void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
 
+void CAN1_TX_IRQHandler(void);
 void CAN1_RX0_IRQHandler(void);
+void CAN1_RX1_IRQHandler(void);
+void ETH_IRQHandler(void);
 void OTG_FS_IRQHandler(void);
 
 /* USER CODE BEGIN EFP */
@@ -1153,7 +1153,10 @@ mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_
   }
 
   mqtt_append_request(&client->pend_req_queue, r);
-  mqtt_output_send(&client->output, client->conn);
+  /* Local change (nucleo-f767): a corked client flushes in mqtt_set_corked() */
+  if (!client->corked) {
+    mqtt_output_send(&client->output, client->conn);
+  }
   return ERR_OK;
 }
 
@@ -1460,4 +1463,25 @@ mqtt_client_is_connected(mqtt_client_t *client)
   return client->conn_state == MQTT_CONNECTED;
 }
 
+/**
+ * @ingroup mqtt
+ * Local change (nucleo-f767), not part of upstream lwIP.
+ * While corked, mqtt_publish() only appends to the output ring buffer;
+ * uncorking hands everything appended meanwhile to TCP in one write and
+ * one output, so a burst of small messages leaves as one segment.
+ * Reset by mqtt_client_connect().
+ * @param client MQTT client
+ * @param corked 1 to hold publishes back, 0 to flush them
+ */
+void
+mqtt_set_corked(mqtt_client_t *client, u8_t corked)
+{
+  LWIP_ASSERT_CORE_LOCKED();
+  LWIP_ASSERT("mqtt_set_corked: client != NULL", client);
+  client->corked = corked;
+  if (!corked && client->conn != NULL) {
+    mqtt_output_send(&client->output, client->conn);
+  }
+}
+
 #endif /* LWIP_TCP && LWIP_CALLBACK_API */
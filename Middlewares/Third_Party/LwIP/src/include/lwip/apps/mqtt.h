@@ -183,6 +183,9 @@ void mqtt_client_free(mqtt_client_t* client);
 
 u8_t mqtt_client_is_connected(mqtt_client_t *client);
 
+/* Local change (nucleo-f767): batch several publishes into one TCP write */
+void mqtt_set_corked(mqtt_client_t *client, u8_t corked);
+
 void mqtt_set_inpub_callback(mqtt_client_t *client, mqtt_incoming_publish_cb_t,
                              mqtt_incoming_data_cb_t data_cb, void *arg);
 
@@ -95,6 +95,9 @@ struct mqtt_client_s
   u8_t rx_buffer[MQTT_VAR_HEADER_BUFFER_LEN];
   /** Output ring-buffer */
   struct mqtt_ringbuf_t output;
+  /** Local change (nucleo-f767): publishes only append while set,
+      see mqtt_set_corked() */
+  u8_t corked;
 };
 
 #ifdef __cplusplus
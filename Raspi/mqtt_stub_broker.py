@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+mqtt_stub_broker.py - minimal MQTT 3.1.1 broker stand-in for bench tests.
+
+Accepts the controller's MQTT client ("net mqtt on") without a real broker:
+  - CONNECT    -> CONNACK (accepted)
+  - PUBLISH    -> printed as one JSON object per line (QoS1 gets a PUBACK)
+  - PINGREQ    -> PINGRESP
+  - SUBSCRIBE  -> SUBACK (granted QoS0), nothing is ever forwarded
+  - DISCONNECT -> connection closed
+
+Each output line also carries the number of PUBLISH packets that arrived in
+the same TCP read ("batch"), which shows whether a burst of per-sensor
+topics was coalesced into one segment.
+
+Usage:
+  mqtt_stub_broker.py [port]            listen on 0.0.0.0 (default 1883)
+  mqtt_stub_broker.py [port] --drop N   close each session after N publishes
+                                        (exercises the reconnect backoff)
+"""
+
+import json
+import socket
+import sys
+import threading
+import time
+
+CONNECT = 1
+CONNACK = 2
+PUBLISH = 3
+PUBACK = 4
+SUBSCRIBE = 8
+SUBACK = 9
+PINGREQ = 12
+PINGRESP = 13
+DISCONNECT = 14
+
+
+def read_packet(buf):
+    """Split one packet off buf. Returns (type, flags, body, consumed) or None."""
+    if len(buf) < 2:
+        return None
+
+    mult, length, i = 1, 0, 1
+    while True:
+        if i >= len(buf):
+            return None
+        b = buf[i]
+        length += (b & 0x7F) * mult
+        mult *= 128
+        i += 1
+        if not b & 0x80:
+            break
+        if i > 4:
+            raise ValueError("bad remaining length")
+
+    if len(buf) < i + length:
+        return None
+    return buf[0] >> 4, buf[0] & 0x0F, buf[i:i + length], i + length
+
+
+def u16(b, off):
+    return (b[off] << 8) | b[off + 1]
+
+
+def handle_client(conn, addr, drop_after):
+    buf = b""
+    client_id = "?"
+    published = 0
+
+    with conn:
+        while True:
+            try:
+                chunk = conn.recv(4096)
+            except OSError:
+                break
+            if not chunk:
+                break
+            buf += chunk
+
+            batch = []
+            while True:
+                pkt = read_packet(buf)
+                if pkt is None:
+                    break
+                ptype, flags, body, used = pkt
+                buf = buf[used:]
+
+                if ptype == CONNECT:
+                    # protocol name, level, flags, keepalive, then client id
+                    off = 2 + u16(body, 0) + 4
+                    client_id = body[off + 2:off + 2 + u16(body, off)].decode(errors="replace")
+                    conn.sendall(bytes([CONNACK << 4, 2, 0, 0]))
+                    print(json.dumps({"event": "connect", "peer": addr[0],
+                                      "client": client_id}), flush=True)
+
+                elif ptype == PUBLISH:
+                    qos = (flags >> 1) & 3
+                    tlen = u16(body, 0)
+                    topic = body[2:2 + tlen].decode(errors="replace")
+                    off = 2 + tlen
+                    if qos:
+                        conn.sendall(bytes([PUBACK << 4, 2]) + body[off:off + 2])
+                        off += 2
+                    batch.append((topic, body[off:].decode(errors="replace"),
+                                  bool(flags & 1)))
+
+                elif ptype == SUBSCRIBE:
+                    conn.sendall(bytes([SUBACK << 4, 3]) + body[0:2] + b"\x00")
+
+                elif ptype == PINGREQ:
+                    conn.sendall(bytes([PINGRESP << 4, 0]))
+
+                elif ptype == DISCONNECT:
+                    return
+
+            now = time.time()
+            for topic, payload, retain in batch:
+                print(json.dumps({"t": round(now, 3), "client": client_id,
+                                  "topic": topic, "payload": payload,
+                                  "retain": retain, "batch": len(batch)}),
+                      flush=True)
+
+            published += len(batch)
+            if drop_after and published >= drop_after:
+                print(json.dumps({"event": "drop", "client": client_id}), flush=True)
+                return
+
+
+def main(argv):
+    port = 1883
+    drop_after = 0
+
+    args = list(argv[1:])
+    if "--drop" in args:
+        i = args.index("--drop")
+        drop_after = int(args[i + 1])
+        del args[i:i + 2]
+    if args:
+        port = int(args[0])
+
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(("0.0.0.0", port))
+    srv.listen(4)
+    print(f"# MQTT stub broker on tcp/{port}", file=sys.stderr)
+
+    while True:
+        conn, addr = srv.accept()
+        threading.Thread(target=handle_client, args=(conn, addr, drop_after),
+                         daemon=True).start()
+
+
+if __name__ == "__main__":
+    try:
+        main(sys.argv)
+    except KeyboardInterrupt:
+        pass
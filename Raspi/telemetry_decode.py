@@ -0,0 +1,356 @@
+#!/usr/bin/env python3
+"""
+telemetry_decode.py - host-side decoder for STM32 telemetry (UDP/TCP).
+
+Understands all wire encodings produced by the controller:
+  - JSON line   : {"ts":...,"i2c":...,"can101":"...","can120":"..."}\n
+  - binary frame: versioned header + typed fields (layout in Inc/app_frame.h)
+  - CAN events  : raw CAN frames pushed on arrival ("net push on")
+  - delta block : many samples compressed with delta-of-delta timestamps,
+                  zigzag varints and XOR floats (layout in Inc/app_tsc.h)
+
+A UDP datagram carries a batch of samples packed back to back (both
+encodings are self-delimiting), so one datagram may yield many records.
+
+The encoding is detected per frame (0xA5 magic vs. '{'), so the controller
+may switch with the CLI command "net enc json|bin|delta" at any time.
+
+Usage:
+  telemetry_decode.py udp [port]        listen for UDP datagrams (default 5005)
+  telemetry_decode.py tcp [port] [--ack] [--cmd "<command>"]...
+                                        accept the STM32 TCP client (default 6006)
+  telemetry_decode.py file <path|->     decode a captured byte stream
+
+Every decoded sample is printed as one JSON object per line.
+
+With --ack the TCP receiver answers "ACK <seq>\n" after each batch of
+printed records that carry a sequence number. The controller then keeps
+samples in its store-and-forward backlog until they are acknowledged and
+replays unacknowledged ones after a reconnect (duplicates share a seq).
+
+Each --cmd is sent as a command frame (layout in Inc/app_cmd.h) once the
+controller has connected; its response frame is printed like a record:
+  ping
+  rate sample|udp|tcp|mqtt <value>   sample Hz, UDP latency ms,
+                                     TCP every Nth sample, MQTT interval ms
+  enc json|bin|delta
+  capture <hz> <ms>                  high-rate window, then previous rate
+  counters
+"""
+
+import json
+import socket
+import struct
+import sys
+
+FRAME_MAGIC = 0xA5
+FRAME_VERSION = 1
+FRAME_HDR = struct.Struct("<BBBBHIQ")  # magic, ver, type, nfields, len, seq, ts_us
+
+TYPE_SAMPLE = 0x01
+TYPE_BLOCK = 0x02
+TYPE_CAN_EVENT = 0x03
+TYPE_CMD = 0x10
+TYPE_RSP = 0x11
+CAN_REC_HDR = struct.Struct("<IHB")  # dt_us, id, dlc
+
+# delta block: control bits and AppTelemetry.valid bits
+TSC_CH_I2C_TEMP = 1 << 0
+TSC_CH_CAN_HB_SEQ = 1 << 1
+TSC_CH_CAN_LUX = 1 << 2
+TSC_CH_CAN_FULL = 1 << 3
+TSC_CH_CAN_IR = 1 << 4
+TSC_CTRL_VALID = 1 << 5
+TSC_CTRL_SEQ_GAP = 1 << 6
+
+VALID_I2C = 1 << 0
+VALID_CAN101 = 1 << 1
+VALID_CAN120 = 1 << 2
+
+# command channel (Inc/app_cmd.h)
+CMD_OPS = {"ping": 0x01, "rate": 0x02, "enc": 0x03, "capture": 0x04,
+           "counters": 0x05, "ack": 0x06}
+CMD_OP_NAMES = {v: k for k, v in CMD_OPS.items()}
+CMD_RATE_CH = {"sample": 0, "udp": 1, "tcp": 2, "mqtt": 3}
+CMD_ENC = {"json": 0, "bin": 1, "delta": 2}
+CMD_STATUS = {0: "ok", 1: "bad_opcode", 2: "bad_args"}
+CMD_COUNTERS = ("udp_datagrams", "udp_samples", "udp_errors", "tcp_queued",
+                "tcp_acked", "tcp_dropped", "backlog_depth", "backlog_evicted",
+                "can_push_frames", "can_overflow", "mqtt_publishes", "cmd_rx",
+                "cmd_errors", "sample_hz")
+
+# channel number -> (name, struct format)
+FIELDS = {
+    1: ("i2c_temp_c", "<h"),
+    2: ("can_hb_seq", "<B"),
+    3: ("can_lux_x100", "<I"),
+    4: ("can_full", "<H"),
+    5: ("can_ir", "<H"),
+}
+
+
+def _decode_fields(body, nfields):
+    out = {}
+    off = 0
+    for _ in range(nfields):
+        fid = body[off]
+        size = 1 << (fid >> 6)
+        ch = fid & 0x3F
+        raw = body[off + 1:off + 1 + size]
+        off += 1 + size
+        if ch in FIELDS:
+            name, fmt = FIELDS[ch]
+            out[name] = struct.unpack(fmt, raw)[0]
+        else:
+            out["ch%d" % ch] = int.from_bytes(raw, "little")
+    return out
+
+
+def _varint(buf, off):
+    v = 0
+    shift = 0
+    while True:
+        b = buf[off]
+        off += 1
+        v |= (b & 0x7F) << shift
+        if b < 0x80:
+            return v, off
+        shift += 7
+
+
+def _svarint(buf, off):
+    v, off = _varint(buf, off)
+    return (v >> 1) ^ -(v & 1), off
+
+
+def _xor32(buf, off):
+    ctl = buf[off]
+    tz = (ctl >> 2) & 3
+    nb = (ctl & 3) + 1
+    x = int.from_bytes(buf[off + 1:off + 1 + nb], "little") << (8 * tz)
+    return x & 0xFFFFFFFF, off + 1 + nb
+
+
+def decode_block(body, seq, ts_us):
+    """Decode the samples of a delta block (body = bytes after the header)."""
+    count = struct.unpack_from("<H", body)[0]
+    off = 2
+    prev = {"seq": seq - 1, "ts": ts_us, "delta": 0, "valid": 0,
+            "temp_bits": 0, "hb": 0, "lux": 0, "full": 0, "ir": 0}
+    out = []
+    for _ in range(count):
+        ctrl = body[off]
+        off += 1
+        dod, off = _svarint(body, off)
+        prev["delta"] += dod
+        prev["ts"] += prev["delta"]
+        if ctrl & TSC_CTRL_VALID:
+            prev["valid"] = body[off]
+            off += 1
+        gap = 0
+        if ctrl & TSC_CTRL_SEQ_GAP:
+            gap, off = _varint(body, off)
+        prev["seq"] += 1 + gap
+        if ctrl & TSC_CH_I2C_TEMP:
+            x, off = _xor32(body, off)
+            prev["temp_bits"] ^= x
+        for bit, key in ((TSC_CH_CAN_HB_SEQ, "hb"), (TSC_CH_CAN_LUX, "lux"),
+                         (TSC_CH_CAN_FULL, "full"), (TSC_CH_CAN_IR, "ir")):
+            if ctrl & bit:
+                d, off = _svarint(body, off)
+                prev[key] += d
+
+        rec = {"enc": "delta", "seq": prev["seq"], "ts_us": prev["ts"]}
+        valid = prev["valid"]
+        if valid & VALID_I2C:
+            rec["i2c_temp_c"] = struct.unpack("<f", struct.pack("<I", prev["temp_bits"]))[0]
+        if valid & VALID_CAN101:
+            rec["can_hb_seq"] = prev["hb"]
+        if valid & VALID_CAN120:
+            rec["can_lux_x100"] = prev["lux"]
+            rec["can_lux"] = prev["lux"] / 100.0
+            rec["can_full"] = prev["full"]
+            rec["can_ir"] = prev["ir"]
+        out.append(rec)
+    return out
+
+
+def decode_can_events(body, nrec, seq, ts_us):
+    """Decode the records of a CAN event frame."""
+    out = []
+    off = 0
+    for _ in range(nrec):
+        dt_us, can_id, dlc = CAN_REC_HDR.unpack_from(body, off)
+        off += CAN_REC_HDR.size
+        data = body[off:off + dlc]
+        off += dlc
+        out.append({"enc": "can", "evt_seq": seq, "ts_us": ts_us + dt_us,
+                    "id": "0x%03X" % can_id, "data": data.hex()})
+    return out
+
+
+def encode_cmd(text, req_id):
+    """Build a command frame from e.g. "rate sample 500"."""
+    words = text.split()
+    op = CMD_OPS[words[0]]
+    if words[0] == "rate":
+        args = struct.pack("<BI", CMD_RATE_CH[words[1]], int(words[2]))
+    elif words[0] == "enc":
+        args = struct.pack("<B", CMD_ENC[words[1]])
+    elif words[0] == "capture":
+        args = struct.pack("<II", int(words[1]), int(words[2]))
+    elif words[0] == "ack":
+        args = struct.pack("<I", int(words[1]))
+    else:
+        args = b""
+    return FRAME_HDR.pack(FRAME_MAGIC, FRAME_VERSION, TYPE_CMD, op,
+                          FRAME_HDR.size + len(args), req_id, 0) + args
+
+
+def decode_response(body, op, req_id, ts_us):
+    """Decode a response frame body (status + data)."""
+    rec = {"enc": "rsp", "op": CMD_OP_NAMES.get(op, op), "id": req_id,
+           "ts_us": ts_us, "status": CMD_STATUS.get(body[0], body[0])}
+    data = body[1:]
+    if op == CMD_OPS["counters"] and data:
+        vals = struct.unpack_from("<%dI" % data[0], data, 1)
+        rec["counters"] = dict(zip(CMD_COUNTERS, vals))
+    elif op == CMD_OPS["rate"] and len(data) == 4:
+        rec["value"] = struct.unpack("<I", data)[0]
+    elif op == CMD_OPS["enc"] and len(data) == 1:
+        rec["value"] = {v: k for k, v in CMD_ENC.items()}.get(data[0], data[0])
+    elif op == CMD_OPS["capture"] and len(data) == 8:
+        rec["hz"], rec["remaining_ms"] = struct.unpack("<II", data)
+    return rec
+
+
+def decode_binary(buf):
+    """
+    Decode one binary frame or delta block at buf[0].
+    Returns (records, consumed) or (None, 0) if incomplete.
+    """
+    if len(buf) < FRAME_HDR.size:
+        return None, 0
+    magic, ver, ftype, nfields, length, seq, ts_us = FRAME_HDR.unpack_from(buf)
+    if magic != FRAME_MAGIC or length < FRAME_HDR.size:
+        raise ValueError("bad frame header")
+    if len(buf) < length:
+        return None, 0
+    if ver == FRAME_VERSION and ftype == TYPE_CAN_EVENT:
+        return decode_can_events(buf[FRAME_HDR.size:length], nfields, seq, ts_us), length
+    if ver == FRAME_VERSION and ftype == TYPE_BLOCK:
+        return decode_block(buf[FRAME_HDR.size:length], seq, ts_us), length
+    if ver == FRAME_VERSION and ftype == TYPE_RSP and length > FRAME_HDR.size:
+        return [decode_response(buf[FRAME_HDR.size:length], nfields, seq, ts_us)], length
+    rec = {"enc": "bin", "ver": ver, "type": ftype, "seq": seq, "ts_us": ts_us}
+    if ver == FRAME_VERSION and ftype == TYPE_SAMPLE:
+        rec.update(_decode_fields(buf[FRAME_HDR.size:length], nfields))
+        if "can_lux_x100" in rec:
+            rec["can_lux"] = rec["can_lux_x100"] / 100.0
+    return [rec], length
+
+
+def decode_stream(buf):
+    """
+    Decode as many complete frames as possible from a byte buffer.
+    Returns (records, remaining_bytes). Garbage bytes are skipped.
+    """
+    records = []
+    pos = 0
+    while pos < len(buf):
+        b = buf[pos]
+        if b == FRAME_MAGIC:
+            try:
+                recs, n = decode_binary(buf[pos:])
+            except (ValueError, IndexError, struct.error):
+                pos += 1
+                continue
+            if recs is None:
+                break
+            records.extend(recs)
+            pos += n
+        elif b == ord("{"):
+            end = buf.find(b"\n", pos)
+            if end < 0:
+                break
+            line = buf[pos:end]
+            pos = end + 1
+            try:
+                rec = json.loads(line.decode("utf-8", "replace"))
+                rec["enc"] = "json"
+                records.append(rec)
+            except ValueError:
+                pass
+        else:
+            pos += 1
+    return records, buf[pos:]
+
+
+def _emit(records):
+    for rec in records:
+        print(json.dumps(rec), flush=True)
+
+
+def run_udp(port):
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    s.bind(("", port))
+    while True:
+        data, _ = s.recvfrom(2048)
+        records, _ = decode_stream(data)
+        _emit(records)
+
+
+def run_tcp(port, ack=False, cmds=()):
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(("", port))
+    srv.listen(1)
+    while True:
+        conn, _ = srv.accept()
+        pending = b""
+        for i, text in enumerate(cmds):
+            conn.sendall(encode_cmd(text, i + 1))
+        with conn:
+            while True:
+                data = conn.recv(4096)
+                if not data:
+                    break
+                records, pending = decode_stream(pending + data)
+                _emit(records)
+                seqs = [r["seq"] for r in records if "seq" in r]
+                if ack and seqs:
+                    conn.sendall(b"ACK %d\n" % seqs[-1])
+
+
+def run_file(path):
+    data = sys.stdin.buffer.read() if path == "-" else open(path, "rb").read()
+    records, _ = decode_stream(data)
+    _emit(records)
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__, file=sys.stderr)
+        return 2
+    mode = argv[1]
+    if mode == "udp":
+        run_udp(int(argv[2]) if len(argv) > 2 else 5005)
+    elif mode == "tcp":
+        args, cmds, rest = [], [], list(argv[2:])
+        while rest:
+            a = rest.pop(0)
+            if a == "--cmd" and rest:
+                cmds.append(rest.pop(0))
+            elif a != "--ack":
+                args.append(a)
+        run_tcp(int(args[0]) if args else 6006, "--ack" in argv[2:], cmds)
+    elif mode == "file" and len(argv) > 2:
+        run_file(argv[2])
+    else:
+        print(__doc__, file=sys.stderr)
+        return 2
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
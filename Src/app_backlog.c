@@ -0,0 +1,278 @@
+/**
+ * @file    app_backlog.c
+ * @brief   Bounded RAM ring of encoded, sequence-numbered telemetry frames.
+ *
+ * This module provides:
+ *  - Reserve/commit API that evicts the oldest frames when the ring is full
+ *  - Replay cursor that skips frames already handed to the transport
+ *  - Release by sequence number (gateway acknowledgement) or once sent
+ *
+ * Design notes:
+ *  - Same contiguous-frame layout as app_txq.c: a frame that does not fit
+ *    before the end of the buffer starts again at offset 0.
+ *  - Frames are pushed in sequence order, so release by sequence number only
+ *    ever removes entries from the tail.
+ *  - Not interrupt safe: producer and lwIP callbacks both run in the main loop.
+ */
+
+#include "app_backlog.h"
+
+#include <stddef.h>
+
+/* =============================================================================
+ * Helpers
+ * ============================================================================= */
+static inline AppBacklogDesc *desc_at(const AppBacklog *b, uint16_t idx)
+{
+  return &b->desc[idx & (uint16_t)(b->ndesc - 1U)];
+}
+
+/**
+ * @brief Drop the oldest entry.
+ */
+static void evict_tail(AppBacklog *b)
+{
+  const AppBacklogDesc *d = desc_at(b, b->tail);
+
+  if ((d->flags & APP_BACKLOG_F_SENT) == 0U && b->unsent > 0U)
+    b->unsent--;
+
+  if (b->cursor == b->tail)
+    b->cursor++;
+  b->tail++;
+
+  if (b->tail == b->head)
+    b->wr = 0;
+}
+
+/**
+ * @brief Find a contiguous span of max_len bytes without evicting.
+ *
+ * @return true and b->res_off set if the frame fits.
+ */
+static bool try_fit(AppBacklog *b, uint16_t max_len)
+{
+  uint16_t count = (uint16_t)(b->head - b->tail);
+
+  if (count >= b->ndesc) return false;
+
+  if (count == 0U) {
+    b->wr      = 0;
+    b->res_off = 0;
+    return true;
+  }
+
+  uint16_t rd = desc_at(b, b->tail)->off;
+
+  if (b->wr > rd) {
+    if ((uint16_t)(b->size - b->wr) >= max_len) {
+      b->res_off = b->wr;
+      return true;
+    }
+    if (rd >= max_len) {
+      b->res_off = 0;
+      return true;
+    }
+    return false;
+  }
+
+  if ((uint16_t)(rd - b->wr) >= max_len) {
+    b->res_off = b->wr;
+    return true;
+  }
+  return false;
+}
+
+/* =============================================================================
+ * Init
+ * ============================================================================= */
+
+/**
+ * @brief Bind a backlog to caller-provided storage.
+ *
+ * @param ndesc Number of descriptor slots, must be a power of two.
+ */
+void APP_BACKLOG_Init(AppBacklog *b, uint8_t *buf, uint16_t size,
+                      AppBacklogDesc *desc, uint16_t ndesc)
+{
+  if (!b) return;
+
+  b->buf     = buf;
+  b->size    = size;
+  b->desc    = desc;
+  b->ndesc   = ndesc;
+
+  b->tail    = 0;
+  b->cursor  = 0;
+  b->head    = 0;
+  b->unsent  = 0;
+  b->wr      = 0;
+  b->res_off = 0;
+}
+
+/* =============================================================================
+ * Producer side
+ * ============================================================================= */
+
+/**
+ * @brief Reserve up to max_len contiguous bytes, evicting old frames if needed.
+ *
+ * @param evicted Incremented by the number of frames dropped to make room.
+ * @return Write pointer (NULL only if max_len exceeds the ring). Must be
+ *         followed by APP_BACKLOG_Commit() before any other call.
+ */
+uint8_t *APP_BACKLOG_Reserve(AppBacklog *b, uint16_t max_len, uint16_t *evicted)
+{
+  if (!b || max_len == 0U || max_len > b->size) return NULL;
+
+  while (!try_fit(b, max_len)) {
+    evict_tail(b);
+    if (evicted) (*evicted)++;
+  }
+
+  return b->buf + b->res_off;
+}
+
+/**
+ * @brief Commit the frame written into the last reservation.
+ */
+void APP_BACKLOG_Commit(AppBacklog *b, uint16_t len, uint32_t seq, uint8_t flags)
+{
+  if (!b || len == 0U) return;
+
+  AppBacklogDesc *d = desc_at(b, b->head);
+  d->off   = b->res_off;
+  d->len   = len;
+  d->seq   = seq;
+  d->flags = flags;
+
+  if ((flags & APP_BACKLOG_F_SENT) == 0U)
+    b->unsent++;
+
+  b->wr = (uint16_t)(b->res_off + len);
+  b->head++;
+}
+
+/* =============================================================================
+ * Replay
+ * ============================================================================= */
+
+/**
+ * @brief Oldest stored frame that has not been handed to the transport.
+ */
+bool APP_BACKLOG_PeekUnsent(AppBacklog *b, const uint8_t **data, uint16_t *len,
+                            uint32_t *seq, uint8_t *flags)
+{
+  if (!b || b->unsent == 0U) return false;
+
+  /* Skip entries that already went out live */
+  while (b->cursor != b->head &&
+         (desc_at(b, b->cursor)->flags & APP_BACKLOG_F_SENT) != 0U)
+    b->cursor++;
+
+  if (b->cursor == b->head) return false;
+
+  const AppBacklogDesc *d = desc_at(b, b->cursor);
+  if (data) *data = b->buf + d->off;
+  if (len)  *len  = d->len;
+  if (seq)  *seq  = d->seq;
+  if (flags) *flags = d->flags;
+
+  return true;
+}
+
+/**
+ * @brief Mark the frame returned by APP_BACKLOG_PeekUnsent() as sent.
+ */
+void APP_BACKLOG_MarkSent(AppBacklog *b)
+{
+  if (!b || b->cursor == b->head) return;
+
+  desc_at(b, b->cursor)->flags |= APP_BACKLOG_F_SENT;
+  if (b->unsent > 0U) b->unsent--;
+  b->cursor++;
+}
+
+/* =============================================================================
+ * Release
+ * ============================================================================= */
+
+/**
+ * @brief Release sent entries with sequence number <= seq (serial arithmetic).
+ *
+ * Stops at the first entry that has not been sent yet: the gateway cannot
+ * have persisted it, even if a newer live sample was acknowledged.
+ */
+uint16_t APP_BACKLOG_ReleaseUpTo(AppBacklog *b, uint32_t seq)
+{
+  uint16_t n = 0;
+
+  if (!b) return 0;
+
+  while (b->tail != b->head &&
+         (desc_at(b, b->tail)->flags & APP_BACKLOG_F_SENT) != 0U &&
+         (int32_t)(desc_at(b, b->tail)->seq - seq) <= 0) {
+    evict_tail(b);
+    n++;
+  }
+
+  return n;
+}
+
+/**
+ * @brief Release leading entries that have been sent (no gateway ACKs).
+ */
+uint16_t APP_BACKLOG_ReleaseSent(AppBacklog *b)
+{
+  uint16_t n = 0;
+
+  if (!b) return 0;
+
+  while (b->tail != b->head &&
+         (desc_at(b, b->tail)->flags & APP_BACKLOG_F_SENT) != 0U) {
+    evict_tail(b);
+    n++;
+  }
+
+  return n;
+}
+
+/**
+ * @brief Mark every stored entry unsent and restart replay at the tail.
+ */
+void APP_BACKLOG_Rewind(AppBacklog *b)
+{
+  if (!b) return;
+
+  for (uint16_t i = b->tail; i != b->head; i++)
+    desc_at(b, i)->flags &= (uint8_t)~APP_BACKLOG_F_SENT;
+
+  b->cursor = b->tail;
+  b->unsent = (uint16_t)(b->head - b->tail);
+}
+
+/* =============================================================================
+ * Occupancy
+ * ============================================================================= */
+
+uint16_t APP_BACKLOG_Depth(const AppBacklog *b)
+{
+  return b ? (uint16_t)(b->head - b->tail) : 0U;
+}
+
+uint16_t APP_BACKLOG_Unsent(const AppBacklog *b)
+{
+  return b ? b->unsent : 0U;
+}
+
+/**
+ * @brief Bytes between the oldest and the newest frame (includes a wrap gap).
+ */
+uint16_t APP_BACKLOG_Bytes(const AppBacklog *b)
+{
+  if (!b || b->tail == b->head) return 0;
+
+  uint16_t rd = desc_at(b, b->tail)->off;
+  return (b->wr > rd) ? (uint16_t)(b->wr - rd)
+                      : (uint16_t)(b->size - rd + b->wr);
+}
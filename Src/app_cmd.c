@@ -0,0 +1,261 @@
+/**
+ * @file    app_cmd.c
+ * @brief   Incremental parser and response encoder for gateway commands.
+ *
+ * This module provides:
+ *  - Byte-wise parser for command frames (APP_FRAME_TYPE_CMD) and the
+ *    legacy "ACK <seq>" text line, fed straight from pbuf payloads
+ *  - Response frame encoder (APP_FRAME_TYPE_RSP)
+ *
+ * Design notes:
+ *  - Header fields are accumulated in place as bytes arrive; only the small
+ *    argument block is stored. No line buffer, no reassembly copy.
+ *  - Frames with an unknown type are skipped by their length field; a bad
+ *    version byte drops back to scanning for the next magic byte.
+ *  - The parser knows nothing about the commands themselves; app_net.c
+ *    executes them in the handler.
+ */
+
+#include "app_cmd.h"
+
+#include <string.h>
+
+/* =============================================================================
+ * Parser states
+ * ============================================================================= */
+enum {
+  ST_IDLE = 0,   /* scanning for APP_FRAME_MAGIC or 'A'  */
+  ST_HDR,        /* inside the frame header               */
+  ST_ARGS,       /* collecting the argument block         */
+  ST_SKIP,       /* discarding the rest of the frame      */
+  ST_TEXT,       /* matching "ACK "                       */
+  ST_NUM         /* ACK sequence digits                   */
+};
+
+static const char k_ack[] = "ACK ";
+
+/* =============================================================================
+ * Helpers
+ * ============================================================================= */
+static void deliver(AppCmdParser *p)
+{
+  p->frames++;
+  if (p->handler)
+    p->handler(&p->cmd, p->ctx);
+}
+
+static void start_frame(AppCmdParser *p)
+{
+  memset(&p->cmd, 0, sizeof(p->cmd));
+  p->state = ST_HDR;
+  p->type  = 0;
+  p->pos   = 1;
+  p->len   = 0;
+}
+
+/**
+ * @brief Header complete: decide whether to collect or skip the payload.
+ */
+static void end_header(AppCmdParser *p)
+{
+  if (p->len < APP_FRAME_HDR_LEN) {
+    p->errors++;
+    p->state = ST_IDLE;
+    return;
+  }
+
+  bool is_cmd = (p->type == APP_FRAME_TYPE_CMD);
+
+  if (p->len == APP_FRAME_HDR_LEN) {
+    p->state = ST_IDLE;
+    if (is_cmd) deliver(p);
+    return;
+  }
+
+  if (!is_cmd) {
+    p->state = ST_SKIP;
+  } else if ((uint16_t)(p->len - APP_FRAME_HDR_LEN) > APP_CMD_ARGS_MAX) {
+    p->cmd.status = APP_CMD_ST_BAD_ARGS;
+    p->state      = ST_SKIP;
+  } else {
+    p->state = ST_ARGS;
+  }
+}
+
+/**
+ * @brief Header byte at offset p->pos (fields are little-endian).
+ */
+static void hdr_byte(AppCmdParser *p, uint8_t c)
+{
+  uint16_t i = p->pos;
+
+  switch (i) {
+    case 1:
+      if (c != APP_FRAME_VERSION) {
+        p->errors++;
+        p->state = ST_IDLE;
+        return;
+      }
+      break;
+    case 2: p->type       = c; break;
+    case 3: p->cmd.opcode = c; break;
+    case 4:
+    case 5: p->len    |= (uint16_t)((uint16_t)c << (8U * (i - 4U))); break;
+    case 6:
+    case 7:
+    case 8:
+    case 9: p->cmd.id |= (uint32_t)c << (8U * (i - 6U)); break;
+    default: break;       /* ts_us: ignored in requests */
+  }
+
+  p->pos++;
+  if (p->pos == APP_FRAME_HDR_LEN)
+    end_header(p);
+}
+
+static void idle_byte(AppCmdParser *p, uint8_t c)
+{
+  if (c == APP_FRAME_MAGIC) {
+    start_frame(p);
+  } else if (c == (uint8_t)k_ack[0]) {
+    p->state = ST_TEXT;
+    p->pos   = 1;
+  } else if (c != '\r' && c != '\n') {
+    p->errors++;
+  }
+}
+
+/* =============================================================================
+ * API
+ * ============================================================================= */
+
+void APP_CMD_Init(AppCmdParser *p, AppCmdHandler handler, void *ctx)
+{
+  if (!p) return;
+
+  memset(p, 0, sizeof(*p));
+  p->handler = handler;
+  p->ctx     = ctx;
+}
+
+/**
+ * @brief Forget a partially received item (new connection).
+ */
+void APP_CMD_Reset(AppCmdParser *p)
+{
+  if (!p) return;
+  p->state = ST_IDLE;
+}
+
+/**
+ * @brief Feed received bytes (one pbuf payload at a time).
+ */
+void APP_CMD_Feed(AppCmdParser *p, const uint8_t *data, uint16_t len)
+{
+  if (!p || !data) return;
+
+  for (uint16_t k = 0; k < len; k++) {
+    uint8_t c = data[k];
+
+    switch (p->state) {
+      case ST_IDLE:
+        idle_byte(p, c);
+        break;
+
+      case ST_HDR:
+        hdr_byte(p, c);
+        break;
+
+      case ST_ARGS:
+        p->cmd.args[p->cmd.nargs++] = c;
+        if (++p->pos == p->len) {
+          p->state = ST_IDLE;
+          deliver(p);
+        }
+        break;
+
+      case ST_SKIP:
+        if (++p->pos == p->len) {
+          p->state = ST_IDLE;
+          if (p->type == APP_FRAME_TYPE_CMD) deliver(p);   /* oversized */
+        }
+        break;
+
+      case ST_TEXT:
+        if (c == (uint8_t)k_ack[p->pos]) {
+          if (++p->pos == sizeof(k_ack) - 1U) {
+            p->state = ST_NUM;
+            p->num   = 0;
+            p->pos   = 0;
+          }
+        } else {
+          p->state = ST_IDLE;
+          idle_byte(p, c);
+        }
+        break;
+
+      case ST_NUM:
+        if (c >= '0' && c <= '9') {
+          p->num = p->num * 10U + (uint32_t)(c - '0');
+          p->pos++;
+        } else if (c == '\n' && p->pos != 0U) {
+          memset(&p->cmd, 0, sizeof(p->cmd));
+          p->cmd.opcode = APP_CMD_OP_ACK;
+          p->cmd.nargs  = 4;
+          for (uint8_t i = 0; i < 4U; i++)
+            p->cmd.args[i] = (uint8_t)(p->num >> (8U * i));
+          p->state = ST_IDLE;
+          deliver(p);
+        } else if (c != '\r') {
+          p->errors++;
+          p->state = ST_IDLE;
+          idle_byte(p, c);
+        }
+        break;
+
+      default:
+        p->state = ST_IDLE;
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Encode the response to cmd into out.
+ */
+uint16_t APP_CMD_EncodeResponse(const AppCmd *cmd, uint8_t status,
+                                const uint8_t *data, uint16_t dlen,
+                                uint64_t ts_us, uint8_t *out, uint16_t cap)
+{
+  if (!cmd || !out) return 0;
+
+  uint16_t len = (uint16_t)(APP_FRAME_HDR_LEN + 1U + dlen);
+  if (len > cap) return 0;
+
+  out[0] = APP_FRAME_MAGIC;
+  out[1] = APP_FRAME_VERSION;
+  out[2] = APP_FRAME_TYPE_RSP;
+  out[3] = cmd->opcode;
+  out[4] = (uint8_t)(len);
+  out[5] = (uint8_t)(len >> 8);
+  for (uint8_t i = 0; i < 4U; i++)
+    out[6U + i] = (uint8_t)(cmd->id >> (8U * i));
+  for (uint8_t i = 0; i < 8U; i++)
+    out[10U + i] = (uint8_t)(ts_us >> (8U * i));
+
+  out[APP_FRAME_HDR_LEN] = status;
+  if (dlen != 0U && data)
+    memcpy(out + APP_FRAME_HDR_LEN + 1U, data, dlen);
+
+  return len;
+}
+
+uint32_t APP_CMD_ArgU32(const AppCmd *cmd, uint8_t off)
+{
+  if (!cmd || (uint16_t)off + 4U > cmd->nargs) return 0;
+
+  return (uint32_t)cmd->args[off]
+       | ((uint32_t)cmd->args[off + 1U] << 8)
+       | ((uint32_t)cmd->args[off + 2U] << 16)
+       | ((uint32_t)cmd->args[off + 3U] << 24);
+}
@@ -0,0 +1,170 @@
+/**
+ * @file    app_fbuf.c
+ * @brief   Serialize-once sample pipeline: shared, reference-counted frames.
+ *
+ * This module provides:
+ *  - A small static pool of sample buffers with reference counts
+ *  - Lazy per-encoding cache: the JSON line and the binary frame of a sample
+ *    are each encoded at most once, whoever asks first
+ *  - Lazy text fields: the CAN text only the JSON line and the status line
+ *    show is copied in on first use, so binary-only streams never touch it
+ *  - Access to the latest sample for USB CLI and UI readers
+ *
+ * Design notes:
+ *  - The pool holds one reference on the latest buffer; it is dropped when
+ *    the next sample is committed. A buffer returns to the pool when its
+ *    count reaches zero.
+ *  - Transports copy the cached bytes into their own rings (TCP TX queue,
+ *    UDP batch pbuf, backlog): a memcpy instead of a second encoder run.
+ *  - Not interrupt safe: producer and all readers run in the main loop.
+ */
+
+#include "app_fbuf.h"
+
+#include <stddef.h>
+
+/* =============================================================================
+ * Pool
+ * ============================================================================= */
+static AppFrameBuf  s_buf[APP_FBUF_COUNT];
+static AppFrameBuf *s_latest = NULL;
+static AppFbufStats s_stats;
+static AppFbufTextFn s_text_fn = NULL;
+
+#define CACHED(enc)  ((uint8_t)(1U << (uint8_t)(enc)))
+#define CACHED_TEXT  ((uint8_t)(1U << 7))
+
+void APP_FBUF_Init(void)
+{
+  for (uint8_t i = 0; i < APP_FBUF_COUNT; i++) {
+    s_buf[i].refs   = 0;
+    s_buf[i].cached = 0;
+  }
+  s_latest  = NULL;
+  s_text_fn = NULL;
+
+  s_stats.published = 0;
+  s_stats.encodes   = 0;
+  s_stats.hits      = 0;
+  s_stats.no_buf    = 0;
+}
+
+/* =============================================================================
+ * Producer
+ * ============================================================================= */
+
+/**
+ * @brief Take an unreferenced buffer for the next sample.
+ *
+ * @return Buffer with one reference (the producer's), or NULL if all are held.
+ */
+AppFrameBuf *APP_FBUF_Begin(void)
+{
+  for (uint8_t i = 0; i < APP_FBUF_COUNT; i++) {
+    AppFrameBuf *f = &s_buf[i];
+    if (f->refs == 0U) {
+      f->refs     = 1;
+      f->cached   = 0;
+      f->json_len = 0;
+      f->bin_len  = 0;
+      return f;
+    }
+  }
+
+  s_stats.no_buf++;
+  return NULL;
+}
+
+/**
+ * @brief Publish f as the latest sample; the producer's reference moves to
+ *        the pool.
+ */
+void APP_FBUF_Commit(AppFrameBuf *f)
+{
+  if (!f) return;
+
+  if (s_latest)
+    APP_FBUF_Release(s_latest);
+
+  s_latest = f;
+  s_stats.published++;
+}
+
+/* =============================================================================
+ * Readers
+ * ============================================================================= */
+
+AppFrameBuf *APP_FBUF_AcquireLatest(void)
+{
+  if (!s_latest) return NULL;
+
+  s_latest->refs++;
+  return s_latest;
+}
+
+void APP_FBUF_Release(AppFrameBuf *f)
+{
+  if (f && f->refs > 0U)
+    f->refs--;
+}
+
+/**
+ * @brief Encoded bytes of f, produced on the first request per encoding.
+ *
+ * @return Pointer into f (valid while a reference is held), NULL if the
+ *         sample does not fit.
+ */
+const uint8_t *APP_FBUF_Frame(AppFrameBuf *f, AppFrameEncoding enc, uint16_t *len)
+{
+  if (!f) return NULL;
+
+  /* Single frames of the delta mode are binary frames */
+  if (enc != APP_FRAME_ENC_JSON)
+    enc = APP_FRAME_ENC_BIN;
+
+  uint8_t  *buf = (enc == APP_FRAME_ENC_JSON) ? f->json : f->bin;
+  uint16_t *n   = (enc == APP_FRAME_ENC_JSON) ? &f->json_len : &f->bin_len;
+
+  if (f->cached & CACHED(enc)) {
+    s_stats.hits++;
+  } else {
+    *n = (enc == APP_FRAME_ENC_JSON)
+           ? APP_FRAME_EncodeJSON(APP_FBUF_Text(f), buf, APP_FBUF_JSON_MAX)
+           : APP_FRAME_EncodeBinary(&f->t, buf, APP_FRAME_BIN_MAX);
+    f->cached |= CACHED(enc);
+    s_stats.encodes++;
+  }
+
+  if (*n == 0U) return NULL;
+
+  if (len) *len = *n;
+  return buf;
+}
+
+void APP_FBUF_SetTextSource(AppFbufTextFn fn)
+{
+  s_text_fn = fn;
+}
+
+/**
+ * @brief Sample of f with its text fields filled in.
+ *
+ * The text is taken on the first request, normally the JSON encode in the
+ * same main-loop pass as the sample; without a source it stays empty.
+ */
+const AppTelemetry *APP_FBUF_Text(AppFrameBuf *f)
+{
+  if (!f) return NULL;
+
+  if ((f->cached & CACHED_TEXT) == 0U) {
+    if (s_text_fn) s_text_fn(&f->t);
+    f->cached |= CACHED_TEXT;
+  }
+
+  return &f->t;
+}
+
+void APP_FBUF_GetStats(AppFbufStats *out)
+{
+  if (out) *out = s_stats;
+}
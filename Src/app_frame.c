@@ -0,0 +1,198 @@
+/**
+ * @file    app_frame.c
+ * @brief   Telemetry sample encoders: JSON text line and compact binary frame.
+ *
+ * This module provides:
+ *  - JSON line encoder (the original gateway format, unchanged)
+ *  - Versioned binary frame encoder (fixed header + typed fields)
+ *  - CAN event frame encoder (raw frames with microsecond arrival times)
+ *
+ * Design notes:
+ *  - Encoders write into a caller-provided buffer and never allocate.
+ *  - The binary encoder is a handful of byte stores; no formatting involved.
+ *  - Binary layout is documented in app_frame.h and decoded on the host by
+ *    Raspi/telemetry_decode.py.
+ */
+
+#include "app_frame.h"
+
+#include <stdio.h>
+
+/* =============================================================================
+ * Little-endian store helpers
+ * ============================================================================= */
+static inline uint8_t *put_u8(uint8_t *p, uint8_t v)
+{
+  p[0] = v;
+  return p + 1;
+}
+
+static inline uint8_t *put_u16_le(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)(v);
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static inline uint8_t *put_u32_le(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)(v);
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+  return p + 4;
+}
+
+static inline uint8_t *put_u64_le(uint8_t *p, uint64_t v)
+{
+  p = put_u32_le(p, (uint32_t)v);
+  return put_u32_le(p, (uint32_t)(v >> 32));
+}
+
+/* =============================================================================
+ * JSON
+ * ============================================================================= */
+
+/**
+ * @brief Encode one sample as a JSON line (newline terminated).
+ *
+ * Payload format (JSON-like):
+ *  {
+ *    "ts": <ms>,
+ *    "i2c": <temp>,
+ *    "can101": "<text>",
+ *    "can120": "<text>"
+ *  }
+ *
+ * Note: snprintf needs room for the terminating NUL, which is not counted
+ * in the returned length. A line that does not fit is rejected (returns 0)
+ * instead of being sent truncated.
+ */
+uint16_t APP_FRAME_EncodeJSON(const AppTelemetry *t, uint8_t *out, uint16_t cap)
+{
+  if (!t || !out || cap == 0U) return 0;
+
+  int n = snprintf((char *)out, cap,
+                   "{\"ts\":%lu,\"i2c\":%ld,\"can101\":\"%s\",\"can120\":\"%s\"}\n",
+                   (unsigned long)t->now_ms,
+                   (long)t->i2c_temp_c,
+                   t->can_0x101,
+                   t->can_0x120);
+  if (n <= 0 || n >= (int)cap) return 0;
+
+  return (uint16_t)n;
+}
+
+/* =============================================================================
+ * Binary
+ * ============================================================================= */
+
+/**
+ * @brief Encode one sample as a binary frame (see app_frame.h for layout).
+ */
+uint16_t APP_FRAME_EncodeBinary(const AppTelemetry *t, uint8_t *out, uint16_t cap)
+{
+  if (!t || !out || cap < APP_FRAME_BIN_MAX) return 0;
+
+  uint8_t *p = out + APP_FRAME_HDR_LEN;
+  uint8_t  nfields = 0;
+
+  if (t->valid & APP_TLM_VALID_I2C) {
+    p = put_u8(p, APP_FRAME_FIELD_I2C_TEMP);
+    p = put_u16_le(p, (uint16_t)(int16_t)t->i2c_temp_c);
+    nfields++;
+  }
+
+  if (t->valid & APP_TLM_VALID_CAN101) {
+    p = put_u8(p, APP_FRAME_FIELD_CAN_HB_SEQ);
+    p = put_u8(p, t->can_hb_seq);
+    nfields++;
+  }
+
+  if (t->valid & APP_TLM_VALID_CAN120) {
+    p = put_u8(p, APP_FRAME_FIELD_CAN_LUX);
+    p = put_u32_le(p, t->can_lux_x100);
+    p = put_u8(p, APP_FRAME_FIELD_CAN_FULL);
+    p = put_u16_le(p, t->can_full);
+    p = put_u8(p, APP_FRAME_FIELD_CAN_IR);
+    p = put_u16_le(p, t->can_ir);
+    nfields += 3U;
+  }
+
+  uint16_t len = (uint16_t)(p - out);
+
+  /* Header last, once the field count and length are known */
+  p = out;
+  p = put_u8(p, APP_FRAME_MAGIC);
+  p = put_u8(p, APP_FRAME_VERSION);
+  p = put_u8(p, APP_FRAME_TYPE_SAMPLE);
+  p = put_u8(p, nfields);
+  p = put_u16_le(p, len);
+  p = put_u32_le(p, t->seq);
+  (void)put_u64_le(p, t->ts_us);
+
+  return len;
+}
+
+/* =============================================================================
+ * CAN events
+ * ============================================================================= */
+
+/**
+ * @brief Encode raw CAN frames as one event frame (see app_frame.h).
+ *
+ * @return Frame length, 0 if n is 0 or the records do not fit.
+ */
+uint16_t APP_FRAME_EncodeCanEvents(const AppCanEvent *ev, uint8_t n, uint32_t seq,
+                                   uint8_t *out, uint16_t cap)
+{
+  if (!ev || !out || n == 0U) return 0;
+
+  uint32_t need = APP_FRAME_HDR_LEN;
+  for (uint8_t i = 0; i < n; i++)
+    need += APP_FRAME_CAN_REC_HDR + ev[i].dlc;
+  if (need > cap) return 0;
+
+  uint8_t *p = out;
+  p = put_u8(p, APP_FRAME_MAGIC);
+  p = put_u8(p, APP_FRAME_VERSION);
+  p = put_u8(p, APP_FRAME_TYPE_CAN_EVENT);
+  p = put_u8(p, n);
+  p = put_u16_le(p, (uint16_t)need);
+  p = put_u32_le(p, seq);
+  p = put_u64_le(p, ev[0].ts_us);
+
+  for (uint8_t i = 0; i < n; i++) {
+    p = put_u32_le(p, (uint32_t)(ev[i].ts_us - ev[0].ts_us));
+    p = put_u16_le(p, ev[i].id);
+    p = put_u8(p, ev[i].dlc);
+    for (uint8_t k = 0; k < ev[i].dlc; k++)
+      p = put_u8(p, ev[i].data[k]);
+  }
+
+  return (uint16_t)need;
+}
+
+/* =============================================================================
+ * Dispatch
+ * ============================================================================= */
+
+uint16_t APP_FRAME_Encode(AppFrameEncoding enc, const AppTelemetry *t,
+                          uint8_t *out, uint16_t cap)
+{
+  /* Delta blocks span several samples (app_tsc.c); one sample on its own
+     is sent as a binary frame */
+  if (enc == APP_FRAME_ENC_BIN || enc == APP_FRAME_ENC_DELTA)
+    return APP_FRAME_EncodeBinary(t, out, cap);
+
+  return APP_FRAME_EncodeJSON(t, out, cap);
+}
+
+const char *APP_FRAME_EncodingName(AppFrameEncoding enc)
+{
+  switch (enc) {
+    case APP_FRAME_ENC_BIN:   return "bin";
+    case APP_FRAME_ENC_DELTA: return "delta";
+    default:                  return "json";
+  }
+}
@@ -26,7 +26,15 @@
 #include "usbd_cdc_if.h"
 #include "tft.h"
 #include "can.h"
+#include "can_db.h"
+#include "can_stats.h"
 #include "app_net.h"
+#include "app_tsc.h"
+#include "app_fbuf.h"
+#include "app_iperf.h"
+#include "app_netstat.h"
+#include "app_membench.h"
+#include "ethernetif.h"
 
 /* =============================================================================
  * Standard library includes
@@ -44,16 +52,6 @@ extern HAL_StatusTypeDef I2C_ReadTempFromESP32(float *out_temp_c);
 extern void   CDC_ConsoleTxService(void);
 extern uint8_t CDC_ReadLine(char *out, uint16_t out_sz);
 
-/* =============================================================================
- * Local file-scope state (legacy / misc)
- * =============================================================================
- * NOTE: This file contains older I2C status variables, but the current UI/CLI
- * uses App_I2C_* getters from the I2C module. Consider removing these if unused.
- */
-static float       g_i2c_temp = 0.0f;
-static uint8_t     g_i2c_ok   = 0;
-static const char* g_i2c_last_err = "none";
-
 /* =============================================================================
  * Debug output (UART + USB console)
  * ============================================================================= */
@@ -102,39 +100,77 @@ static void print_help(void)
     "  get can\r\n"
     "  get can101\r\n"
     "  get can120\r\n"
+    "  can stats\r\n"
+    "  can db\r\n"
+    "  can filter\r\n"
+    "  can send <id> <hex> [deadline_ms]\r\n"
+    "  can tx\r\n"
+    "  can bus [reset]\r\n"
+    "  can bus tlm <ms>|off\r\n"
     "  uptime\r\n"
     "  log on|off\r\n"
     "  rate <ms>\r\n"
+    "  net enc json|bin|delta\r\n"
+    "  net bench [samples] [hz]\r\n"
+    "  net membench [ops]\r\n"
+    "  net tcp\r\n"
+    "  net udp\r\n"
+    "  net frames\r\n"
+    "  net eth\r\n"
+    "  net filter [promisc|allmulti on|off]\r\n"
+    "  net filter bcast|budget <n>\r\n"
+    "  net backlog\r\n"
+    "  net push [on|off]\r\n"
+    "  net mqtt [on|off]\r\n"
+    "  net mqtt broker <ip> [port]\r\n"
+    "  net mqtt interval <ms>\r\n"
+    "  net rate <hz>\r\n"
+    "  net latency <ms>\r\n"
+    "  net capture <hz> <ms>\r\n"
+    "  iperf -s [-u]\r\n"
+    "  iperf -c <ip> [-u] [-t s] [-b rate[K|M]] [-l len] [-p port]\r\n"
+    "  iperf [stop]\r\n"
+    "  netstat [reset]\r\n"
+    "  netstat tlm <ms>|off\r\n"
     "  version\r\n"
   );
 }
 
+/**
+ * @brief I2C part of a status line from a shared sample.
+ */
+static void fmt_i2c(char *out, size_t cap, const AppTelemetry *t)
+{
+  if (t->valid & APP_TLM_VALID_I2C)
+    snprintf(out, cap, "Temp: %ld C", (long)t->i2c_temp_c);
+  else
+    snprintf(out, cap, "ERR: %s", App_I2C_GetLastErr());
+}
+
 /**
  * @brief Print one compact status line (I2C + CAN).
  *
- * Note:
- *  - This uses the legacy g_i2c_* variables (as in the original code). If you
- *    want consistent output, switch to App_I2C_* getters like in App_UserFeedUI().
+ * Values come from the latest telemetry sample (app_fbuf.c), i.e. exactly
+ * what was sent on the network.
  */
 static void print_status_line(void)
 {
   char line[256];
   char i2c_txt[64];
+  AppFrameBuf *f = APP_FBUF_AcquireLatest();
 
-  if (g_i2c_ok)
-  {
-    int temp_i = (int)g_i2c_temp;
-    snprintf(i2c_txt, sizeof(i2c_txt), "Temp: %d C", temp_i);
-  }
-  else
-  {
-    snprintf(i2c_txt, sizeof(i2c_txt), "ERR: %s", g_i2c_last_err);
+  if (!f) {
+    CDC_ConsolePrintSafe("ERR: no sample yet\r\n");
+    return;
   }
 
+  const AppTelemetry *t = APP_FBUF_Text(f);
+
+  fmt_i2c(i2c_txt, sizeof(i2c_txt), t);
   snprintf(line, sizeof(line),
-           "[I2C]: %s | [CAN]: %s\r\n",
-           i2c_txt,
-           CAN1_GetLastText());
+           "[I2C]: %s | [CAN]: %s | %s\r\n",
+           i2c_txt, t->can_0x101, t->can_0x120);
+  APP_FBUF_Release(f);
 
   CDC_ConsolePrintSafe(line);
 }
@@ -145,17 +181,18 @@ static void print_status_line(void)
 static void print_i2c_line(void)
 {
   char line[128];
+  char i2c_txt[64];
+  AppFrameBuf *f = APP_FBUF_AcquireLatest();
 
-  if (g_i2c_ok)
-  {
-    int temp_i = (int)g_i2c_temp;
-    snprintf(line, sizeof(line), "[I2C]: Temp: %d C\r\n", temp_i);
-  }
-  else
-  {
-    snprintf(line, sizeof(line), "[I2C]: ERR: %s\r\n", g_i2c_last_err);
+  if (!f) {
+    CDC_ConsolePrintSafe("ERR: no sample yet\r\n");
+    return;
   }
 
+  fmt_i2c(i2c_txt, sizeof(i2c_txt), &f->t);
+  APP_FBUF_Release(f);
+
+  snprintf(line, sizeof(line), "[I2C]: %s\r\n", i2c_txt);
   CDC_ConsolePrintSafe(line);
 }
 
@@ -170,29 +207,235 @@ static void print_can_line(void)
 }
 
 /**
- * @brief Print status as JSON (compact).
+ * @brief Print the latest sample as its JSON telemetry line.
+ *
+ * Same bytes as the UDP/TCP JSON encoding (shared, encoded once).
  */
 static void print_status_json(void)
 {
-  char line[256];
+  char line[APP_FBUF_JSON_MAX + 2U];
+  uint16_t n = 0;
+  AppFrameBuf *f = APP_FBUF_AcquireLatest();
+  const uint8_t *json = f ? APP_FBUF_Frame(f, APP_FRAME_ENC_JSON, &n) : NULL;
+
+  if (json && n > 0U) {
+    /* The wire line ends with '\n'; the console wants CRLF */
+    snprintf(line, sizeof(line), "%.*s\r\n", (int)(n - 1U), (const char *)json);
+    CDC_ConsolePrintSafe(line);
+  } else {
+    CDC_ConsolePrintSafe("ERR: no sample yet\r\n");
+  }
 
-  if (g_i2c_ok)
-  {
-    int temp_i = (int)g_i2c_temp;
-    snprintf(line, sizeof(line),
-             "{\"i2c\":{\"ok\":true,\"temp_c\":%d},\"can\":{\"text\":\"%s\"}}\r\n",
-             temp_i, CAN1_GetLastText());
+  APP_FBUF_Release(f);
+}
+
+/**
+ * @brief Print the counters of the current / last iperf run.
+ */
+static void print_iperf_stats(void)
+{
+  static const char *const k_mode[] = {
+    "idle", "tcp server", "udp server", "tcp client", "udp client"
+  };
+  AppIperfStats st;
+  char line[240];
+
+  APP_IPERF_GetStats(&st);
+  snprintf(line, sizeof(line),
+           "IPERF: %s%s %lu.%03lu s %lu.%02lu Mbit/s %lu pps bytes=%lu pkts=%lu\r\n"
+           "  retrans=%lu lost=%lu ooo=%lu jitter=%lu us%s"
+           " pool_empty=%lu tx_busy=%lu mem_err=%lu err=%lu\r\n",
+           k_mode[st.mode], st.running ? " running" : "",
+           (unsigned long)(st.elapsed_ms / 1000U), (unsigned long)(st.elapsed_ms % 1000U),
+           (unsigned long)(st.kbps / 1000U), (unsigned long)((st.kbps % 1000U) / 10U),
+           (unsigned long)st.pps, (unsigned long)st.bytes, (unsigned long)st.packets,
+           (unsigned long)st.retransmits, (unsigned long)st.lost,
+           (unsigned long)st.out_of_order, (unsigned long)st.jitter_us,
+           (st.mode == APP_IPERF_UDP_CLIENT && !st.report) ? " (no report)" : "",
+           (unsigned long)st.rx_pool_empty, (unsigned long)st.tx_busy,
+           (unsigned long)st.mem_err, (unsigned long)st.errors);
+  CDC_ConsolePrintSafe(line);
+}
+
+/**
+ * @brief Print CAN bus load, error state and per-ID rates (can_stats.c).
+ */
+static void print_can_bus(void)
+{
+  static const char *const k_lec[CAN_STATS_LEC_COUNT] = {
+    "none", "stuff", "form", "ack", "bit1", "bit0", "crc"
+  };
+  CanStatsBus b;
+  CanStatsId  ids[CAN_STATS_IDS_MAX];
+  uint32_t sent, errors;
+  char line[220];
+
+  CAN_STATS_GetBus(&b);
+  uint8_t n = CAN_STATS_GetIds(ids, (uint8_t)CAN_STATS_IDS_MAX);
+  APP_NET_GetCanStatsCounts(&sent, &errors);
+
+  snprintf(line, sizeof(line),
+           "CAN BUS: load=%u.%u%% peak=%u.%u%% rejected=%u.%u%% rx=%lu fps tx=%lu fps"
+           " frames rx=%lu tx=%lu ids=%u untracked=%lu\r\n",
+           (unsigned)(b.load_permille / 10U), (unsigned)(b.load_permille % 10U),
+           (unsigned)(b.peak_permille / 10U), (unsigned)(b.peak_permille % 10U),
+           (unsigned)(b.rejected_permille / 10U), (unsigned)(b.rejected_permille % 10U),
+           (unsigned long)b.rx_fps, (unsigned long)b.tx_fps,
+           (unsigned long)b.rx_frames, (unsigned long)b.tx_frames,
+           (unsigned)b.ids, (unsigned long)b.untracked);
+  CDC_ConsolePrintSafe(line);
+
+  snprintf(line, sizeof(line),
+           "CAN ERR: %s tec=%u rec=%u lec=%s irqs=%lu stuff=%lu form=%lu ack=%lu"
+           " bit1=%lu bit0=%lu crc=%lu\r\n",
+           b.bus_off ? "bus-off" : b.passive ? "passive" : b.warning ? "warning" : "active",
+           (unsigned)b.tec, (unsigned)b.rec, k_lec[b.last_lec % CAN_STATS_LEC_COUNT],
+           (unsigned long)b.err_irqs,
+           (unsigned long)b.lec_count[CAN_STATS_LEC_STUFF],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_FORM],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_ACK],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_BIT1],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_BIT0],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_CRC]);
+  CDC_ConsolePrintSafe(line);
+
+  snprintf(line, sizeof(line),
+           "CAN ERR: warning=%lu passive=%lu bus-off=%lu recovered=%lu fifo_overrun=%lu\r\n",
+           (unsigned long)b.warning_events, (unsigned long)b.passive_events,
+           (unsigned long)b.busoff_events, (unsigned long)b.recoveries,
+           (unsigned long)b.fifo_overruns);
+  CDC_ConsolePrintSafe(line);
+
+  CDC_ConsolePrintSafe("ID        FRAMES   RATE/s  PERIOD_US  JITTER_US     MIN_US     MAX_US\r\n");
+  for (uint8_t i = 0; i < n; i++) {
+    snprintf(line, sizeof(line), "0x%03X %10lu %6lu.%lu %10lu %10lu %10lu %10lu\r\n",
+             (unsigned)ids[i].id, (unsigned long)ids[i].frames,
+             (unsigned long)(ids[i].rate_x10 / 10U), (unsigned long)(ids[i].rate_x10 % 10U),
+             (unsigned long)ids[i].period_us, (unsigned long)ids[i].jitter_us,
+             (unsigned long)ids[i].min_us, (unsigned long)ids[i].max_us);
+    CDC_ConsolePrintSafe(line);
   }
-  else
-  {
-    snprintf(line, sizeof(line),
-             "{\"i2c\":{\"ok\":false,\"err\":\"%s\"},\"can\":{\"text\":\"%s\"}}\r\n",
-             g_i2c_last_err, CAN1_GetLastText());
+
+  snprintf(line, sizeof(line), "TLM: canstats=%lu ms sent=%lu err=%lu\r\n",
+           (unsigned long)APP_NET_GetCanStatsPeriod(),
+           (unsigned long)sent, (unsigned long)errors);
+  CDC_ConsolePrintSafe(line);
+}
+
+/**
+ * @brief Print pool usage, protocol counters and drops (app_netstat.c).
+ */
+static void print_netstat(void)
+{
+  AppNetstatPool  pools[APP_NETSTAT_POOLS_MAX];
+  AppNetstatProto protos[APP_NETSTAT_PROTOS_MAX];
+  AppNetstatDrops d;
+  uint32_t sent, errors;
+  char line[200];
+
+  uint8_t np = APP_NETSTAT_GetPools(pools, (uint8_t)APP_NETSTAT_POOLS_MAX);
+  uint8_t nr = APP_NETSTAT_GetProtos(protos, (uint8_t)APP_NETSTAT_PROTOS_MAX);
+  APP_NETSTAT_GetDrops(&d);
+  APP_NET_GetNetstatCounts(&sent, &errors);
+
+  CDC_ConsolePrintSafe("POOL               AVAIL    USED    PEAK    FAIL\r\n");
+  for (uint8_t i = 0; i < np; i++) {
+    snprintf(line, sizeof(line), "%-16s %7lu %7lu %7lu %7lu\r\n", pools[i].name,
+             (unsigned long)pools[i].avail, (unsigned long)pools[i].used,
+             (unsigned long)pools[i].peak, (unsigned long)pools[i].fail);
+    CDC_ConsolePrintSafe(line);
+  }
+
+  CDC_ConsolePrintSafe("PROTO         TX        RX      DROP  MEMERR     ERR\r\n");
+  for (uint8_t i = 0; i < nr; i++) {
+    snprintf(line, sizeof(line), "%-6s %9lu %9lu %9lu %7lu %7lu\r\n", protos[i].name,
+             (unsigned long)protos[i].xmit, (unsigned long)protos[i].recv,
+             (unsigned long)protos[i].drop, (unsigned long)protos[i].memerr,
+             (unsigned long)protos[i].err);
+    CDC_ConsolePrintSafe(line);
   }
 
+  snprintf(line, sizeof(line),
+           "ETH: pool_empty=%lu buf_unavail=%lu missed=%lu fifo_ovf=%lu crc=%lu"
+           " align=%lu dma_err=%lu tx_busy=%lu\r\n",
+           (unsigned long)d.rx_pool_empty, (unsigned long)d.rx_buf_unavail,
+           (unsigned long)d.rx_missed, (unsigned long)d.rx_fifo_overflow,
+           (unsigned long)d.rx_crc_errors, (unsigned long)d.rx_align_errors,
+           (unsigned long)d.dma_errors, (unsigned long)d.tx_busy);
+  CDC_ConsolePrintSafe(line);
+
+  snprintf(line, sizeof(line),
+           "APP: tcp_retrans=%lu udp_dropped=%lu udp_nobuf=%lu tcp_dropped=%lu"
+           " backlog_evicted=%lu\r\n"
+           "TLM: netstat=%lu ms sent=%lu err=%lu\r\n",
+           (unsigned long)d.tcp_retrans, (unsigned long)d.udp_dropped,
+           (unsigned long)d.udp_no_pbuf, (unsigned long)d.tcp_dropped,
+           (unsigned long)d.backlog_evicted,
+           (unsigned long)APP_NET_GetNetstatPeriod(),
+           (unsigned long)sent, (unsigned long)errors);
   CDC_ConsolePrintSafe(line);
 }
 
+/**
+ * @brief "iperf -s|-c ..." with iperf2-style options (modified in place).
+ *
+ * -b takes bits/s with an optional K or M suffix; 0 sends unpaced.
+ */
+static void cli_iperf_start(char *args)
+{
+  bool server = false, udp = false;
+  const char *ip = NULL;
+  uint32_t secs = 0, kbps = APP_IPERF_DEFAULT_KBPS, len = 0, port = 0;
+  bool ok;
+
+  for (char *t = strtok(args, " "); t; t = strtok(NULL, " ")) {
+    char *v = NULL;
+
+    if (strcmp(t, "-s") == 0) {
+      server = true;
+    } else if (strcmp(t, "-u") == 0) {
+      udp = true;
+    } else if ((v = strtok(NULL, " ")) == NULL) {
+      ip = NULL;
+      server = false;
+      break;
+    } else if (strcmp(t, "-c") == 0) {
+      ip = v;
+    } else if (strcmp(t, "-t") == 0) {
+      secs = (uint32_t)strtoul(v, NULL, 10);
+    } else if (strcmp(t, "-l") == 0) {
+      len = (uint32_t)strtoul(v, NULL, 10);
+    } else if (strcmp(t, "-p") == 0) {
+      port = (uint32_t)strtoul(v, NULL, 10);
+    } else if (strcmp(t, "-b") == 0) {
+      char *end = NULL;
+      kbps = (uint32_t)strtoul(v, &end, 10);
+      if (*end == 'M' || *end == 'm')      kbps *= 1000U;
+      else if (*end != 'K' && *end != 'k') kbps /= 1000U;
+    } else {
+      ip = NULL;
+      server = false;
+      break;
+    }
+  }
+
+  if (server)
+    ok = APP_IPERF_StartServer(udp);
+  else if (ip && len <= 0xFFFFU && port <= 0xFFFFU)
+    ok = APP_IPERF_StartClient(udp, ip, (uint16_t)port, secs * 1000U, kbps, (uint16_t)len);
+  else
+    ok = false;
+
+  if (ok) {
+    char line[64];
+    snprintf(line, sizeof(line), "OK: iperf %s %s\r\n",
+             udp ? "udp" : "tcp", server ? "server" : "client");
+    CDC_ConsolePrintSafe(line);
+  } else {
+    CDC_ConsolePrintSafe("ERR: iperf -s [-u] | -c <ip> [-u] [-t s] [-b rate] [-l len] [-p port]\r\n");
+  }
+}
+
 /* =============================================================================
  * USB CLI: state + service (command parser)
  * ============================================================================= */
@@ -258,6 +501,127 @@ void App_CLI_Service(uint32_t now_ms)
     snprintf(line, sizeof(line), "[CAN120]: %s\r\n", CAN1_GetText_0x120());
     CDC_ConsolePrintSafe(line);
 
+  } else if (strcmp(p, "can stats") == 0) {
+    CAN1_RxStats st;
+    char line[220];
+    CAN1_GetRxStats(&st);
+    for (uint32_t i = 0; i < 2u; i++) {
+      const CAN1_RxFifoStats *fs = &st.fifo[i];
+      snprintf(line, sizeof(line),
+               "CAN RX%lu: frames=%lu ignored=%lu ring=%u/%u max=%u batch_max=%u"
+               " ring_overflow=%lu fifo_overrun=%lu\r\n",
+               (unsigned long)i, (unsigned long)fs->frames, (unsigned long)fs->ignored,
+               (unsigned)fs->pending, (unsigned)fs->size,
+               (unsigned)fs->max_pending, (unsigned)fs->max_batch,
+               (unsigned long)fs->ring_overflow, (unsigned long)fs->fifo_overrun);
+      CDC_ConsolePrintSafe(line);
+    }
+    snprintf(line, sizeof(line), "CAN RX: bit=%lu ns\r\n", (unsigned long)st.bit_ns);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "can filter") == 0) {
+    CAN1_FilterStats fs;
+    CanFltBank b;
+    char line[200];
+    CAN1_GetFilterStats(&fs);
+    snprintf(line, sizeof(line),
+             "CAN FILTER: %s ids=%u banks=%u (list=%u mask=%u fifo1=%u) extra_ids=%u"
+             " open=%u\r\n",
+             fs.accept_all ? "accept-all" : "table", (unsigned)fs.ids, (unsigned)fs.banks,
+             (unsigned)fs.list_banks, (unsigned)fs.mask_banks, (unsigned)fs.fifo1_banks,
+             (unsigned)fs.extra_ids, (unsigned)fs.open);
+    CDC_ConsolePrintSafe(line);
+    for (uint8_t i = 0; CAN1_GetFilterBank(i, &b) != 0u; i++) {
+      if (b.mask_mode)
+        snprintf(line, sizeof(line),
+                 "CAN FILTER: bank %u FIFO%u mask 0x%03X/0x%03X 0x%03X/0x%03X\r\n",
+                 (unsigned)i, (unsigned)b.fifo, (unsigned)b.id[0], (unsigned)b.mask[0],
+                 (unsigned)b.id[1], (unsigned)b.mask[1]);
+      else
+        snprintf(line, sizeof(line),
+                 "CAN FILTER: bank %u FIFO%u list 0x%03X 0x%03X 0x%03X 0x%03X\r\n",
+                 (unsigned)i, (unsigned)b.fifo, (unsigned)b.id[0], (unsigned)b.id[1],
+                 (unsigned)b.id[2], (unsigned)b.id[3]);
+      CDC_ConsolePrintSafe(line);
+    }
+    snprintf(line, sizeof(line),
+             "CAN FILTER: rejected~%lu (%lu surveys of %u ms per %u ms) outside=%lu\r\n",
+             (unsigned long)fs.rejected_est, (unsigned long)fs.surveys,
+             (unsigned)CAN1_FILTER_SURVEY_WINDOW_MS, (unsigned)CAN1_FILTER_SURVEY_PERIOD_MS,
+             (unsigned long)fs.outside);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strncmp(p, "can send ", 9) == 0) {
+    /* can send <id> <hex bytes> [deadline_ms], e.g. "can send 0x200 0a01 500" */
+    char *end = NULL;
+    char line[96];
+    uint8_t data[8];
+    uint8_t dlc = 0;
+    uint32_t id = (uint32_t)strtoul(p + 9, &end, 0);
+    const char *h = end;
+    while (*h == ' ') h++;
+    while (dlc < 8U && h[0] != 0 && h[0] != ' ' && h[1] != 0 && h[1] != ' ') {
+      char byte[3] = { h[0], h[1], 0 };
+      data[dlc++] = (uint8_t)strtoul(byte, NULL, 16);
+      h += 2;
+    }
+    uint32_t deadline = (*h == ' ') ? (uint32_t)strtoul(h, NULL, 10) : 1000U;
+    uint8_t ok = (end != p + 9 && id <= 0x7FFU) ? CAN1_Send((uint16_t)id, data, dlc, deadline) : 0U;
+    snprintf(line, sizeof(line), "CAN TX: 0x%03lX dlc=%u deadline=%lu ms %s\r\n",
+             (unsigned long)id, (unsigned)dlc, (unsigned long)deadline,
+             ok ? "queued" : "refused");
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "can tx") == 0) {
+    CAN1_TxStats ts;
+    char line[220];
+    CAN1_GetTxStats(&ts);
+    snprintf(line, sizeof(line),
+             "CAN TX: queued=%lu sent=%lu rejected=%lu dropped=%lu expired=%lu"
+             " preempted=%lu errors=%lu queue=%u/%u max=%u mailboxes=%u/3"
+             " latency=%lu us max=%lu us\r\n",
+             (unsigned long)ts.queued, (unsigned long)ts.sent,
+             (unsigned long)ts.rejected, (unsigned long)ts.dropped,
+             (unsigned long)ts.expired, (unsigned long)ts.preempted,
+             (unsigned long)ts.errors, (unsigned)ts.pending,
+             (unsigned)CAN1_TX_QUEUE_SIZE, (unsigned)ts.max_pending,
+             (unsigned)ts.in_flight, (unsigned long)ts.last_latency_us,
+             (unsigned long)ts.max_latency_us);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "can bus") == 0) {
+    print_can_bus();
+
+  } else if (strcmp(p, "can bus reset") == 0) {
+    CAN_STATS_ResetPeaks();
+    CDC_ConsolePrintSafe("OK: can bus peaks reset\r\n");
+
+  } else if (strncmp(p, "can bus tlm ", 12) == 0) {
+    uint32_t ms = (strcmp(p + 12, "off") == 0) ? 0U : (uint32_t)strtoul(p + 12, NULL, 10);
+    APP_NET_SetCanStatsPeriod(ms);
+
+    char line[64];
+    snprintf(line, sizeof(line), "OK: can bus tlm=%lu ms\r\n",
+             (unsigned long)APP_NET_GetCanStatsPeriod());
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "can db") == 0) {
+    char line[200];
+    for (uint32_t m = 0; m < CAN_DB_MSG_COUNT; m++) {
+      CanDbMsgInfo mi;
+      char txt[128];
+      CAN_DB_GetMsgInfo((CanDbMsg)m, now_ms, &mi);
+      (void)CAN_DB_FormatMsg((CanDbMsg)m, txt, sizeof(txt));
+      snprintf(line, sizeof(line),
+               "CAN DB: 0x%03X frames=%lu dlc_err=%lu %s: %s\r\n",
+               (unsigned)mi.id, (unsigned long)mi.frames,
+               (unsigned long)mi.dlc_errors, mi.fresh ? "fresh" : "stale", txt);
+      CDC_ConsolePrintSafe(line);
+    }
+    snprintf(line, sizeof(line), "CAN DB: unknown IDs=%lu\r\n",
+             (unsigned long)CAN_DB_GetUnknown());
+    CDC_ConsolePrintSafe(line);
+
   } else if (strncmp(p, "rate ", 5) == 0) {
     uint32_t ms = (uint32_t)strtoul(p + 5, NULL, 10);
 
@@ -271,6 +635,306 @@ void App_CLI_Service(uint32_t now_ms)
              (unsigned long)s_print_period_ms);
     CDC_ConsolePrintSafe(line);
 
+  } else if (strcmp(p, "net enc json") == 0) {
+    APP_NET_SetEncoding(APP_FRAME_ENC_JSON);
+    CDC_ConsolePrintSafe("OK: net enc=json\r\n");
+
+  } else if (strcmp(p, "net enc bin") == 0) {
+    APP_NET_SetEncoding(APP_FRAME_ENC_BIN);
+    CDC_ConsolePrintSafe("OK: net enc=bin\r\n");
+
+  } else if (strcmp(p, "net enc delta") == 0) {
+    APP_NET_SetEncoding(APP_FRAME_ENC_DELTA);
+    CDC_ConsolePrintSafe("OK: net enc=delta\r\n");
+
+  } else if (strcmp(p, "net bench") == 0 || strncmp(p, "net bench ", 10) == 0) {
+    char *end = NULL;
+    uint32_t n  = (p[9] != 0) ? (uint32_t)strtoul(p + 10, &end, 10) : 0U;
+    uint32_t hz = (end != NULL) ? (uint32_t)strtoul(end, NULL, 10) : 0U;
+    AppTscBench b;
+    char line[200];
+
+    if (n == 0U || n > 10000U) n = 1000U;
+    if (hz == 0U) hz = APP_NET_GetSampleRate();
+
+    APP_TSC_Benchmark((uint16_t)n, hz, &b);
+
+    /* ratios x100 to avoid float printf */
+    uint32_t r_bin  = b.bytes_delta ? (b.bytes_bin  * 100U) / b.bytes_delta : 0U;
+    uint32_t r_json = b.bytes_delta ? (b.bytes_json * 100U) / b.bytes_delta : 0U;
+    uint32_t cps    = b.samples ? b.cycles / b.samples : 0U;
+
+    snprintf(line, sizeof(line),
+             "TSC: n=%u hz=%lu delta=%luB bin=%luB json=%luB"
+             " ratio bin=%lu.%02lux json=%lu.%02lux enc=%lu cyc/sample\r\n",
+             (unsigned)b.samples, (unsigned long)hz,
+             (unsigned long)b.bytes_delta, (unsigned long)b.bytes_bin,
+             (unsigned long)b.bytes_json,
+             (unsigned long)(r_bin / 100U), (unsigned long)(r_bin % 100U),
+             (unsigned long)(r_json / 100U), (unsigned long)(r_json % 100U),
+             (unsigned long)cps);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net membench") == 0 || strncmp(p, "net membench ", 13) == 0) {
+    uint32_t n = (p[12] != 0) ? (uint32_t)strtoul(p + 13, NULL, 10) : 0U;
+    AppMemBench b;
+    char line[240];
+
+    if (n == 0U || n > APP_MEMBENCH_OPS_MAX) n = APP_MEMBENCH_OPS_DEFAULT;
+
+    APP_MEMBENCH_Run(n, &b);
+
+    snprintf(line, sizeof(line),
+             "MEM: %s ops=%lu allocs=%lu fails=%lu frag_fails=%lu skipped=%lu"
+             " live_peak=%luB\r\n"
+             "  malloc cyc min/avg/max=%lu/%lu/%lu free cyc min/avg/max=%lu/%lu/%lu"
+             " free=%luB largest=%luB\r\n",
+             b.pools ? "pools" : "heap",
+             (unsigned long)b.ops, (unsigned long)b.allocs,
+             (unsigned long)b.fails, (unsigned long)b.frag_fails,
+             (unsigned long)b.skipped, (unsigned long)b.live_peak,
+             (unsigned long)b.alloc_min,
+             (unsigned long)((b.allocs + b.fails) ? b.alloc_total / (b.allocs + b.fails) : 0U),
+             (unsigned long)b.alloc_max,
+             (unsigned long)b.free_min,
+             (unsigned long)(b.frees ? b.free_total / b.frees : 0U),
+             (unsigned long)b.free_max,
+             (unsigned long)b.free_bytes, (unsigned long)b.largest);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net tcp") == 0) {
+    AppNetTcpStats st;
+    char line[200];
+    APP_NET_GetTcpStats(&st);
+    snprintf(line, sizeof(line),
+             "TCP TXQ: queued=%u inflight=%u total=%lu acked=%lu dropped=%lu"
+             " every=%lu cmds=%lu cmderr=%lu\r\n",
+             (unsigned)st.queued, (unsigned)st.inflight,
+             (unsigned long)st.total_queued,
+             (unsigned long)st.total_acked,
+             (unsigned long)st.total_dropped,
+             (unsigned long)st.tcp_divider,
+             (unsigned long)st.cmds,
+             (unsigned long)st.cmd_errors);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net push on") == 0) {
+    APP_NET_SetCanPush(true);
+    CDC_ConsolePrintSafe("OK: net push=on\r\n");
+
+  } else if (strcmp(p, "net push off") == 0) {
+    APP_NET_SetCanPush(false);
+    CDC_ConsolePrintSafe("OK: net push=off\r\n");
+
+  } else if (strcmp(p, "net push") == 0) {
+    AppNetCanPushStats st;
+    char line[160];
+    APP_NET_GetCanPushStats(&st);
+    snprintf(line, sizeof(line),
+             "PUSH: %s pending=%u frames=%lu coalesced=%lu dgrams=%lu err=%lu ovf=%lu\r\n",
+             st.enabled ? "on" : "off", (unsigned)st.pending,
+             (unsigned long)st.frames, (unsigned long)st.coalesced,
+             (unsigned long)st.datagrams, (unsigned long)st.errors,
+             (unsigned long)st.overflow);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net mqtt on") == 0) {
+    APP_NET_SetMqtt(true);
+    CDC_ConsolePrintSafe("OK: net mqtt=on\r\n");
+
+  } else if (strcmp(p, "net mqtt off") == 0) {
+    APP_NET_SetMqtt(false);
+    CDC_ConsolePrintSafe("OK: net mqtt=off\r\n");
+
+  } else if (strncmp(p, "net mqtt broker ", 16) == 0) {
+    char ip[16];
+    const char *sp = strchr(p + 16, ' ');
+    size_t ip_len  = sp ? (size_t)(sp - (p + 16)) : strlen(p + 16);
+    uint32_t port  = sp ? (uint32_t)strtoul(sp + 1, NULL, 10) : APP_MQTT_PORT;
+    char line[80];
+
+    if (ip_len < sizeof(ip)) {
+      memcpy(ip, p + 16, ip_len);
+      ip[ip_len] = 0;
+    } else {
+      ip[0] = 0;
+    }
+
+    if (port != 0U && port <= 0xFFFFU && APP_NET_SetMqttBroker(ip, (uint16_t)port)) {
+      snprintf(line, sizeof(line), "OK: net mqtt broker=%s:%lu\r\n",
+               ip, (unsigned long)port);
+      CDC_ConsolePrintSafe(line);
+    } else {
+      CDC_ConsolePrintSafe("ERR: net mqtt broker <ip> [port]\r\n");
+    }
+
+  } else if (strncmp(p, "net mqtt interval ", 18) == 0) {
+    APP_NET_SetMqttInterval((uint32_t)strtoul(p + 18, NULL, 10));
+
+    char line[64];
+    snprintf(line, sizeof(line), "OK: net mqtt interval=%lu ms\r\n",
+             (unsigned long)APP_NET_GetMqttInterval());
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net mqtt") == 0) {
+    AppNetMqttStats st;
+    char line[200];
+    APP_NET_GetMqttStats(&st);
+    snprintf(line, sizeof(line),
+             "MQTT: %s %s broker=%s:%u interval=%lu ms conn=%lu lost=%lu err=%lu"
+             " bursts=%lu pub=%lu drop=%lu\r\n",
+             st.enabled ? "on" : "off", st.connected ? "up" : "down",
+             st.broker, (unsigned)st.broker_port,
+             (unsigned long)APP_NET_GetMqttInterval(),
+             (unsigned long)st.connects, (unsigned long)st.disconnects,
+             (unsigned long)st.errors, (unsigned long)st.bursts,
+             (unsigned long)st.publishes, (unsigned long)st.dropped);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net backlog") == 0) {
+    AppNetBacklogStats st;
+    char line[200];
+    APP_NET_GetBacklogStats(&st);
+    snprintf(line, sizeof(line),
+             "BACKLOG: depth=%u unsent=%u bytes=%u stored=%lu evicted=%lu replayed=%lu"
+             " discarded=%lu gw_ack=%s last=%lu\r\n",
+             (unsigned)st.depth, (unsigned)st.unsent, (unsigned)st.bytes,
+             (unsigned long)st.stored, (unsigned long)st.evicted,
+             (unsigned long)st.replayed, (unsigned long)st.discarded,
+             st.gw_ack_mode ? "on" : "off",
+             (unsigned long)st.gw_acked_seq);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net frames") == 0) {
+    AppFbufStats st;
+    char line[128];
+    APP_FBUF_GetStats(&st);
+    snprintf(line, sizeof(line),
+             "FRAMES: samples=%lu encodes=%lu shared=%lu nobuf=%lu\r\n",
+             (unsigned long)st.published, (unsigned long)st.encodes,
+             (unsigned long)st.hits, (unsigned long)st.no_buf);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net eth") == 0) {
+    ethernetif_stats_t st;
+    char line[220];
+    ethernetif_get_stats(&st);
+    snprintf(line, sizeof(line),
+             "ETH: rx_irq=%lu rx=%lu pool_empty=%lu buf_unavail=%lu dma_err=%lu"
+             " tx=%lu busy=%lu linearized=%lu ring=%lu/%u max=%lu\r\n",
+             (unsigned long)st.rx_irq, (unsigned long)st.rx_frames,
+             (unsigned long)st.rx_pool_empty, (unsigned long)st.rx_buf_unavail,
+             (unsigned long)st.dma_errors,
+             (unsigned long)st.tx_frames, (unsigned long)st.tx_busy,
+             (unsigned long)st.tx_linearized, (unsigned long)st.tx_inuse,
+             (unsigned)ETH_TX_DESC_CNT, (unsigned long)st.tx_inuse_max);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net filter") == 0 || strncmp(p, "net filter ", 11) == 0) {
+    ethernetif_filter_t f;
+    ethernetif_stats_t st;
+    char line[240];
+    const char *arg = p + 10;
+    ethernetif_get_filter(&f);
+
+    if (strncmp(arg, " promisc ", 9) == 0) {
+      f.promiscuous = (strcmp(arg + 9, "on") == 0);
+      ethernetif_set_filter(&f);
+    } else if (strncmp(arg, " allmulti ", 10) == 0) {
+      f.pass_all_multicast = (strcmp(arg + 10, "on") == 0);
+      ethernetif_set_filter(&f);
+    } else if (strncmp(arg, " bcast ", 7) == 0) {
+      f.bcast_per_sec = (uint16_t)strtoul(arg + 7, NULL, 10);
+      ethernetif_set_filter(&f);
+    } else if (strncmp(arg, " budget ", 8) == 0) {
+      f.rx_budget = (uint16_t)strtoul(arg + 8, NULL, 10);
+      ethernetif_set_filter(&f);
+    }
+
+    ethernetif_get_stats(&st);
+    snprintf(line, sizeof(line),
+             "FILTER: promisc=%s allmulti=%s hash=%08lx%08lx bcast=%u/s budget=%u\r\n"
+             "  mcast=%lu bcast=%lu bcast_drop=%lu storms=%lu%s budget_hits=%lu\r\n",
+             f.promiscuous ? "on" : "off", f.pass_all_multicast ? "on" : "off",
+             (unsigned long)st.mcast_hash[0], (unsigned long)st.mcast_hash[1],
+             (unsigned)f.bcast_per_sec, (unsigned)f.rx_budget,
+             (unsigned long)st.rx_mcast, (unsigned long)st.rx_bcast,
+             (unsigned long)st.rx_bcast_dropped, (unsigned long)st.rx_bcast_blocks,
+             st.bcast_blocked ? " (blocking)" : "",
+             (unsigned long)st.rx_budget_hits);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "net udp") == 0) {
+    AppNetUdpStats st;
+    char line[200];
+    APP_NET_GetUdpStats(&st);
+    snprintf(line, sizeof(line),
+             "UDP: rate=%lu Hz latency=%lu ms pending=%u/%uB dgrams=%lu samples=%lu"
+             " full=%lu timer=%lu err=%lu nobuf=%lu dropped=%lu\r\n",
+             (unsigned long)APP_NET_GetSampleRate(),
+             (unsigned long)APP_NET_GetUdpMaxLatency(),
+             (unsigned)st.pending_samples, (unsigned)st.pending_bytes,
+             (unsigned long)st.datagrams, (unsigned long)st.samples,
+             (unsigned long)st.flush_full, (unsigned long)st.flush_timer,
+             (unsigned long)st.errors, (unsigned long)st.no_pbuf,
+             (unsigned long)st.dropped);
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strncmp(p, "net rate ", 9) == 0) {
+    APP_NET_SetSampleRate((uint32_t)strtoul(p + 9, NULL, 10));
+
+    char line[64];
+    snprintf(line, sizeof(line), "OK: net rate=%lu Hz\r\n",
+             (unsigned long)APP_NET_GetSampleRate());
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strncmp(p, "net capture ", 12) == 0) {
+    char *end = NULL;
+    uint32_t hz = (uint32_t)strtoul(p + 12, &end, 10);
+    uint32_t ms = (uint32_t)strtoul(end, NULL, 10);
+
+    APP_NET_StartCapture(hz, ms, HAL_GetTick());
+
+    char line[64];
+    snprintf(line, sizeof(line), "OK: net capture=%lu Hz for %lu ms\r\n",
+             (unsigned long)APP_NET_GetSampleRate(),
+             (unsigned long)((ms > APP_NET_CAPTURE_MAX_MS) ? APP_NET_CAPTURE_MAX_MS : ms));
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strncmp(p, "net latency ", 12) == 0) {
+    APP_NET_SetUdpMaxLatency((uint32_t)strtoul(p + 12, NULL, 10));
+
+    char line[64];
+    snprintf(line, sizeof(line), "OK: net latency=%lu ms\r\n",
+             (unsigned long)APP_NET_GetUdpMaxLatency());
+    CDC_ConsolePrintSafe(line);
+
+  } else if (strcmp(p, "iperf") == 0) {
+    print_iperf_stats();
+
+  } else if (strcmp(p, "iperf stop") == 0) {
+    APP_IPERF_Stop();
+    print_iperf_stats();
+
+  } else if (strncmp(p, "iperf ", 6) == 0) {
+    cli_iperf_start(p + 6);
+
+  } else if (strcmp(p, "netstat") == 0) {
+    print_netstat();
+
+  } else if (strcmp(p, "netstat reset") == 0) {
+    APP_NETSTAT_ResetPeaks();
+    CDC_ConsolePrintSafe("OK: netstat peaks reset\r\n");
+
+  } else if (strncmp(p, "netstat tlm ", 12) == 0) {
+    uint32_t ms = (strcmp(p + 12, "off") == 0) ? 0U : (uint32_t)strtoul(p + 12, NULL, 10);
+    APP_NET_SetNetstatPeriod(ms);
+
+    char line[64];
+    snprintf(line, sizeof(line), "OK: netstat tlm=%lu ms\r\n",
+             (unsigned long)APP_NET_GetNetstatPeriod());
+    CDC_ConsolePrintSafe(line);
+
   } else if (strcmp(p, "version") == 0) {
     CDC_ConsolePrintSafe("FW: nucleo-f767-base | build: " __DATE__ " " __TIME__ "\r\n");
 
@@ -286,18 +950,15 @@ void App_CLI_Service(uint32_t now_ms)
  * CAN: service timing wrapper
  * ============================================================================= */
 
-static uint32_t s_last_can = 0;
-
 /**
- * @brief Periodic CAN service wrapper.
+ * @brief CAN service wrapper, every main loop pass.
  *
- * CAN RX is IRQ-driven, but keeping a service call is useful for consistency
- * and for future extensions (TX, timeouts, etc.).
+ * The RX IRQ only queues frames; CAN1_Service() decodes them, so it must
+ * not be rate-limited (its RX ring bridges a single pass).
  */
 void App_CAN_Service(uint32_t now_ms)
 {
-  if ((uint32_t)(now_ms - s_last_can) < 50U) return;
-  s_last_can = now_ms;
+  (void)now_ms;
 
   CAN1_Service();
 }
@@ -536,14 +1197,24 @@ void App_UserFeedUI(uint32_t now_ms)
   else
     App_UI_SetLineF(UI_LINE_NET_TCP, rgb(0, 255, 255), 0x0000, "NET TCP: DOWN");
 
-  App_UI_SetLineF(UI_LINE_TCP_PAYLOAD, rgb(0, 100, 100), 0x0000,
-                  "TCP: %s", APP_NET_GetLastTCP());
+  /* Preview of the sample that went out last (shared with UDP/TCP/USB) */
+  AppFrameBuf *f = APP_FBUF_AcquireLatest();
+
+  if (f) {
+    App_UI_SetLineF(UI_LINE_TCP_PAYLOAD, rgb(0, 100, 100), 0x0000,
+                    "TCP: %s seq=%lu", APP_FRAME_EncodingName(APP_NET_GetEncoding()),
+                    (unsigned long)f->t.seq);
+    App_UI_SetLineF(UI_LINE_NET_PAYLOAD, rgb(0, 100, 100), 0x0000,
+                    "UDP: ts=%lu i2c=%ld", (unsigned long)f->t.now_ms,
+                    (long)f->t.i2c_temp_c);
+    APP_FBUF_Release(f);
+  } else {
+    App_UI_SetLine(UI_LINE_TCP_PAYLOAD, rgb(0, 100, 100), 0x0000, "TCP: -");
+    App_UI_SetLine(UI_LINE_NET_PAYLOAD, rgb(0, 100, 100), 0x0000, "UDP: -");
+  }
 
   App_UI_SetLineF(UI_LINE_NET_UDP, rgb(0, 255, 255), 0x0000,
-                  "NET UDP: TX 1Hz");
-
-  App_UI_SetLineF(UI_LINE_NET_PAYLOAD, rgb(0, 100, 100), 0x0000,
-                  "UDP: %s", APP_NET_GetLastUDP());
+                  "NET UDP: %lu Hz", (unsigned long)APP_NET_GetSampleRate());
 }
 
 /**
@@ -605,7 +1276,6 @@ void App_Init(void)
   dbg("USB CDC init OK\r\n");
   dbg("Type 'help' over USB CDC\r\n");
 
-  s_last_can   = HAL_GetTick();
   s_last_ui    = HAL_GetTick();
   s_last_print = HAL_GetTick();
 }
@@ -0,0 +1,738 @@
+/**
+ * @file    app_iperf.c
+ * @brief   iperf2-compatible throughput source and sink (lwIP raw API).
+ *
+ * This module provides:
+ *  - TCP sink on APP_IPERF_PORT: counts the stream of an `iperf -c` client
+ *  - UDP sink: sequence loss / reordering, RFC 3550 jitter, and the iperf2
+ *    server report answering the client's FIN datagram
+ *  - TCP source: iperf2 client header, then a no-copy pattern stream for a
+ *    fixed duration (`iperf -s` on the other end)
+ *  - UDP source: datagrams paced to a bit rate, FIN handshake, server
+ *    report parsed back into the counters
+ *  - Per-run counters: Mbit/s, pps, retransmits, RX_POOL / TX ring / lwIP
+ *    pool exhaustion (deltas of ethernetif and lwIP stats)
+ *
+ * Wire format (iperf 2.0.x, all fields big-endian):
+ *  - UDP datagram: id i32 (negative = FIN), tv_sec u32, tv_usec u32, then
+ *    the client header area (flags = 0: plain test)
+ *  - TCP stream: client header (flags, threads, port, buffer len, window,
+ *    amount = -duration in 10 ms units), then payload
+ *  - Server report: the FIN datagram header followed by flags, total length
+ *    (hi, lo), stop time (s, us), errors, out of order, datagrams, jitter
+ *    (s, us)
+ *
+ * Design notes:
+ *  - Payload is a static pattern in the non-cacheable DMA region: TCP writes
+ *    and UDP datagrams reference it (PBUF_ROM / PBUF_REF), so the ETH DMA
+ *    reads it in place; only the per-datagram header is allocated
+ *  - One test at a time; dual / tradeoff tests (-d, -r) are not supported
+ *  - Runs in the main loop next to telemetry; the counters are what the
+ *    whole stack sustains with the application running
+ */
+
+#include "app_iperf.h"
+
+#include <string.h>
+
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "ethernetif.h"
+
+#include "app_platform.h"  /* App_GetMicros(), APP_DMA_BUFFER */
+
+/* =============================================================================
+ * Protocol constants
+ * ============================================================================= */
+#define IPERF_UDP_HDR_LEN       12U      /* id, tv_sec, tv_usec            */
+#define IPERF_CLIENT_HDR_LEN    24U      /* flags .. amount                */
+#define IPERF_SERVER_HDR_LEN    40U      /* flags .. jitter2               */
+#define IPERF_HEADER_VERSION1   0x80000000UL
+
+/* Client header area in every datagram; zero flags mean a plain test */
+#define IPERF_UDP_MIN_LEN       (IPERF_UDP_HDR_LEN + IPERF_CLIENT_HDR_LEN)
+
+/* UDP source: datagrams per service pass, FIN retries (iperf2: 10 x 250 ms) */
+#define IPERF_UDP_BURST         16U
+#define IPERF_FIN_TRIES         10U
+#define IPERF_FIN_INTERVAL_MS   250U
+
+/* =============================================================================
+ * State
+ * ============================================================================= */
+static AppIperfStats    s_st;
+
+static struct udp_pcb  *s_udp    = NULL;
+static struct tcp_pcb  *s_listen = NULL;
+static struct tcp_pcb  *s_conn   = NULL;
+
+static uint32_t s_start_ms;
+static uint32_t s_last_ms;              /* last byte counted              */
+static uint32_t s_deadline_ms;          /* client: end of the run         */
+
+/* Baselines of the shared counters at run start */
+static ethernetif_stats_t s_eth0;
+static uint32_t s_rexmit0;
+static uint32_t s_memerr0;
+static uint8_t  s_nrtx;                 /* last sampled pcb->nrtx         */
+static uint32_t s_rto;                  /* RTO expiries seen in poll      */
+
+/* Client */
+static ip_addr_t s_peer;
+static uint16_t  s_peer_port;
+static uint32_t  s_duration_ms;
+static uint32_t  s_kbps;
+static uint16_t  s_len;
+static int32_t   s_udp_id;
+static uint8_t   s_fin_tries;
+static uint32_t  s_fin_next_ms;
+
+/* UDP sink */
+static ip_addr_t s_src;
+static uint16_t  s_src_port;
+static int32_t   s_last_id;
+static int32_t   s_last_transit;
+static uint32_t  s_jitter16;            /* jitter in us, scaled by 16     */
+
+/* Payload pattern ("0123456789..." like iperf), read in place by the DMA */
+APP_DMA_BUFFER static uint8_t s_pattern[APP_IPERF_LEN_MAX];
+
+/* =============================================================================
+ * Helpers
+ * ============================================================================= */
+static void put_be32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static uint32_t get_be32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+       | ((uint32_t)p[2] << 8)  |  (uint32_t)p[3];
+}
+
+static uint32_t tcp_rexmit_total(void)
+{
+#if MIB2_STATS
+  return lwip_stats.mib2.tcpretranssegs + s_rto;
+#else
+  return s_rto;
+#endif
+}
+
+static uint32_t mem_err_total(void)
+{
+  uint32_t n = 0;
+#if MEM_STATS
+  n += lwip_stats.mem.err;
+#endif
+#if MEMP_STATS
+  for (uint32_t i = 0; i < (uint32_t)MEMP_MAX; i++)
+    n += lwip_stats.memp[i]->err;
+#endif
+  return n;
+}
+
+/**
+ * @brief Reset the counters and take the baselines of the shared ones.
+ */
+static void run_begin(void)
+{
+  AppIperfMode mode = s_st.mode;
+
+  memset(&s_st, 0, sizeof(s_st));
+  s_st.mode    = mode;
+  s_st.running = true;
+
+  s_start_ms = sys_now();
+  s_last_ms  = s_start_ms;
+
+  s_rto  = 0;
+  s_nrtx = 0;
+  ethernetif_get_stats(&s_eth0);
+  s_rexmit0 = tcp_rexmit_total();
+  s_memerr0 = mem_err_total();
+
+  s_last_id      = -1;
+  s_last_transit = 0;
+  s_jitter16     = 0;
+}
+
+/**
+ * @brief Shared counters as deltas since the run started.
+ */
+static void run_deltas(AppIperfStats *o)
+{
+  ethernetif_stats_t eth;
+  ethernetif_get_stats(&eth);
+
+  o->rx_pool_empty = (eth.rx_pool_empty - s_eth0.rx_pool_empty)
+                   + (eth.rx_buf_unavail - s_eth0.rx_buf_unavail);
+  o->tx_busy       = eth.tx_busy - s_eth0.tx_busy;
+  o->mem_err       = mem_err_total() - s_memerr0;
+
+  if (o->mode == APP_IPERF_TCP_CLIENT || o->mode == APP_IPERF_TCP_SERVER)
+    o->retransmits = tcp_rexmit_total() - s_rexmit0;
+}
+
+static void run_end(void)
+{
+  if (!s_st.running) return;
+
+  s_st.running    = false;
+  s_st.elapsed_ms = s_last_ms - s_start_ms;
+  run_deltas(&s_st);
+}
+
+static void udp_close_pcb(void)
+{
+  if (s_udp) {
+    udp_remove(s_udp);
+    s_udp = NULL;
+  }
+}
+
+static void tcp_detach(struct tcp_pcb *pcb)
+{
+  tcp_arg(pcb, NULL);
+  tcp_recv(pcb, NULL);
+  tcp_sent(pcb, NULL);
+  tcp_err(pcb, NULL);
+  tcp_poll(pcb, NULL, 0);
+}
+
+static void tcp_close_conn(void)
+{
+  if (!s_conn) return;
+
+  tcp_detach(s_conn);
+  if (tcp_close(s_conn) != ERR_OK)
+    tcp_abort(s_conn);
+  s_conn = NULL;
+}
+
+/* =============================================================================
+ * UDP
+ * ============================================================================= */
+
+/**
+ * @brief One datagram: allocated header, pattern payload by reference.
+ */
+static err_t udp_send_datagram(int32_t id)
+{
+  struct pbuf *h = pbuf_alloc(PBUF_TRANSPORT, IPERF_UDP_MIN_LEN, PBUF_RAM);
+  if (!h) return ERR_MEM;
+
+  uint64_t now_us = App_GetMicros();
+  uint8_t *b      = (uint8_t *)h->payload;
+
+  memset(b, 0, IPERF_UDP_MIN_LEN);
+  put_be32(b + 0, (uint32_t)id);
+  put_be32(b + 4, (uint32_t)(now_us / 1000000ULL));
+  put_be32(b + 8, (uint32_t)(now_us % 1000000ULL));
+
+  if (s_len > IPERF_UDP_MIN_LEN) {
+    struct pbuf *d = pbuf_alloc(PBUF_RAW, (u16_t)(s_len - IPERF_UDP_MIN_LEN), PBUF_REF);
+    if (!d) {
+      pbuf_free(h);
+      return ERR_MEM;
+    }
+    d->payload = s_pattern;
+    pbuf_cat(h, d);
+  }
+
+  err_t err = udp_sendto(s_udp, h, &s_peer, s_peer_port);
+  pbuf_free(h);
+  return err;
+}
+
+/**
+ * @brief Sink side: answer a FIN datagram with the iperf2 server report.
+ */
+static void udp_send_report(const uint8_t *fin_hdr, const ip_addr_t *addr, u16_t port)
+{
+  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT,
+                              IPERF_UDP_HDR_LEN + IPERF_SERVER_HDR_LEN, PBUF_RAM);
+  if (!p) return;
+
+  uint8_t *b = (uint8_t *)p->payload;
+  uint8_t *r = b + IPERF_UDP_HDR_LEN;
+
+  memcpy(b, fin_hdr, IPERF_UDP_HDR_LEN);
+  put_be32(r + 0,  IPERF_HEADER_VERSION1);
+  put_be32(r + 4,  (uint32_t)(s_st.bytes >> 32));
+  put_be32(r + 8,  (uint32_t)s_st.bytes);
+  put_be32(r + 12, s_st.elapsed_ms / 1000U);
+  put_be32(r + 16, (s_st.elapsed_ms % 1000U) * 1000U);
+  put_be32(r + 20, s_st.lost);
+  put_be32(r + 24, s_st.out_of_order);
+  put_be32(r + 28, (uint32_t)(s_last_id + 1));
+  put_be32(r + 32, s_st.jitter_us / 1000000U);
+  put_be32(r + 36, s_st.jitter_us % 1000000U);
+
+  (void)udp_sendto(s_udp, p, addr, port);
+  pbuf_free(p);
+}
+
+/**
+ * @brief Sink side: sequence, loss and jitter bookkeeping of one datagram.
+ */
+static void udp_sink_datagram(int32_t id, const uint8_t *hdr, uint16_t len)
+{
+  /* Transit time on mixed clocks: only its variation is used */
+  uint32_t sent_us = get_be32(hdr + 4) * 1000000U + get_be32(hdr + 8);
+  int32_t  transit = (int32_t)((uint32_t)App_GetMicros() - sent_us);
+
+  if (s_st.packets != 0U) {
+    int32_t d = transit - s_last_transit;
+    if (d < 0) d = -d;
+    /* RFC 3550: J += (|D| - J) / 16 */
+    s_jitter16 += (uint32_t)d - ((s_jitter16 + 8U) >> 4);
+  }
+  s_last_transit = transit;
+  s_st.jitter_us = s_jitter16 >> 4;
+
+  if (id == s_last_id + 1) {
+    s_last_id = id;
+  } else if (id > s_last_id) {
+    s_st.lost += (uint32_t)(id - s_last_id - 1);
+    s_last_id  = id;
+  } else {
+    s_st.out_of_order++;
+    if (s_st.lost != 0U) s_st.lost--;
+  }
+
+  s_st.bytes += len;
+  s_st.packets++;
+  s_last_ms = sys_now();
+}
+
+static void on_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                        const ip_addr_t *addr, u16_t port)
+{
+  (void)arg;
+  (void)pcb;
+
+  uint8_t hdr[IPERF_UDP_HDR_LEN + IPERF_SERVER_HDR_LEN];
+
+  if (!p) return;
+  if (p->tot_len < IPERF_UDP_HDR_LEN) {
+    pbuf_free(p);
+    return;
+  }
+
+  uint16_t n  = pbuf_copy_partial(p, hdr, sizeof(hdr), 0);
+  int32_t  id = (int32_t)get_be32(hdr);
+
+  if (s_st.mode == APP_IPERF_UDP_SERVER) {
+    bool same = ip_addr_cmp(addr, &s_src) && port == s_src_port;
+
+    if (id >= 0) {
+      /* First datagram of a new client (or a restarted one) */
+      if (!same || (!s_st.running && id == 0)) {
+        if (s_st.running && !same) {
+          pbuf_free(p);
+          return;                       /* one client at a time */
+        }
+        ip_addr_copy(s_src, *addr);
+        s_src_port = port;
+        run_begin();
+      }
+      if (s_st.running)
+        udp_sink_datagram(id, hdr, p->tot_len);
+    } else if (same) {
+      /* FIN, possibly repeated until the report arrives */
+      run_end();
+      udp_send_report(hdr, addr, port);
+    }
+
+  } else if (s_st.mode == APP_IPERF_UDP_CLIENT) {
+    /* Server report for our FIN */
+    if (id < 0 && n >= IPERF_UDP_HDR_LEN + IPERF_SERVER_HDR_LEN && !s_st.report) {
+      const uint8_t *r = hdr + IPERF_UDP_HDR_LEN;
+      s_st.lost         = get_be32(r + 20);
+      s_st.out_of_order = get_be32(r + 24);
+      s_st.jitter_us    = get_be32(r + 32) * 1000000U + get_be32(r + 36);
+      s_st.report       = true;
+      s_fin_tries       = 0;
+    }
+  }
+
+  pbuf_free(p);
+}
+
+static bool udp_open(uint16_t local_port)
+{
+  s_udp = udp_new_ip_type(IPADDR_TYPE_V4);
+  if (!s_udp) return false;
+
+  if (udp_bind(s_udp, IP_ANY_TYPE, local_port) != ERR_OK) {
+    udp_close_pcb();
+    return false;
+  }
+
+  udp_recv(s_udp, on_udp_recv, NULL);
+  return true;
+}
+
+/**
+ * @brief Source side: datagrams owed by the bit rate (or a burst when
+ *        unpaced), then the FIN handshake.
+ */
+static void udp_client_service(uint32_t now_ms)
+{
+  if (s_st.running) {
+    uint32_t elapsed = now_ms - s_start_ms;
+
+    if (elapsed >= s_duration_ms) {
+      s_last_ms = s_start_ms + s_duration_ms;
+      run_end();
+      s_fin_tries   = IPERF_FIN_TRIES;
+      s_fin_next_ms = now_ms;
+    } else {
+      /* kbit/s * ms / 8 = bytes */
+      uint64_t owed = (uint64_t)s_kbps * elapsed / 8U;
+
+      for (uint8_t i = 0; i < IPERF_UDP_BURST; i++) {
+        if (s_kbps != 0U && s_st.bytes + s_len > owed) break;
+
+        err_t err = udp_send_datagram(s_udp_id);
+        if (err != ERR_OK) {
+          s_st.errors++;
+          break;                        /* ring / heap full: next pass */
+        }
+
+        s_udp_id++;
+        s_st.packets++;
+        s_st.bytes += s_len;
+        s_last_ms   = now_ms;
+      }
+    }
+  }
+
+  if (!s_st.running && s_fin_tries != 0U && (int32_t)(now_ms - s_fin_next_ms) >= 0) {
+    /* Negative id marks the FIN; -0 would not, if nothing was sent */
+    (void)udp_send_datagram(-((s_udp_id != 0) ? s_udp_id : 1));
+    s_fin_tries--;
+    s_fin_next_ms = now_ms + IPERF_FIN_INTERVAL_MS;
+  }
+}
+
+/* =============================================================================
+ * TCP
+ * ============================================================================= */
+static void on_tcp_err(void *arg, err_t err)
+{
+  (void)arg;
+  (void)err;
+
+  /* pcb already freed by lwIP */
+  s_conn = NULL;
+  if (s_st.running) {
+    s_st.errors++;
+    run_end();
+  }
+}
+
+static err_t on_tcp_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+  (void)arg;
+  (void)err;
+
+  if (!p) {
+    /* Client finished (or server closed on us) */
+    run_end();
+    tcp_detach(pcb);
+    s_conn = NULL;
+    if (tcp_close(pcb) != ERR_OK) {
+      tcp_abort(pcb);
+      return ERR_ABRT;
+    }
+    return ERR_OK;
+  }
+
+  if (s_st.mode == APP_IPERF_TCP_SERVER && s_st.running) {
+    s_st.bytes   += p->tot_len;
+    s_st.packets += pbuf_clen(p);
+    s_last_ms     = sys_now();
+  }
+
+  tcp_recved(pcb, p->tot_len);
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static err_t on_tcp_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+  (void)arg;
+
+  if (err != ERR_OK || !newpcb) return ERR_VAL;
+
+  if (s_conn) {
+    tcp_abort(newpcb);                  /* one client at a time */
+    return ERR_ABRT;
+  }
+
+  s_conn = newpcb;
+  tcp_recv(newpcb, on_tcp_recv);
+  tcp_err(newpcb, on_tcp_err);
+  run_begin();
+  return ERR_OK;
+}
+
+/**
+ * @brief Queue pattern segments while the send buffer has room.
+ */
+static void tcp_client_fill(void)
+{
+  if (!s_conn || !s_st.running) return;
+
+  while (tcp_sndbuf(s_conn) != 0U && tcp_sndqueuelen(s_conn) < TCP_SND_QUEUELEN) {
+    u16_t n = tcp_sndbuf(s_conn);
+    if (n > tcp_mss(s_conn)) n = tcp_mss(s_conn);
+    if (n > sizeof(s_pattern)) n = (u16_t)sizeof(s_pattern);
+
+    /* No copy: the pattern never changes */
+    if (tcp_write(s_conn, s_pattern, n, TCP_WRITE_FLAG_MORE) != ERR_OK)
+      break;
+    s_st.packets++;
+  }
+
+  (void)tcp_output(s_conn);
+}
+
+static err_t on_tcp_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+  (void)arg;
+  (void)pcb;
+
+  if (s_st.running) {
+    s_st.bytes += len;
+    s_last_ms   = sys_now();
+    tcp_client_fill();
+  }
+  return ERR_OK;
+}
+
+/* Slow timer: RTO retransmissions show up as pcb->nrtx increments */
+static err_t on_tcp_poll(void *arg, struct tcp_pcb *pcb)
+{
+  (void)arg;
+
+  if (pcb->nrtx > s_nrtx)
+    s_rto += (uint32_t)(pcb->nrtx - s_nrtx);
+  s_nrtx = pcb->nrtx;
+  return ERR_OK;
+}
+
+static err_t on_tcp_connected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  (void)arg;
+
+  if (err != ERR_OK) return err;
+
+  uint8_t hdr[IPERF_CLIENT_HDR_LEN];
+  memset(hdr, 0, sizeof(hdr));
+  put_be32(hdr + 4,  1U);                                  /* threads    */
+  put_be32(hdr + 8,  s_peer_port);
+  put_be32(hdr + 12, s_len);
+  put_be32(hdr + 20, (uint32_t)-(int32_t)(s_duration_ms / 10U)); /* time */
+
+  run_begin();
+  s_deadline_ms = s_start_ms + s_duration_ms;
+
+  if (tcp_write(pcb, hdr, sizeof(hdr), TCP_WRITE_FLAG_COPY) != ERR_OK) {
+    s_st.errors++;
+    return ERR_OK;
+  }
+
+  tcp_client_fill();
+  return ERR_OK;
+}
+
+/* =============================================================================
+ * API
+ * ============================================================================= */
+void APP_IPERF_Init(void)
+{
+  for (uint16_t i = 0; i < sizeof(s_pattern); i++)
+    s_pattern[i] = (uint8_t)('0' + (i % 10U));
+
+  memset(&s_st, 0, sizeof(s_st));
+  s_st.mode = APP_IPERF_IDLE;
+}
+
+/**
+ * @brief Stop any test and release its pcbs (counters are kept).
+ */
+void APP_IPERF_Stop(void)
+{
+  if (s_st.running) {
+    if (s_st.mode == APP_IPERF_TCP_CLIENT || s_st.mode == APP_IPERF_UDP_CLIENT)
+      s_last_ms = sys_now();
+    run_end();
+  }
+
+  tcp_close_conn();
+  if (s_listen) {
+    tcp_close(s_listen);
+    s_listen = NULL;
+  }
+  udp_close_pcb();
+
+  s_fin_tries = 0;
+  s_st.mode   = APP_IPERF_IDLE;
+}
+
+bool APP_IPERF_StartServer(bool udp)
+{
+  APP_IPERF_Stop();
+  memset(&s_st, 0, sizeof(s_st));
+
+  if (udp) {
+    if (!udp_open(APP_IPERF_PORT)) return false;
+    ip_addr_set_zero(&s_src);
+    s_src_port = 0;
+    s_st.mode  = APP_IPERF_UDP_SERVER;
+    return true;
+  }
+
+  struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+  if (!pcb) return false;
+
+  if (tcp_bind(pcb, IP_ANY_TYPE, APP_IPERF_PORT) != ERR_OK) {
+    tcp_abort(pcb);
+    return false;
+  }
+
+  s_listen = tcp_listen(pcb);
+  if (!s_listen) {
+    tcp_abort(pcb);
+    return false;
+  }
+
+  tcp_accept(s_listen, on_tcp_accept);
+  s_st.mode = APP_IPERF_TCP_SERVER;
+  return true;
+}
+
+bool APP_IPERF_StartClient(bool udp, const char *ip_str, uint16_t port,
+                           uint32_t duration_ms, uint32_t kbps, uint16_t len)
+{
+  ip_addr_t ip;
+
+  if (!ip_str || ipaddr_aton(ip_str, &ip) == 0) return false;
+
+  APP_IPERF_Stop();
+  memset(&s_st, 0, sizeof(s_st));
+
+  if (duration_ms == 0U) duration_ms = APP_IPERF_DEFAULT_MS;
+  if (duration_ms > APP_IPERF_MAX_MS) duration_ms = APP_IPERF_MAX_MS;
+  if (len == 0U) len = APP_IPERF_DEFAULT_LEN;
+  if (len > APP_IPERF_LEN_MAX) len = APP_IPERF_LEN_MAX;
+  if (len < IPERF_UDP_MIN_LEN) len = IPERF_UDP_MIN_LEN;
+
+  s_peer        = ip;
+  s_peer_port   = (port != 0U) ? port : APP_IPERF_PORT;
+  s_duration_ms = duration_ms;
+  s_kbps        = kbps;
+  s_len         = len;
+
+  if (udp) {
+    if (!udp_open(0)) return false;
+    s_st.mode = APP_IPERF_UDP_CLIENT;
+    s_udp_id  = 0;
+    run_begin();
+    return true;
+  }
+
+  s_conn = tcp_new_ip_type(IPADDR_TYPE_V4);
+  if (!s_conn) return false;
+
+  tcp_err(s_conn, on_tcp_err);
+  tcp_recv(s_conn, on_tcp_recv);
+  tcp_sent(s_conn, on_tcp_sent);
+  tcp_poll(s_conn, on_tcp_poll, 1);
+
+  if (tcp_connect(s_conn, &s_peer, s_peer_port, on_tcp_connected) != ERR_OK) {
+    tcp_close_conn();
+    return false;
+  }
+
+  s_st.mode = APP_IPERF_TCP_CLIENT;
+  return true;
+}
+
+/**
+ * @brief Main-loop part: pacing and end of client runs.
+ */
+void APP_IPERF_Service(uint32_t now_ms)
+{
+  switch (s_st.mode) {
+    case APP_IPERF_UDP_CLIENT:
+      udp_client_service(now_ms);
+      break;
+
+    case APP_IPERF_TCP_CLIENT:
+      if (s_st.running && (int32_t)(now_ms - s_deadline_ms) >= 0) {
+        run_end();
+        tcp_close_conn();
+      } else {
+        tcp_client_fill();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+uint32_t APP_IPERF_SleepTime(uint32_t now_ms)
+{
+  int32_t left;
+
+  switch (s_st.mode) {
+    case APP_IPERF_UDP_CLIENT:
+      if (s_st.running)
+        return (s_kbps == 0U) ? 0U : 1U;      /* pacing granularity */
+      if (s_fin_tries == 0U)
+        return UINT32_MAX;
+      left = (int32_t)(s_fin_next_ms - now_ms);
+      return (left > 0) ? (uint32_t)left : 0U;
+
+    case APP_IPERF_TCP_CLIENT:
+      /* Refilled from the sent callback; only the end is timed here */
+      if (!s_st.running)
+        return UINT32_MAX;
+      left = (int32_t)(s_deadline_ms - now_ms);
+      return (left > 0) ? (uint32_t)left : 0U;
+
+    default:
+      return UINT32_MAX;
+  }
+}
+
+void APP_IPERF_GetStats(AppIperfStats *out)
+{
+  if (!out) return;
+
+  *out = s_st;
+
+  /* Live while running, frozen at the end of the run */
+  if (s_st.running) {
+    out->elapsed_ms = s_last_ms - s_start_ms;
+    run_deltas(out);
+  }
+
+  if (out->elapsed_ms != 0U) {
+    out->kbps = (uint32_t)(out->bytes * 8U / out->elapsed_ms);
+    out->pps  = (uint32_t)((uint64_t)out->packets * 1000U / out->elapsed_ms);
+  }
+}
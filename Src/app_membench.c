@@ -0,0 +1,294 @@
+/**
+ * @file    app_membench.c
+ * @brief   lwIP heap benchmark: allocation latency and fragmentation under
+ *          the firmware's own traffic profile.
+ *
+ * This module provides:
+ *  - A replay of the mem_malloc() sizes and lifetimes this firmware produces
+ *    (ACK and segment headers, ARP, iperf headers, command responses, MQTT
+ *    bursts, full-MSS copied segments), driven by a fixed-seed PRNG so every
+ *    build sees the same sequence
+ *  - Per-call cycle counts (min / avg / max) of mem_malloc() and mem_free()
+ *  - Fragmentation: allocations that failed although enough bytes were
+ *    free, and the largest block still available at the end of the run
+ *
+ * Design notes:
+ *  - Runs against the real lwIP heap of the build: the first-fit MEM_SIZE
+ *    heap, or the MEM_USE_POOLS pools (CMake LWIP_MEM_POOLS=ON). Build both
+ *    and compare the two reports
+ *  - Blocking, main loop only; lwIP does not run meanwhile, and the blocks
+ *    held at once are capped so a run cannot starve the stack afterwards
+ *  - Failure and peak counters the run adds to the lwIP stats are restored,
+ *    so "netstat" keeps describing real traffic
+ *  - Cycle counts include interrupts taken during the call (max)
+ */
+
+#include "app_membench.h"
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/priv/memp_priv.h"   /* MEMP_POOL_FIRST/LAST, memp_malloc_helper */
+
+#include "app_platform.h"  /* App_CycleCounterInit(), App_GetCycles() */
+
+/* =============================================================================
+ * Traffic profile
+ * ============================================================================= */
+
+/*
+ * mem_malloc() sizes as pbuf_alloc(PBUF_RAM) requests them: aligned struct
+ * pbuf and header room, then the payload. Lifetimes are in operations (one
+ * allocation attempt each): headers are freed once the frame is sent,
+ * copied TCP data stays until it is ACKed.
+ */
+typedef struct
+{
+  uint16_t size;
+  uint8_t  weight;          /* percent of allocations */
+  uint8_t  life_min;
+  uint8_t  life_max;
+} profile_t;
+
+static const profile_t s_profile[] = {
+  {   72U, 40U,  1U,  4U },  /* TCP ACK / no-copy segment header      */
+  {   60U, 10U,  1U,  2U },  /* ARP request / reply                   */
+  {   96U, 15U,  1U,  2U },  /* iperf UDP header                      */
+  {  136U, 10U,  4U, 16U },  /* gateway response, DNS query           */
+  {  300U, 15U,  8U, 32U },  /* MQTT burst (copied)                   */
+  { 1532U, 10U,  8U, 32U },  /* full-MSS copied segment               */
+};
+
+#define PROFILE_COUNT  (sizeof(s_profile) / sizeof(s_profile[0]))
+#define BENCH_SEED     0x2545F491UL
+
+typedef struct
+{
+  void    *p;
+  uint16_t size;
+  uint32_t expires;         /* op index at which the block is freed */
+} slot_t;
+
+static slot_t   s_slot[APP_MEMBENCH_SLOTS];
+static uint32_t s_rng;
+
+static uint32_t rng_next(void)
+{
+  /* xorshift32 */
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return s_rng;
+}
+
+static const profile_t *profile_pick(void)
+{
+  uint32_t r = rng_next() % 100U;
+
+  for (uint32_t i = 0; i < PROFILE_COUNT; i++) {
+    if (r < s_profile[i].weight) return &s_profile[i];
+    r -= s_profile[i].weight;
+  }
+  return &s_profile[0];
+}
+
+/* =============================================================================
+ * Heap state
+ * ============================================================================= */
+
+/**
+ * @brief Bytes mem_malloc() could still hand out if there were no
+ *        fragmentation (heap) or size classes (pools).
+ */
+static uint32_t heap_free_bytes(void)
+{
+  uint32_t n = 0;
+
+#if MEM_USE_POOLS && MEMP_STATS
+  const uint32_t helper = LWIP_MEM_ALIGN_SIZE(sizeof(struct memp_malloc_helper));
+
+  for (uint32_t i = (uint32_t)MEMP_POOL_FIRST; i <= (uint32_t)MEMP_POOL_LAST; i++) {
+    const struct memp_desc *d = memp_pools[i];
+    n += (uint32_t)(d->num - d->stats->used) * (uint32_t)(d->size - helper);
+  }
+#elif MEM_STATS
+  n = (uint32_t)(lwip_stats.mem.avail - lwip_stats.mem.used);
+#endif
+
+  return n;
+}
+
+/**
+ * @brief Largest block available now (binary search with real allocations).
+ */
+static uint32_t heap_largest(void)
+{
+  uint32_t lo = 0;
+#if MEM_USE_POOLS
+  /* larger requests trip an assertion in mem_malloc() */
+  uint32_t hi = (uint32_t)memp_pools[MEMP_POOL_LAST]->size
+              - LWIP_MEM_ALIGN_SIZE(sizeof(struct memp_malloc_helper));
+#else
+  uint32_t hi = MEM_SIZE;
+#endif
+
+  while (lo < hi) {
+    uint32_t mid = (lo + hi + 1U) / 2U;
+    void *p = mem_malloc((mem_size_t)mid);
+    if (p) {
+      mem_free(p);
+      lo = mid;
+    } else {
+      hi = mid - 1U;
+    }
+  }
+  return lo;
+}
+
+/* Failure / peak counters of the heap (or malloc pools), restored after a run */
+typedef struct
+{
+#if MEM_USE_POOLS && MEMP_STATS
+  STAT_COUNTER err[MEMP_POOL_LAST - MEMP_POOL_FIRST + 1];
+  mem_size_t   max[MEMP_POOL_LAST - MEMP_POOL_FIRST + 1];
+#elif MEM_STATS
+  STAT_COUNTER err;
+  mem_size_t   max;
+#else
+  uint8_t      unused;
+#endif
+} heap_stats_t;
+
+static void heap_stats_save(heap_stats_t *s)
+{
+#if MEM_USE_POOLS && MEMP_STATS
+  for (uint32_t i = (uint32_t)MEMP_POOL_FIRST; i <= (uint32_t)MEMP_POOL_LAST; i++) {
+    s->err[i - (uint32_t)MEMP_POOL_FIRST] = memp_pools[i]->stats->err;
+    s->max[i - (uint32_t)MEMP_POOL_FIRST] = memp_pools[i]->stats->max;
+  }
+#elif MEM_STATS
+  s->err = lwip_stats.mem.err;
+  s->max = lwip_stats.mem.max;
+#else
+  (void)s;
+#endif
+}
+
+static void heap_stats_restore(const heap_stats_t *s)
+{
+#if MEM_USE_POOLS && MEMP_STATS
+  for (uint32_t i = (uint32_t)MEMP_POOL_FIRST; i <= (uint32_t)MEMP_POOL_LAST; i++) {
+    memp_pools[i]->stats->err = s->err[i - (uint32_t)MEMP_POOL_FIRST];
+    memp_pools[i]->stats->max = s->max[i - (uint32_t)MEMP_POOL_FIRST];
+  }
+#elif MEM_STATS
+  lwip_stats.mem.err = s->err;
+  lwip_stats.mem.max = s->max;
+#else
+  (void)s;
+#endif
+}
+
+/* =============================================================================
+ * Benchmark
+ * ============================================================================= */
+
+static void timed_free(slot_t *s, uint32_t *live, AppMemBench *out)
+{
+  uint32_t c0 = App_GetCycles();
+  mem_free(s->p);
+  uint32_t c = App_GetCycles() - c0;
+
+  if (c < out->free_min) out->free_min = c;
+  if (c > out->free_max) out->free_max = c;
+  out->free_total += c;
+  out->frees++;
+
+  *live -= s->size;
+  s->p = NULL;
+}
+
+/**
+ * @brief Replay the traffic profile for ops allocation attempts.
+ *
+ * Each operation first frees the blocks whose lifetime ended, then
+ * allocates one block of a size drawn from the profile.
+ */
+void APP_MEMBENCH_Run(uint32_t ops, AppMemBench *out)
+{
+  heap_stats_t saved;
+  uint32_t live = 0;
+
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+  memset(s_slot, 0, sizeof(s_slot));
+
+  out->pools     = (MEM_USE_POOLS != 0);
+  out->alloc_min = UINT32_MAX;
+  out->free_min  = UINT32_MAX;
+
+  s_rng = BENCH_SEED;
+  App_CycleCounterInit();
+  heap_stats_save(&saved);
+
+  for (uint32_t op = 0; op < ops; op++) {
+    slot_t *empty = NULL;
+
+    for (uint32_t i = 0; i < APP_MEMBENCH_SLOTS; i++) {
+      slot_t *s = &s_slot[i];
+      if (s->p && (int32_t)(op - s->expires) >= 0)
+        timed_free(s, &live, out);
+      if (!s->p && !empty)
+        empty = s;
+    }
+
+    const profile_t *pr = profile_pick();
+    uint32_t life = pr->life_min + rng_next() % (uint32_t)(pr->life_max - pr->life_min + 1U);
+
+    out->ops++;
+    if (!empty || live + pr->size > APP_MEMBENCH_LIVE_MAX) {
+      out->skipped++;
+      continue;
+    }
+
+    uint32_t c0 = App_GetCycles();
+    void *p = mem_malloc((mem_size_t)pr->size);
+    uint32_t c = App_GetCycles() - c0;
+
+    if (c < out->alloc_min) out->alloc_min = c;
+    if (c > out->alloc_max) out->alloc_max = c;
+    out->alloc_total += c;
+
+    if (!p) {
+      out->fails++;
+      if (heap_free_bytes() >= pr->size)
+        out->frag_fails++;
+      continue;
+    }
+
+    out->allocs++;
+    empty->p       = p;
+    empty->size    = pr->size;
+    empty->expires = op + life;
+
+    live += pr->size;
+    if (live > out->live_peak) out->live_peak = live;
+  }
+
+  /* Heap shape with the last blocks still held */
+  out->free_bytes = heap_free_bytes();
+  out->largest    = heap_largest();
+
+  for (uint32_t i = 0; i < APP_MEMBENCH_SLOTS; i++) {
+    if (s_slot[i].p)
+      timed_free(&s_slot[i], &live, out);
+  }
+
+  heap_stats_restore(&saved);
+
+  if (out->alloc_min == UINT32_MAX) out->alloc_min = 0;
+  if (out->free_min == UINT32_MAX)  out->free_min = 0;
+}
@@ -3,19 +3,53 @@
  * @brief   Lightweight UDP/TCP telemetry transport using lwIP (NO_SYS mode).
  *
  * This module provides:
- *  - UDP fire-and-forget telemetry sender
- *  - TCP client with automatic reconnect and single-message TX buffering
- *  - Periodic lwIP polling (CubeMX NO_SYS integration)
- *  - Small UI/debug helpers exposing last sent payload snippets
+ *  - Batched UDP telemetry: samples taken at a configurable rate (10..1000 Hz)
+ *    are packed back to back into one datagram, flushed when the next sample
+ *    might no longer fit the netif MTU or when the oldest sample reaches the
+ *    max latency deadline; samples are encoded in place into a pbuf from a
+ *    dedicated memp pool (TLM_POOL), no heap allocation and no copy
+ *  - Optional event-driven CAN push: raw frames captured by the CAN RX ISR are
+ *    forwarded over UDP from the next main-loop pass (coalesced under bursts)
+ *  - Store-and-forward backlog (app_backlog.c): samples taken while the TCP
+ *    link is down are kept as binary frames and replayed after reconnect,
+ *    interleaved with live data; optional gateway ACK
+ *  - Inbound command channel on the TCP link (app_cmd.c): the gateway sets
+ *    rates and encoding, opens high-rate capture windows and reads counters
+ *    with framed requests; responses are interleaved with telemetry
+ *  - TCP client with automatic reconnect and a zero-copy multi-frame TX queue
+ *    (app_txq.c): frames are written with tcp_write() without copy and the
+ *    ring memory is released by ACKed byte count in on_tcp_sent(), once the
+ *    ETH TX DMA no longer holds a frame that may reference it
+ *  - Optional MQTT publisher (lwIP apps/mqtt): per-sensor topics, QoS0
+ *    bursts written as one TCP segment, non-blocking reconnect with backoff
+ *  - Runtime-selectable wire encoding (JSON line or binary frame, app_frame.c;
+ *    delta-compressed UDP blocks, app_tsc.c)
+ *  - Interrupt-notified RX: the ETH IRQ flags received frames, the next
+ *    main-loop pass drains them
+ *  - Deadline-driven pump: RX/TX completion, lwIP timers and link polling
+ *    run only when due (MX_LWIP_Pump()); APP_NET_SleepTime() tells the main
+ *    loop whether it may sleep
+ *  - Serialize-once sample pipeline (app_fbuf.c): every sample lives in a
+ *    shared, reference-counted buffer; its JSON / binary frames are encoded
+ *    at most once and copied into the UDP batch, TCP queue and backlog, and
+ *    read back by the USB CLI and the UI
+ *  - iperf2-compatible throughput test (app_iperf.c), serviced from here
+ *  - Optional network statistics channel: a JSON snapshot of pool usage,
+ *    protocol counters and drops (app_netstat.c) as its own datagram
+ *  - Optional CAN statistics channel: bus load, errors and per-ID rates
+ *    (can_stats.c), sent the same way
  *
  * Design goals:
  *  - Simple, robust networking without an RTOS
  *  - Non-blocking main-loop driven operation
- *  - Safe interaction with lwIP callbacks (minimal state, no dynamic queues)
+ *  - Safe interaction with lwIP callbacks (minimal state, static queues only)
  *
  * Assumptions:
  *  - lwIP is configured in NO_SYS mode (CubeMX default)
- *  - ethernetif_input() is used (polling, not IRQ-driven)
+ *  - ethernetif_input() runs in the main loop only; the ETH IRQ just sets
+ *    ethernetif_pending() and wakes the idle __WFI()
+ *  - TX is asynchronous: pbufs passed to lwIP stay referenced until the DMA
+ *    has sent them (TLM_POOL buffers included)
  *  - gnetif is provided by CubeMX lwIP glue code
  */
 
@@ -29,24 +63,29 @@
 #include "lwip/tcp.h"
 #include "lwip/ip_addr.h"
 #include "lwip/netif.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/apps/mqtt.h"
 #include "ethernetif.h"
-#include "lwip.h"          /* MX_LWIP_Process() */
-
+#include "lwip.h"          /* MX_LWIP_Pump(), MX_LWIP_SleepTime() */
+
+#include "app_txq.h"
+#include "app_backlog.h"
+#include "app_tsc.h"
+#include "app_cmd.h"
+#include "app_fbuf.h"
+#include "app_iperf.h"
+#include "app_netstat.h"
+#include "can_stats.h"
 #include "app_helpers.h"   /* App_I2C_GetTempInt(), etc. */
+#include "app_platform.h"  /* App_GetMicros() */
 #include "can.h"           /* CAN1_GetText_0x101(), CAN1_GetText_0x120() */
 
 /* gnetif is created by CubeMX lwIP glue code */
 extern struct netif gnetif;
 
-/* =============================================================================
- * Last payload snippets (for UI / debug)
- * ============================================================================= */
-static char g_udp_last[64] = "-";
-static char g_tcp_last[64] = "-";
-
-const char* APP_NET_GetLastUDP(void) { return g_udp_last; }
-const char* APP_NET_GetLastTCP(void) { return g_tcp_last; }
-
 /* =============================================================================
  * Internal network state
  * ============================================================================= */
@@ -57,6 +96,70 @@ static uint16_t  g_tcp_port = APP_TCP_PORT;
 /* UDP control block */
 static struct udp_pcb *g_udp = NULL;
 
+/* Wire encoding for both UDP and TCP + sample sequence counter */
+static AppFrameEncoding g_encoding = APP_FRAME_ENC_JSON;
+static uint32_t         g_tlm_seq  = 0;
+
+/* Sampling schedule (microsecond time base, see App_GetMicros) */
+static uint32_t g_sample_hz      = APP_NET_SAMPLE_HZ_DEFAULT;
+static uint64_t g_next_sample_us = 0;
+
+/* High-rate capture window (APP_NET_StartCapture): rate restored afterwards */
+static bool     g_capture_active  = false;
+static uint32_t g_capture_end_ms  = 0;
+static uint32_t g_capture_prev_hz = APP_NET_SAMPLE_HZ_DEFAULT;
+
+/* Telemetry TX pbufs: header room for all layers + one full UDP batch.
+   Payload follows the pbuf struct so lwIP prepends headers in place. */
+typedef struct
+{
+  struct pbuf_custom pbuf_custom;
+  uint8_t buff[LWIP_MEM_ALIGN_SIZE(PBUF_TRANSPORT) + APP_NET_UDP_BATCH_MAX];
+} TlmBuff_t;
+
+/* Read by the ETH TX DMA in place: non-cacheable RAM_NC */
+extern u8_t memp_memory_TLM_POOL_base[] APP_DMA_BUFFER;
+LWIP_MEMPOOL_DECLARE(TLM_POOL, APP_NET_TLM_PBUF_CNT, sizeof(TlmBuff_t), "Zero-copy telemetry TX pool");
+
+/* UDP batch: encoded samples back to back in one pool pbuf per datagram */
+static struct pbuf *g_udp_batch     = NULL;
+static uint16_t g_udp_batch_cap     = 0;
+static uint16_t g_udp_batch_len     = 0;
+static AppFrameEncoding g_udp_batch_enc = APP_FRAME_ENC_JSON;
+static AppTscEncoder    g_udp_tsc;     /* ENC_DELTA: block encoder state */
+static uint16_t g_udp_batch_samples = 0;
+static uint32_t g_udp_batch_t0_ms   = 0;      /* first sample in batch */
+static uint32_t g_udp_max_latency_ms = APP_NET_UDP_LATENCY_DEFAULT_MS;
+
+/* Event-driven CAN push (opt-in) */
+static bool     g_can_push          = false;
+static uint32_t g_can_evt_seq       = 0;
+static uint32_t g_can_push_frames   = 0;
+static uint32_t g_can_push_coalesced = 0;
+static uint32_t g_can_push_dgrams   = 0;
+static uint32_t g_can_push_errors   = 0;
+
+/* UDP counters (see APP_NET_GetUdpStats) */
+static uint32_t g_udp_datagrams   = 0;
+static uint32_t g_udp_samples     = 0;
+static uint32_t g_udp_flush_full  = 0;
+static uint32_t g_udp_flush_timer = 0;
+static uint32_t g_udp_errors      = 0;
+static uint32_t g_udp_no_pbuf     = 0;
+static uint32_t g_udp_dropped     = 0;
+
+/* Network statistics channel (app_netstat.c), 0 = off */
+static uint32_t g_netstat_period_ms = 0;
+static uint32_t g_netstat_next_ms   = 0;
+static uint32_t g_netstat_sent      = 0;
+static uint32_t g_netstat_errors    = 0;
+
+/* CAN statistics channel (can_stats.c), 0 = off */
+static uint32_t g_canstats_period_ms = 0;
+static uint32_t g_canstats_next_ms   = 0;
+static uint32_t g_canstats_sent      = 0;
+static uint32_t g_canstats_errors    = 0;
+
 /* =============================================================================
  * TCP client state
  * ============================================================================= */
@@ -72,9 +175,77 @@ static tcp_state_t     g_tcp_state = TCP_DOWN;
 /* next allowed reconnect attempt (ms) */
 static uint32_t g_next_tcp_reconnect_ms = 0;
 
-/* Single-message TX buffer (one in-flight packet at a time) */
-static char     g_tcp_txbuf[256];
-static uint16_t g_tcp_txlen = 0;
+/* Multi-frame TX queue: frames stay pinned in the ring until ACKed */
+static uint8_t    g_tcp_txbuf[APP_NET_TCP_TXQ_BYTES] APP_DMA_BUFFER;   /* PBUF_ROM source */
+static AppTxqDesc g_tcp_txdesc[APP_NET_TCP_TXQ_FRAMES];
+static AppTxQueue g_tcp_txq;
+
+/* Ring release deferred until the ETH DMA has let go of every frame queued
+   before the ACK / abort (a retransmission may still sit in the TX ring) */
+static uint32_t g_tcp_txq_acked    = 0;      /* ACKed bytes not yet released */
+static bool     g_tcp_txq_reset    = false;  /* reset requested              */
+static uint32_t g_tcp_txq_eth_mark = 0;      /* ethernetif_tx_mark() then    */
+
+/* Store-and-forward backlog: frames (they carry seq + ts) kept while the
+   link is down or the TX queue is full, replayed after reconnect. JSON
+   lines on a JSON stream, self-contained binary frames otherwise */
+static uint8_t        g_backlog_buf[APP_NET_BACKLOG_BYTES];
+static AppBacklogDesc g_backlog_desc[APP_NET_BACKLOG_FRAMES];
+static AppBacklog     g_backlog;
+
+/* Gateway ACK (APP_CMD_OP_ACK): once seen on a connection, frames are kept
+   until acknowledged; every new connection starts without */
+static bool     g_gw_ack_mode  = false;
+static uint32_t g_gw_acked_seq = 0;
+
+/* Inbound command channel (app_cmd.c), responses go through the TX queue */
+static AppCmdParser g_cmd;
+static uint32_t     g_cmd_rsp_dropped = 0;
+
+/* TCP carries every Nth sample (APP_CMD_CH_TCP_DIVIDER) */
+static uint32_t g_tcp_divider = 1;
+static uint32_t g_tcp_div_cnt = 0;
+
+/* Backlog counters (see APP_NET_GetBacklogStats) */
+static uint32_t g_backlog_stored    = 0;
+static uint32_t g_backlog_evicted   = 0;
+static uint32_t g_backlog_replayed  = 0;
+static uint32_t g_backlog_discarded = 0;
+
+/* Frame counters (see APP_NET_GetTcpStats) */
+static uint32_t g_tcp_frames_queued  = 0;
+static uint32_t g_tcp_frames_acked   = 0;
+static uint32_t g_tcp_frames_dropped = 0;
+
+/* =============================================================================
+ * MQTT publisher state
+ * ============================================================================= */
+typedef enum {
+  MQTT_DOWN = 0,
+  MQTT_CONNECTING,
+  MQTT_UP
+} mqtt_state_t;
+
+static mqtt_client_t *g_mqtt = NULL;      /* lwIP apps/mqtt client (allocated once) */
+static mqtt_state_t  g_mqtt_state = MQTT_DOWN;
+static bool          g_mqtt_enabled = (APP_NET_MQTT_DEFAULT_ON != 0);
+
+static ip_addr_t g_mqtt_broker_ip;
+static uint16_t  g_mqtt_port = APP_MQTT_PORT;
+
+static uint32_t g_mqtt_interval_ms     = APP_NET_MQTT_INTERVAL_DEFAULT_MS;
+static uint32_t g_mqtt_next_pub_ms     = 0;
+static uint32_t g_mqtt_next_connect_ms = 0;
+static uint32_t g_mqtt_connect_t0_ms   = 0;
+static uint32_t g_mqtt_backoff_ms      = APP_NET_MQTT_BACKOFF_MIN_MS;
+
+/* Counters (see APP_NET_GetMqttStats) */
+static uint32_t g_mqtt_connects    = 0;
+static uint32_t g_mqtt_disconnects = 0;
+static uint32_t g_mqtt_bursts      = 0;
+static uint32_t g_mqtt_publishes   = 0;
+static uint32_t g_mqtt_dropped     = 0;
+static uint32_t g_mqtt_errors      = 0;
 
 /* =============================================================================
  * Helpers
@@ -103,66 +274,545 @@ static void udp_init_once(void)
 }
 
 /**
- * @brief Send telemetry via UDP (fire-and-forget).
+ * @brief Usable datagram payload: netif MTU minus IPv4 and UDP headers,
+ *        capped to the pool buffer.
+ */
+static uint16_t udp_batch_limit(void)
+{
+  uint16_t lim = APP_NET_UDP_BATCH_MAX;
+
+  if (gnetif.mtu > (IP_HLEN + UDP_HLEN)) {
+    uint16_t mtu_payload = (uint16_t)(gnetif.mtu - IP_HLEN - UDP_HLEN);
+    if (mtu_payload < lim) lim = mtu_payload;
+  }
+
+  return lim;
+}
+
+/**
+ * @brief Custom free: return the telemetry buffer to TLM_POOL.
+ *
+ * Called by pbuf_free() once the last reference is dropped (after
+ * udp_sendto() returns and the ETH DMA has sent the frame, or later if it
+ * was queued for ARP).
+ */
+static void tlm_pbuf_free(struct pbuf *p)
+{
+  struct pbuf_custom *custom_pbuf = (struct pbuf_custom *)p;
+  LWIP_MEMPOOL_FREE(TLM_POOL, custom_pbuf);
+}
+
+/**
+ * @brief Take one buffer from TLM_POOL as a PBUF_TRANSPORT pbuf of 'len'.
+ *
+ * PBUF_RAM type (payload contiguous with the struct) lets udp/ip/etharp add
+ * their headers in front of the payload without another allocation.
+ */
+static struct pbuf *tlm_pbuf_alloc(uint16_t len)
+{
+  TlmBuff_t *b = (TlmBuff_t *)LWIP_MEMPOOL_ALLOC(TLM_POOL);
+  if (!b) return NULL;
+
+  b->pbuf_custom.custom_free_function = tlm_pbuf_free;
+  return pbuf_alloced_custom(PBUF_TRANSPORT, len, PBUF_RAM, &b->pbuf_custom,
+                             b->buff, (u16_t)sizeof(b->buff));
+}
+
+/**
+ * @brief Send the pending batch as one datagram (fire-and-forget).
  *
- * Payload format (JSON-like):
- *  {
- *    "ts": <ms>,
- *    "i2c": <temp>,
- *    "can101": "<text>",
- *    "can120": "<text>"
- *  }
+ * The samples were encoded in place, so sending only trims the pbuf to the
+ * used length. One pool buffer, one set of headers and one ETH transmit per
+ * batch; no heap allocation and no copy.
  */
-bool APP_NET_SendUDP(const AppTelemetry *t)
+bool APP_NET_FlushUDP(void)
 {
-  if (!t) return false;
+  struct pbuf *p = g_udp_batch;
+
+  if (!p) return true;
+
+  g_udp_batch         = NULL;
+  g_udp_batch_cap     = 0;
 
   if (!g_udp)
     udp_init_once();
+
+  bool ok = false;
+
+  if (g_udp_batch_enc == APP_FRAME_ENC_DELTA && g_udp_batch_samples != 0U)
+    g_udp_batch_len = APP_TSC_Finish(&g_udp_tsc);
+
+  if (g_udp && g_udp_batch_len != 0U) {
+    pbuf_realloc(p, (u16_t)g_udp_batch_len);
+    ok = (udp_sendto(g_udp, p, &g_remote_ip, g_udp_port) == ERR_OK);
+  }
+  pbuf_free(p);
+
+  if (ok) {
+    g_udp_datagrams++;
+    g_udp_samples += g_udp_batch_samples;
+  } else {
+    g_udp_errors++;
+    g_udp_dropped += g_udp_batch_samples;
+  }
+
+  g_udp_batch_len     = 0;
+  g_udp_batch_samples = 0;
+  return ok;
+}
+
+/**
+ * @brief Append one sample to the UDP batch.
+ *
+ * The first sample of a batch takes a pbuf from TLM_POOL sized for the MTU;
+ * every sample's shared frame (app_fbuf.c) in the current wire encoding is
+ * then copied into its payload. Both encodings are self-delimiting (newline / length field), so
+ * the receiver splits a datagram back into samples.
+ *
+ * In ENC_DELTA mode the whole datagram is one compressed block (app_tsc.c)
+ * instead of independent frames.
+ *
+ * Flush rules:
+ *  - encoding changed since the batch was started: flush first
+ *  - sample does not fit the remaining space: flush first, then append
+ *  - remaining space smaller than the sample just added: flush now, the next
+ *    one would most likely not fit either
+ *  - max latency deadline: checked by APP_NET_Service()
+ */
+bool APP_NET_SendUDP(AppFrameBuf *f)
+{
+  if (!f) return false;
+
+  const AppTelemetry *t = &f->t;
+  const uint8_t *frame  = NULL;
+  uint16_t flen = 0;
+  uint16_t n    = 0;
+
+  if (g_encoding != APP_FRAME_ENC_DELTA) {
+    frame = APP_FBUF_Frame(f, g_encoding, &flen);
+    if (!frame) {
+      g_udp_dropped++;
+      return false;
+    }
+  }
+
+  if (g_udp_batch && g_udp_batch_enc != g_encoding)
+    (void)APP_NET_FlushUDP();
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (!g_udp_batch) {
+      g_udp_batch_cap = udp_batch_limit();
+      g_udp_batch     = tlm_pbuf_alloc(g_udp_batch_cap);
+      if (!g_udp_batch) {
+        g_udp_no_pbuf++;
+        g_udp_dropped++;
+        return false;
+      }
+      g_udp_batch_enc = g_encoding;
+      if (g_udp_batch_enc == APP_FRAME_ENC_DELTA)
+        (void)APP_TSC_Begin(&g_udp_tsc, (uint8_t *)g_udp_batch->payload,
+                            g_udp_batch_cap, t);
+    }
+
+    if (g_udp_batch_enc == APP_FRAME_ENC_DELTA) {
+      n = APP_TSC_Append(&g_udp_tsc, t);
+    } else if ((uint16_t)(g_udp_batch_cap - g_udp_batch_len) >= flen) {
+      memcpy((uint8_t *)g_udp_batch->payload + g_udp_batch_len, frame, flen);
+      n = flen;
+    }
+    if (n != 0U || g_udp_batch_samples == 0U) break;
+
+    g_udp_flush_full++;
+    (void)APP_NET_FlushUDP();
+  }
+  if (n == 0U) {
+    g_udp_dropped++;
+    return false;
+  }
+
+  if (g_udp_batch_samples == 0U)
+    g_udp_batch_t0_ms = t->now_ms;
+
+  if (g_udp_batch_enc == APP_FRAME_ENC_DELTA)
+    g_udp_batch_len = g_udp_tsc.len;
+  else
+    g_udp_batch_len = (uint16_t)(g_udp_batch_len + n);
+  g_udp_batch_samples++;
+
+  uint16_t next_max = (g_udp_batch_enc == APP_FRAME_ENC_DELTA) ? APP_TSC_SAMPLE_MAX : n;
+  if ((uint16_t)(g_udp_batch_cap - g_udp_batch_len) < next_max) {
+    g_udp_flush_full++;
+    return APP_NET_FlushUDP();
+  }
+
+  return true;
+}
+
+/* =============================================================================
+ * Event-driven CAN push
+ * ============================================================================= */
+
+/**
+ * @brief Enable/disable forwarding of every received CAN frame.
+ */
+void APP_NET_SetCanPush(bool on)
+{
+  g_can_push = on;
+  CAN1_SetRawCapture(on ? 1u : 0u);
+}
+
+bool APP_NET_GetCanPush(void)
+{
+  return g_can_push;
+}
+
+/**
+ * @brief Forward captured CAN frames as one UDP event datagram.
+ *
+ * Runs on every main-loop pass (the RX interrupt wakes the CPU from WFI), so
+ * latency is one loop iteration instead of the sampling period.
+ *
+ * Coalescing: if more than APP_NET_CAN_COALESCE_MIN frames were pending, only
+ * the newest frame per CAN ID is sent (latest value wins); below that every
+ * frame goes out.
+ */
+static void can_push_service(void)
+{
+  AppCanEvent   ev[APP_NET_CAN_PUSH_BATCH];
+  CAN1_RawFrame f;
+  uint8_t n = 0;
+
+  if (!g_can_push) return;
+
+  while (n < APP_NET_CAN_PUSH_BATCH && CAN1_PopRaw(&f)) {
+    ev[n].ts_us = f.ts_us;
+    ev[n].id    = f.id;
+    ev[n].dlc   = f.dlc;
+    memcpy(ev[n].data, f.data, sizeof(ev[n].data));
+    n++;
+  }
+  if (n == 0U) return;
+
+  g_can_push_frames += n;
+
+  if (n > APP_NET_CAN_COALESCE_MIN) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < n; i++) {
+      bool newer = false;
+      for (uint8_t j = (uint8_t)(i + 1U); j < n; j++) {
+        if (ev[j].id == ev[i].id) { newer = true; break; }
+      }
+      if (newer) continue;
+      ev[kept++] = ev[i];
+    }
+    g_can_push_coalesced += (uint32_t)(n - kept);
+    n = kept;
+  }
+
+  if (!g_udp)
+    udp_init_once();
+
+  uint16_t cap = udp_batch_limit();
+  struct pbuf *p = g_udp ? tlm_pbuf_alloc(cap) : NULL;
+  if (!p) {
+    g_can_push_errors++;
+    return;
+  }
+
+  uint16_t len = APP_FRAME_EncodeCanEvents(ev, n, g_can_evt_seq++,
+                                           (uint8_t *)p->payload, cap);
+  bool ok = false;
+  if (len != 0U) {
+    pbuf_realloc(p, len);
+    ok = (udp_sendto(g_udp, p, &g_remote_ip, g_udp_port) == ERR_OK);
+  }
+  pbuf_free(p);
+
+  if (ok) g_can_push_dgrams++;
+  else    g_can_push_errors++;
+}
+
+/**
+ * @brief Snapshot of CAN push counters.
+ */
+void APP_NET_GetCanPushStats(AppNetCanPushStats *out)
+{
+  if (!out) return;
+
+  out->enabled   = g_can_push;
+  out->pending   = CAN1_RawPending();
+  out->frames    = g_can_push_frames;
+  out->coalesced = g_can_push_coalesced;
+  out->datagrams = g_can_push_dgrams;
+  out->errors    = g_can_push_errors;
+  out->overflow  = CAN1_GetRawOverflow();
+}
+
+/* =============================================================================
+ * Network statistics channel
+ * ============================================================================= */
+
+/**
+ * @brief Stats period; 0 turns the channel off, other values are clamped to
+ *        APP_NETSTAT_PERIOD_MIN_MS..APP_NETSTAT_PERIOD_MAX_MS.
+ */
+void APP_NET_SetNetstatPeriod(uint32_t ms)
+{
+  if (ms != 0U && ms < APP_NETSTAT_PERIOD_MIN_MS) ms = APP_NETSTAT_PERIOD_MIN_MS;
+  if (ms > APP_NETSTAT_PERIOD_MAX_MS) ms = APP_NETSTAT_PERIOD_MAX_MS;
+
+  g_netstat_period_ms = ms;
+  g_netstat_next_ms   = HAL_GetTick();
+}
+
+uint32_t APP_NET_GetNetstatPeriod(void)
+{
+  return g_netstat_period_ms;
+}
+
+void APP_NET_GetNetstatCounts(uint32_t *sent, uint32_t *errors)
+{
+  if (sent)   *sent   = g_netstat_sent;
+  if (errors) *errors = g_netstat_errors;
+}
+
+/**
+ * @brief Encode one stats snapshot into its own datagram and send it.
+ *
+ * A JSON line, so the gateway decoder prints it like any other record;
+ * the sample batch is not touched.
+ */
+static bool stats_send(uint16_t (*encode)(uint32_t, char *, uint16_t), uint32_t now_ms)
+{
   if (!g_udp)
+    udp_init_once();
+
+  uint16_t cap = udp_batch_limit();
+  struct pbuf *p = g_udp ? tlm_pbuf_alloc(cap) : NULL;
+  if (!p)
     return false;
 
-  char msg[256];
-  int n = snprintf(msg, sizeof(msg),
-                   "{\"ts\":%lu,\"i2c\":%ld,\"can101\":\"%s\",\"can120\":\"%s\"}\n",
-                   (unsigned long)t->now_ms,
-                   (long)t->i2c_temp_c,
-                   t->can_0x101,
-                   t->can_0x120);
-  if (n <= 0) return false;
-  if (n >= (int)sizeof(msg)) n = (int)sizeof(msg) - 1;
-
-  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)n, PBUF_RAM);
-  if (!p) return false;
-
-  memcpy(p->payload, msg, (size_t)n);
-  err_t err = udp_sendto(g_udp, p, &g_remote_ip, g_udp_port);
+  uint16_t len = encode(now_ms, (char *)p->payload, cap);
+  bool ok = false;
+  if (len != 0U) {
+    pbuf_realloc(p, len);
+    ok = (udp_sendto(g_udp, p, &g_remote_ip, g_udp_port) == ERR_OK);
+  }
   pbuf_free(p);
+  return ok;
+}
+
+/**
+ * @brief Send the network stats snapshot when due.
+ */
+static void netstat_service(uint32_t now_ms)
+{
+  if (g_netstat_period_ms == 0U ||
+      (int32_t)(now_ms - g_netstat_next_ms) < 0)
+    return;
+
+  g_netstat_next_ms = now_ms + g_netstat_period_ms;
+
+  if (stats_send(APP_NETSTAT_EncodeJSON, now_ms)) g_netstat_sent++;
+  else                                            g_netstat_errors++;
+}
+
+/* =============================================================================
+ * CAN statistics channel
+ * ============================================================================= */
+
+/**
+ * @brief CAN stats period; 0 turns the channel off, other values are clamped
+ *        to CAN_STATS_PERIOD_MIN_MS..CAN_STATS_PERIOD_MAX_MS.
+ */
+void APP_NET_SetCanStatsPeriod(uint32_t ms)
+{
+  if (ms != 0U && ms < CAN_STATS_PERIOD_MIN_MS) ms = CAN_STATS_PERIOD_MIN_MS;
+  if (ms > CAN_STATS_PERIOD_MAX_MS) ms = CAN_STATS_PERIOD_MAX_MS;
+
+  g_canstats_period_ms = ms;
+  g_canstats_next_ms   = HAL_GetTick();
+}
+
+uint32_t APP_NET_GetCanStatsPeriod(void)
+{
+  return g_canstats_period_ms;
+}
+
+void APP_NET_GetCanStatsCounts(uint32_t *sent, uint32_t *errors)
+{
+  if (sent)   *sent   = g_canstats_sent;
+  if (errors) *errors = g_canstats_errors;
+}
 
-  return (err == ERR_OK);
+/**
+ * @brief Send the CAN stats snapshot when due.
+ */
+static void canstats_service(uint32_t now_ms)
+{
+  if (g_canstats_period_ms == 0U ||
+      (int32_t)(now_ms - g_canstats_next_ms) < 0)
+    return;
+
+  g_canstats_next_ms = now_ms + g_canstats_period_ms;
+
+  if (stats_send(CAN_STATS_EncodeJSON, now_ms)) g_canstats_sent++;
+  else                                          g_canstats_errors++;
+}
+
+/* =============================================================================
+ * Sampling rate
+ * ============================================================================= */
+
+/**
+ * @brief Sampling rate for UDP/TCP telemetry, clamped to
+ *        APP_NET_SAMPLE_HZ_MIN..APP_NET_SAMPLE_HZ_MAX.
+ */
+static void sample_rate_apply(uint32_t hz)
+{
+  if (hz < APP_NET_SAMPLE_HZ_MIN) hz = APP_NET_SAMPLE_HZ_MIN;
+  if (hz > APP_NET_SAMPLE_HZ_MAX) hz = APP_NET_SAMPLE_HZ_MAX;
+
+  g_sample_hz      = hz;
+  g_next_sample_us = 0;   /* restart schedule */
+}
+
+void APP_NET_SetSampleRate(uint32_t hz)
+{
+  /* An explicit rate ends a running capture window */
+  g_capture_active = false;
+  sample_rate_apply(hz);
+}
+
+uint32_t APP_NET_GetSampleRate(void)
+{
+  return g_sample_hz;
+}
+
+/**
+ * @brief Sample at hz for duration_ms, then return to the previous rate.
+ *
+ * A capture started while another one runs extends it; the rate restored
+ * afterwards is the one from before the first capture.
+ */
+void APP_NET_StartCapture(uint32_t hz, uint32_t duration_ms, uint32_t now_ms)
+{
+  if (duration_ms > APP_NET_CAPTURE_MAX_MS) duration_ms = APP_NET_CAPTURE_MAX_MS;
+
+  if (!g_capture_active)
+    g_capture_prev_hz = g_sample_hz;
+
+  sample_rate_apply(hz);
+  g_capture_end_ms = now_ms + duration_ms;
+  g_capture_active = true;
+}
+
+bool APP_NET_CaptureActive(void)
+{
+  return g_capture_active;
+}
+
+/**
+ * @brief Max age of the oldest sample in a UDP batch before it is flushed.
+ */
+void APP_NET_SetUdpMaxLatency(uint32_t ms)
+{
+  if (ms < 1U)     ms = 1U;
+  if (ms > 10000U) ms = 10000U;
+  g_udp_max_latency_ms = ms;
+}
+
+uint32_t APP_NET_GetUdpMaxLatency(void)
+{
+  return g_udp_max_latency_ms;
+}
+
+/**
+ * @brief Snapshot of UDP batching counters.
+ */
+void APP_NET_GetUdpStats(AppNetUdpStats *out)
+{
+  if (!out) return;
+
+  out->pending_samples = g_udp_batch_samples;
+  out->pending_bytes   = g_udp_batch_len;
+  out->datagrams       = g_udp_datagrams;
+  out->samples         = g_udp_samples;
+  out->flush_full      = g_udp_flush_full;
+  out->flush_timer     = g_udp_flush_timer;
+  out->errors          = g_udp_errors;
+  out->no_pbuf         = g_udp_no_pbuf;
+  out->dropped         = g_udp_dropped;
 }
 
 /* =============================================================================
  * TCP helpers
  * ============================================================================= */
 
+/**
+ * @brief Apply a deferred ACK release / reset of the TX queue once the ETH
+ *        DMA has released the frames submitted before it.
+ */
+static void tcp_txq_settle(void)
+{
+  if ((g_tcp_txq_acked == 0U && !g_tcp_txq_reset) ||
+      !ethernetif_tx_released(g_tcp_txq_eth_mark))
+    return;
+
+  if (g_tcp_txq_acked != 0U) {
+    g_tcp_frames_acked += APP_TXQ_Ack(&g_tcp_txq, g_tcp_txq_acked);
+    g_tcp_txq_acked = 0;
+  }
+
+  if (g_tcp_txq_reset) {
+    g_tcp_frames_dropped += APP_TXQ_Reset(&g_tcp_txq);
+    g_tcp_txq_reset = false;
+  }
+}
+
+/**
+ * @brief Drop all queued/in-flight frames (lwIP must no longer reference
+ *        them); the ring itself is reset once the ETH DMA is done with it.
+ */
+static void tcp_txq_drop_all(void)
+{
+  g_tcp_txq_reset    = true;
+  g_tcp_txq_eth_mark = ethernetif_tx_mark();
+  tcp_txq_settle();
+}
+
 /**
  * @brief Gracefully close TCP connection and reset state.
+ *
+ * A graceful close keeps retransmitting unacked data from the queue memory,
+ * which is about to be reused. If anything is still in flight the connection
+ * is aborted instead.
+ *
+ * @return true if the PCB was aborted (callers inside lwIP callbacks must
+ *         then return ERR_ABRT).
  */
-static void app_tcp_close(void)
+static bool app_tcp_close(void)
 {
+  bool aborted = false;
+
   if (g_tcp) {
     tcp_arg(g_tcp, NULL);
     tcp_err(g_tcp, NULL);
     tcp_recv(g_tcp, NULL);
     tcp_sent(g_tcp, NULL);
     tcp_poll(g_tcp, NULL, 0);
-    tcp_close(g_tcp);
+
+    if (APP_TXQ_InFlight(&g_tcp_txq) != 0U || tcp_close(g_tcp) != ERR_OK) {
+      tcp_abort(g_tcp);
+      aborted = true;
+    }
     g_tcp = NULL;
   }
 
-  g_tcp_state = TCP_DOWN;
-  g_tcp_txlen = 0;
+  g_tcp_state   = TCP_DOWN;
+  g_gw_ack_mode = false;
+  tcp_txq_drop_all();
+  return aborted;
 }
 
 /**
@@ -175,17 +825,135 @@ static void tcp_force_abort(void)
     g_tcp = NULL;
   }
 
-  g_tcp_state = TCP_DOWN;
-  g_tcp_txlen = 0;
+  g_tcp_state   = TCP_DOWN;
+  g_gw_ack_mode = false;
+  tcp_txq_drop_all();
+}
+
+/**
+ * @brief Backlog format for the stream's encoding: JSON lines for a JSON
+ *        stream, binary frames (no delta reference) for a binary one.
+ */
+static uint8_t backlog_format(void)
+{
+  return (g_encoding == APP_FRAME_ENC_JSON) ? APP_BACKLOG_F_JSON : 0U;
+}
+
+/**
+ * @brief Store one sample in the backlog in the stream's format.
+ *
+ * @param flags APP_BACKLOG_F_SENT if the sample also went out live (kept only
+ *              for a replay after the gateway failed to acknowledge it).
+ */
+static void backlog_store(AppFrameBuf *f, uint8_t flags)
+{
+  uint8_t  fmt = backlog_format();
+  uint16_t n   = 0;
+  const uint8_t *frame = APP_FBUF_Frame(f, fmt ? APP_FRAME_ENC_JSON : APP_FRAME_ENC_BIN, &n);
+  if (!frame) return;
+
+  flags |= fmt;
+
+  uint16_t evicted = 0;
+  uint8_t *dst = APP_BACKLOG_Reserve(&g_backlog, n, &evicted);
+
+  g_backlog_evicted += evicted;
+  if (!dst) return;
+
+  memcpy(dst, frame, n);
+  APP_BACKLOG_Commit(&g_backlog, n, f->t.seq, flags);
+  g_backlog_stored++;
+}
+
+/**
+ * @brief Move backlog frames into the TX queue while the link is idle.
+ *
+ * Replay only runs while no live frame is waiting and the replayed share of
+ * the TX queue stays below APP_NET_REPLAY_FRAMES_MAX, so live samples always
+ * find room and go out next. Frames are copied (a few dozen bytes each):
+ * the TX queue pins its memory until the TCP ACK, the backlog entry may be
+ * evicted before that. Frames stored in the other format (the encoding was
+ * switched between JSON and binary meanwhile) are discarded, not injected.
+ */
+static void backlog_replay(void)
+{
+  const uint8_t *data;
+  uint16_t len;
+  uint32_t seq;
+  uint8_t  flags;
+
+  while (APP_TXQ_Queued(&g_tcp_txq) == 0U &&
+         APP_TXQ_InFlight(&g_tcp_txq) < APP_NET_REPLAY_FRAMES_MAX &&
+         APP_BACKLOG_PeekUnsent(&g_backlog, &data, &len, &seq, &flags)) {
+    if ((flags & APP_BACKLOG_F_JSON) != backlog_format()) {
+      APP_BACKLOG_MarkSent(&g_backlog);
+      g_backlog_discarded++;
+      continue;
+    }
+
+    uint8_t *dst = APP_TXQ_Reserve(&g_tcp_txq, len);
+    if (!dst) break;
+
+    memcpy(dst, data, len);
+    APP_TXQ_Commit(&g_tcp_txq, len);
+    APP_BACKLOG_MarkSent(&g_backlog);
+
+    g_tcp_frames_queued++;
+    g_backlog_replayed++;
+  }
+
+  /* Without gateway ACKs a replayed frame is done once handed to TCP */
+  if (!g_gw_ack_mode)
+    (void)APP_BACKLOG_ReleaseSent(&g_backlog);
+}
+
+/**
+ * @brief Hand queued frames to lwIP while send buffer space is available.
+ *
+ * Frames are written without TCP_WRITE_FLAG_COPY: lwIP references the ring
+ * memory directly. Adjacent frames are merged into one PBUF_ROM by lwIP.
+ */
+static void tcp_pump(void)
+{
+  const uint8_t *data;
+  uint16_t len;
+  bool wrote = false;
+
+  /* Old frames of a dropped connection must not reach the new one */
+  tcp_txq_settle();
+  if (g_tcp_txq_reset || !APP_NET_TcpIsConnected()) return;
+
+  backlog_replay();
+
+  while (APP_TXQ_PeekUnsent(&g_tcp_txq, &data, &len)) {
+    if (len > tcp_sndbuf(g_tcp)) break;
+    if (tcp_sndqueuelen(g_tcp) >= TCP_SND_QUEUELEN) break;
+
+    if (tcp_write(g_tcp, data, len, TCP_WRITE_FLAG_MORE) != ERR_OK)
+      break;
+
+    APP_TXQ_MarkSent(&g_tcp_txq);
+    wrote = true;
+  }
+
+  if (wrote)
+    (void)tcp_output(g_tcp);
 }
 
 /**
- * @brief Called by lwIP when TX buffer was acknowledged.
+ * @brief Called by lwIP when sent data was acknowledged.
+ *
+ * Releases ring memory by ACKed byte count and refills the send buffer.
+ * lwIP is done with the bytes, but a retransmission of them may still wait
+ * in the ETH TX ring: the release waits for the frames submitted so far.
  */
 static err_t on_tcp_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
 {
-  (void)arg; (void)tpcb; (void)len;
-  g_tcp_txlen = 0;
+  (void)arg; (void)tpcb;
+
+  g_tcp_txq_acked   += len;
+  g_tcp_txq_eth_mark = ethernetif_tx_mark();
+  tcp_pump();
   return ERR_OK;
 }
 
@@ -195,15 +963,191 @@ static err_t on_tcp_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
 static void on_tcp_err(void *arg, err_t err)
 {
   (void)arg; (void)err;
+
+  /* PCB is already freed by lwIP; it no longer references the queue */
   g_tcp = NULL;
-  g_tcp_state = TCP_DOWN;
-  g_tcp_txlen = 0;
+  g_tcp_state   = TCP_DOWN;
+  g_gw_ack_mode = false;
+  tcp_txq_drop_all();
+}
+
+/**
+ * @brief Gateway acknowledged everything up to and including seq.
+ */
+static void on_gateway_ack(uint32_t seq)
+{
+  g_gw_ack_mode  = true;
+  g_gw_acked_seq = seq;
+  (void)APP_BACKLOG_ReleaseUpTo(&g_backlog, seq);
+}
+
+/**
+ * @brief Queue a response frame behind the telemetry already in the TX queue.
+ */
+static void cmd_respond(const AppCmd *cmd, uint8_t status,
+                        const uint8_t *data, uint16_t dlen)
+{
+  uint8_t *dst = g_tcp_txq_reset ? NULL : APP_TXQ_Reserve(&g_tcp_txq, APP_CMD_RSP_MAX);
+  uint16_t n   = 0;
+
+  if (dst)
+    n = APP_CMD_EncodeResponse(cmd, status, data, dlen, App_GetMicros(),
+                               dst, APP_CMD_RSP_MAX);
+  if (n == 0U) {
+    g_cmd_rsp_dropped++;
+    return;
+  }
+
+  APP_TXQ_Commit(&g_tcp_txq, n);
+  g_tcp_frames_queued++;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+  for (uint8_t i = 0; i < 4U; i++)
+    *p++ = (uint8_t)(v >> (8U * i));
+  return p;
+}
+
+/**
+ * @brief SET_RATE: apply one channel rate, report the value in effect.
+ */
+static uint8_t cmd_set_rate(const AppCmd *cmd, uint32_t *applied)
+{
+  if (cmd->nargs != 5U) return APP_CMD_ST_BAD_ARGS;
+
+  uint32_t v = APP_CMD_ArgU32(cmd, 1);
+
+  switch (cmd->args[0]) {
+    case APP_CMD_CH_SAMPLE_HZ:
+      APP_NET_SetSampleRate(v);
+      *applied = APP_NET_GetSampleRate();
+      break;
+    case APP_CMD_CH_UDP_LATENCY:
+      APP_NET_SetUdpMaxLatency(v);
+      *applied = APP_NET_GetUdpMaxLatency();
+      break;
+    case APP_CMD_CH_TCP_DIVIDER:
+      g_tcp_divider = (v == 0U) ? 1U : v;
+      g_tcp_div_cnt = 0;
+      *applied = g_tcp_divider;
+      break;
+    case APP_CMD_CH_MQTT_INTERVAL:
+      APP_NET_SetMqttInterval(v);
+      *applied = APP_NET_GetMqttInterval();
+      break;
+    default:
+      return APP_CMD_ST_BAD_ARGS;
+  }
+
+  return APP_CMD_ST_OK;
+}
+
+/**
+ * @brief GET_COUNTERS: snapshot in APP_CMD_CTR_* order.
+ */
+static uint16_t cmd_counters(uint8_t *out)
+{
+  AppNetUdpStats     u;
+  AppNetCanPushStats c;
+  uint32_t v[APP_CMD_CTR_COUNT];
+
+  APP_NET_GetUdpStats(&u);
+  APP_NET_GetCanPushStats(&c);
+
+  v[APP_CMD_CTR_UDP_DATAGRAMS]   = u.datagrams;
+  v[APP_CMD_CTR_UDP_SAMPLES]     = u.samples;
+  v[APP_CMD_CTR_UDP_ERRORS]      = u.errors + u.no_pbuf;
+  v[APP_CMD_CTR_TCP_QUEUED]      = g_tcp_frames_queued;
+  v[APP_CMD_CTR_TCP_ACKED]       = g_tcp_frames_acked;
+  v[APP_CMD_CTR_TCP_DROPPED]     = g_tcp_frames_dropped;
+  v[APP_CMD_CTR_BACKLOG_DEPTH]   = APP_BACKLOG_Depth(&g_backlog);
+  v[APP_CMD_CTR_BACKLOG_EVICTED] = g_backlog_evicted;
+  v[APP_CMD_CTR_CAN_PUSH_FRAMES] = c.frames;
+  v[APP_CMD_CTR_CAN_OVERFLOW]    = c.overflow;
+  v[APP_CMD_CTR_MQTT_PUBLISHES]  = g_mqtt_publishes;
+  v[APP_CMD_CTR_CMD_RX]          = g_cmd.frames;
+  v[APP_CMD_CTR_CMD_ERRORS]      = g_cmd.errors;
+  v[APP_CMD_CTR_SAMPLE_HZ]       = g_sample_hz;
+
+  uint8_t *p = out;
+  *p++ = (uint8_t)APP_CMD_CTR_COUNT;
+  for (uint8_t i = 0; i < APP_CMD_CTR_COUNT; i++)
+    p = put_u32(p, v[i]);
+
+  return (uint16_t)(p - out);
+}
+
+/**
+ * @brief Execute one gateway request (called from the parser).
+ */
+static void on_gateway_cmd(const AppCmd *cmd, void *ctx)
+{
+  (void)ctx;
+
+  uint8_t  data[1U + 4U * APP_CMD_CTR_COUNT];
+  uint16_t dlen   = 0;
+  uint8_t  status = cmd->status;
+
+  if (cmd->opcode == APP_CMD_OP_ACK) {
+    if (cmd->nargs == 4U)
+      on_gateway_ack(APP_CMD_ArgU32(cmd, 0));
+    return;
+  }
+
+  if (status == APP_CMD_ST_OK) {
+    switch (cmd->opcode) {
+      case APP_CMD_OP_PING:
+        break;
+
+      case APP_CMD_OP_SET_RATE: {
+        uint32_t applied = 0;
+        status = cmd_set_rate(cmd, &applied);
+        if (status == APP_CMD_ST_OK)
+          dlen = (uint16_t)(put_u32(data, applied) - data);
+        break;
+      }
+
+      case APP_CMD_OP_SET_ENCODING:
+        if (cmd->nargs != 1U || cmd->args[0] > (uint8_t)APP_FRAME_ENC_DELTA) {
+          status = APP_CMD_ST_BAD_ARGS;
+          break;
+        }
+        APP_NET_SetEncoding((AppFrameEncoding)cmd->args[0]);
+        data[0] = (uint8_t)APP_NET_GetEncoding();
+        dlen    = 1;
+        break;
+
+      case APP_CMD_OP_CAPTURE:
+        if (cmd->nargs != 8U) {
+          status = APP_CMD_ST_BAD_ARGS;
+          break;
+        }
+        APP_NET_StartCapture(APP_CMD_ArgU32(cmd, 0), APP_CMD_ArgU32(cmd, 4),
+                             HAL_GetTick());
+        dlen = (uint16_t)(put_u32(put_u32(data, g_sample_hz),
+                                  g_capture_end_ms - HAL_GetTick()) - data);
+        break;
+
+      case APP_CMD_OP_GET_COUNTERS:
+        dlen = cmd_counters(data);
+        break;
+
+      default:
+        status = APP_CMD_ST_BAD_OPCODE;
+        break;
+    }
+  }
+
+  cmd_respond(cmd, status, data, dlen);
 }
 
 /**
  * @brief TCP receive callback.
  *
- * Incoming data is ignored; connection is kept alive.
+ * Inbound bytes are gateway requests (app_cmd.h), parsed incrementally
+ * straight from each pbuf of the chain. Responses are queued and pumped
+ * once the whole chain is consumed.
  */
 static err_t on_tcp_recv(void *arg, struct tcp_pcb *tpcb,
                          struct pbuf *p, err_t err)
@@ -212,12 +1156,16 @@ static err_t on_tcp_recv(void *arg, struct tcp_pcb *tpcb,
 
   if (!p) {
     /* Remote closed connection */
-    app_tcp_close();
-    return ERR_OK;
+    return app_tcp_close() ? ERR_ABRT : ERR_OK;
   }
 
+  for (struct pbuf *q = p; q != NULL; q = q->next)
+    APP_CMD_Feed(&g_cmd, (const uint8_t *)q->payload, q->len);
+
   tcp_recved(tpcb, p->tot_len);
   pbuf_free(p);
+
+  tcp_pump();
   return ERR_OK;
 }
 
@@ -233,7 +1181,11 @@ static err_t on_tcp_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
     return err;
   }
 
-  g_tcp_state = TCP_UP;
+  g_tcp_state   = TCP_UP;
+  APP_CMD_Reset(&g_cmd);
+
+  /* Whatever the gateway has not acknowledged goes out again */
+  APP_BACKLOG_Rewind(&g_backlog);
 
   tcp_recv(tpcb, on_tcp_recv);
   tcp_sent(tpcb, on_tcp_sent);
@@ -276,43 +1228,383 @@ bool APP_NET_TcpIsConnected(void)
 }
 
 /**
- * @brief Send telemetry over TCP (one message at a time).
+ * @brief Queue telemetry for TCP transmission.
  *
  * Behavior:
- *  - Returns false if not connected or if a TX is already in flight.
- *  - TX buffer is released in on_tcp_sent().
+ *  - The sample's shared frame is copied into the TX ring and written to TCP
+ *    as soon as the send buffer allows; several frames may be in flight.
+ *  - Ring memory is released in on_tcp_sent().
+ *  - If not connected or the TX queue is full, the sample goes to the
+ *    backlog and is replayed later; returns false in that case.
+ *  - Once the gateway sends ACKs, live samples are also journaled in the
+ *    backlog (flagged sent) until acknowledged.
  */
-bool APP_NET_SendTCP(const AppTelemetry *t)
+bool APP_NET_SendTCP(AppFrameBuf *f)
 {
-  if (!t) return false;
-  if (!APP_NET_TcpIsConnected()) return false;
-  if (g_tcp_txlen != 0) return false;
+  if (!f) return false;
+
+  bool live = false;
+
+  if (APP_NET_TcpIsConnected() && !g_tcp_txq_reset) {
+    uint16_t n = 0;
+    const uint8_t *frame = APP_FBUF_Frame(f, g_encoding, &n);
+    uint8_t *dst = frame ? APP_TXQ_Reserve(&g_tcp_txq, n) : NULL;
+    if (dst) {
+      memcpy(dst, frame, n);
+      APP_TXQ_Commit(&g_tcp_txq, n);
+      g_tcp_frames_queued++;
+      live = true;
+    }
+  }
 
-  int n = snprintf(g_tcp_txbuf, sizeof(g_tcp_txbuf),
-                   "{\"ts\":%lu,\"i2c\":%ld,\"can101\":\"%s\",\"can120\":\"%s\"}\n",
-                   (unsigned long)t->now_ms,
-                   (long)t->i2c_temp_c,
-                   t->can_0x101,
-                   t->can_0x120);
-  if (n <= 0) return false;
-  if (n >= (int)sizeof(g_tcp_txbuf)) n = (int)sizeof(g_tcp_txbuf) - 1;
+  if (!live)
+    backlog_store(f, 0U);
+  else if (g_gw_ack_mode)
+    backlog_store(f, APP_BACKLOG_F_SENT);
 
-  g_tcp_txlen = (uint16_t)n;
+  tcp_pump();
+  return live;
+}
 
-  if (tcp_write(g_tcp, g_tcp_txbuf, g_tcp_txlen,
-                TCP_WRITE_FLAG_COPY) != ERR_OK) {
-    g_tcp_txlen = 0;
-    return false;
+/**
+ * @brief Snapshot of TCP queue occupancy and frame counters.
+ */
+void APP_NET_GetTcpStats(AppNetTcpStats *out)
+{
+  if (!out) return;
+
+  out->queued        = APP_TXQ_Queued(&g_tcp_txq);
+  out->inflight      = APP_TXQ_InFlight(&g_tcp_txq);
+  out->total_queued  = g_tcp_frames_queued;
+  out->total_acked   = g_tcp_frames_acked;
+  out->total_dropped = g_tcp_frames_dropped;
+  out->tcp_divider   = g_tcp_divider;
+  out->cmds          = g_cmd.frames;
+  out->cmd_errors    = g_cmd.errors + g_cmd_rsp_dropped;
+}
+
+/**
+ * @brief Snapshot of the store-and-forward backlog.
+ */
+void APP_NET_GetBacklogStats(AppNetBacklogStats *out)
+{
+  if (!out) return;
+
+  out->depth        = APP_BACKLOG_Depth(&g_backlog);
+  out->unsent       = APP_BACKLOG_Unsent(&g_backlog);
+  out->bytes        = APP_BACKLOG_Bytes(&g_backlog);
+  out->gw_ack_mode  = g_gw_ack_mode;
+  out->gw_acked_seq = g_gw_acked_seq;
+  out->stored       = g_backlog_stored;
+  out->evicted      = g_backlog_evicted;
+  out->replayed     = g_backlog_replayed;
+  out->discarded    = g_backlog_discarded;
+}
+
+/* =============================================================================
+ * MQTT publisher
+ * ============================================================================= */
+
+/* One PUBLISH of a burst: topic suffix below APP_NET_MQTT_TOPIC_PREFIX */
+typedef struct {
+  const char *topic;
+  char        payload[16];
+} mqtt_msg_t;
+
+/**
+ * @brief Schedule the next connect attempt and double the backoff.
+ */
+static void mqtt_schedule_reconnect(uint32_t now_ms)
+{
+  g_mqtt_state           = MQTT_DOWN;
+  g_mqtt_next_connect_ms = now_ms + g_mqtt_backoff_ms;
+
+  g_mqtt_backoff_ms *= 2U;
+  if (g_mqtt_backoff_ms > APP_NET_MQTT_BACKOFF_MAX_MS)
+    g_mqtt_backoff_ms = APP_NET_MQTT_BACKOFF_MAX_MS;
+}
+
+/**
+ * @brief Connection state callback from the lwIP MQTT client.
+ *
+ * Called on CONNACK and whenever the client closes the connection (broker
+ * refused, TCP error, keep-alive timeout). Not called for mqtt_disconnect().
+ */
+static void on_mqtt_connection(mqtt_client_t *client, void *arg,
+                               mqtt_connection_status_t status)
+{
+  (void)arg;
+
+  uint32_t now_ms = HAL_GetTick();
+
+  if (status == MQTT_CONNECT_ACCEPTED) {
+    g_mqtt_state      = MQTT_UP;
+    g_mqtt_backoff_ms = APP_NET_MQTT_BACKOFF_MIN_MS;
+    g_mqtt_connects++;
+
+    /* Replaces the retained "offline" left by the last-will message */
+    (void)mqtt_publish(client, APP_NET_MQTT_TOPIC_PREFIX "/status", "online", 6U,
+                       0U, 1U, NULL, NULL);
+    return;
   }
 
-  if (tcp_output(g_tcp) != ERR_OK) {
-    g_tcp_txlen = 0;
-    return false;
+  if (g_mqtt_state == MQTT_UP)
+    g_mqtt_disconnects++;
+  else
+    g_mqtt_errors++;
+
+  mqtt_schedule_reconnect(now_ms);
+}
+
+/**
+ * @brief Start a non-blocking connect (CONNECT goes out once TCP is up).
+ */
+static void mqtt_start_connect(uint32_t now_ms)
+{
+  static const struct mqtt_connect_client_info_t ci = {
+    .client_id   = APP_NET_MQTT_CLIENT_ID,
+    .keep_alive  = APP_NET_MQTT_KEEPALIVE_S,
+    .will_topic  = APP_NET_MQTT_TOPIC_PREFIX "/status",
+    .will_msg    = "offline",
+    .will_qos    = 0,
+    .will_retain = 1,
+  };
+
+  /* The client struct is opaque outside lwIP: taken from the lwIP heap on
+     the first connect and kept for good */
+  if (g_mqtt == NULL)
+    g_mqtt = mqtt_client_new();
+
+  err_t e = (g_mqtt != NULL)
+              ? mqtt_client_connect(g_mqtt, &g_mqtt_broker_ip, g_mqtt_port,
+                                    on_mqtt_connection, NULL, &ci)
+              : ERR_MEM;
+  if (e != ERR_OK) {
+    g_mqtt_errors++;
+    mqtt_schedule_reconnect(now_ms);
+    return;
+  }
+
+  g_mqtt_state         = MQTT_CONNECTING;
+  g_mqtt_connect_t0_ms = now_ms;
+}
+
+/**
+ * @brief Drop the connection without notifying on_mqtt_connection().
+ */
+static void mqtt_stop(void)
+{
+  if (g_mqtt != NULL)
+    mqtt_disconnect(g_mqtt);
+  g_mqtt_state = MQTT_DOWN;
+}
+
+/**
+ * @brief Connect / reconnect handling, called from APP_NET_Poll().
+ *
+ * Never blocks: a SYN that is not answered within APP_NET_MQTT_CONNECT_TIMEOUT_MS
+ * is dropped and retried with exponential backoff (2 s .. 30 s).
+ */
+static void mqtt_poll(uint32_t now_ms)
+{
+  if (!g_mqtt_enabled) return;
+
+  switch (g_mqtt_state) {
+    case MQTT_DOWN:
+      if ((int32_t)(now_ms - g_mqtt_next_connect_ms) >= 0)
+        mqtt_start_connect(now_ms);
+      break;
+
+    case MQTT_CONNECTING:
+      if ((uint32_t)(now_ms - g_mqtt_connect_t0_ms) >= APP_NET_MQTT_CONNECT_TIMEOUT_MS) {
+        mqtt_stop();
+        g_mqtt_errors++;
+        mqtt_schedule_reconnect(now_ms);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Fill one message per valid sensor channel.
+ *
+ * Payloads are plain decimal text (no float printf: fixed point by hand).
+ */
+static uint8_t mqtt_build_msgs(const AppTelemetry *t, mqtt_msg_t *m)
+{
+  uint8_t n = 0;
+
+  if (t->valid & APP_TLM_VALID_I2C) {
+    int32_t  c100 = (int32_t)(t->i2c_temp_f * 100.0f);
+    uint32_t a    = (uint32_t)((c100 < 0) ? -c100 : c100);
+    m[n].topic = APP_NET_MQTT_TOPIC_PREFIX "/i2c/temp";
+    snprintf(m[n].payload, sizeof(m[n].payload), "%s%lu.%02lu",
+             (c100 < 0) ? "-" : "", (unsigned long)(a / 100U),
+             (unsigned long)(a % 100U));
+    n++;
+  }
+
+  if (t->valid & APP_TLM_VALID_CAN101) {
+    m[n].topic = APP_NET_MQTT_TOPIC_PREFIX "/can/hb_seq";
+    snprintf(m[n].payload, sizeof(m[n].payload), "%u", t->can_hb_seq);
+    n++;
+  }
+
+  if (t->valid & APP_TLM_VALID_CAN120) {
+    m[n].topic = APP_NET_MQTT_TOPIC_PREFIX "/can/lux";
+    snprintf(m[n].payload, sizeof(m[n].payload), "%lu.%02lu",
+             (unsigned long)(t->can_lux_x100 / 100U),
+             (unsigned long)(t->can_lux_x100 % 100U));
+    n++;
+
+    m[n].topic = APP_NET_MQTT_TOPIC_PREFIX "/can/full";
+    snprintf(m[n].payload, sizeof(m[n].payload), "%u", t->can_full);
+    n++;
+
+    m[n].topic = APP_NET_MQTT_TOPIC_PREFIX "/can/ir";
+    snprintf(m[n].payload, sizeof(m[n].payload), "%u", t->can_ir);
+    n++;
   }
 
+  return n;
+}
+
+/**
+ * @brief Publish one sample as a burst of per-sensor QoS0 messages.
+ *
+ * QoS0 needs no PUBACK, so all messages are pipelined without waiting.
+ * The client is corked for the burst (mqtt_set_corked(), a local addition
+ * to lwIP apps/mqtt): every mqtt_publish() only appends to the client's
+ * output ring, and uncorking hands the whole burst to tcp_write() and
+ * tcp_output() once, as one segment. Messages that do not fit the ring or
+ * the request pool (MQTT_OUTPUT_RINGBUF_SIZE, MQTT_REQ_MAX_IN_FLIGHT) are
+ * dropped.
+ */
+static void mqtt_publish_sample(const AppTelemetry *t)
+{
+  mqtt_msg_t m[5];
+  uint8_t n = mqtt_build_msgs(t, m);
+
+  if (n == 0U || g_mqtt == NULL || !mqtt_client_is_connected(g_mqtt)) return;
+
+  mqtt_set_corked(g_mqtt, 1U);
+
+  for (uint8_t i = 0; i < n; i++) {
+    err_t e = mqtt_publish(g_mqtt, m[i].topic, m[i].payload,
+                           (u16_t)strlen(m[i].payload), 0U, 0U, NULL, NULL);
+    if (e == ERR_OK)
+      g_mqtt_publishes++;
+    else
+      g_mqtt_dropped++;
+  }
+
+  mqtt_set_corked(g_mqtt, 0U);
+
+  g_mqtt_bursts++;
+}
+
+void APP_NET_SetMqtt(bool on)
+{
+  if (on == g_mqtt_enabled) return;
+
+  g_mqtt_enabled = on;
+
+  if (!on) {
+    mqtt_stop();
+  } else {
+    g_mqtt_backoff_ms      = APP_NET_MQTT_BACKOFF_MIN_MS;
+    g_mqtt_next_connect_ms = HAL_GetTick();
+  }
+}
+
+bool APP_NET_GetMqtt(void)
+{
+  return g_mqtt_enabled;
+}
+
+bool APP_NET_MqttIsConnected(void)
+{
+  return g_mqtt_state == MQTT_UP;
+}
+
+/**
+ * @brief Change the broker; an open connection is dropped and re-established.
+ */
+bool APP_NET_SetMqttBroker(const char *ip_str, uint16_t port)
+{
+  ip_addr_t ip;
+  if (!parse_ip(ip_str, &ip)) return false;
+
+  g_mqtt_broker_ip = ip;
+  g_mqtt_port      = (port != 0U) ? port : APP_MQTT_PORT;
+
+  mqtt_stop();
+  g_mqtt_backoff_ms      = APP_NET_MQTT_BACKOFF_MIN_MS;
+  g_mqtt_next_connect_ms = HAL_GetTick();
   return true;
 }
 
+void APP_NET_SetMqttInterval(uint32_t ms)
+{
+  if (ms < APP_NET_MQTT_INTERVAL_MIN_MS) ms = APP_NET_MQTT_INTERVAL_MIN_MS;
+  g_mqtt_interval_ms = ms;
+}
+
+uint32_t APP_NET_GetMqttInterval(void)
+{
+  return g_mqtt_interval_ms;
+}
+
+/**
+ * @brief Snapshot of the MQTT publisher.
+ */
+void APP_NET_GetMqttStats(AppNetMqttStats *out)
+{
+  if (!out) return;
+
+  out->enabled     = g_mqtt_enabled;
+  out->connected   = APP_NET_MqttIsConnected();
+  out->broker_port = g_mqtt_port;
+  out->connects    = g_mqtt_connects;
+  out->disconnects = g_mqtt_disconnects;
+  out->errors      = g_mqtt_errors;
+  out->bursts      = g_mqtt_bursts;
+  out->publishes   = g_mqtt_publishes;
+  out->dropped     = g_mqtt_dropped;
+  snprintf(out->broker, sizeof(out->broker), "%s", ipaddr_ntoa(&g_mqtt_broker_ip));
+}
+
+/* =============================================================================
+ * Sample text
+ * ============================================================================= */
+
+/**
+ * @brief Bounded string copy (always terminated).
+ */
+static void copy_text(char *dst, const char *src, size_t cap)
+{
+  size_t i = 0;
+
+  if (src) {
+    for (; i + 1U < cap && src[i] != 0; i++)
+      dst[i] = src[i];
+  }
+  dst[i] = 0;
+}
+
+/**
+ * @brief Pre-formatted CAN text of a sample (APP_FBUF_Text() source): only
+ *        copied when the JSON line or the status line needs it.
+ */
+static void net_fill_text(AppTelemetry *t)
+{
+  copy_text(t->can_0x101, CAN1_GetText_0x101(), sizeof(t->can_0x101));
+  copy_text(t->can_0x120, CAN1_GetText_0x120(), sizeof(t->can_0x120));
+}
+
 /* =============================================================================
  * Public API
  * ============================================================================= */
@@ -323,8 +1615,21 @@ bool APP_NET_SendTCP(const AppTelemetry *t)
 void APP_NET_Init(void)
 {
   parse_ip(APP_RASPI_IP, &g_remote_ip);
+  parse_ip(APP_MQTT_BROKER_IP, &g_mqtt_broker_ip);
   udp_init_once();
 
+  LWIP_MEMPOOL_INIT(TLM_POOL);
+  APP_FBUF_Init();
+  APP_FBUF_SetTextSource(net_fill_text);
+
+  APP_CMD_Init(&g_cmd, on_gateway_cmd, NULL);
+  APP_IPERF_Init();
+
+  APP_TXQ_Init(&g_tcp_txq, g_tcp_txbuf, (uint16_t)sizeof(g_tcp_txbuf),
+               g_tcp_txdesc, APP_NET_TCP_TXQ_FRAMES);
+  APP_BACKLOG_Init(&g_backlog, g_backlog_buf, (uint16_t)sizeof(g_backlog_buf),
+                   g_backlog_desc, APP_NET_BACKLOG_FRAMES);
+
   g_tcp_state = TCP_DOWN;
   g_next_tcp_reconnect_ms = 0;
 }
@@ -345,22 +1650,49 @@ bool APP_NET_SetRemote(const char *ip_str,
   g_udp_port  = udp_port;
   g_tcp_port  = tcp_port;
 
-  app_tcp_close();
+  /* A different gateway: its ACK state starts over */
+  (void)app_tcp_close();
+  g_gw_acked_seq = 0;
   return true;
 }
 
 /**
- * @brief Low-level lwIP pump (NO_SYS mode).
+ * @brief Select wire encoding for subsequent UDP/TCP telemetry.
  *
- * Must be called regularly from main loop.
+ * Binary frames are self-delimiting (length in header), so switching while
+ * a TCP connection is up is safe for a decoder that auto-detects per frame.
  */
-void APP_NET_Poll(uint32_t now_ms)
+void APP_NET_SetEncoding(AppFrameEncoding enc)
 {
-  (void)now_ms;
+  switch (enc) {
+    case APP_FRAME_ENC_BIN:
+    case APP_FRAME_ENC_DELTA:
+      g_encoding = enc;
+      break;
+    default:
+      g_encoding = APP_FRAME_ENC_JSON;
+      break;
+  }
+}
 
-  MX_LWIP_Process();
-  ethernetif_input(&gnetif);
-  sys_check_timeouts();
+AppFrameEncoding APP_NET_GetEncoding(void)
+{
+  return g_encoding;
+}
+
+/**
+ * @brief Network pump (NO_SYS mode): lwIP work that is due, then the
+ *        connection housekeeping.
+ *
+ * Cheap when nothing is due; called on every APP_NET_Service() pass.
+ */
+void APP_NET_Poll(uint32_t now_ms)
+{
+  /* RX frames, sent TX frames, due lwIP timers, link poll */
+  if (MX_LWIP_Pump(now_ms)) {
+    /* ACKs or freed TX descriptors: push frames that did not fit earlier */
+    tcp_pump();
+  }
 
   /* Handle TCP reconnect attempts */
   if (!APP_NET_TcpIsConnected()) {
@@ -370,53 +1702,177 @@ void APP_NET_Poll(uint32_t now_ms)
       g_next_tcp_reconnect_ms = now_ms + 2000;
     }
   }
+
+  /* MQTT connect / backoff (opt-in) */
+  mqtt_poll(now_ms);
 }
 
 /* =============================================================================
  * Main-loop service (called from main.c)
  * ============================================================================= */
 
+/**
+ * @brief Take one telemetry sample from the cached sensor/CAN state.
+ */
+static void net_build_sample(uint32_t now_ms, AppTelemetry *t)
+{
+  memset(t, 0, sizeof(*t));
+
+  t->now_ms     = now_ms;
+  t->ts_us      = App_GetMicros();
+  t->seq        = g_tlm_seq++;
+  t->i2c_temp_c = (int32_t)App_I2C_GetTempInt();
+  t->i2c_temp_f = App_I2C_GetTemp();
+
+  if (App_I2C_IsOk())
+    t->valid |= APP_TLM_VALID_I2C;
+
+  if (CAN1_101_IsValid()) {
+    t->valid     |= APP_TLM_VALID_CAN101;
+    t->can_hb_seq = CAN1_101_GetSeq();
+  }
+
+  if (CAN1_120_IsValid()) {
+    t->valid       |= APP_TLM_VALID_CAN120;
+    t->can_lux_x100 = CAN1_120_GetLuxX100();
+    t->can_full     = CAN1_120_GetFull();
+    t->can_ir       = CAN1_120_GetIR();
+  }
+}
+
 /**
  * @brief Periodic network service.
  *
  * Timing:
- *  - lwIP pump: every 10 ms
- *  - Telemetry send: every 1000 ms
+ *  - lwIP pump: every call; RX / TX completion while the ETH IRQ has
+ *    flagged frames, lwIP timers when due, link poll every 100 ms
+ *  - CAN event push: every call (if enabled)
+ *  - Network statistics: every g_netstat_period_ms (if enabled)
+ *  - CAN statistics: every g_canstats_period_ms (if enabled)
+ *  - Telemetry sample: every 1/g_sample_hz (10..1000 Hz), raised for the
+ *    duration of a capture window; TCP gets every g_tcp_divider-th sample
+ *  - MQTT burst: latest sample every g_mqtt_interval_ms (if connected)
+ *  - UDP batch flush: when full or after g_udp_max_latency_ms
  */
 void APP_NET_Service(uint32_t now_ms)
 {
-  static uint32_t lwip_tick = 0;
-  static uint32_t send_tick = 0;
+  APP_NET_Poll(now_ms);
+
+  /* Throughput test (idle unless started from the CLI) */
+  APP_IPERF_Service(now_ms);
+
+  /* CAN frames captured since the last pass (push mode only) */
+  can_push_service();
+
+  /* Stack statistics (opt-in) */
+  netstat_service(now_ms);
+  canstats_service(now_ms);
+
+  /* End of a capture window: back to the configured rate */
+  if (g_capture_active && (int32_t)(now_ms - g_capture_end_ms) >= 0) {
+    g_capture_active = false;
+    sample_rate_apply(g_capture_prev_hz);
+  }
+
+  uint64_t now_us    = App_GetMicros();
+  uint64_t period_us = 1000000ULL / g_sample_hz;
+
+  if (g_next_sample_us == 0U)
+    g_next_sample_us = now_us;
+
+  if ((int64_t)(now_us - g_next_sample_us) >= 0) {
+    /* One shared buffer per sample: each encoding is produced once and
+       reused by UDP, TCP, backlog and the USB/UI readers (app_fbuf.c) */
+    AppFrameBuf *f = APP_FBUF_Begin();
+
+    if (f) {
+      net_build_sample(now_ms, &f->t);
+      APP_FBUF_Commit(f);
+
+      (void)APP_NET_SendUDP(f);
+
+      if (++g_tcp_div_cnt >= g_tcp_divider) {
+        g_tcp_div_cnt = 0;
+        (void)APP_NET_SendTCP(f);
+      }
+
+      /* MQTT gets the latest sample once per publish interval */
+      if (g_mqtt_state == MQTT_UP &&
+          (int32_t)(now_ms - g_mqtt_next_pub_ms) >= 0) {
+        mqtt_publish_sample(&f->t);
+        g_mqtt_next_pub_ms = now_ms + g_mqtt_interval_ms;
+      }
+    }
+
+    /* Keep a fixed grid; if the loop stalled, skip missed slots */
+    g_next_sample_us += period_us;
+    if ((int64_t)(now_us - g_next_sample_us) >= 0)
+      g_next_sample_us = now_us + period_us;
+  }
 
-  /* 10 ms lwIP processing */
-  if ((int32_t)(now_ms - lwip_tick) >= 0) {
-    APP_NET_Poll(now_ms);
-    lwip_tick = now_ms + 10;
+  /* Latency deadline for a partially filled UDP batch */
+  if (g_udp_batch_samples != 0U &&
+      (uint32_t)(now_ms - g_udp_batch_t0_ms) >= g_udp_max_latency_ms) {
+    g_udp_flush_timer++;
+    (void)APP_NET_FlushUDP();
   }
+}
 
-  /* 1 Hz telemetry */
-  if ((int32_t)(now_ms - send_tick) >= 0) {
-    AppTelemetry t = {0};
+/**
+ * @brief Earlier of the current deadline t and the one at due_ms.
+ */
+static uint32_t deadline_min(uint32_t t, uint32_t now_ms, uint32_t due_ms)
+{
+  int32_t left = (int32_t)(due_ms - now_ms);
 
-    t.now_ms     = now_ms;
-    t.i2c_temp_c = (int32_t)App_I2C_GetTempInt();
+  if (left <= 0) return 0U;
+  return ((uint32_t)left < t) ? (uint32_t)left : t;
+}
 
-    snprintf(t.can_0x101, sizeof(t.can_0x101), "%s",
-             CAN1_GetText_0x101());
-    snprintf(t.can_0x120, sizeof(t.can_0x120), "%s",
-             CAN1_GetText_0x120());
+/**
+ * @brief Milliseconds until APP_NET_Service() has work (0 = call it again
+ *        without sleeping).
+ *
+ * Covers the lwIP pump, the next telemetry sample, the UDP batch latency,
+ * the end of a capture window, the stats channel, TCP / MQTT reconnects
+ * and an iperf run.
+ */
+uint32_t APP_NET_SleepTime(uint32_t now_ms)
+{
+  uint32_t t = MX_LWIP_SleepTime(now_ms);
+  uint32_t it = APP_IPERF_SleepTime(now_ms);
+
+  if (it < t) t = it;
+  if (t == 0U) return 0U;
+
+  /* Next sample (rounded down to the 1 ms tick that wakes us) */
+  uint64_t now_us = App_GetMicros();
+  int64_t  sample_left = (int64_t)(g_next_sample_us - now_us);
+  if (sample_left <= 0) return 0U;
+  uint64_t sample_ms = (uint64_t)sample_left / 1000U;
+  if (sample_ms < t) t = (uint32_t)sample_ms;
 
-    snprintf(g_udp_last, sizeof(g_udp_last),
-             "ts=%lu i2c=%ld",
-             (unsigned long)t.now_ms,
-             (long)t.i2c_temp_c);
+  if (g_udp_batch_samples != 0U)
+    t = deadline_min(t, now_ms, g_udp_batch_t0_ms + g_udp_max_latency_ms);
 
-    snprintf(g_tcp_last, sizeof(g_tcp_last),
-             "C101=%.58s", t.can_0x101);
+  if (g_capture_active)
+    t = deadline_min(t, now_ms, g_capture_end_ms);
 
-    (void)APP_NET_SendUDP(&t);
-    (void)APP_NET_SendTCP(&t);
+  if (g_netstat_period_ms != 0U)
+    t = deadline_min(t, now_ms, g_netstat_next_ms);
 
-    send_tick = now_ms + 1000;
+  if (g_canstats_period_ms != 0U)
+    t = deadline_min(t, now_ms, g_canstats_next_ms);
+
+  if (!APP_NET_TcpIsConnected())
+    t = deadline_min(t, now_ms, g_next_tcp_reconnect_ms);
+
+  if (g_mqtt_enabled) {
+    if (g_mqtt_state == MQTT_DOWN)
+      t = deadline_min(t, now_ms, g_mqtt_next_connect_ms);
+    else if (g_mqtt_state == MQTT_CONNECTING)
+      t = deadline_min(t, now_ms, g_mqtt_connect_t0_ms + APP_NET_MQTT_CONNECT_TIMEOUT_MS);
   }
+
+  return t;
 }
@@ -0,0 +1,284 @@
+/**
+ * @file    app_netstat.c
+ * @brief   Network stack statistics: pool usage, protocol counters, drops.
+ *
+ * This module provides:
+ *  - Pool table: lwIP heap, every lwIP memp pool and the private zero-copy
+ *    pools (RX_POOL, TLM_POOL) with capacity, current use, high-water mark
+ *    and allocation failures
+ *  - Protocol table: TX / RX / drop / error counts of link, ARP, IP, ICMP,
+ *    UDP and TCP (lwIP stats)
+ *  - Loss outside lwIP: RX_POOL refill failures, DMA missed frames and FIFO
+ *    overflows, MMC CRC / alignment errors, TX ring full, telemetry drops
+ *  - One JSON line with all of it for the optional stats channel (app_net.c)
+ *
+ * Design notes:
+ *  - Nothing is counted here: lwIP (LWIP_STATS), ethernetif and app_net keep
+ *    their counters on their own paths; this module only reads them, so the
+ *    cost is paid when a snapshot is taken
+ *  - Peaks are what pools are sized by: run the worst-case load, read
+ *    "netstat", size each pool a margin above its peak
+ *  - Main loop only (same context as lwIP in NO_SYS mode)
+ */
+
+#include "app_netstat.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "lwip/opt.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "ethernetif.h"
+
+#include "app_net.h"
+
+/* =============================================================================
+ * Pool tables
+ * ============================================================================= */
+#if MEMP_STATS
+/* lwIP pool names in memp_t order (the X-macro that defines the pools) */
+static const char *const s_memp_names[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+
+/* Private pools declared with LWIP_MEMPOOL_DECLARE() */
+LWIP_MEMPOOL_PROTOTYPE(RX_POOL);     /* ethernetif.c */
+LWIP_MEMPOOL_PROTOTYPE(TLM_POOL);    /* app_net.c    */
+
+typedef struct
+{
+  const char             *name;
+  const struct memp_desc *desc;
+} private_pool_t;
+
+static const private_pool_t s_private[] = {
+  { "RX_POOL",  &memp_RX_POOL  },
+  { "TLM_POOL", &memp_TLM_POOL },
+};
+#endif
+
+/* =============================================================================
+ * Snapshots
+ * ============================================================================= */
+#if MEM_STATS || MEMP_STATS
+static void pool_row(AppNetstatPool *r, const char *name, const struct stats_mem *s)
+{
+  r->name  = name;
+  r->avail = (uint32_t)s->avail;
+  r->used  = (uint32_t)s->used;
+  r->peak  = (uint32_t)s->max;
+  r->fail  = (uint32_t)s->err;
+}
+#endif
+
+/**
+ * @brief Heap, lwIP pools, private pools (in that order).
+ */
+uint8_t APP_NETSTAT_GetPools(AppNetstatPool *out, uint8_t cap)
+{
+  uint8_t n = 0;
+
+  if (!out) return 0;
+
+#if MEM_STATS
+  if (n < cap)
+    pool_row(&out[n++], "HEAP", &lwip_stats.mem);
+#endif
+
+#if MEMP_STATS
+  for (uint32_t i = 0; i < (uint32_t)MEMP_MAX && n < cap; i++)
+    pool_row(&out[n++], s_memp_names[i], lwip_stats.memp[i]);
+
+  for (uint32_t i = 0; i < sizeof(s_private) / sizeof(s_private[0]) && n < cap; i++)
+    pool_row(&out[n++], s_private[i].name, s_private[i].desc->stats);
+#endif
+
+  return n;
+}
+
+#if LINK_STATS || ETHARP_STATS || IP_STATS || ICMP_STATS || UDP_STATS || TCP_STATS
+static void proto_row(AppNetstatProto *r, const char *name, const struct stats_proto *s)
+{
+  r->name   = name;
+  r->xmit   = s->xmit;
+  r->recv   = s->recv;
+  r->drop   = s->drop;
+  r->memerr = s->memerr;
+  r->err    = (uint32_t)s->chkerr + s->lenerr + s->rterr
+            + s->proterr + s->opterr + s->err;
+}
+#endif
+
+/**
+ * @brief Protocol counters, bottom of the stack first.
+ */
+uint8_t APP_NETSTAT_GetProtos(AppNetstatProto *out, uint8_t cap)
+{
+  uint8_t n = 0;
+
+  if (!out) return 0;
+
+#if LINK_STATS
+  if (n < cap) proto_row(&out[n++], "link", &lwip_stats.link);
+#endif
+#if ETHARP_STATS
+  if (n < cap) proto_row(&out[n++], "etharp", &lwip_stats.etharp);
+#endif
+#if IP_STATS
+  if (n < cap) proto_row(&out[n++], "ip", &lwip_stats.ip);
+#endif
+#if ICMP_STATS
+  if (n < cap) proto_row(&out[n++], "icmp", &lwip_stats.icmp);
+#endif
+#if UDP_STATS
+  if (n < cap) proto_row(&out[n++], "udp", &lwip_stats.udp);
+#endif
+#if TCP_STATS
+  if (n < cap) proto_row(&out[n++], "tcp", &lwip_stats.tcp);
+#endif
+
+  return n;
+}
+
+void APP_NETSTAT_GetDrops(AppNetstatDrops *out)
+{
+  ethernetif_stats_t eth;
+  AppNetUdpStats     udp;
+  AppNetTcpStats     tcp;
+  AppNetBacklogStats bl;
+
+  if (!out) return;
+
+  ethernetif_get_stats(&eth);
+  APP_NET_GetUdpStats(&udp);
+  APP_NET_GetTcpStats(&tcp);
+  APP_NET_GetBacklogStats(&bl);
+
+  out->rx_pool_empty    = eth.rx_pool_empty;
+  out->rx_buf_unavail   = eth.rx_buf_unavail;
+  out->rx_missed        = eth.rx_missed;
+  out->rx_fifo_overflow = eth.rx_fifo_overflow;
+  out->rx_crc_errors    = eth.rx_crc_errors;
+  out->rx_align_errors  = eth.rx_align_errors;
+  out->dma_errors       = eth.dma_errors;
+  out->tx_busy          = eth.tx_busy;
+
+#if MIB2_STATS
+  out->tcp_retrans      = lwip_stats.mib2.tcpretranssegs;
+#else
+  out->tcp_retrans      = 0;
+#endif
+  out->udp_dropped      = udp.dropped;
+  out->udp_no_pbuf      = udp.no_pbuf;
+  out->tcp_dropped      = tcp.total_dropped;
+  out->backlog_evicted  = bl.evicted;
+}
+
+/**
+ * @brief Restart every high-water mark at the pool's current use.
+ *
+ * Lets a sizing run measure one load phase instead of the boot peak.
+ */
+void APP_NETSTAT_ResetPeaks(void)
+{
+#if MEM_STATS
+  lwip_stats.mem.max = lwip_stats.mem.used;
+#endif
+
+#if MEMP_STATS
+  for (uint32_t i = 0; i < (uint32_t)MEMP_MAX; i++)
+    lwip_stats.memp[i]->max = lwip_stats.memp[i]->used;
+
+  for (uint32_t i = 0; i < sizeof(s_private) / sizeof(s_private[0]); i++)
+    s_private[i].desc->stats->max = s_private[i].desc->stats->used;
+#endif
+}
+
+/* =============================================================================
+ * Telemetry encoding
+ * ============================================================================= */
+
+typedef struct
+{
+  char    *buf;
+  uint16_t cap;
+  uint16_t len;
+  bool     full;
+} json_out_t;
+
+/**
+ * @brief Append to the line; once something did not fit, nothing more is
+ *        added and the line is rejected.
+ */
+static void json_put(json_out_t *o, const char *fmt, ...)
+{
+  va_list ap;
+  int n;
+
+  if (o->full) return;
+
+  va_start(ap, fmt);
+  n = vsnprintf(o->buf + o->len, (size_t)(o->cap - o->len), fmt, ap);
+  va_end(ap);
+
+  if (n < 0 || (uint32_t)n >= (uint32_t)(o->cap - o->len))
+    o->full = true;
+  else
+    o->len = (uint16_t)(o->len + n);
+}
+
+/**
+ * @brief One JSON line:
+ *   {"netstat":{"ts":<ms>,
+ *     "pools":{"<name>":[avail,used,peak,fail],...},
+ *     "proto":{"<name>":[tx,rx,drop,memerr,err],...},
+ *     "drops":{"<counter>":n,...}}}\n
+ *
+ * @return Line length, 0 if it does not fit in cap.
+ */
+uint16_t APP_NETSTAT_EncodeJSON(uint32_t now_ms, char *out, uint16_t cap)
+{
+  AppNetstatPool  pools[APP_NETSTAT_POOLS_MAX];
+  AppNetstatProto protos[APP_NETSTAT_PROTOS_MAX];
+  AppNetstatDrops d;
+  json_out_t o = { out, cap, 0, false };
+
+  if (!out || cap == 0U) return 0;
+
+  uint8_t np = APP_NETSTAT_GetPools(pools, (uint8_t)APP_NETSTAT_POOLS_MAX);
+  uint8_t nr = APP_NETSTAT_GetProtos(protos, (uint8_t)APP_NETSTAT_PROTOS_MAX);
+  APP_NETSTAT_GetDrops(&d);
+
+  json_put(&o, "{\"netstat\":{\"ts\":%lu,\"pools\":{", (unsigned long)now_ms);
+  for (uint8_t i = 0; i < np; i++) {
+    json_put(&o, "%s\"%s\":[%lu,%lu,%lu,%lu]", (i != 0U) ? "," : "",
+             pools[i].name, (unsigned long)pools[i].avail,
+             (unsigned long)pools[i].used, (unsigned long)pools[i].peak,
+             (unsigned long)pools[i].fail);
+  }
+
+  json_put(&o, "},\"proto\":{");
+  for (uint8_t i = 0; i < nr; i++) {
+    json_put(&o, "%s\"%s\":[%lu,%lu,%lu,%lu,%lu]", (i != 0U) ? "," : "",
+             protos[i].name, (unsigned long)protos[i].xmit,
+             (unsigned long)protos[i].recv, (unsigned long)protos[i].drop,
+             (unsigned long)protos[i].memerr, (unsigned long)protos[i].err);
+  }
+
+  json_put(&o, "},\"drops\":{\"rx_pool_empty\":%lu,\"rx_buf_unavail\":%lu,"
+               "\"rx_missed\":%lu,\"rx_fifo_overflow\":%lu,\"rx_crc\":%lu,"
+               "\"rx_align\":%lu,\"dma_err\":%lu,\"tx_busy\":%lu,",
+           (unsigned long)d.rx_pool_empty, (unsigned long)d.rx_buf_unavail,
+           (unsigned long)d.rx_missed, (unsigned long)d.rx_fifo_overflow,
+           (unsigned long)d.rx_crc_errors, (unsigned long)d.rx_align_errors,
+           (unsigned long)d.dma_errors, (unsigned long)d.tx_busy);
+  json_put(&o, "\"tcp_retrans\":%lu,\"udp_dropped\":%lu,\"udp_no_pbuf\":%lu,"
+               "\"tcp_dropped\":%lu,\"backlog_evicted\":%lu}}}\n",
+           (unsigned long)d.tcp_retrans, (unsigned long)d.udp_dropped,
+           (unsigned long)d.udp_no_pbuf, (unsigned long)d.tcp_dropped,
+           (unsigned long)d.backlog_evicted);
+
+  return o.full ? 0U : o.len;
+}
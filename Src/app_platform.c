@@ -4,14 +4,18 @@
  *
  * This module contains:
  *  - SystemClock_Config(): configures HSE + PLL and bus prescalers
- *  - MPU_Config(): configures MPU regions (cacheable SRAM + optional non-cacheable DMA region)
+ *  - MPU_Config(): configures MPU regions (write-back cached SRAM + non-cacheable DMA region)
+ *    and enables I-Cache/D-Cache
  *  - Error_Handler(): last-resort error loop with UART message
+ *  - App_GetMicros(): microsecond timestamp for telemetry
+ *  - App_CycleCounterInit()/App_GetCycles(): DWT cycle counter for benchmarks
+ *  - App_DCacheClean()/App_DCacheInvalidate(): cache maintenance for DMA buffers
  *
  * Notes:
  *  - The clock tree parameters must match your board clock source and target frequencies.
  *  - MPU region base addresses and sizes MUST be power-of-two and properly aligned.
- *  - If D-Cache is enabled, DMA buffers must be handled carefully:
- *      * either place them into a non-cacheable region (recommended), or
+ *  - D-Cache is enabled, so DMA buffers must be handled carefully:
+ *      * either place them into the non-cacheable region (APP_DMA_BUFFER), or
  *      * perform cache clean/invalidate operations around DMA transfers.
  */
 
@@ -90,13 +94,14 @@ void SystemClock_Config(void)
 /**
  * @brief Configure MPU regions and enable I-Cache/D-Cache (if present).
  *
- * Typical intent:
- *  - Region 0: general SRAM as cacheable for CPU performance
- *  - Region 1: dedicated DMA buffer area as non-cacheable to avoid coherency issues
+ * Layout (must match STM32F767ZITX_FLASH.ld):
+ *  - Region 0: 0x20000000, 512 KB, normal memory, write-back read/write-allocate
+ *  - Region 1: 0x20060000, 128 KB (RAM_NC), normal memory, non-cacheable;
+ *    overrides region 0 (higher region number wins)
  *
- * You MUST adapt:
- *  - BaseAddress and Size to match your exact SRAM map and linker placement.
- *  - DMA region must be aligned to its size and not overlap other critical areas.
+ * All DMA-visible buffers live in region 1 (ETH descriptors, RX_POOL, lwIP
+ * heap, telemetry TX pool, TCP TX ring, SPI DMA buffers). DTCM at the start
+ * of region 0 is never cached, the attribute has no effect there.
  */
 void MPU_Config(void)
 {
@@ -106,47 +111,46 @@ void MPU_Config(void)
   HAL_MPU_Disable();
 
   /* ------------------------------------------------------------------------
-   * Region 0: Cacheable SRAM region (example)
+   * Region 0: SRAM, write-back cached (TEX=1, C=1, B=1)
    * ------------------------------------------------------------------------
    * Size must be a power-of-two and BaseAddress must be aligned to Size.
-   * Adjust to match your MCU SRAM size and layout.
    */
   MPU_InitStruct.Enable           = MPU_REGION_ENABLE;
   MPU_InitStruct.Number           = MPU_REGION_NUMBER0;
   MPU_InitStruct.BaseAddress      = 0x20000000;
   MPU_InitStruct.Size             = MPU_REGION_SIZE_512KB;
   MPU_InitStruct.SubRegionDisable = 0x00;
-  MPU_InitStruct.TypeExtField     = MPU_TEX_LEVEL0;
+  MPU_InitStruct.TypeExtField     = MPU_TEX_LEVEL1;
   MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
   MPU_InitStruct.DisableExec      = MPU_INSTRUCTION_ACCESS_ENABLE;
   MPU_InitStruct.IsShareable      = MPU_ACCESS_NOT_SHAREABLE;
   MPU_InitStruct.IsCacheable      = MPU_ACCESS_CACHEABLE;
-  MPU_InitStruct.IsBufferable     = MPU_ACCESS_NOT_BUFFERABLE;
+  MPU_InitStruct.IsBufferable     = MPU_ACCESS_BUFFERABLE;
   HAL_MPU_ConfigRegion(&MPU_InitStruct);
 
   /* ------------------------------------------------------------------------
-   * Region 1: Non-cacheable DMA buffer region (example)
+   * Region 1: DMA buffers, normal memory non-cacheable (TEX=1, C=0, B=0)
    * ------------------------------------------------------------------------
-   * Place SPI/Ethernet DMA buffers into this region to avoid D-Cache coherency
-   * maintenance. The address/size shown below are examples only.
+   * Normal (not device) memory: unaligned access and memcpy() stay legal,
+   * which lwIP and the frame encoders rely on.
    */
   MPU_InitStruct.Enable           = MPU_REGION_ENABLE;
   MPU_InitStruct.Number           = MPU_REGION_NUMBER1;
-  MPU_InitStruct.BaseAddress      = 0x2007C000;           /* Example base address */
-  MPU_InitStruct.Size             = MPU_REGION_SIZE_32KB; /* Example size */
+  MPU_InitStruct.BaseAddress      = APP_DMA_RAM_BASE;
+  MPU_InitStruct.Size             = MPU_REGION_SIZE_128KB;
   MPU_InitStruct.SubRegionDisable = 0x00;
-  MPU_InitStruct.TypeExtField     = MPU_TEX_LEVEL0;
+  MPU_InitStruct.TypeExtField     = MPU_TEX_LEVEL1;
   MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
-  MPU_InitStruct.DisableExec      = MPU_INSTRUCTION_ACCESS_ENABLE;
+  MPU_InitStruct.DisableExec      = MPU_INSTRUCTION_ACCESS_DISABLE;
   MPU_InitStruct.IsShareable      = MPU_ACCESS_SHAREABLE;
   MPU_InitStruct.IsCacheable      = MPU_ACCESS_NOT_CACHEABLE;
-  MPU_InitStruct.IsBufferable     = MPU_ACCESS_BUFFERABLE;
+  MPU_InitStruct.IsBufferable     = MPU_ACCESS_NOT_BUFFERABLE;
   HAL_MPU_ConfigRegion(&MPU_InitStruct);
 
   /* Enable MPU with a default privileged map */
   HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
 
-  /* Enable caches (only do this if your memory attributes are correct) */
+  /* Enable caches (every DMA buffer is in region 1 or maintained explicitly) */
   SCB_EnableICache();
   SCB_EnableDCache();
 #else
@@ -156,6 +160,125 @@ void MPU_Config(void)
 #endif
 }
 
+/* =============================================================================
+ * Microsecond time base
+ * ============================================================================= */
+
+/**
+ * @brief Microseconds since boot.
+ *
+ * Combines the 1 ms HAL tick with the elapsed part of the current SysTick
+ * period. The tick is sampled twice so a SysTick interrupt between the two
+ * reads cannot produce a value that jumps backwards.
+ *
+ * Notes:
+ *  - Resolution is one SysTick count (1/HCLK), accuracy follows the HAL tick.
+ *  - Monotonic: wraps of HAL_GetTick() (~49.7 days) are counted into the
+ *    high word. This needs a call at least every ~24.8 days, which the main
+ *    loop guarantees.
+ *  - Callable from thread and interrupt context.
+ */
+static uint32_t s_us_last_ms = 0;   /* newest tick seen by App_GetMicros() */
+static uint32_t s_us_wraps   = 0;   /* HAL tick wraps                      */
+
+APP_ITCM uint64_t App_GetMicros(void)
+{
+  uint32_t ms;
+  uint32_t val;
+  uint32_t hi;
+
+  do {
+    ms  = HAL_GetTick();
+    val = SysTick->VAL;
+  } while (ms != HAL_GetTick());
+
+  uint32_t load = SysTick->LOAD + 1U;
+  uint32_t sub  = (uint32_t)(((uint64_t)(load - val) * 1000U) / load);
+
+  uint32_t pm = __get_PRIMASK();
+  __disable_irq();
+  if ((int32_t)(ms - s_us_last_ms) >= 0) {
+    if (ms < s_us_last_ms) s_us_wraps++;
+    s_us_last_ms = ms;
+    hi = s_us_wraps;
+  } else {
+    /* An interrupt advanced the state after our sample; if that crossed
+       the wrap, our sample still belongs to the previous epoch */
+    hi = s_us_wraps - ((ms > s_us_last_ms) ? 1U : 0U);
+  }
+  __set_PRIMASK(pm);
+
+  return ((((uint64_t)hi << 32) | ms) * 1000U) + sub;
+}
+
+/* =============================================================================
+ * Cycle counter
+ * ============================================================================= */
+
+/**
+ * @brief Enable the DWT cycle counter (idempotent).
+ */
+void App_CycleCounterInit(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55U;              /* unlock on Cortex-M7 */
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Core clock cycles (wraps every 2^32 / HCLK seconds).
+ */
+uint32_t App_GetCycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+/* =============================================================================
+ * D-cache maintenance
+ * ============================================================================= */
+
+#define DCACHE_LINE  32U
+
+/**
+ * @brief Write back cached data of [addr, addr + len) before a DMA reads it.
+ *
+ * Lines are rounded outwards; cleaning never loses data, so buffers need no
+ * particular alignment. Buffers in APP_DMA_RAM are skipped.
+ */
+void App_DCacheClean(const void *addr, uint32_t len)
+{
+#if defined (__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+  if (len == 0U || APP_IS_DMA_RAM(addr)) return;
+
+  uint32_t start = (uint32_t)addr & ~(DCACHE_LINE - 1U);
+  uint32_t end   = (uint32_t)addr + len;
+
+  SCB_CleanDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+#else
+  (void)addr;
+  (void)len;
+#endif
+}
+
+/**
+ * @brief Drop cached lines of [addr, addr + len) after a DMA wrote it.
+ *
+ * The buffer must own its cache lines (32-byte aligned start and size),
+ * otherwise neighbouring variables would lose pending writes. Buffers in
+ * APP_DMA_RAM are skipped.
+ */
+void App_DCacheInvalidate(void *addr, uint32_t len)
+{
+#if defined (__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+  if (len == 0U || APP_IS_DMA_RAM(addr)) return;
+
+  SCB_InvalidateDCache_by_Addr((uint32_t *)addr, (int32_t)len);
+#else
+  (void)addr;
+  (void)len;
+#endif
+}
+
 /* =============================================================================
  * Error handler
  * ============================================================================= */
@@ -16,10 +16,14 @@
  *  - DMA must be configured and linked to hspi1 (see MX_DMA_Init() and __HAL_LINKDMA).
  *  - Do not call blocking HAL_SPI_Transmit/Receive functions from this module.
  *  - Callbacks run in IRQ context -> keep them short.
+ *  - D-Cache is on: place tx/rx in APP_DMA_BUFFER memory (non-cacheable, no
+ *    maintenance). Buffers elsewhere are cleaned/invalidated here; an rx
+ *    buffer outside that region must then be 32-byte aligned and sized.
  */
 
 #include "app_spi.h"
 #include "spi.h"   /* provides hspi1 and HAL SPI types */
+#include "app_platform.h"   /* App_DCacheClean()/App_DCacheInvalidate() */
 
 /* =============================================================================
  * Internal state
@@ -35,6 +39,10 @@ static volatile spi_job_state_t s_state = SPI_JOB_IDLE;
 /* Last error code captured from the HAL handle (0 = no error) */
 static volatile uint32_t s_last_err = 0;
 
+/* RX buffer of the running job (invalidated again on completion) */
+static uint8_t *s_rx     = NULL;
+static uint16_t s_rx_len = 0;
+
 /* =============================================================================
  * Public API
  * ============================================================================= */
@@ -79,6 +87,13 @@ bool App_SPI_StartTxRx(uint8_t *tx, uint8_t *rx, uint16_t len)
 
   s_state = SPI_JOB_BUSY;
 
+  /* Cached buffers: DMA must see the TX bytes, and no dirty RX line may be
+     evicted on top of the incoming data */
+  App_DCacheClean(tx, len);
+  App_DCacheInvalidate(rx, len);
+  s_rx     = rx;
+  s_rx_len = len;
+
   /* Start DMA transfer (non-blocking) */
   if (HAL_SPI_TransmitReceive_DMA(&hspi1, tx, rx, len) != HAL_OK)
   {
@@ -114,6 +129,9 @@ void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
 {
   if (hspi == &hspi1)
   {
+    /* Drop lines speculatively fetched while the DMA was writing */
+    App_DCacheInvalidate(s_rx, s_rx_len);
+
     s_state = SPI_JOB_IDLE;
     /* Optional: signal an event or call an application hook here */
   }
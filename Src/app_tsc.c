@@ -0,0 +1,293 @@
+/**
+ * @file    app_tsc.c
+ * @brief   Streaming time-series compression of telemetry samples into blocks.
+ *
+ * This module provides:
+ *  - Block encoder (begin / append / finish) writing into a caller buffer
+ *  - Delta-of-delta timestamps, zigzag varint integers, Gorilla-style XOR
+ *    for the float channel, and change bits so unchanged channels are free
+ *  - On-target benchmark (compression ratio + encode cycles per sample)
+ *
+ * Design notes:
+ *  - Block layout is documented in app_tsc.h and decoded on the host by
+ *    Raspi/telemetry_decode.py.
+ *  - The predictor restarts in every block: a lost datagram only loses its
+ *    own samples.
+ *  - The XOR step is byte aligned (trailing zero bytes + significant bytes)
+ *    rather than Gorilla's bit-level windows; cheaper on the MCU and still
+ *    small for slowly drifting values.
+ */
+
+#include "app_tsc.h"
+#include "app_platform.h"  /* App_CycleCounterInit(), App_GetCycles() */
+
+#include <stdio.h>
+#include <string.h>
+
+/* =============================================================================
+ * Primitive writers
+ * ============================================================================= */
+static inline uint8_t *put_varint(uint8_t *p, uint64_t v)
+{
+  while (v >= 0x80U) {
+    *p++ = (uint8_t)(v | 0x80U);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+static inline uint64_t zigzag64(int64_t v)
+{
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline uint8_t *put_svarint(uint8_t *p, int64_t v)
+{
+  return put_varint(p, zigzag64(v));
+}
+
+/**
+ * @brief XOR of two float bit patterns, byte aligned.
+ *
+ * Control byte: bits 3..2 = trailing zero bytes, bits 1..0 = significant
+ * bytes - 1. Then the significant bytes, little-endian. x must be non-zero.
+ */
+static uint8_t *put_xor32(uint8_t *p, uint32_t x)
+{
+  uint8_t tz = 0;
+  while ((x & 0xFFU) == 0U) {
+    x >>= 8;
+    tz++;
+  }
+
+  uint8_t nb = 1;
+  while (nb < 4U && (x >> (8U * nb)) != 0U)
+    nb++;
+
+  *p++ = (uint8_t)((tz << 2) | (nb - 1U));
+  for (uint8_t i = 0; i < nb; i++)
+    *p++ = (uint8_t)(x >> (8U * i));
+
+  return p;
+}
+
+static inline void put_u16_at(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)(v);
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint32_t float_bits(float f)
+{
+  uint32_t u;
+  memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+/* =============================================================================
+ * Encoder
+ * ============================================================================= */
+
+/**
+ * @brief Start a block. The header is written now and patched by Finish().
+ */
+bool APP_TSC_Begin(AppTscEncoder *e, uint8_t *out, uint16_t cap,
+                   const AppTelemetry *t)
+{
+  if (!e || !out || !t || cap < (APP_TSC_BLOCK_HDR_LEN + APP_TSC_SAMPLE_MAX))
+    return false;
+
+  memset(e, 0, sizeof(*e));
+  e->out = out;
+  e->cap = cap;
+
+  /* Reference point: first sample gets delta 0 and no sequence gap */
+  e->prev_seq = t->seq - 1U;
+  e->prev_ts  = t->ts_us;
+
+  uint8_t *p = out;
+  p[0] = APP_FRAME_MAGIC;
+  p[1] = APP_FRAME_VERSION;
+  p[2] = APP_FRAME_TYPE_BLOCK;
+  p[3] = APP_TSC_CHANNELS;
+  /* p[4..5] length and p[18..19] count are patched in Finish() */
+
+  for (uint8_t i = 0; i < 4U; i++)
+    p[6U + i] = (uint8_t)(t->seq >> (8U * i));
+  for (uint8_t i = 0; i < 8U; i++)
+    p[10U + i] = (uint8_t)(t->ts_us >> (8U * i));
+
+  e->len = APP_TSC_BLOCK_HDR_LEN;
+  return true;
+}
+
+/**
+ * @brief Append one sample.
+ *
+ * @return Bytes written, or 0 if fewer than APP_TSC_SAMPLE_MAX bytes are left
+ *         (caller finishes the block and starts a new one).
+ */
+uint16_t APP_TSC_Append(AppTscEncoder *e, const AppTelemetry *t)
+{
+  if (!e || !e->out || !t) return 0;
+  if ((uint16_t)(e->cap - e->len) < APP_TSC_SAMPLE_MAX) return 0;
+  if (e->count == 0xFFFFU) return 0;
+
+  uint8_t *start = e->out + e->len;
+  uint8_t *p     = start + 1;           /* ctrl byte patched below */
+  uint8_t  ctrl  = 0;
+
+  /* Timestamp: delta-of-delta */
+  int64_t delta = (int64_t)(t->ts_us - e->prev_ts);
+  p = put_svarint(p, delta - e->prev_delta);
+  e->prev_ts    = t->ts_us;
+  e->prev_delta = delta;
+
+  if (t->valid != e->prev_valid) {
+    ctrl |= APP_TSC_CTRL_VALID;
+    *p++ = t->valid;
+    e->prev_valid = t->valid;
+  }
+
+  if (t->seq != (uint32_t)(e->prev_seq + 1U)) {
+    ctrl |= APP_TSC_CTRL_SEQ_GAP;
+    p = put_varint(p, (uint32_t)(t->seq - e->prev_seq - 1U));
+  }
+  e->prev_seq = t->seq;
+
+  if (t->valid & APP_TLM_VALID_I2C) {
+    uint32_t bits = float_bits(t->i2c_temp_f);
+    if (bits != e->prev_temp_bits) {
+      ctrl |= APP_TSC_CH_I2C_TEMP;
+      p = put_xor32(p, bits ^ e->prev_temp_bits);
+      e->prev_temp_bits = bits;
+    }
+  }
+
+  if ((t->valid & APP_TLM_VALID_CAN101) && t->can_hb_seq != e->prev_hb_seq) {
+    ctrl |= APP_TSC_CH_CAN_HB_SEQ;
+    p = put_svarint(p, (int64_t)t->can_hb_seq - e->prev_hb_seq);
+    e->prev_hb_seq = t->can_hb_seq;
+  }
+
+  if (t->valid & APP_TLM_VALID_CAN120) {
+    if (t->can_lux_x100 != e->prev_lux) {
+      ctrl |= APP_TSC_CH_CAN_LUX;
+      p = put_svarint(p, (int64_t)t->can_lux_x100 - (int64_t)e->prev_lux);
+      e->prev_lux = t->can_lux_x100;
+    }
+    if (t->can_full != e->prev_full) {
+      ctrl |= APP_TSC_CH_CAN_FULL;
+      p = put_svarint(p, (int64_t)t->can_full - e->prev_full);
+      e->prev_full = t->can_full;
+    }
+    if (t->can_ir != e->prev_ir) {
+      ctrl |= APP_TSC_CH_CAN_IR;
+      p = put_svarint(p, (int64_t)t->can_ir - e->prev_ir);
+      e->prev_ir = t->can_ir;
+    }
+  }
+
+  *start = ctrl;
+
+  uint16_t n = (uint16_t)(p - start);
+  e->len = (uint16_t)(e->len + n);
+  e->count++;
+  return n;
+}
+
+/**
+ * @brief Patch frame length and sample count into the block header.
+ */
+uint16_t APP_TSC_Finish(AppTscEncoder *e)
+{
+  if (!e || !e->out) return 0;
+
+  put_u16_at(e->out + 4, e->len);
+  put_u16_at(e->out + APP_FRAME_HDR_LEN, e->count);
+  return e->len;
+}
+
+/* =============================================================================
+ * Benchmark
+ * ============================================================================= */
+
+/**
+ * @brief Deterministic test signal resembling the real channels.
+ *
+ * Temperature drifts by 1/16 degC steps, lux ramps slowly, full/ir follow lux,
+ * the ESP32 heartbeat ticks at 1 Hz, timestamps carry +-20 us jitter.
+ */
+static void bench_sample(uint32_t i, uint32_t sample_hz, AppTelemetry *t)
+{
+  uint32_t period_us = 1000000U / sample_hz;
+  uint32_t noise     = (i * 2654435761U) >> 27;        /* 0..31 */
+
+  memset(t, 0, sizeof(*t));
+
+  t->seq          = i;
+  t->ts_us        = 1000000ULL + (uint64_t)i * period_us + noise - 16U;
+  t->now_ms       = (uint32_t)(t->ts_us / 1000U);
+  t->valid        = APP_TLM_VALID_I2C | APP_TLM_VALID_CAN101 | APP_TLM_VALID_CAN120;
+  t->i2c_temp_f   = 21.5f + (float)((i / (sample_hz / 2U + 1U)) % 8U) * 0.0625f;
+  t->i2c_temp_c   = (int32_t)t->i2c_temp_f;
+  t->can_hb_seq   = (uint8_t)(i / sample_hz);
+  t->can_lux_x100 = 12000U + (i / (sample_hz / 10U + 1U)) * 3U;
+  t->can_full     = (uint16_t)(t->can_lux_x100 / 40U);
+  t->can_ir       = (uint16_t)(t->can_lux_x100 / 160U);
+
+  snprintf(t->can_0x101, sizeof(t->can_0x101), "hb seq=%u", t->can_hb_seq);
+  snprintf(t->can_0x120, sizeof(t->can_0x120), "lux=%lu.%02lu full=%u ir=%u",
+           (unsigned long)(t->can_lux_x100 / 100U),
+           (unsigned long)(t->can_lux_x100 % 100U),
+           t->can_full, t->can_ir);
+}
+
+/**
+ * @brief Encode nsamples of the test signal in MTU-sized blocks and compare
+ *        against the binary and JSON encodings.
+ *
+ * Only APP_TSC_Append() is timed (DWT cycle counter).
+ */
+void APP_TSC_Benchmark(uint16_t nsamples, uint32_t sample_hz, AppTscBench *out)
+{
+  static uint8_t block[1472];
+  uint8_t frame[256];
+  AppTscEncoder enc;
+  AppTelemetry  t;
+
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+  if (sample_hz == 0U) sample_hz = 1U;
+
+  App_CycleCounterInit();
+
+  bool open = false;
+
+  for (uint16_t i = 0; i < nsamples; i++) {
+    bench_sample(i, sample_hz, &t);
+
+    out->bytes_bin  += APP_FRAME_EncodeBinary(&t, frame, (uint16_t)sizeof(frame));
+    out->bytes_json += APP_FRAME_EncodeJSON(&t, frame, (uint16_t)sizeof(frame));
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+      if (!open)
+        open = APP_TSC_Begin(&enc, block, (uint16_t)sizeof(block), &t);
+
+      uint32_t c0 = App_GetCycles();
+      uint16_t n  = APP_TSC_Append(&enc, &t);
+      out->cycles += App_GetCycles() - c0;
+
+      if (n != 0U) break;
+
+      out->bytes_delta += APP_TSC_Finish(&enc);
+      open = false;
+    }
+
+    out->samples++;
+  }
+
+  if (open)
+    out->bytes_delta += APP_TSC_Finish(&enc);
+}
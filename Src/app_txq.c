@@ -0,0 +1,203 @@
+/**
+ * @file    app_txq.c
+ * @brief   Byte ring of encoded frames for zero-copy TCP transmit.
+ *
+ * This module provides:
+ *  - Reserve/commit API so encoders write frames straight into the ring
+ *  - In-order hand-off of queued frames to tcp_write() without TCP_WRITE_FLAG_COPY
+ *  - Release of ring memory by acknowledged byte count (on_tcp_sent)
+ *
+ * Design notes:
+ *  - Each frame occupies one contiguous span of the ring; a frame that does not
+ *    fit before the end of the buffer starts again at offset 0 (the tail gap is
+ *    skipped). Consecutive frames are adjacent in memory, which lets lwIP extend
+ *    the previous PBUF_ROM instead of chaining one pbuf per frame.
+ *  - Memory of a frame handed to TCP stays pinned until its last byte is ACKed.
+ *  - Descriptor counters are free-running uint16; ndesc must be a power of two.
+ *  - Not interrupt safe: producer and lwIP callbacks both run in the main loop.
+ */
+
+#include "app_txq.h"
+
+#include <stddef.h>
+
+/* =============================================================================
+ * Helpers
+ * ============================================================================= */
+static inline AppTxqDesc *desc_at(const AppTxQueue *q, uint16_t idx)
+{
+  return &q->desc[idx & (uint16_t)(q->ndesc - 1U)];
+}
+
+/* =============================================================================
+ * Init
+ * ============================================================================= */
+
+/**
+ * @brief Bind a queue to caller-provided storage.
+ *
+ * @param ndesc Number of descriptor slots, must be a power of two.
+ */
+void APP_TXQ_Init(AppTxQueue *q, uint8_t *buf, uint16_t size,
+                  AppTxqDesc *desc, uint16_t ndesc)
+{
+  if (!q) return;
+
+  q->buf   = buf;
+  q->size  = size;
+  q->desc  = desc;
+  q->ndesc = ndesc;
+
+  (void)APP_TXQ_Reset(q);
+}
+
+/* =============================================================================
+ * Producer side
+ * ============================================================================= */
+
+/**
+ * @brief Reserve up to max_len contiguous bytes for the next frame.
+ *
+ * @return Write pointer, or NULL if the ring (bytes or descriptors) is full.
+ *         Must be followed by APP_TXQ_Commit() before any other queue call.
+ */
+uint8_t *APP_TXQ_Reserve(AppTxQueue *q, uint16_t max_len)
+{
+  if (!q || max_len == 0U || max_len > q->size) return NULL;
+
+  uint16_t count = (uint16_t)(q->head - q->tail);
+  if (count >= q->ndesc) return NULL;
+
+  /* Empty ring: restart at the beginning, no fragmentation */
+  if (count == 0U) {
+    q->wr      = 0;
+    q->res_off = 0;
+    return q->buf;
+  }
+
+  uint16_t rd = desc_at(q, q->tail)->off;
+
+  if (q->wr > rd) {
+    /* Used span is [rd, wr): free space at the end, then before rd */
+    if ((uint16_t)(q->size - q->wr) >= max_len)
+      q->res_off = q->wr;
+    else if (rd >= max_len)
+      q->res_off = 0;
+    else
+      return NULL;
+  } else {
+    /* Wrapped: free space is [wr, rd) */
+    if ((uint16_t)(rd - q->wr) >= max_len)
+      q->res_off = q->wr;
+    else
+      return NULL;
+  }
+
+  return q->buf + q->res_off;
+}
+
+/**
+ * @brief Commit the frame written into the last reservation.
+ */
+void APP_TXQ_Commit(AppTxQueue *q, uint16_t len)
+{
+  if (!q || len == 0U) return;
+
+  AppTxqDesc *d = desc_at(q, q->head);
+  d->off = q->res_off;
+  d->len = len;
+
+  q->wr = (uint16_t)(q->res_off + len);
+  q->head++;
+}
+
+/* =============================================================================
+ * Transmit side
+ * ============================================================================= */
+
+/**
+ * @brief Get the oldest frame that has not been written to TCP yet.
+ */
+bool APP_TXQ_PeekUnsent(const AppTxQueue *q, const uint8_t **data, uint16_t *len)
+{
+  if (!q || q->sent == q->head) return false;
+
+  const AppTxqDesc *d = desc_at(q, q->sent);
+  if (data) *data = q->buf + d->off;
+  if (len)  *len  = d->len;
+
+  return true;
+}
+
+/**
+ * @brief Mark the frame returned by APP_TXQ_PeekUnsent() as handed to TCP.
+ */
+void APP_TXQ_MarkSent(AppTxQueue *q)
+{
+  if (!q || q->sent == q->head) return;
+  q->sent++;
+}
+
+/**
+ * @brief Release acknowledged bytes.
+ *
+ * TCP acknowledges bytes in the order they were written, so frames are
+ * released from the tail. A partial ACK is remembered in q->acked.
+ */
+uint16_t APP_TXQ_Ack(AppTxQueue *q, uint32_t bytes)
+{
+  uint16_t released = 0;
+
+  if (!q) return 0;
+
+  while (bytes > 0U && q->tail != q->sent) {
+    const AppTxqDesc *d = desc_at(q, q->tail);
+    uint16_t rem = (uint16_t)(d->len - q->acked);
+
+    if (bytes >= rem) {
+      bytes   -= rem;
+      q->acked = 0;
+      q->tail++;
+      released++;
+    } else {
+      q->acked = (uint16_t)(q->acked + bytes);
+      bytes    = 0;
+    }
+  }
+
+  return released;
+}
+
+/**
+ * @brief Drop all frames (queued and in flight).
+ *
+ * Only call once lwIP no longer references the memory (PCB closed/aborted).
+ */
+uint16_t APP_TXQ_Reset(AppTxQueue *q)
+{
+  if (!q) return 0;
+
+  uint16_t n = (uint16_t)(q->head - q->tail);
+
+  q->tail    = q->head;
+  q->sent    = q->head;
+  q->acked   = 0;
+  q->wr      = 0;
+  q->res_off = 0;
+
+  return n;
+}
+
+/* =============================================================================
+ * Occupancy
+ * ============================================================================= */
+
+uint16_t APP_TXQ_Queued(const AppTxQueue *q)
+{
+  return q ? (uint16_t)(q->head - q->sent) : 0U;
+}
+
+uint16_t APP_TXQ_InFlight(const AppTxQueue *q)
+{
+  return q ? (uint16_t)(q->sent - q->tail) : 0U;
+}
@@ -1,24 +1,68 @@
 /**
  * @file    can.c
- * @brief   CAN1 initialization and RX snapshot decoding for two standard IDs.
+ * @brief   CAN1 initialization, hardware filters, RX frame rings, decoding and
+ *          a prioritized TX queue.
  *
  * This module provides:
- *  - CAN1 MSP init (GPIO + IRQ)
+ *  - CAN1 MSP init (GPIO + IRQs)
  *  - CAN1 init for a "robust" 500 kbit/s timing (as configured)
- *  - Filter configuration (accept all, FIFO0)
- *  - RX interrupt callback that decodes:
+ *  - Filter banks programmed from the IDs of the signal table
+ *    (can_db_table.h, packed by can_filter.c): high-priority IDs into
+ *    FIFO1, the others into FIFO0, every other ID rejected in hardware
+ *  - RX interrupt callbacks (one per FIFO) that only copy frames, with their
+ *    arrival time, into a lock-free SPSC ring per FIFO
+ *  - CAN1_Service() (main loop) decoding the queued frames (FIFO1 first)
+ *    with the signal table (can_db.c):
  *      * 0x101: heartbeat sequence byte
  *      * 0x120: light sensor payload (8 bytes, little-endian fields)
- *  - Text getters for UI and structured getters for app logic
+ *  - Text getters for UI and structured getters for app logic (wrappers
+ *    around the table's messages and signals)
+ *  - Optional raw frame capture into a second ring (event-driven telemetry
+ *    push, see app_net.c)
+ *  - CAN1_Send(): a software queue ordered like bus arbitration (lower ID
+ *    first, FIFO within an ID) that the TX-complete interrupt feeds into
+ *    the three mailboxes, with per-frame deadlines and statistics
+ *  - Error interrupt (SCE) and the feed of the bus statistics (can_stats.c):
+ *    every received / sent / rejected frame, ESR, FIFO overruns
  *
  * Design notes:
- *  - ISR (RX callback) updates "snapshots" and formatted text buffers.
- *  - Getter functions implement a simple freshness timeout (2 seconds).
- *  - No TX is implemented here; only RX is handled.
+ *  - The ISRs empty their FIFO (3 frames deep) on every interrupt and do no
+ *    formatting, so back-to-back frames at full bus load cannot overrun it.
+ *    Overruns and a full ring are counted, not hidden.
+ *  - Arrival time: time-triggered mode makes bxCAN stamp each frame with
+ *    its bit-time counter at start of frame. The ISR entry time is taken
+ *    for the newest frame of a batch; older ones are dated back by their
+ *    counter difference, so frames read together keep their real spacing.
+ *  - Rejected frames: bxCAN does not count frames its filters drop. One
+ *    spare bank accepts everything into FIFO0; it is opened for
+ *    CAN1_FILTER_SURVEY_WINDOW_MS every CAN1_FILTER_SURVEY_PERIOD_MS and
+ *    the frames it lets in are scaled up to the whole period. The same bank
+ *    stays open while raw capture runs (the push forwards every frame) and
+ *    when the table cannot be packed.
+ *  - Text is formatted only when a getter asks for it and the value changed.
+ *  - Freshness timeouts (2 seconds) come from the table.
+ *  - TX never blocks: CAN1_Send() queues and returns. A full queue drops
+ *    its lowest-priority frame for a higher-priority one, or refuses.
+ *    A frame whose ID already occupies a mailbox waits, so frames of one
+ *    ID leave in order (the hardware picks among mailboxes by ID only).
+ *    When all mailboxes hold lower-priority frames than the best queued
+ *    one, the worst mailbox is aborted and its frame re-queued. Frames past
+ *    their deadline are dropped from the queue or aborted in the mailbox
+ *    (CAN1_Service()); without a deadline a frame nobody ACKs is retried
+ *    forever by the hardware and holds its mailbox.
+ *  - TX state is shared by CAN1_Service()/CAN1_Send() and the TX interrupt;
+ *    the main loop side masks interrupts for the few list operations.
+ *  - RX rings: each ISR is the only writer of its ring's head, CAN1_Service()
+ *    the only writer of the tails. A full ring drops the new frame (counted).
+ *  - Each CAN IRQ handler serves only its own source (see stm32f7xx_it.c):
+ *    HAL_CAN_IRQHandler() would dispatch every enabled source from any of
+ *    them and break the single-producer rings.
  */
 
 #include "can.h"
-#include <string.h>
+#include "can_db.h"
+#include "can_stats.h"
+#include "app_platform.h"   /* App_GetMicros() */
 #include <stdio.h>
 
 /* =============================================================================
@@ -27,41 +71,118 @@
 CAN_HandleTypeDef hcan1;
 
 /* =============================================================================
- * Snapshot state (updated from IRQ)
+ * RX frame rings (single producer: RX ISR of the FIFO, single consumer:
+ * CAN1_Service()), indexed by CAN_RX_FIFO0 / CAN_RX_FIFO1
  * ============================================================================= */
-static volatile uint8_t  s_has101   = 0;
-static volatile uint8_t  s_has120   = 0;
+#if (CAN1_RX_RING_SIZE & (CAN1_RX_RING_SIZE - 1U)) != 0U || CAN1_RX_RING_SIZE > 32768U
+#error "CAN1_RX_RING_SIZE must be a power of two (<= 32768)"
+#endif
+#if (CAN1_RX1_RING_SIZE & (CAN1_RX1_RING_SIZE - 1U)) != 0U || CAN1_RX1_RING_SIZE > 32768U
+#error "CAN1_RX1_RING_SIZE must be a power of two (<= 32768)"
+#endif
+#if (CAN1_RAW_RING_SIZE & (CAN1_RAW_RING_SIZE - 1U)) != 0U || CAN1_RAW_RING_SIZE > 32768U
+#error "CAN1_RAW_RING_SIZE must be a power of two (<= 32768)"
+#endif
 
-static volatile uint8_t  s_hb_seq   = 0;
-static volatile uint32_t s_lux_x100 = 0; /* lux value scaled by 100 */
-static volatile uint16_t s_full     = 0;
-static volatile uint16_t s_ir       = 0;
+typedef struct
+{
+  CAN1_RawFrame    *buf;
+  uint16_t          size;
+  volatile uint16_t head;
+  volatile uint16_t tail;
+  volatile uint32_t overflow;
+  volatile uint32_t ignored;
+  volatile uint8_t  max_batch;
+  uint32_t          fifo_overrun;
+  uint32_t          frames;
+  uint16_t          max_pending;
+} rx_ring_t;
+
+static CAN1_RawFrame s_rx0_buf[CAN1_RX_RING_SIZE]  APP_DTCM;
+static CAN1_RawFrame s_rx1_buf[CAN1_RX1_RING_SIZE] APP_DTCM;
+
+static rx_ring_t s_rx[2] APP_DTCM_DATA = {
+  [CAN_RX_FIFO0] = { .buf = s_rx0_buf, .size = CAN1_RX_RING_SIZE  },
+  [CAN_RX_FIFO1] = { .buf = s_rx1_buf, .size = CAN1_RX1_RING_SIZE },
+};
+
+/* Nominal bit time in ns (bxCAN timer unit), set by CAN1_Start() */
+static uint32_t s_bit_ns = 2000u;
 
 /* =============================================================================
- * Last text buffers + timestamps (used by UI getters)
+ * Hardware filters
  * ============================================================================= */
-static char     s_last_txt[128] = "no data";
-static char     s_101_txt[128]  = "none";
-static char     s_120_txt[128]  = "none";
-static uint32_t s_last_tick     = 0;
-static uint32_t s_101_tick      = 0;
-static uint32_t s_120_tick      = 0;
+_Static_assert(CAN_DB_MSG_COUNT <= CAN_FLT_IDS_MAX, "too many table IDs for the filter packer");
+
+static CanFltBank   s_flt[CAN_FLT_BANKS_MAX];
+static CanFltResult s_flt_res;
+static uint8_t      s_flt_open_bank = 0;     /* accept-all bank (FIFO0)             */
+static bool         s_flt_ready     = false; /* banks programmed                    */
+static bool         s_flt_fallback  = false; /* table not packable: bank always open */
+
+/* Survey of what the filters reject (main loop only) */
+static bool     s_survey_open    = false;
+static bool     s_survey_valid   = false;  /* s_survey_t0/_len describe a window */
+static uint32_t s_survey_t0      = 0;      /* start of the last window           */
+static uint32_t s_survey_len     = 0;      /* length of the last window          */
+static uint32_t s_survey_outside = 0;      /* s_outside at the start of it       */
+static uint32_t s_surveys        = 0;
+static uint32_t s_outside        = 0;      /* frames only the open bank let in   */
+static uint64_t s_rejected_est   = 0;
 
 /* =============================================================================
- * Little-endian helpers (payload decoding)
+ * TX queue and mailboxes (main loop with interrupts masked, TX ISR)
  * ============================================================================= */
-static inline uint32_t u32_le(const uint8_t *p)
+#define CAN1_TX_MAILBOXES   3U
+
+typedef struct
 {
-  return ((uint32_t)p[0])       |
-         ((uint32_t)p[1] << 8)  |
-         ((uint32_t)p[2] << 16) |
-         ((uint32_t)p[3] << 24);
-}
+  uint64_t t_us;            /* queued at (App_GetMicros())        */
+  uint32_t expire_ms;       /* HAL tick; valid if has_deadline    */
+  uint32_t seq;             /* FIFO order within an ID            */
+  uint16_t id;
+  uint8_t  dlc;
+  uint8_t  has_deadline;
+  uint8_t  data[8];
+} tx_frame_t;
 
-static inline uint16_t u16_le(const uint8_t *p)
+typedef enum
 {
-  return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
-}
+  TX_ABORT_NONE = 0,
+  TX_ABORT_EXPIRED,         /* deadline passed in the mailbox     */
+  TX_ABORT_PREEMPT          /* make room for a higher priority    */
+} tx_abort_t;
+
+typedef struct
+{
+  tx_frame_t f;
+  uint8_t    busy;
+  uint8_t    abort;         /* tx_abort_t requested               */
+} tx_mailbox_t;
+
+/* Sorted by priority, best at the end (pop without moving the rest) */
+static tx_frame_t   s_txq[CAN1_TX_QUEUE_SIZE];
+static uint16_t     s_txq_n   = 0;
+static uint32_t     s_tx_seq  = 0;
+static tx_mailbox_t s_tx_mb[CAN1_TX_MAILBOXES];
+static CAN1_TxStats s_tx_st;
+
+/* =============================================================================
+ * Text cache (formatted on demand, per table message)
+ * ============================================================================= */
+static char     s_txt[CAN_DB_MSG_COUNT][128];
+static uint32_t s_txt_frames[CAN_DB_MSG_COUNT]; /* CAN_DB_MsgFrames() at formatting */
+static int16_t  s_last_msg  = -1;               /* last decoded message */
+static uint32_t s_last_tick = 0;
+
+/* =============================================================================
+ * Raw frame capture ring (producer: CAN1_Service(), consumer: app_net.c)
+ * ============================================================================= */
+static CAN1_RawFrame     s_raw_ring[CAN1_RAW_RING_SIZE] APP_DTCM;
+static volatile uint16_t s_raw_head     = 0;
+static volatile uint16_t s_raw_tail     = 0;
+static volatile uint8_t  s_raw_enabled  = 0;
+static volatile uint32_t s_raw_overflow = 0;
 
 /* =============================================================================
  * MSP init: CAN1 pins + IRQ
@@ -73,8 +194,11 @@ static inline uint16_t u16_le(const uint8_t *p)
  * Pin mapping (board/MCU dependent):
  *  - PD0 / PD1 configured as AF9 CAN1
  *
- * Interrupt:
- *  - Enables CAN1_RX0_IRQn (FIFO0 message pending interrupt)
+ * Interrupts:
+ *  - CAN1_RX1_IRQn (FIFO1, high-priority IDs): priority 4
+ *  - CAN1_RX0_IRQn (FIFO0): priority 5
+ *  - CAN1_TX_IRQn (mailbox empty): priority 6
+ *  - CAN1_SCE_IRQn (errors, bus-off): priority 6
  */
 void HAL_CAN_MspInit(CAN_HandleTypeDef* hcan)
 {
@@ -94,6 +218,12 @@ void HAL_CAN_MspInit(CAN_HandleTypeDef* hcan)
 
     HAL_NVIC_SetPriority(CAN1_RX0_IRQn, 5, 0);
     HAL_NVIC_EnableIRQ(CAN1_RX0_IRQn);
+    HAL_NVIC_SetPriority(CAN1_RX1_IRQn, 4, 0);
+    HAL_NVIC_EnableIRQ(CAN1_RX1_IRQn);
+    HAL_NVIC_SetPriority(CAN1_TX_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(CAN1_TX_IRQn);
+    HAL_NVIC_SetPriority(CAN1_SCE_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(CAN1_SCE_IRQn);
   }
 }
 
@@ -118,13 +248,13 @@ void MX_CAN1_Init(void)
   hcan1.Init.TimeSeg1      = CAN_BS1_3TQ;
   hcan1.Init.TimeSeg2      = CAN_BS2_2TQ;
 
-  /* Robustness / behavior */
-  hcan1.Init.TimeTriggeredMode      = DISABLE;
+  /* Robustness / behavior (time-triggered mode only for the RX timestamps) */
+  hcan1.Init.TimeTriggeredMode      = ENABLE;
   hcan1.Init.AutoBusOff             = ENABLE;
   hcan1.Init.AutoWakeUp             = DISABLE;
   hcan1.Init.AutoRetransmission     = ENABLE;
   hcan1.Init.ReceiveFifoLocked      = DISABLE;
-  hcan1.Init.TransmitFifoPriority   = DISABLE;
+  hcan1.Init.TransmitFifoPriority   = DISABLE;  /* mailboxes leave by ID priority */
 
   if (HAL_CAN_Init(&hcan1) != HAL_OK)
     Error_Handler();
@@ -135,129 +265,750 @@ void MX_CAN1_Init(void)
  * ============================================================================= */
 
 /**
- * @brief Configure filter (accept all) and start CAN with FIFO0 RX interrupt.
+ * @brief Open/close the accept-all bank (FA1R may change while running).
+ */
+static void filter_open(bool on)
+{
+  if (!s_flt_ready) return;
+
+  if (on || s_flt_fallback) SET_BIT(hcan1.Instance->FA1R, 1UL << s_flt_open_bank);
+  else                      CLEAR_BIT(hcan1.Instance->FA1R, 1UL << s_flt_open_bank);
+}
+
+/**
+ * @brief Program the filter banks from the table's IDs.
  *
- * Filter configuration:
- *  - ID mask mode, 32-bit scale
- *  - All IDs accepted (ID=0, MASK=0)
- *  - Assigned to FIFO0
+ * Banks 0..n-1: the packed table IDs (16-bit scale, FIFO1 banks first).
+ * Bank n:       accept-all (16-bit mask 0, FIFO0), active only when open.
+ * List entries win over masks, lower banks over higher ones, so the open
+ * bank never steals a table ID from its FIFO.
  */
-void CAN1_Start(void)
+static void filters_config(void)
 {
+  CanFltId ids[CAN_DB_MSG_COUNT];
   CAN_FilterTypeDef f = {0};
 
-  f.FilterBank           = 0;
+  for (uint32_t m = 0; m < CAN_DB_MSG_COUNT; m++)
+  {
+    CanDbMsgInfo mi;
+    CAN_DB_GetMsgInfo((CanDbMsg)m, 0u, &mi);
+    ids[m].id   = mi.id;
+    ids[m].fifo = mi.fifo;
+  }
+
+  s_flt_fallback = !CAN_FLT_Pack(ids, CAN_DB_MSG_COUNT, CAN_FLT_BANKS_MAX - 1U,
+                                 s_flt, &s_flt_res);
+  if (s_flt_fallback)
+  {
+    CanFltResult none = {0};
+    s_flt_res = none;
+  }
+
+  /* For dual CAN devices; CAN1 owns banks 0..13 */
+  f.SlaveStartFilterBank = CAN_FLT_BANKS_MAX;
+  f.FilterScale          = CAN_FILTERSCALE_16BIT;
+  f.FilterActivation     = CAN_FILTER_ENABLE;
+
+  for (uint8_t b = 0; b < s_flt_res.banks; b++)
+  {
+    uint32_t regs[4];
+    CAN_FLT_BankRegs(&s_flt[b], regs);
+
+    f.FilterBank           = b;
+    f.FilterMode           = s_flt[b].mask_mode ? CAN_FILTERMODE_IDMASK : CAN_FILTERMODE_IDLIST;
+    f.FilterFIFOAssignment = (s_flt[b].fifo != 0u) ? CAN_FILTER_FIFO1 : CAN_FILTER_FIFO0;
+    f.FilterIdHigh         = regs[0];
+    f.FilterIdLow          = regs[1];
+    f.FilterMaskIdHigh     = regs[2];
+    f.FilterMaskIdLow      = regs[3];
+
+    if (HAL_CAN_ConfigFilter(&hcan1, &f) != HAL_OK) Error_Handler();
+  }
+
+  /* Accept-all bank: 16-bit like the others, so it never outranks them */
+  s_flt_open_bank        = s_flt_res.banks;
+  f.FilterBank           = s_flt_open_bank;
   f.FilterMode           = CAN_FILTERMODE_IDMASK;
-  f.FilterScale          = CAN_FILTERSCALE_32BIT;
   f.FilterFIFOAssignment = CAN_FILTER_FIFO0;
-  f.FilterActivation     = ENABLE;
+  f.FilterIdHigh         = 0;
+  f.FilterIdLow          = 0;
+  f.FilterMaskIdHigh     = 0;
+  f.FilterMaskIdLow      = 0;
+  f.FilterActivation     = (s_flt_fallback || s_raw_enabled) ? CAN_FILTER_ENABLE
+                                                           : CAN_FILTER_DISABLE;
 
-  /* For dual CAN devices; harmless on single CAN use */
-  f.SlaveStartFilterBank = 14;
+  if (HAL_CAN_ConfigFilter(&hcan1, &f) != HAL_OK) Error_Handler();
+  s_flt_ready = true;
+}
 
-  /* Accept all IDs */
-  f.FilterIdHigh      = 0;
-  f.FilterIdLow       = 0;
-  f.FilterMaskIdHigh  = 0;
-  f.FilterMaskIdLow   = 0;
+/**
+ * @brief Configure the filters and start CAN with the RX FIFO0/FIFO1, TX
+ *        mailbox empty and error interrupts.
+ */
+void CAN1_Start(void)
+{
+  /* Bit time = prescaler * (SYNC + BS1 + BS2) time quanta of PCLK1 */
+  uint32_t tq = 1u + ((hcan1.Init.TimeSeg1 >> CAN_BTR_TS1_Pos) + 1u)
+                   + ((hcan1.Init.TimeSeg2 >> CAN_BTR_TS2_Pos) + 1u);
+  uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+  if (pclk1 != 0u)
+    s_bit_ns = (uint32_t)(((uint64_t)hcan1.Init.Prescaler * tq * 1000000000ull) / pclk1);
+  CAN_STATS_Configure(s_bit_ns);
 
-  if (HAL_CAN_ConfigFilter(&hcan1, &f) != HAL_OK) Error_Handler();
-  if (HAL_CAN_Start(&hcan1) != HAL_OK)            Error_Handler();
+  filters_config();
+
+  if (HAL_CAN_Start(&hcan1) != HAL_OK) Error_Handler();
 
-  /* Enable IRQ on RX FIFO0 message pending */
-  if (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK)
+  /* Enable IRQ on RX FIFO0 / FIFO1 message pending, TX complete and errors
+     (error warning / passive, bus-off, every error frame via LEC) */
+  if (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING |
+                                           CAN_IT_RX_FIFO1_MSG_PENDING |
+                                           CAN_IT_TX_MAILBOX_EMPTY |
+                                           CAN_IT_ERROR_WARNING | CAN_IT_ERROR_PASSIVE |
+                                           CAN_IT_BUSOFF | CAN_IT_LAST_ERROR_CODE |
+                                           CAN_IT_ERROR) != HAL_OK)
     Error_Handler();
 }
 
 /* =============================================================================
- * RX callback (ISR context)
+ * RX callbacks (ISR context)
  * ============================================================================= */
 
 /**
- * @brief RX FIFO0 message pending callback.
+ * @brief Empty one RX FIFO into its ring: queue the frames, nothing else.
  *
- * Decoding rules:
- *  - Only standard ID, data frames
- *  - 0x101: DLC >= 1, d[0] = heartbeat sequence
- *  - 0x120: DLC == 8, fields:
- *      * d[0..3] : lux_x100 (uint32 little-endian)
- *      * d[4..5] : full     (uint16 little-endian)
- *      * d[6..7] : ir       (uint16 little-endian)
+ * Takes every frame in the FIFO (up to 3); only standard ID data frames are
+ * kept. When the ring is full the frame is still read, so the FIFO keeps
+ * space for the next one, and counted as ring overflow.
  *
  * Important:
- *  - This runs in interrupt context. Keep it short.
- *  - It updates shared variables; getters may read them concurrently.
+ *  - This runs in interrupt context. Keep it short: no formatting, no
+ *    decoding (see CAN1_Service()).
  */
-void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
+APP_ITCM static void rx_drain(CAN_HandleTypeDef *hcan, uint32_t fifo)
 {
-  if (hcan->Instance != CAN1) return;
-
+  rx_ring_t          *r = &s_rx[fifo];
   CAN_RxHeaderTypeDef rh;
-  uint8_t d[8];
+  uint16_t mask   = (uint16_t)(r->size - 1U);
+  uint64_t now_us = App_GetMicros();
+  uint16_t first  = r->head;
+  uint16_t head   = first;
 
-  if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rh, d) != HAL_OK) return;
-  if (rh.IDE != CAN_ID_STD)  return;
-  if (rh.RTR != CAN_RTR_DATA) return;
+  while (HAL_CAN_GetRxFifoFillLevel(hcan, fifo) != 0u)
+  {
+    if ((uint16_t)(head - r->tail) >= r->size)
+    {
+      uint8_t discard[8];
+      (void)HAL_CAN_GetRxMessage(hcan, fifo, &rh, discard);
+      r->overflow++;
+      continue;
+    }
 
-  uint32_t now = HAL_GetTick();
-  s_last_tick = now;
+    CAN1_RawFrame *f = &r->buf[head & mask];
+    if (HAL_CAN_GetRxMessage(hcan, fifo, &rh, f->data) != HAL_OK) break;
+
+    if (rh.IDE != CAN_ID_STD || rh.RTR != CAN_RTR_DATA)
+    {
+      r->ignored++;
+      continue;
+    }
+
+    f->hw_ts = (uint16_t)rh.Timestamp;
+    f->id    = (uint16_t)rh.StdId;
+    f->dlc   = (uint8_t)((rh.DLC > 8u) ? 8u : rh.DLC);
+    head++;
+  }
+
+  if (head == first) return;
+
+  /* Date the batch back from the newest frame by the bxCAN timer */
+  uint16_t hw_last = r->buf[(uint16_t)(head - 1U) & mask].hw_ts;
+  for (uint16_t i = first; i != head; i++)
+  {
+    CAN1_RawFrame *f = &r->buf[i & mask];
+    f->ts_us = now_us - ((uint32_t)(uint16_t)(hw_last - f->hw_ts) * s_bit_ns) / 1000u;
+  }
+
+  if ((uint16_t)(head - first) > r->max_batch)
+    r->max_batch = (uint8_t)(head - first);
+
+  __DMB();                    /* frame contents visible before the index */
+  r->head = head;
+}
+
+APP_ITCM void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+  if (hcan->Instance == CAN1) rx_drain(hcan, CAN_RX_FIFO0);
+}
+
+APP_ITCM void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+  if (hcan->Instance == CAN1) rx_drain(hcan, CAN_RX_FIFO1);
+}
+
+/* =============================================================================
+ * TX queue (main loop + TX ISR)
+ * ============================================================================= */
+
+/* a goes before b: lower ID, then queued earlier */
+static inline bool tx_before(const tx_frame_t *a, const tx_frame_t *b)
+{
+  return (a->id != b->id) ? (a->id < b->id) : ((int32_t)(a->seq - b->seq) < 0);
+}
 
-  /* --------- 0x101: Heartbeat -------------------------------------------- */
-  if (rh.StdId == 0x101u && rh.DLC >= 1u)
+/**
+ * @brief Insert by priority. A full queue loses its lowest-priority frame,
+ *        which may be f itself.
+ *
+ * @return 1 if f was queued, 0 if it was the one dropped.
+ */
+static uint8_t txq_insert(const tx_frame_t *f)
+{
+  if (s_txq_n >= CAN1_TX_QUEUE_SIZE)
   {
-    s_hb_seq = d[0];
-    s_has101 = 1;
-    s_101_tick = now;
+    if (!tx_before(f, &s_txq[0])) return 0u;
+
+    /* Drop the worst (index 0) */
+    for (uint16_t i = 1; i < s_txq_n; i++) s_txq[i - 1U] = s_txq[i];
+    s_txq_n--;
+    s_tx_st.dropped++;
+  }
+
+  uint16_t i = s_txq_n;
+  while (i > 0u && tx_before(&s_txq[i - 1U], f))
+  {
+    s_txq[i] = s_txq[i - 1U];
+    i--;
+  }
+  s_txq[i] = *f;
+  s_txq_n++;
 
-    snprintf(s_last_txt, sizeof(s_last_txt), "HB seq=%u", (unsigned)s_hb_seq);
+  if (s_txq_n > s_tx_st.max_pending) s_tx_st.max_pending = s_txq_n;
+  return 1u;
+}
 
-    strncpy(s_101_txt, s_last_txt, sizeof(s_101_txt));
-    s_101_txt[sizeof(s_101_txt) - 1] = 0;
+static void txq_remove(uint16_t i)
+{
+  for (; (uint16_t)(i + 1U) < s_txq_n; i++) s_txq[i] = s_txq[i + 1U];
+  s_txq_n--;
+}
+
+static bool tx_id_in_flight(uint16_t id)
+{
+  for (uint32_t mb = 0; mb < CAN1_TX_MAILBOXES; mb++)
+  {
+    if (s_tx_mb[mb].busy && s_tx_mb[mb].f.id == id) return true;
   }
-  /* --------- 0x120: Light sensor ----------------------------------------- */
-  else if (rh.StdId == 0x120u && rh.DLC == 8u)
+  return false;
+}
+
+/**
+ * @brief Collect finished mailboxes (RQCPx): sent, aborted or failed.
+ */
+APP_ITCM static void tx_complete(void)
+{
+  uint32_t tsr = hcan1.Instance->TSR;
+
+  for (uint32_t mb = 0; mb < CAN1_TX_MAILBOXES; mb++)
   {
-    s_lux_x100 = u32_le(&d[0]);
-    s_full     = u16_le(&d[4]);
-    s_ir       = u16_le(&d[6]);
-
-    s_has120   = 1;
-    s_120_tick = now;
-
-    /* Present lux as integer in UI text */
-    snprintf(s_last_txt, sizeof(s_last_txt),
-             "LIGHT lux=%lu full=%u ir=%u",
-             (unsigned long)(s_lux_x100 / 100u),
-             (unsigned)s_full,
-             (unsigned)s_ir);
-
-    strncpy(s_120_txt, s_last_txt, sizeof(s_120_txt));
-    s_120_txt[sizeof(s_120_txt) - 1] = 0;
+    uint32_t rqcp = CAN_TSR_RQCP0 << (8u * mb);
+    if ((tsr & rqcp) == 0u) continue;
+
+    hcan1.Instance->TSR = rqcp;         /* clears RQCP, TXOK, ALST, TERR */
+
+    tx_mailbox_t *m = &s_tx_mb[mb];
+    if (!m->busy) continue;
+    m->busy = 0;
+
+    if ((tsr & (CAN_TSR_TXOK0 << (8u * mb))) != 0u)
+    {
+      uint32_t lat = (uint32_t)(App_GetMicros() - m->f.t_us);
+      s_tx_st.sent++;
+      CAN_STATS_OnTx(m->f.id, m->f.dlc, m->f.data);
+      s_tx_st.last_latency_us = lat;
+      if (lat > s_tx_st.max_latency_us) s_tx_st.max_latency_us = lat;
+    }
+    else if (m->abort == TX_ABORT_PREEMPT)
+    {
+      s_tx_st.preempted++;
+      /* Back into the queue; if it filled up meanwhile with better frames,
+         the preempted one is the worst and is dropped */
+      if (!txq_insert(&m->f)) s_tx_st.dropped++;
+    }
+    else if (m->abort == TX_ABORT_EXPIRED)
+    {
+      s_tx_st.expired++;
+    }
+    else
+    {
+      s_tx_st.errors++;
+    }
+    m->abort = TX_ABORT_NONE;
   }
 }
 
+/**
+ * @brief Move the best queued frames into free mailboxes; when none is free
+ *        and a mailbox holds a lower-priority frame, abort it.
+ *
+ * Call from the TX ISR or with interrupts masked.
+ */
+APP_ITCM static void tx_fill(void)
+{
+  tx_complete();
+
+  for (int32_t q = (int32_t)s_txq_n - 1; q >= 0; q--)
+  {
+    tx_frame_t *f = &s_txq[q];
+    if (tx_id_in_flight(f->id)) continue;
+
+    if (HAL_CAN_GetTxMailboxesFreeLevel(&hcan1) == 0u)
+    {
+      /* Priority inversion: worst mailbox below the best waiting frame */
+      uint32_t worst = CAN1_TX_MAILBOXES;
+      for (uint32_t mb = 0; mb < CAN1_TX_MAILBOXES; mb++)
+      {
+        if (!s_tx_mb[mb].busy || s_tx_mb[mb].abort != TX_ABORT_NONE) continue;
+        if (worst == CAN1_TX_MAILBOXES || tx_before(&s_tx_mb[worst].f, &s_tx_mb[mb].f))
+          worst = mb;
+      }
+      if (worst < CAN1_TX_MAILBOXES && tx_before(f, &s_tx_mb[worst].f))
+      {
+        s_tx_mb[worst].abort = TX_ABORT_PREEMPT;
+        (void)HAL_CAN_AbortTxRequest(&hcan1, CAN_TX_MAILBOX0 << worst);
+      }
+      return;
+    }
+
+    CAN_TxHeaderTypeDef th = {0};
+    uint32_t            mbx;
+
+    th.StdId              = f->id;
+    th.IDE                = CAN_ID_STD;
+    th.RTR                = CAN_RTR_DATA;
+    th.DLC                = f->dlc;
+    th.TransmitGlobalTime = DISABLE;   /* TTCM: would overwrite data[6..7] */
+
+    if (HAL_CAN_AddTxMessage(&hcan1, &th, f->data, &mbx) != HAL_OK) return;
+
+    tx_mailbox_t *m = &s_tx_mb[__builtin_ctz(mbx)];
+    m->f     = *f;
+    m->busy  = 1;
+    m->abort = TX_ABORT_NONE;
+    txq_remove((uint16_t)q);
+  }
+}
+
+/**
+ * @brief Drop queued frames and abort mailboxes past their deadline.
+ */
+static void tx_expire(uint32_t now)
+{
+  uint32_t pm = __get_PRIMASK();
+  __disable_irq();
+
+  for (uint16_t i = 0; i < s_txq_n; )
+  {
+    if (s_txq[i].has_deadline && (int32_t)(now - s_txq[i].expire_ms) >= 0)
+    {
+      txq_remove(i);
+      s_tx_st.expired++;
+      continue;
+    }
+    i++;
+  }
+
+  for (uint32_t mb = 0; mb < CAN1_TX_MAILBOXES; mb++)
+  {
+    tx_mailbox_t *m = &s_tx_mb[mb];
+    if (m->busy && m->abort == TX_ABORT_NONE && m->f.has_deadline &&
+        (int32_t)(now - m->f.expire_ms) >= 0)
+    {
+      m->abort = TX_ABORT_EXPIRED;
+      (void)HAL_CAN_AbortTxRequest(&hcan1, CAN_TX_MAILBOX0 << mb);
+    }
+  }
+
+  __set_PRIMASK(pm);
+}
+
+/**
+ * @brief Error interrupt (CAN1_SCE_IRQHandler()): count, then re-arm.
+ *
+ * LEC is reset so the next error frame sets it again; the state flags
+ * (warning / passive / bus-off) are read-only and followed by
+ * CAN_STATS_Service().
+ */
+void CAN1_SceIRQ(void)
+{
+  uint32_t esr = hcan1.Instance->ESR;
+
+  CLEAR_BIT(hcan1.Instance->ESR, CAN_ESR_LEC);
+  hcan1.Instance->MSR = CAN_MSR_ERRI;      /* rc_w1: other bits unaffected */
+
+  CAN_STATS_OnErrorIrq(esr);
+}
+
+/**
+ * @brief TX mailbox empty interrupt (CAN1_TX_IRQHandler()).
+ */
+APP_ITCM void CAN1_TxMailboxIRQ(void)
+{
+  tx_fill();
+}
+
+/**
+ * @brief Queue a standard data frame; never waits for the bus.
+ *
+ * @param deadline_ms  drop the frame if it has not left this many ms from
+ *                     now (0: no deadline)
+ * @return 1 if queued, 0 if refused (bad arguments, or the queue is full of
+ *         frames with higher priority).
+ */
+uint8_t CAN1_Send(uint16_t id, const uint8_t *data, uint8_t dlc, uint32_t deadline_ms)
+{
+  tx_frame_t f = {0};
+
+  if (id > 0x7FFu || dlc > 8u || (!data && dlc != 0u)) return 0u;
+
+  f.t_us         = App_GetMicros();
+  f.expire_ms    = HAL_GetTick() + deadline_ms;
+  f.has_deadline = (deadline_ms != 0u) ? 1u : 0u;
+  f.id           = id;
+  f.dlc          = dlc;
+  for (uint8_t i = 0; i < dlc; i++) f.data[i] = data[i];
+
+  uint32_t pm = __get_PRIMASK();
+  __disable_irq();
+
+  f.seq = s_tx_seq++;
+  uint8_t ok = txq_insert(&f);
+  if (ok) s_tx_st.queued++;
+  else    s_tx_st.rejected++;
+  tx_fill();
+
+  __set_PRIMASK(pm);
+  return ok;
+}
+
+void CAN1_GetTxStats(CAN1_TxStats *out)
+{
+  if (!out) return;
+
+  uint32_t pm = __get_PRIMASK();
+  __disable_irq();
+
+  *out = s_tx_st;
+  out->pending   = s_txq_n;
+  out->in_flight = 0;
+  for (uint32_t mb = 0; mb < CAN1_TX_MAILBOXES; mb++)
+    out->in_flight = (uint8_t)(out->in_flight + s_tx_mb[mb].busy);
+
+  __set_PRIMASK(pm);
+}
+
 /* =============================================================================
- * Service hook (kept for app structure)
+ * Decoding (main loop)
  * ============================================================================= */
 
 /**
- * @brief Optional service hook. RX snapshots are updated by IRQ.
+ * @brief True if the frame got in only through the open accept-all bank.
+ */
+static bool frame_outside(uint16_t id)
+{
+  if (s_flt_fallback || CAN_DB_IsKnownId(id)) return false;
+
+  for (uint8_t b = 0; b < s_flt_res.banks; b++)
+  {
+    if (CAN_FLT_Match(&s_flt[b], id)) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Decode one frame into the signal table's slots.
+ */
+static void decode_frame(const CAN1_RawFrame *f, uint32_t now)
+{
+  s_last_tick = now;
+
+  int16_t m = CAN_DB_Decode(f->id, f->dlc, f->data, now);
+  if (m >= 0) s_last_msg = m;
+}
+
+/**
+ * @brief Copy one frame into the raw capture ring (if enabled).
+ */
+static void capture_frame(const CAN1_RawFrame *f)
+{
+  if (!s_raw_enabled) return;
+
+  uint16_t head = s_raw_head;
+
+  if ((uint16_t)(head - s_raw_tail) < CAN1_RAW_RING_SIZE)
+  {
+    s_raw_ring[head & (CAN1_RAW_RING_SIZE - 1U)] = *f;
+    s_raw_head = (uint16_t)(head + 1U);
+  }
+  else
+  {
+    s_raw_overflow++;
+  }
+}
+
+/**
+ * @brief Open and close the survey window of the accept-all bank.
  *
- * Keep this function so the rest of the app can call it uniformly.
+ * The frames a window lets in are accounted when the next one opens, so
+ * frames still queued when it closed are included. No survey while raw
+ * capture keeps the bank open (nothing is rejected then).
+ */
+static void filter_survey(uint32_t now)
+{
+  if (s_flt_fallback || s_raw_enabled)
+  {
+    if (s_survey_valid) CAN_STATS_OnSurvey(0u);   /* nothing rejected now */
+    s_survey_open  = false;
+    s_survey_valid = false;
+    return;
+  }
+
+  if (s_survey_open)
+  {
+    if ((uint32_t)(now - s_survey_t0) < CAN1_FILTER_SURVEY_WINDOW_MS) return;
+
+    filter_open(false);
+    s_survey_open = false;
+    s_survey_len  = now - s_survey_t0;
+    return;
+  }
+
+  if (s_survey_valid && (uint32_t)(now - s_survey_t0) < CAN1_FILTER_SURVEY_PERIOD_MS) return;
+
+  if (s_survey_valid && s_survey_len != 0u)
+  {
+    s_rejected_est += (uint64_t)(s_outside - s_survey_outside) * (uint32_t)(now - s_survey_t0)
+                      / s_survey_len;
+    s_surveys++;
+    CAN_STATS_OnSurvey(s_survey_len);
+  }
+
+  s_survey_t0      = now;
+  s_survey_len     = 0;
+  s_survey_outside = s_outside;
+  s_survey_valid   = true;
+  s_survey_open    = true;
+  filter_open(true);
+}
+
+/**
+ * @brief Decode every frame one RX ring holds.
+ */
+static void service_ring(rx_ring_t *r, uint32_t now)
+{
+  uint16_t tail = r->tail;
+  uint16_t head = r->head;
+
+  if (tail == head) return;
+
+  uint16_t pending = (uint16_t)(head - tail);
+  if (pending > r->max_pending) r->max_pending = pending;
+
+  __DMB();                    /* read the index before the frame contents */
+  while (tail != head)
+  {
+    const CAN1_RawFrame *f = &r->buf[tail & (uint16_t)(r->size - 1U)];
+
+    if (!frame_outside(f->id))
+    {
+      decode_frame(f, now);
+      CAN_STATS_OnRx(f->id, f->dlc, f->data, f->ts_us);
+    }
+    else
+    {
+      s_outside++;
+      if (s_raw_enabled) CAN_STATS_OnRx(f->id, f->dlc, f->data, f->ts_us);
+      else               CAN_STATS_OnRejected(f->id, f->dlc, f->data);
+    }
+    capture_frame(f);
+    r->frames++;
+
+    tail++;
+    __DMB();                  /* finish with the slot before releasing it */
+    r->tail = tail;
+  }
+}
+
+/**
+ * @brief Decode every frame the RX ISRs queued since the last call.
+ *
+ * Call it on every main loop pass: the rings only have to bridge the time
+ * between two passes. FIFO1 (high-priority IDs) is decoded first. Also
+ * picks up FIFO overruns (no interrupt for them), runs the filter survey,
+ * expires TX frames and updates the bus statistics.
  */
 void CAN1_Service(void)
 {
-  /* Nothing required; IRQ fills snapshots */
+  uint32_t now = HAL_GetTick();
+
+  if (__HAL_CAN_GET_FLAG(&hcan1, CAN_FLAG_FOV0))
+  {
+    __HAL_CAN_CLEAR_FLAG(&hcan1, CAN_FLAG_FOV0);
+    s_rx[CAN_RX_FIFO0].fifo_overrun++;
+    CAN_STATS_OnOverrun();
+  }
+  if (__HAL_CAN_GET_FLAG(&hcan1, CAN_FLAG_FOV1))
+  {
+    __HAL_CAN_CLEAR_FLAG(&hcan1, CAN_FLAG_FOV1);
+    s_rx[CAN_RX_FIFO1].fifo_overrun++;
+    CAN_STATS_OnOverrun();
+  }
+
+  filter_survey(now);
+  tx_expire(now);
+
+  service_ring(&s_rx[CAN_RX_FIFO1], now);
+  service_ring(&s_rx[CAN_RX_FIFO0], now);
+
+  CAN_STATS_Service(now, hcan1.Instance->ESR);
+}
+
+uint16_t CAN1_RxPending(void)
+{
+  return (uint16_t)((uint16_t)(s_rx[CAN_RX_FIFO0].head - s_rx[CAN_RX_FIFO0].tail) +
+                    (uint16_t)(s_rx[CAN_RX_FIFO1].head - s_rx[CAN_RX_FIFO1].tail));
+}
+
+void CAN1_GetRxStats(CAN1_RxStats *out)
+{
+  if (!out) return;
+
+  for (uint32_t i = 0; i < 2u; i++)
+  {
+    const rx_ring_t  *r = &s_rx[i];
+    CAN1_RxFifoStats *o = &out->fifo[i];
+
+    o->frames        = r->frames;
+    o->ignored       = r->ignored;
+    o->ring_overflow = r->overflow;
+    o->fifo_overrun  = r->fifo_overrun;
+    o->pending       = (uint16_t)(r->head - r->tail);
+    o->max_pending   = r->max_pending;
+    o->size          = r->size;
+    o->max_batch     = r->max_batch;
+  }
+  out->bit_ns = s_bit_ns;
+}
+
+void CAN1_GetFilterStats(CAN1_FilterStats *out)
+{
+  if (!out) return;
+
+  out->banks        = s_flt_res.banks;
+  out->list_banks   = s_flt_res.list_banks;
+  out->mask_banks   = s_flt_res.mask_banks;
+  out->fifo1_banks  = s_flt_res.fifo1_banks;
+  out->ids          = s_flt_res.ids;
+  out->extra_ids    = s_flt_res.extra_ids;
+  out->accept_all   = s_flt_fallback;
+  out->open         = s_flt_fallback || s_survey_open || s_raw_enabled;
+  out->outside      = s_outside;
+  out->surveys      = s_surveys;
+  out->rejected_est = (s_rejected_est > UINT32_MAX) ? UINT32_MAX : (uint32_t)s_rejected_est;
+}
+
+/**
+ * @brief Copy one programmed bank (table IDs only, not the accept-all bank).
+ *
+ * @return 1 if the bank exists, 0 otherwise.
+ */
+uint8_t CAN1_GetFilterBank(uint8_t bank, CanFltBank *out)
+{
+  if (!out || bank >= s_flt_res.banks) return 0u;
+
+  *out = s_flt[bank];
+  return 1u;
+}
+
+/* =============================================================================
+ * Raw frame capture (consumer side)
+ * ============================================================================= */
+
+/**
+ * @brief Enable/disable raw frame capture. Disabling discards pending frames.
+ *
+ * While enabled the accept-all filter bank is open.
+ */
+void CAN1_SetRawCapture(uint8_t on)
+{
+  if (!on)
+  {
+    s_raw_enabled = 0;
+    s_raw_tail    = s_raw_head;
+    filter_open(false);     /* the next survey starts a fresh baseline */
+    return;
+  }
+
+  s_raw_tail    = s_raw_head;
+  s_raw_enabled = 1;
+  filter_open(true);        /* the push forwards every frame on the bus */
+}
+
+/**
+ * @brief Take the oldest captured frame.
+ *
+ * @return 1 if a frame was copied to out, 0 if the ring is empty.
+ */
+uint8_t CAN1_PopRaw(CAN1_RawFrame *out)
+{
+  uint16_t tail = s_raw_tail;
+
+  if (tail == s_raw_head) return 0u;
+
+  *out = s_raw_ring[tail & (CAN1_RAW_RING_SIZE - 1U)];
+  s_raw_tail = (uint16_t)(tail + 1U);
+  return 1u;
+}
+
+uint16_t CAN1_RawPending(void)
+{
+  return (uint16_t)(s_raw_head - s_raw_tail);
+}
+
+uint32_t CAN1_GetRawOverflow(void)
+{
+  return s_raw_overflow;
 }
 
 /* =============================================================================
  * UI text getters
  * ============================================================================= */
 
+/**
+ * @brief Text of a table message, formatted again only after a new frame.
+ */
+static const char *msg_text(CanDbMsg m)
+{
+  uint32_t frames = CAN_DB_MsgFrames(m);
+
+  if (frames == 0u) return "none";
+  if (s_txt_frames[m] != frames)
+  {
+    (void)CAN_DB_FormatMsg(m, s_txt[m], sizeof(s_txt[m]));
+    s_txt_frames[m] = frames;
+  }
+  return s_txt[m];
+}
+
+/**
+ * @brief Returns the text of the last decoded frame (any table message).
+ */
 const char* CAN1_GetLastText(void)
 {
   (void)s_last_tick; /* currently unused but kept for possible future timeouts */
-  return s_last_txt;
+
+  if (s_last_msg < 0) return "no data";
+  return msg_text((CanDbMsg)s_last_msg);
 }
 
 /**
@@ -265,8 +1016,8 @@ const char* CAN1_GetLastText(void)
  */
 const char* CAN1_GetText_0x101(void)
 {
-  if (HAL_GetTick() - s_101_tick > 2000u) return "none";
-  return s_101_txt;
+  if (!CAN_DB_MsgFresh(CAN_DB_MSG_HB, HAL_GetTick())) return "none";
+  return msg_text(CAN_DB_MSG_HB);
 }
 
 /**
@@ -274,8 +1025,8 @@ const char* CAN1_GetText_0x101(void)
  */
 const char* CAN1_GetText_0x120(void)
 {
-  if (HAL_GetTick() - s_120_tick > 2000u) return "none";
-  return s_120_txt;
+  if (!CAN_DB_MsgFresh(CAN_DB_MSG_LIGHT, HAL_GetTick())) return "none";
+  return msg_text(CAN_DB_MSG_LIGHT);
 }
 
 /* =============================================================================
@@ -283,16 +1034,19 @@ const char* CAN1_GetText_0x120(void)
  * ============================================================================= */
 
 /**
- * @brief True if we have a recent 0x101 message.
- *
- * Note:
- *  - This function currently checks the text getter. Alternatively, you could
- *    check s_has101 + timestamp directly for slightly cleaner semantics.
+ * @brief True if we have a recent (<= 2 seconds old) 0x101 message.
  */
 uint8_t CAN1_101_IsValid(void)
 {
-  const char *s = CAN1_GetText_0x101();
-  return (s && strcmp(s, "none") != 0) ? 1u : 0u;
+  return CAN_DB_MsgFresh(CAN_DB_MSG_HB, HAL_GetTick()) ? 1u : 0u;
+}
+
+/**
+ * @brief Returns the heartbeat sequence byte from the last 0x101 frame.
+ */
+uint8_t CAN1_101_GetSeq(void)
+{
+  return (uint8_t)CAN_DB_GetRaw(CAN_DB_SIG_HB_SEQ);
 }
 
 /* =============================================================================
@@ -304,24 +1058,32 @@ uint8_t CAN1_101_IsValid(void)
  */
 uint8_t CAN1_120_IsValid(void)
 {
-  return (HAL_GetTick() - s_120_tick <= 2000u) ? 1u : 0u;
+  return CAN_DB_MsgFresh(CAN_DB_MSG_LIGHT, HAL_GetTick()) ? 1u : 0u;
 }
 
 /**
  * @brief Returns lux (integer) from the last 0x120 frame.
- *        Internally stored as lux*100, so we divide by 100 here.
+ *        Received as lux*100; the table scales it by 1/100.
  */
 uint32_t CAN1_120_GetLux(void)
 {
-  return (uint32_t)(s_lux_x100 / 100u);
+  return (uint32_t)CAN_DB_GetPhys(CAN_DB_SIG_LIGHT_LUX_X100);
+}
+
+/**
+ * @brief Returns lux*100 exactly as received (no precision loss).
+ */
+uint32_t CAN1_120_GetLuxX100(void)
+{
+  return CAN_DB_GetRaw(CAN_DB_SIG_LIGHT_LUX_X100);
 }
 
 uint16_t CAN1_120_GetFull(void)
 {
-  return s_full;
+  return (uint16_t)CAN_DB_GetRaw(CAN_DB_SIG_LIGHT_FULL);
 }
 
 uint16_t CAN1_120_GetIR(void)
 {
-  return s_ir;
+  return (uint16_t)CAN_DB_GetRaw(CAN_DB_SIG_LIGHT_IR);
 }
@@ -0,0 +1,273 @@
+/**
+ * @file    can_db.c
+ * @brief   Table-driven CAN signal decoder.
+ *
+ * This module turns the rows of can_db_table.h into:
+ *  - A const message table (ID, DLC, timeout, label, first signal)
+ *  - A const signal table (shift, mask, byte order, sign, scale, text key)
+ *  - A const 2048-entry index: standard ID -> message, one load per frame
+ *  - Value slots (raw bits per signal) and per-message reception state
+ *
+ * Decoding a frame is an index lookup plus, per signal, one shift and one
+ * mask on the payload read as a 64-bit word (byte-swapped once for
+ * Motorola signals), independent of the number of IDs in the table.
+ *
+ * Design notes:
+ *  - Everything is built by the preprocessor from the table; there is no
+ *    init function and no generated file to keep in sync.
+ *  - Motorola start bits are converted to a shift at compile time.
+ *  - Scales are integer fractions so values and text need no float
+ *    (newlib-nano printf has no %f).
+ *  - Runs in the main loop (CAN1_Service()); the slots are not shared with
+ *    interrupts.
+ */
+
+#include "can_db.h"
+#include <stdio.h>
+
+/* =============================================================================
+ * Descriptors
+ * ============================================================================= */
+typedef struct
+{
+  uint16_t    id;
+  uint8_t     dlc;
+  uint16_t    timeout_ms;
+  uint8_t     fifo;
+  uint16_t    first_sig;
+  const char *label;
+} msg_desc_t;
+
+typedef struct
+{
+  uint8_t     msg;
+  uint8_t     shift;        /* of the LSB in the LE or BE payload word */
+  uint8_t     len;
+  uint8_t     order;
+  uint8_t     sign;
+  uint32_t    mask;
+  int32_t     num;
+  int32_t     den;
+  int32_t     offset;
+  const char *key;
+} sig_desc_t;
+
+/* LSB position of a Motorola signal in the payload read big-endian:
+   DBC numbers the MSB as bit (start % 8) of byte (start / 8) */
+#define CAN_DB_BE_SHIFT(start, len) \
+  ((7u - (start) / 8u) * 8u + (start) % 8u - ((len) - 1u))
+
+#define CAN_DB_SHIFT(start, len, order) \
+  (((order) == CAN_DB_BE) ? CAN_DB_BE_SHIFT(start, len) : (start))
+
+#define CAN_DB_MASK(len) \
+  ((uint32_t)((1ull << (len)) - 1u))
+
+static const msg_desc_t s_msgs[CAN_DB_MSG_COUNT] = {
+#define CAN_DB_X_MSG(name, id, dlc, timeout_ms, fifo, label) \
+  [CAN_DB_MSG_##name] = { (id), (dlc), (timeout_ms), (fifo), CAN_DB_SIG_FIRST_##name, (label) },
+#define CAN_DB_X_SIG(msg, name, start, len, order, sign, num, den, offset, key)
+  CAN_DB_TABLE(CAN_DB_X_MSG, CAN_DB_X_SIG)
+#undef CAN_DB_X_MSG
+#undef CAN_DB_X_SIG
+};
+
+static const sig_desc_t s_sigs[CAN_DB_SIG_COUNT] = {
+#define CAN_DB_X_MSG(name, id, dlc, timeout_ms, fifo, label)
+#define CAN_DB_X_SIG(msg, name, start, len, order, sign, num, den, offset, key) \
+  [CAN_DB_SIG_##msg##_##name] = { CAN_DB_MSG_##msg, CAN_DB_SHIFT(start, len, order), \
+                                  (len), (order), (sign), CAN_DB_MASK(len),          \
+                                  (num), (den), (offset), (key) },
+  CAN_DB_TABLE(CAN_DB_X_MSG, CAN_DB_X_SIG)
+#undef CAN_DB_X_MSG
+#undef CAN_DB_X_SIG
+};
+
+/* ID -> message + 1 (0 = not in the table) */
+static const uint16_t s_id_index[CAN_DB_ID_SPACE] = {
+#define CAN_DB_X_MSG(name, id, dlc, timeout_ms, fifo, label) [(id)] = CAN_DB_MSG_##name + 1u,
+#define CAN_DB_X_SIG(msg, name, start, len, order, sign, num, den, offset, key)
+  CAN_DB_TABLE(CAN_DB_X_MSG, CAN_DB_X_SIG)
+#undef CAN_DB_X_MSG
+#undef CAN_DB_X_SIG
+};
+
+/* =============================================================================
+ * Compile-time checks of the table
+ * ============================================================================= */
+#define CAN_DB_X_MSG(name, id, dlc, timeout_ms, fifo, label)                        \
+  _Static_assert((id) < CAN_DB_ID_SPACE, "CAN ID of " #name " is not 11-bit");    \
+  _Static_assert((dlc) >= 1u && (dlc) <= 8u, "DLC of " #name " out of range");     \
+  _Static_assert((fifo) <= 1u, "RX FIFO of " #name " is not 0 or 1");              \
+  enum { CAN_DB_DLC_##name = (dlc) };
+#define CAN_DB_X_SIG(msg, name, start, len, order, sign, num, den, offset, key)    \
+  _Static_assert((len) >= 1u && (len) <= 32u, #msg "." #name ": length 1..32");     \
+  _Static_assert((den) != 0, #msg "." #name ": zero denominator");                  \
+  _Static_assert((order) == CAN_DB_BE                                                \
+                 ? ((start) < 64u && (start) % 8u + 1u + 8u * (7u - (start) / 8u)   \
+                    >= (len) && CAN_DB_BE_SHIFT(start, len) + 8u * CAN_DB_DLC_##msg >= 64u) \
+                 : ((start) + (len) <= 8u * CAN_DB_DLC_##msg),                       \
+                 #msg "." #name ": outside the message's DLC");
+CAN_DB_TABLE(CAN_DB_X_MSG, CAN_DB_X_SIG)
+#undef CAN_DB_X_MSG
+#undef CAN_DB_X_SIG
+
+_Static_assert(CAN_DB_MSG_COUNT <= 256u, "sig_desc_t.msg is 8-bit");
+
+/* =============================================================================
+ * State
+ * ============================================================================= */
+typedef struct
+{
+  uint32_t frames;
+  uint32_t dlc_errors;
+  uint32_t last_ms;
+} msg_state_t;
+
+static uint32_t    s_raw[CAN_DB_SIG_COUNT];
+static msg_state_t s_msg_state[CAN_DB_MSG_COUNT];
+static uint32_t    s_unknown = 0;
+
+/* =============================================================================
+ * Decoding
+ * ============================================================================= */
+
+/**
+ * @brief Decode one standard data frame into the signal slots.
+ *
+ * @return the frame's CanDbMsg, or -1 (ID not in the table / frame too short).
+ */
+int16_t CAN_DB_Decode(uint16_t id, uint8_t dlc, const uint8_t *data, uint32_t now_ms)
+{
+  uint16_t m = (id < CAN_DB_ID_SPACE) ? s_id_index[id] : 0u;
+
+  if (m == 0u)
+  {
+    s_unknown++;
+    return -1;
+  }
+  m--;
+
+  const msg_desc_t *md = &s_msgs[m];
+  msg_state_t      *ms = &s_msg_state[m];
+
+  if (dlc < md->dlc)
+  {
+    ms->dlc_errors++;
+    return -1;
+  }
+
+  /* Payload as one word; bytes past the DLC are not read by any signal */
+  uint64_t le = 0;
+  for (uint32_t i = 0; i < 8u; i++)
+    le |= (uint64_t)data[i] << (8u * i);
+  uint64_t be = __builtin_bswap64(le);
+
+  for (uint16_t s = md->first_sig; s < CAN_DB_SIG_COUNT && s_sigs[s].msg == m; s++)
+  {
+    const sig_desc_t *sd = &s_sigs[s];
+    uint32_t raw = (uint32_t)(((sd->order == CAN_DB_BE) ? be : le) >> sd->shift) & sd->mask;
+
+    if (sd->sign == CAN_DB_SIGNED && sd->len < 32u && (raw >> (sd->len - 1u)) != 0u)
+      raw |= ~sd->mask;
+
+    s_raw[s] = raw;
+  }
+
+  ms->last_ms = now_ms;
+  ms->frames++;
+  return (int16_t)m;
+}
+
+/* =============================================================================
+ * Getters
+ * ============================================================================= */
+bool CAN_DB_MsgFresh(CanDbMsg m, uint32_t now_ms)
+{
+  if ((unsigned)m >= CAN_DB_MSG_COUNT) return false;
+
+  const msg_state_t *ms = &s_msg_state[m];
+  return ms->frames != 0u && (uint32_t)(now_ms - ms->last_ms) <= s_msgs[m].timeout_ms;
+}
+
+uint32_t CAN_DB_MsgFrames(CanDbMsg m)
+{
+  return ((unsigned)m < CAN_DB_MSG_COUNT) ? s_msg_state[m].frames : 0u;
+}
+
+void CAN_DB_GetMsgInfo(CanDbMsg m, uint32_t now_ms, CanDbMsgInfo *out)
+{
+  if (!out || (unsigned)m >= CAN_DB_MSG_COUNT) return;
+
+  out->id         = s_msgs[m].id;
+  out->fifo       = s_msgs[m].fifo;
+  out->label      = s_msgs[m].label;
+  out->frames     = s_msg_state[m].frames;
+  out->dlc_errors = s_msg_state[m].dlc_errors;
+  out->last_ms    = s_msg_state[m].last_ms;
+  out->fresh      = CAN_DB_MsgFresh(m, now_ms);
+}
+
+bool CAN_DB_IsKnownId(uint16_t id)
+{
+  return id < CAN_DB_ID_SPACE && s_id_index[id] != 0u;
+}
+
+uint32_t CAN_DB_GetUnknown(void)
+{
+  return s_unknown;
+}
+
+uint32_t CAN_DB_GetRaw(CanDbSig s)
+{
+  return ((unsigned)s < CAN_DB_SIG_COUNT) ? s_raw[s] : 0u;
+}
+
+int32_t CAN_DB_GetPhys(CanDbSig s)
+{
+  if ((unsigned)s >= CAN_DB_SIG_COUNT) return 0;
+
+  const sig_desc_t *sd = &s_sigs[s];
+  int64_t raw = (sd->sign == CAN_DB_SIGNED) ? (int64_t)(int32_t)s_raw[s] : (int64_t)s_raw[s];
+
+  return (int32_t)(raw * sd->num / sd->den + sd->offset);
+}
+
+float CAN_DB_GetPhysF(CanDbSig s)
+{
+  if ((unsigned)s >= CAN_DB_SIG_COUNT) return 0.0f;
+
+  const sig_desc_t *sd = &s_sigs[s];
+  float raw = (sd->sign == CAN_DB_SIGNED) ? (float)(int32_t)s_raw[s] : (float)s_raw[s];
+
+  return raw * (float)sd->num / (float)sd->den + (float)sd->offset;
+}
+
+/* =============================================================================
+ * Text
+ * ============================================================================= */
+
+/**
+ * @brief Format a message as "<label> key=value ..." (signals with a key).
+ *
+ * @return characters written (without the terminator).
+ */
+uint16_t CAN_DB_FormatMsg(CanDbMsg m, char *out, uint16_t cap)
+{
+  if (!out || cap == 0u) return 0u;
+  out[0] = 0;
+  if ((unsigned)m >= CAN_DB_MSG_COUNT) return 0u;
+
+  int n = snprintf(out, cap, "%s", s_msgs[m].label);
+
+  for (uint16_t s = s_msgs[m].first_sig;
+       s < CAN_DB_SIG_COUNT && s_sigs[s].msg == m && n >= 0 && n < (int)cap; s++)
+  {
+    if (!s_sigs[s].key) continue;
+    n += snprintf(&out[n], (size_t)(cap - n), " %s=%ld",
+                  s_sigs[s].key, (long)CAN_DB_GetPhys((CanDbSig)s));
+  }
+
+  if (n < 0) return 0u;
+  return (uint16_t)((n < (int)cap) ? n : (int)cap - 1);
+}
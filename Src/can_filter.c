@@ -0,0 +1,295 @@
+/**
+ * @file    can_filter.c
+ * @brief   Packs a set of standard IDs into bxCAN filter banks.
+ *
+ * bxCAN offers per bank (16-bit scale, standard IDs):
+ *  - list mode: 4 exact IDs
+ *  - mask mode: 2 id/mask pairs
+ * and routes each bank to FIFO0 or FIFO1.
+ *
+ * Packing:
+ *  - Every ID starts as an exact entry; exact entries go into list banks.
+ *  - While the banks needed exceed the budget, the two entries of the same
+ *    FIFO whose merged mask admits the fewest additional IDs are merged
+ *    (mask = bits both agree on). Entries covered by the result are dropped.
+ *  - Merged entries go into mask banks. FIFO1 banks are emitted first.
+ *
+ * Design notes:
+ *  - Runs once at start-up (CAN1_Start()); O(n^3) in the worst case for the
+ *    few dozen IDs of a table, no hardware access, no dynamic memory.
+ *  - The result is exact (no extra IDs) whenever ceil(n/4) banks per FIFO
+ *    fit; otherwise CanFltResult.extra_ids says what the masks let through.
+ */
+
+#include "can_filter.h"
+#include <stddef.h>
+
+/* =============================================================================
+ * Packing state
+ * ============================================================================= */
+typedef struct
+{
+  uint16_t id;
+  uint16_t mask;
+  uint8_t  fifo;
+} entry_t;
+
+static entry_t  s_e[CAN_FLT_IDS_MAX];
+static uint16_t s_ne;
+
+/* 16-bit filter register layout: STDID[10:0] | RTR | IDE | EXID[17:15] */
+#define CAN_FLT_REG_STDID_POS  5U
+#define CAN_FLT_REG_RTR_IDE    0x0018U
+
+/* =============================================================================
+ * Helpers
+ * ============================================================================= */
+
+/* IDs an id/mask entry accepts */
+static uint32_t accepted(uint16_t mask)
+{
+  return 1UL << (11U - (uint32_t)__builtin_popcount(mask & CAN_FLT_MASK_EXACT));
+}
+
+static uint8_t banks_needed(void)
+{
+  uint16_t exact[2] = {0, 0};
+  uint16_t masked[2] = {0, 0};
+
+  for (uint16_t i = 0; i < s_ne; i++)
+  {
+    if (s_e[i].mask == CAN_FLT_MASK_EXACT) exact[s_e[i].fifo]++;
+    else                                   masked[s_e[i].fifo]++;
+  }
+
+  uint32_t n = 0;
+  for (uint32_t f = 0; f < 2U; f++)
+    n += (exact[f] + 3U) / 4U + (masked[f] + 1U) / 2U;
+
+  return (n > 255U) ? 255U : (uint8_t)n;
+}
+
+static void remove_entry(uint16_t i)
+{
+  s_e[i] = s_e[s_ne - 1U];
+  s_ne--;
+}
+
+/**
+ * @brief Merge the cheapest pair of entries of the same FIFO.
+ *
+ * @return false if every FIFO is down to a single entry.
+ */
+static bool merge_cheapest(void)
+{
+  int32_t  best_cost  = INT32_MAX;
+  uint8_t  best_exact = 3;
+  uint16_t bi = 0, bj = 0;
+
+  for (uint16_t i = 0; i < s_ne; i++)
+  {
+    for (uint16_t j = (uint16_t)(i + 1U); j < s_ne; j++)
+    {
+      if (s_e[i].fifo != s_e[j].fifo) continue;
+
+      uint16_t m = (uint16_t)(s_e[i].mask & s_e[j].mask & ~(s_e[i].id ^ s_e[j].id));
+      int32_t  cost = (int32_t)accepted(m) - (int32_t)accepted(s_e[i].mask)
+                                           - (int32_t)accepted(s_e[j].mask);
+      /* equal cost: merging mask entries frees more bank space */
+      uint8_t  exact = (uint8_t)((s_e[i].mask == CAN_FLT_MASK_EXACT) +
+                                 (s_e[j].mask == CAN_FLT_MASK_EXACT));
+
+      if (cost < best_cost || (cost == best_cost && exact < best_exact))
+      {
+        best_cost  = cost;
+        best_exact = exact;
+        bi = i;
+        bj = j;
+      }
+    }
+  }
+
+  if (best_cost == INT32_MAX) return false;
+
+  uint16_t m = (uint16_t)(s_e[bi].mask & s_e[bj].mask & ~(s_e[bi].id ^ s_e[bj].id));
+  s_e[bi].mask = m;
+  s_e[bi].id   = (uint16_t)(s_e[bi].id & m);
+
+  /* Drop entries the merged one covers (including bj) */
+  entry_t merged = s_e[bi];
+  for (uint16_t k = 0; k < s_ne; )
+  {
+    if (k != bi && s_e[k].fifo == merged.fifo &&
+        (s_e[k].mask & m) == m && (s_e[k].id & m) == merged.id)
+    {
+      remove_entry(k);
+      if (bi == s_ne) bi = k;   /* bi was moved into slot k */
+      continue;
+    }
+    k++;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Emit the banks of one FIFO: list banks, then mask banks.
+ */
+static uint8_t emit_fifo(uint8_t fifo, CanFltBank *out, uint8_t nb, CanFltResult *res)
+{
+  CanFltBank *b = NULL;
+  uint8_t     used = 0;
+
+  for (uint16_t i = 0; i < s_ne; i++)
+  {
+    if (s_e[i].fifo != fifo || s_e[i].mask != CAN_FLT_MASK_EXACT) continue;
+
+    if (!b || used == 4U)
+    {
+      b = &out[nb++];
+      b->fifo      = fifo;
+      b->mask_mode = false;
+      b->mask[0]   = b->mask[1] = CAN_FLT_MASK_EXACT;
+      used = 0;
+      res->list_banks++;
+    }
+    for (uint8_t k = used; k < 4U; k++) b->id[k] = s_e[i].id;  /* pad */
+    used++;
+  }
+
+  b = NULL;
+  for (uint16_t i = 0; i < s_ne; i++)
+  {
+    if (s_e[i].fifo != fifo || s_e[i].mask == CAN_FLT_MASK_EXACT) continue;
+
+    if (!b || used == 2U)
+    {
+      b = &out[nb++];
+      b->fifo      = fifo;
+      b->mask_mode = true;
+      b->id[2]     = b->id[3] = 0;
+      used = 0;
+      res->mask_banks++;
+    }
+    for (uint8_t k = used; k < 2U; k++)
+    {
+      b->id[k]   = s_e[i].id;
+      b->mask[k] = s_e[i].mask;
+    }
+    used++;
+  }
+
+  return nb;
+}
+
+/* =============================================================================
+ * API
+ * ============================================================================= */
+
+/**
+ * @brief Pack the IDs into at most max_banks filter banks.
+ *
+ * @param ids        subscribed IDs (duplicates allowed; FIFO1 wins)
+ * @param n          number of IDs (<= CAN_FLT_IDS_MAX)
+ * @param max_banks  banks available (<= CAN_FLT_BANKS_MAX)
+ * @param out        bank array of at least max_banks entries
+ * @param res        summary (optional)
+ * @return true if packed; false if out of range or not packable.
+ */
+bool CAN_FLT_Pack(const CanFltId *ids, uint16_t n, uint8_t max_banks,
+                  CanFltBank *out, CanFltResult *res)
+{
+  CanFltResult r = {0};
+  uint32_t     wanted[2048U / 32U] = {0};
+
+  if ((!ids && n != 0U) || !out || n > CAN_FLT_IDS_MAX || max_banks > CAN_FLT_BANKS_MAX)
+    return false;
+
+  s_ne = 0;
+  for (uint16_t i = 0; i < n; i++)
+  {
+    uint16_t id = ids[i].id;
+    if (id > CAN_FLT_MASK_EXACT || ids[i].fifo > 1U) return false;
+
+    if (wanted[id / 32U] & (1UL << (id % 32U)))
+    {
+      for (uint16_t k = 0; k < s_ne; k++)
+        if (s_e[k].id == id && ids[i].fifo > s_e[k].fifo) s_e[k].fifo = ids[i].fifo;
+      continue;
+    }
+
+    wanted[id / 32U] |= 1UL << (id % 32U);
+    s_e[s_ne].id   = id;
+    s_e[s_ne].mask = CAN_FLT_MASK_EXACT;
+    s_e[s_ne].fifo = ids[i].fifo;
+    s_ne++;
+  }
+  r.ids = s_ne;
+
+  while (banks_needed() > max_banks)
+  {
+    if (!merge_cheapest()) return false;
+  }
+
+  uint8_t nb = emit_fifo(1U, out, 0U, &r);
+  r.fifo1_banks = nb;
+  nb = emit_fifo(0U, out, nb, &r);
+  r.banks = nb;
+
+  /* IDs outside the set that the masks let through */
+  if (r.mask_banks != 0U)
+  {
+    for (uint16_t id = 0; id <= CAN_FLT_MASK_EXACT; id++)
+    {
+      if (wanted[id / 32U] & (1UL << (id % 32U))) continue;
+      for (uint8_t b = 0; b < nb; b++)
+      {
+        if (CAN_FLT_Match(&out[b], id))
+        {
+          r.extra_ids++;
+          break;
+        }
+      }
+    }
+  }
+
+  if (res) *res = r;
+  return true;
+}
+
+bool CAN_FLT_Match(const CanFltBank *b, uint16_t id)
+{
+  if (!b) return false;
+
+  if (!b->mask_mode)
+    return id == b->id[0] || id == b->id[1] || id == b->id[2] || id == b->id[3];
+
+  return (id & b->mask[0]) == b->id[0] || (id & b->mask[1]) == b->id[1];
+}
+
+/**
+ * @brief Register values of a bank for HAL_CAN_ConfigFilter() (16-bit scale).
+ *
+ * regs[0..3] = FilterIdHigh, FilterIdLow, FilterMaskIdHigh, FilterMaskIdLow.
+ * Only standard data frames match (RTR and IDE compared as 0).
+ */
+void CAN_FLT_BankRegs(const CanFltBank *b, uint32_t regs[4])
+{
+  if (!b || !regs) return;
+
+  if (!b->mask_mode)
+  {
+    /* List: FR1 = {MaskIdLow, IdLow}, FR2 = {MaskIdHigh, IdHigh} */
+    regs[1] = (uint32_t)b->id[0] << CAN_FLT_REG_STDID_POS;
+    regs[3] = (uint32_t)b->id[1] << CAN_FLT_REG_STDID_POS;
+    regs[0] = (uint32_t)b->id[2] << CAN_FLT_REG_STDID_POS;
+    regs[2] = (uint32_t)b->id[3] << CAN_FLT_REG_STDID_POS;
+    return;
+  }
+
+  /* Mask: pair 0 in the low halves, pair 1 in the high halves */
+  regs[1] = (uint32_t)b->id[0] << CAN_FLT_REG_STDID_POS;
+  regs[3] = ((uint32_t)b->mask[0] << CAN_FLT_REG_STDID_POS) | CAN_FLT_REG_RTR_IDE;
+  regs[0] = (uint32_t)b->id[1] << CAN_FLT_REG_STDID_POS;
+  regs[2] = ((uint32_t)b->mask[1] << CAN_FLT_REG_STDID_POS) | CAN_FLT_REG_RTR_IDE;
+}
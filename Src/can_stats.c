@@ -0,0 +1,527 @@
+/**
+ * @file    can_stats.c
+ * @brief   CAN bus load, error and per-ID rate / jitter statistics.
+ *
+ * This module provides:
+ *  - Exact on-wire length of a standard data frame (bit stuffing computed
+ *    over the real ID, data and CRC-15, plus delimiters, ACK, EOF and IFS)
+ *  - Bus load per window from the received and sent frames, with peak, and
+ *    the load the hardware filters drop (measured in the filter survey
+ *    windows of can.c)
+ *  - Per-ID frame rate, mean inter-arrival time, jitter and min / max
+ *    interval from the RX timestamps (start of frame, can.c)
+ *  - Error state: TEC / REC, last error code and a count per code, entries
+ *    into error warning / passive / bus-off and bus-off recoveries, RX FIFO
+ *    overruns
+ *  - One JSON line with all of it for the optional telemetry channel
+ *    (app_net.c)
+ *
+ * Design notes:
+ *  - Nothing here touches the peripheral: can.c feeds frames, ESR snapshots
+ *    and events, so the module also builds for the host simulation.
+ *  - Contexts: the TX ISR only adds to the TX totals, the SCE ISR only to
+ *    the error interrupt counters; everything else runs in the main loop
+ *    (CAN1_Service() / CLI), which only reads what the ISRs write.
+ *  - State entries are seen either by the ISR (flag set at an error
+ *    interrupt) or by the poll of ESR in CAN_STATS_Service(), so a bus-off
+ *    that ends between two main-loop passes is still counted.
+ */
+
+#include "can_stats.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+/* =============================================================================
+ * bxCAN ESR layout
+ * ============================================================================= */
+#define ESR_EWGF        (1UL << 0)
+#define ESR_EPVF        (1UL << 1)
+#define ESR_BOFF        (1UL << 2)
+#define ESR_FLAGS       (ESR_EWGF | ESR_EPVF | ESR_BOFF)
+#define ESR_LEC(esr)    (((esr) >> 4) & 7UL)
+#define ESR_TEC(esr)    (((esr) >> 16) & 0xFFUL)
+#define ESR_REC(esr)    (((esr) >> 24) & 0xFFUL)
+
+/* =============================================================================
+ * State
+ * ============================================================================= */
+#if (CAN_STATS_IDS_MAX & (CAN_STATS_IDS_MAX - 1U)) != 0U || CAN_STATS_IDS_MAX > 255U
+#error "CAN_STATS_IDS_MAX must be a power of two (<= 128)"
+#endif
+
+typedef struct
+{
+  uint16_t key;             /* id + 1, 0 = free */
+  uint32_t frames;
+  uint32_t win_frames;
+  uint32_t rate_x10;
+  uint64_t last_us;
+  uint32_t period_us;
+  uint32_t jitter_us;
+  uint32_t min_us;
+  uint32_t max_us;
+} id_row_t;
+
+static uint32_t s_bit_ns = 2000u;
+
+/* Main loop */
+static id_row_t s_ids[CAN_STATS_IDS_MAX];
+static uint16_t s_ids_used   = 0;
+static uint32_t s_untracked  = 0;
+static uint32_t s_rx_frames  = 0;
+static uint32_t s_rx_bits    = 0;   /* current window */
+static uint32_t s_rx_win     = 0;   /* frames, current window */
+static uint32_t s_rej_bits   = 0;   /* since the last survey */
+static uint32_t s_overruns   = 0;
+
+static bool     s_win_started = false;
+static uint32_t s_win_t0      = 0;
+static uint32_t s_tx_frames0  = 0;  /* TX totals at window start */
+static uint32_t s_tx_bits0    = 0;
+
+static uint16_t s_load     = 0;
+static uint16_t s_peak     = 0;
+static uint16_t s_rejected = 0;
+static uint32_t s_rx_fps   = 0;
+static uint32_t s_tx_fps   = 0;
+
+static uint32_t s_esr          = 0;  /* last snapshot */
+static uint32_t s_flags        = 0;  /* ESR_FLAGS at the last pass */
+static uint32_t s_hits_seen[3];      /* s_flag_hits at the last pass */
+static uint32_t s_state_events[3];   /* warning, passive, bus-off */
+static uint32_t s_recoveries   = 0;
+
+/* TX ISR */
+static volatile uint32_t s_tx_frames = 0;
+static volatile uint32_t s_tx_bits   = 0;
+
+/* SCE ISR */
+static volatile uint32_t s_err_irqs = 0;
+static volatile uint32_t s_lec_count[CAN_STATS_LEC_COUNT];
+static volatile uint8_t  s_last_lec = 0;
+static volatile uint32_t s_flag_hits[3];  /* error IRQs with EWGF / EPVF / BOFF set */
+
+/* =============================================================================
+ * Frame length
+ * ============================================================================= */
+typedef struct
+{
+  uint16_t crc;
+  uint8_t  prev;
+  uint8_t  run;
+  uint16_t stuff;
+} wire_t;
+
+/* One bit of the stuffed part (SOF .. CRC); crc: also feed the CRC-15 */
+static void wire_bit(wire_t *w, uint8_t bit, bool crc)
+{
+  if (crc)
+  {
+    uint8_t nxt = (uint8_t)(bit ^ ((w->crc >> 14) & 1u));
+    w->crc = (uint16_t)((w->crc << 1) & 0x7FFFu);
+    if (nxt) w->crc ^= 0x4599u;
+  }
+
+  if (w->run != 0u && bit == w->prev)
+  {
+    if (++w->run == 5u)
+    {
+      w->stuff++;
+      w->prev = (uint8_t)!bit;   /* the stuff bit starts the next run */
+      w->run  = 1u;
+    }
+    return;
+  }
+  w->prev = bit;
+  w->run  = 1u;
+}
+
+static void wire_bits(wire_t *w, uint32_t v, uint8_t n, bool crc)
+{
+  while (n-- != 0u)
+    wire_bit(w, (uint8_t)((v >> n) & 1u), crc);
+}
+
+/**
+ * @brief Bits a standard data frame takes on the bus.
+ *
+ * 34 + 8*dlc stuffed bits (SOF, ID, RTR, IDE, r0, DLC, data, CRC), the
+ * stuff bits, and 13 fixed ones (CRC delimiter, ACK, ACK delimiter, EOF,
+ * intermission).
+ */
+uint16_t CAN_STATS_FrameBits(uint16_t id, uint8_t dlc, const uint8_t *data)
+{
+  wire_t w = {0};
+
+  if (dlc > 8u) dlc = 8u;
+
+  wire_bit(&w, 0u, true);                  /* SOF            */
+  wire_bits(&w, id & 0x7FFu, 11u, true);   /* ID             */
+  wire_bits(&w, 0u, 3u, true);             /* RTR, IDE, r0   */
+  wire_bits(&w, dlc, 4u, true);            /* DLC            */
+  for (uint8_t i = 0; i < dlc && data; i++)
+    wire_bits(&w, data[i], 8u, true);
+  wire_bits(&w, w.crc, 15u, false);        /* CRC            */
+
+  return (uint16_t)(34u + 8u * dlc + w.stuff + 13u);
+}
+
+/* =============================================================================
+ * Feeding
+ * ============================================================================= */
+void CAN_STATS_Configure(uint32_t bit_ns)
+{
+  if (bit_ns != 0u) s_bit_ns = bit_ns;
+}
+
+static id_row_t *id_row(uint16_t id)
+{
+  uint32_t h = ((uint32_t)id * 2654435761u) >> 16;
+
+  for (uint32_t i = 0; i < CAN_STATS_IDS_MAX; i++)
+  {
+    id_row_t *r = &s_ids[(h + i) & (CAN_STATS_IDS_MAX - 1U)];
+
+    if (r->key == (uint16_t)(id + 1u)) return r;
+    if (r->key == 0u)
+    {
+      r->key    = (uint16_t)(id + 1u);
+      r->min_us = UINT32_MAX;
+      s_ids_used++;
+      return r;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief One received frame (main loop), ts_us = start of frame.
+ */
+void CAN_STATS_OnRx(uint16_t id, uint8_t dlc, const uint8_t *data, uint64_t ts_us)
+{
+  s_rx_frames++;
+  s_rx_win++;
+  s_rx_bits += CAN_STATS_FrameBits(id, dlc, data);
+
+  id_row_t *r = id_row(id);
+  if (!r)
+  {
+    s_untracked++;
+    return;
+  }
+
+  r->win_frames++;
+  if (r->frames++ != 0u && ts_us > r->last_us)
+  {
+    uint64_t d64 = ts_us - r->last_us;
+    uint32_t d   = (d64 > UINT32_MAX) ? UINT32_MAX : (uint32_t)d64;
+
+    if (r->frames == 2u)
+    {
+      r->period_us = d;
+    }
+    else
+    {
+      int64_t  err = (int64_t)d - (int64_t)r->period_us;
+      uint32_t dev = (uint32_t)((err < 0) ? -err : err);
+
+      r->period_us = (uint32_t)((int64_t)r->period_us + err / 16);
+      r->jitter_us = (uint32_t)((int64_t)r->jitter_us +
+                                ((int64_t)dev - (int64_t)r->jitter_us) / 16);
+    }
+    if (d < r->min_us) r->min_us = d;
+    if (d > r->max_us) r->max_us = d;
+  }
+  r->last_us = ts_us;
+}
+
+/**
+ * @brief One frame ACKed on the bus (TX ISR): totals only.
+ */
+void CAN_STATS_OnTx(uint16_t id, uint8_t dlc, const uint8_t *data)
+{
+  s_tx_bits += CAN_STATS_FrameBits(id, dlc, data);
+  s_tx_frames++;
+}
+
+/**
+ * @brief Error interrupt (SCE ISR) with the ESR read before clearing LEC.
+ */
+void CAN_STATS_OnErrorIrq(uint32_t esr)
+{
+  uint32_t lec = ESR_LEC(esr);
+
+  s_err_irqs++;
+  if (lec >= CAN_STATS_LEC_STUFF && lec <= CAN_STATS_LEC_CRC)
+  {
+    s_lec_count[lec]++;
+    s_last_lec = (uint8_t)lec;
+  }
+
+  for (uint32_t k = 0; k < 3u; k++)
+  {
+    if ((esr & (1UL << k)) != 0u) s_flag_hits[k]++;
+  }
+}
+
+void CAN_STATS_OnOverrun(void)
+{
+  s_overruns++;
+}
+
+/**
+ * @brief A frame only the open survey bank let in (would have been dropped).
+ */
+void CAN_STATS_OnRejected(uint16_t id, uint8_t dlc, const uint8_t *data)
+{
+  s_rej_bits += CAN_STATS_FrameBits(id, dlc, data);
+}
+
+/**
+ * @brief End of a filter survey: the rejected frames of window_ms give the
+ *        load the filters drop. 0: the filters currently drop nothing.
+ */
+void CAN_STATS_OnSurvey(uint32_t window_ms)
+{
+  uint64_t p = (window_ms != 0u)
+             ? (uint64_t)s_rej_bits * s_bit_ns / ((uint64_t)window_ms * 1000u) : 0u;
+
+  s_rejected = (p > 0xFFFFu) ? 0xFFFFu : (uint16_t)p;
+  s_rej_bits = 0;
+}
+
+/**
+ * @brief Close the load window when due and track the error state.
+ *
+ * @param esr  current bxCAN ESR
+ */
+void CAN_STATS_Service(uint32_t now_ms, uint32_t esr)
+{
+  /* Error state: entries seen by the poll or by the error interrupt */
+  uint32_t seen = esr & ESR_FLAGS;
+  for (uint32_t k = 0; k < 3u; k++)
+  {
+    uint32_t hits = s_flag_hits[k];
+    if (hits != s_hits_seen[k]) seen |= 1UL << k;
+    s_hits_seen[k] = hits;
+
+    if ((seen & ~s_flags & (1UL << k)) != 0u) s_state_events[k]++;
+  }
+  if (((s_flags | seen) & ESR_BOFF) != 0u && (esr & ESR_BOFF) == 0u) s_recoveries++;
+  s_flags = esr & ESR_FLAGS;
+  s_esr   = esr;
+
+  /* Load window */
+  uint32_t tx_frames = s_tx_frames;
+  uint32_t tx_bits   = s_tx_bits;
+
+  if (!s_win_started)
+  {
+    s_win_started = true;
+    s_win_t0      = now_ms;
+    s_tx_frames0  = tx_frames;
+    s_tx_bits0    = tx_bits;
+    return;
+  }
+
+  uint32_t elapsed = now_ms - s_win_t0;
+  if (elapsed < CAN_STATS_WINDOW_MS) return;
+
+  uint64_t bits = (uint64_t)s_rx_bits + (uint32_t)(tx_bits - s_tx_bits0);
+  uint64_t load = bits * s_bit_ns / ((uint64_t)elapsed * 1000u);
+
+  s_load   = (load > 0xFFFFu) ? 0xFFFFu : (uint16_t)load;
+  s_rx_fps = (uint32_t)((uint64_t)s_rx_win * 1000u / elapsed);
+  s_tx_fps = (uint32_t)((uint64_t)(uint32_t)(tx_frames - s_tx_frames0) * 1000u / elapsed);
+  if (s_load > s_peak) s_peak = s_load;
+
+  for (uint32_t i = 0; i < CAN_STATS_IDS_MAX; i++)
+  {
+    id_row_t *r = &s_ids[i];
+    if (r->key == 0u) continue;
+    r->rate_x10   = (uint32_t)((uint64_t)r->win_frames * 10000u / elapsed);
+    r->win_frames = 0;
+  }
+
+  s_win_t0     = now_ms;
+  s_rx_bits    = 0;
+  s_rx_win     = 0;
+  s_tx_frames0 = tx_frames;
+  s_tx_bits0   = tx_bits;
+}
+
+/* =============================================================================
+ * Reading
+ * ============================================================================= */
+void CAN_STATS_GetBus(CanStatsBus *out)
+{
+  if (!out) return;
+
+  out->load_permille     = s_load;
+  out->peak_permille     = s_peak;
+  out->rejected_permille = s_rejected;
+  out->rx_fps            = s_rx_fps;
+  out->tx_fps            = s_tx_fps;
+  out->rx_frames         = s_rx_frames;
+  out->tx_frames         = s_tx_frames;
+  out->ids               = s_ids_used;
+  out->untracked         = s_untracked;
+
+  out->tec            = (uint8_t)ESR_TEC(s_esr);
+  out->rec            = (uint8_t)ESR_REC(s_esr);
+  out->last_lec       = s_last_lec;
+  out->warning        = (s_esr & ESR_EWGF) != 0u;
+  out->passive        = (s_esr & ESR_EPVF) != 0u;
+  out->bus_off        = (s_esr & ESR_BOFF) != 0u;
+  out->err_irqs       = s_err_irqs;
+  for (uint32_t i = 0; i < CAN_STATS_LEC_COUNT; i++)
+    out->lec_count[i] = s_lec_count[i];
+  out->warning_events = s_state_events[0];
+  out->passive_events = s_state_events[1];
+  out->busoff_events  = s_state_events[2];
+  out->recoveries     = s_recoveries;
+  out->fifo_overruns  = s_overruns;
+}
+
+/**
+ * @brief Copy up to cap ID rows, sorted by ID.
+ *
+ * @return rows copied.
+ */
+uint8_t CAN_STATS_GetIds(CanStatsId *out, uint8_t cap)
+{
+  uint8_t n = 0;
+
+  if (!out) return 0;
+
+  for (uint32_t i = 0; i < CAN_STATS_IDS_MAX && n < cap; i++)
+  {
+    const id_row_t *r = &s_ids[i];
+    if (r->key == 0u) continue;
+
+    CanStatsId row = {
+      .id        = (uint16_t)(r->key - 1u),
+      .frames    = r->frames,
+      .rate_x10  = r->rate_x10,
+      .period_us = r->period_us,
+      .jitter_us = r->jitter_us,
+      .min_us    = (r->min_us == UINT32_MAX) ? 0u : r->min_us,
+      .max_us    = r->max_us,
+    };
+
+    uint8_t k = n++;
+    while (k > 0u && out[k - 1u].id > row.id)
+    {
+      out[k] = out[k - 1u];
+      k--;
+    }
+    out[k] = row;
+  }
+  return n;
+}
+
+/**
+ * @brief Restart the load peak and the per-ID min / max intervals.
+ */
+void CAN_STATS_ResetPeaks(void)
+{
+  s_peak = s_load;
+
+  for (uint32_t i = 0; i < CAN_STATS_IDS_MAX; i++)
+  {
+    s_ids[i].min_us = UINT32_MAX;
+    s_ids[i].max_us = 0;
+  }
+}
+
+/* =============================================================================
+ * Telemetry encoding
+ * ============================================================================= */
+
+typedef struct
+{
+  char    *buf;
+  uint16_t cap;
+  uint16_t len;
+  bool     full;
+} json_out_t;
+
+/**
+ * @brief Append to the line; once something did not fit, nothing more is
+ *        added and the line is rejected.
+ */
+static void json_put(json_out_t *o, const char *fmt, ...)
+{
+  va_list ap;
+  int n;
+
+  if (o->full) return;
+
+  va_start(ap, fmt);
+  n = vsnprintf(o->buf + o->len, (size_t)(o->cap - o->len), fmt, ap);
+  va_end(ap);
+
+  if (n < 0 || (uint32_t)n >= (uint32_t)(o->cap - o->len))
+    o->full = true;
+  else
+    o->len = (uint16_t)(o->len + n);
+}
+
+/**
+ * @brief One JSON line:
+ *   {"canstats":{"ts":<ms>,"load":<permille>,"peak":..,"rejected":..,
+ *     "fps":[rx,tx],"frames":[rx,tx],
+ *     "err":{"state":"active|warning|passive|busoff","tec":..,"rec":..,
+ *            "lec":..,"irqs":..,"stuff":..,...,"recovered":..,"overrun":..},
+ *     "ids":{"0x<id>":[frames,rate_x10,period_us,jitter_us,min_us,max_us],...}}}\n
+ *
+ * @return Line length, 0 if it does not fit in cap.
+ */
+uint16_t CAN_STATS_EncodeJSON(uint32_t now_ms, char *out, uint16_t cap)
+{
+  CanStatsBus b;
+  CanStatsId  ids[CAN_STATS_IDS_MAX];
+  json_out_t  o = { out, cap, 0, false };
+
+  if (!out || cap == 0U) return 0;
+
+  CAN_STATS_GetBus(&b);
+  uint8_t n = CAN_STATS_GetIds(ids, (uint8_t)CAN_STATS_IDS_MAX);
+
+  const char *state = b.bus_off ? "busoff" : b.passive ? "passive"
+                    : b.warning ? "warning" : "active";
+
+  json_put(&o, "{\"canstats\":{\"ts\":%lu,\"load\":%u,\"peak\":%u,\"rejected\":%u,"
+               "\"fps\":[%lu,%lu],\"frames\":[%lu,%lu],",
+           (unsigned long)now_ms, (unsigned)b.load_permille, (unsigned)b.peak_permille,
+           (unsigned)b.rejected_permille, (unsigned long)b.rx_fps,
+           (unsigned long)b.tx_fps, (unsigned long)b.rx_frames,
+           (unsigned long)b.tx_frames);
+  json_put(&o, "\"err\":{\"state\":\"%s\",\"tec\":%u,\"rec\":%u,\"lec\":%u,\"irqs\":%lu,"
+               "\"stuff\":%lu,\"form\":%lu,\"ack\":%lu,\"bit1\":%lu,\"bit0\":%lu,"
+               "\"crc\":%lu,",
+           state, (unsigned)b.tec, (unsigned)b.rec, (unsigned)b.last_lec,
+           (unsigned long)b.err_irqs,
+           (unsigned long)b.lec_count[CAN_STATS_LEC_STUFF],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_FORM],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_ACK],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_BIT1],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_BIT0],
+           (unsigned long)b.lec_count[CAN_STATS_LEC_CRC]);
+  json_put(&o, "\"warning\":%lu,\"passive\":%lu,\"busoff\":%lu,\"recovered\":%lu,"
+               "\"overrun\":%lu},\"ids\":{",
+           (unsigned long)b.warning_events, (unsigned long)b.passive_events,
+           (unsigned long)b.busoff_events, (unsigned long)b.recoveries,
+           (unsigned long)b.fifo_overruns);
+  for (uint8_t i = 0; i < n; i++) {
+    json_put(&o, "%s\"0x%03X\":[%lu,%lu,%lu,%lu,%lu,%lu]", (i != 0U) ? "," : "",
+             (unsigned)ids[i].id, (unsigned long)ids[i].frames,
+             (unsigned long)ids[i].rate_x10, (unsigned long)ids[i].period_us,
+             (unsigned long)ids[i].jitter_us, (unsigned long)ids[i].min_us,
+             (unsigned long)ids[i].max_us);
+  }
+  json_put(&o, "}}}\n");
+
+  return o.full ? 0U : o.len;
+}
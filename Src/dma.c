@@ -13,8 +13,9 @@
  *  - This file only configures the DMA streams. To actually use DMA with SPI1,
  *    you must link these handles to the SPI handle via __HAL_LINKDMA() in
  *    HAL_SPI_MspInit().
- *  - If you are using cache (D-Cache) on STM32F7, DMA buffers should be placed
- *    carefully and/or cleaned/invalidated as required.
+ *  - D-Cache is enabled: DMA buffers belong in the non-cacheable region
+ *    (APP_DMA_BUFFER, app_platform.h); App_SPI_StartTxRx() maintains the cache
+ *    for buffers placed elsewhere.
  */
 
 #include "dma.h"
@@ -26,12 +26,12 @@ static uint8_t MACAddr[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 };
 /* =============================================================================
  * DMA descriptor tables
  * =============================================================================
- * ETH DMA reads/writes these descriptors. Alignment is important, especially
- * on cache-enabled MCUs (STM32F7).
+ * ETH DMA reads/writes these descriptors. They live in the non-cacheable
+ * RAM_NC region (linker script), so no cache maintenance is needed.
  */
 #if defined ( __GNUC__ )
-ETH_DMADescTypeDef DMARxDscrTab[ETH_RX_DESC_CNT] __attribute__((aligned(32)));
-ETH_DMADescTypeDef DMATxDscrTab[ETH_TX_DESC_CNT] __attribute__((aligned(32)));
+ETH_DMADescTypeDef DMARxDscrTab[ETH_RX_DESC_CNT] __attribute__((section(".RxDecripSection"), aligned(32)));
+ETH_DMADescTypeDef DMATxDscrTab[ETH_TX_DESC_CNT] __attribute__((section(".TxDecripSection"), aligned(32)));
 #else
 /* If using a different compiler, ensure equivalent 32-byte alignment here. */
 ETH_DMADescTypeDef DMARxDscrTab[ETH_RX_DESC_CNT];
@@ -14,6 +14,7 @@
 #include "eth.h"              /* <-- IMPORTANT: uses CubeMX eth.c globals (heth, TxConfig) */
 #include "ethernetif.h"
 #include "lan8742.h"
+#include "app_platform.h"     /* App_DCacheClean(), APP_ITCM */
 
 #include "lwip/opt.h"
 #include "lwip/mem.h"
@@ -23,6 +24,8 @@
 #include "netif/ethernet.h"
 #include "netif/etharp.h"
 #include "lwip/ethip6.h"
+#include "lwip/igmp.h"
+#include "lwip/mld6.h"
 
 #include <string.h>
 
@@ -33,9 +36,18 @@
 #define IFNAME0 's'
 #define IFNAME1 't'
 
-#define ETH_DMA_TRANSMIT_TIMEOUT  (20U)
-
 /* USER CODE BEGIN 1 */
+/* Ingress defaults (ethernetif_set_filter() changes them at runtime) */
+#define ETH_BCAST_PER_SEC_DEFAULT  200U   /* broadcast frames passed to lwIP per second  */
+#define ETH_RX_BUDGET_DEFAULT      8U     /* frames per ethernetif_input() pass          */
+
+/* Broadcast storm handling: the budget is accounted per window; when the
+   drops in one window reach ETH_BCAST_STORM_FACTOR x budget the MAC itself
+   discards broadcasts for ETH_BCAST_BLOCK_MS, so they stop consuming
+   descriptors and RX_POOL buffers */
+#define ETH_BCAST_WINDOW_MS        100U
+#define ETH_BCAST_STORM_FACTOR     4U
+#define ETH_BCAST_BLOCK_MS         500U
 /* USER CODE END 1 */
 
 /* Private types -------------------------------------------------------------*/
@@ -51,12 +63,42 @@ typedef struct
   uint8_t buff[(ETH_RX_BUF_SIZE + 31) & ~31] __ALIGNED(32);
 } RxBuff_t;
 
-/* Memory Pool Declaration */
+/* Memory Pool Declaration (non-cacheable RAM_NC, see linker script) */
 #define ETH_RX_BUFFER_CNT  12U
+#if defined ( __GNUC__ )
+__attribute__((section(".Rx_PoolSection"))) extern u8_t memp_memory_RX_POOL_base[];
+#endif
 LWIP_MEMPOOL_DECLARE(RX_POOL, ETH_RX_BUFFER_CNT, sizeof(RxBuff_t), "Zero-copy RX PBUF pool");
 
 /* Private variables ---------------------------------------------------------*/
-static uint8_t RxAllocStatus;
+static volatile uint8_t RxAllocStatus;
+
+/* Set by the ETH RX interrupt (or a returned RX buffer), cleared when the
+   main loop starts draining the DMA ring */
+static volatile uint8_t RxPending;
+
+/* Set by the ETH TX complete interrupt: sent frames can be released */
+static volatile uint8_t TxPending;
+
+static ethernetif_stats_t EthStats;
+
+static ethernetif_filter_t EthFilter = {
+  .promiscuous        = 0U,
+  .pass_all_multicast = 0U,
+  .bcast_per_sec      = ETH_BCAST_PER_SEC_DEFAULT,
+  .rx_budget          = ETH_RX_BUDGET_DEFAULT,
+};
+
+/* Multicast hash table (MACHTHR, MACHTLR) and joins per hash bin */
+static u32_t McastHash[2];
+static u8_t  McastRefs[64];
+
+/* Broadcast budget state (main loop only) */
+static u32_t BcastWindowStart;
+static u32_t BcastBlockUntil;
+static u16_t BcastPassed;
+static u16_t BcastDropped;
+static u8_t  BcastBlocked;
 
 /* IMPORTANT:
    heth and TxConfig are defined in CubeMX Src/eth.c.
@@ -82,6 +124,15 @@ int32_t ETH_PHY_IO_WriteReg(uint32_t DevAddr, uint32_t RegAddr, uint32_t RegVal)
 int32_t ETH_PHY_IO_GetTick(void);
 
 /* USER CODE BEGIN 2 */
+static void eth_filter_apply(void);
+#if LWIP_IGMP
+static err_t eth_igmp_mac_filter(struct netif *netif, const ip4_addr_t *group,
+                                 enum netif_mac_filter_action action);
+#endif
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+static err_t eth_mld_mac_filter(struct netif *netif, const ip6_addr_t *group,
+                                enum netif_mac_filter_action action);
+#endif
 /* USER CODE END 2 */
 
 ETH_TxPacketConfig TxConfig;
@@ -97,6 +148,10 @@ static void low_level_init(struct netif *netif)
   /* Initialize the RX POOL */
   LWIP_MEMPOOL_INIT(RX_POOL);
 
+  /* Perfect unicast, hashed multicast (empty until lwIP joins a group);
+     the MAC is not started yet */
+  eth_filter_apply();
+
 #if LWIP_ARP || LWIP_ETHERNET
   netif->hwaddr_len = ETH_HWADDR_LEN;
 
@@ -116,6 +171,16 @@ static void low_level_init(struct netif *netif)
   netif->flags |= NETIF_FLAG_BROADCAST;
 #endif
 
+  /* Multicast groups joined by lwIP go into the MAC hash table */
+#if LWIP_IGMP
+  netif->flags |= NETIF_FLAG_IGMP;
+  netif_set_igmp_mac_filter(netif, eth_igmp_mac_filter);
+#endif
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+  netif->flags |= NETIF_FLAG_MLD6;
+  netif_set_mld_mac_filter(netif, eth_mld_mac_filter);
+#endif
+
   /* Set PHY IO functions */
   LAN8742_IOCtx.Init     = ETH_PHY_IO_Init;
   LAN8742_IOCtx.DeInit   = ETH_PHY_IO_DeInit;
@@ -142,13 +207,51 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
   (void)netif;
 
   uint32_t i = 0U;
+  uint32_t clen, inuse;
+  uint8_t linearize;
   struct pbuf *q = NULL;
   ETH_BufferTypeDef Txbuffer[ETH_TX_DESC_CNT] = {0};
 
+  /* Reclaim descriptors of frames already on the wire */
+  HAL_ETH_ReleaseTxPacket(&heth);
+
+  /* Chains longer than the descriptor ring (e.g. TCP segments built from
+     several no-copy PBUF_ROM references) are linearized into one RAM pbuf */
+  clen = pbuf_clen(p);
+  linearize = (clen > ETH_TX_DESC_CNT);
+  if (linearize)
+    clen = 1U;
+
+  /* Ring full: let lwIP keep the frame (TCP retries from its unsent queue)
+     instead of waiting for the DMA */
+  if (clen > ETH_TX_DESC_CNT - HAL_ETH_GetTxBuffersNumber(&heth))
+  {
+    EthStats.tx_busy++;
+    return ERR_MEM;
+  }
+
+  if (linearize)
+  {
+    p = pbuf_clone(PBUF_RAW, PBUF_RAM, p);
+    if (p == NULL)
+    {
+      EthStats.tx_busy++;
+      return ERR_MEM;
+    }
+    EthStats.tx_linearized++;
+  }
+  else
+  {
+    /* The DMA reads the caller's buffers in place; hold them until
+       HAL_ETH_TxFreeCallback() */
+    pbuf_ref(p);
+  }
+
   for (q = p; q != NULL; q = q->next)
   {
-    if (i >= ETH_TX_DESC_CNT)
-      return ERR_IF;
+    /* Payloads outside RAM_NC (e.g. PBUF_ROM data) may still sit in the
+       D-cache */
+    App_DCacheClean(q->payload, q->len);
 
     Txbuffer[i].buffer = q->payload;
     Txbuffer[i].len    = q->len;
@@ -166,13 +269,22 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
   TxConfig.TxBuffer = Txbuffer;
   TxConfig.pData    = p;
 
-  if (HAL_ETH_Transmit(&heth, &TxConfig, ETH_DMA_TRANSMIT_TIMEOUT) != HAL_OK)
-    return ERR_IF;
+  if (HAL_ETH_Transmit_IT(&heth, &TxConfig) != HAL_OK)
+  {
+    pbuf_free(p);
+    EthStats.tx_busy++;
+    return ERR_MEM;
+  }
+
+  EthStats.tx_frames++;
+  inuse = HAL_ETH_GetTxBuffersNumber(&heth);
+  if (inuse > EthStats.tx_inuse_max)
+    EthStats.tx_inuse_max = inuse;
 
   return ERR_OK;
 }
 
-static struct pbuf *low_level_input(struct netif *netif)
+APP_ITCM static struct pbuf *low_level_input(struct netif *netif)
 {
   (void)netif;
 
@@ -186,15 +298,146 @@ static struct pbuf *low_level_input(struct netif *netif)
   return p;
 }
 
-void ethernetif_input(struct netif *netif)
+/**
+  * @brief ARP request or reply addressed to our IPv4 address. Always passed,
+  *        so peers can resolve us during a broadcast storm.
+  */
+APP_ITCM static u8_t rx_is_arp_for_us(struct netif *netif, const struct pbuf *p)
+{
+#if LWIP_IPV4 && LWIP_ARP
+  const u8_t *f = (const u8_t *)p->payload;
+  u32_t tip;
+
+  if (p->len < 42U || f[12] != 0x08U || f[13] != 0x06U)
+    return 0U;
+
+  /* Ethernet header (14) + ARP target protocol address offset (24) */
+  memcpy(&tip, &f[38], sizeof(tip));
+  return (u8_t)(tip == ip4_addr_get_u32(netif_ip4_addr(netif)));
+#else
+  (void)netif;
+  (void)p;
+  return 0U;
+#endif
+}
+
+/**
+  * @brief Software part of the receive filter: broadcast budget.
+  *
+  * Unicast and multicast frames were already filtered by the MAC (perfect
+  * address / hash table) and are only counted here.
+  *
+  * @return 1 to pass the frame to lwIP, 0 to drop it.
+  */
+APP_ITCM static u8_t rx_admit(struct netif *netif, const struct pbuf *p)
+{
+  const u8_t *f = (const u8_t *)p->payload;
+  u16_t budget;
+
+  if ((f[0] & 0x01U) == 0U)
+    return 1U;
+
+  if ((f[0] & f[1] & f[2] & f[3] & f[4] & f[5]) != 0xFFU)
+  {
+    EthStats.rx_mcast++;
+    return 1U;
+  }
+
+  EthStats.rx_bcast++;
+
+  if (EthFilter.bcast_per_sec == 0U || rx_is_arp_for_us(netif, p))
+    return 1U;
+
+  budget = (u16_t)((u32_t)EthFilter.bcast_per_sec * ETH_BCAST_WINDOW_MS / 1000U);
+  if (budget == 0U)
+    budget = 1U;
+
+  if (BcastPassed < budget)
+  {
+    BcastPassed++;
+    return 1U;
+  }
+
+  EthStats.rx_bcast_dropped++;
+  BcastDropped++;
+
+  /* Storm: let the MAC discard broadcasts for a while */
+  if (!BcastBlocked && BcastDropped >= (u32_t)budget * ETH_BCAST_STORM_FACTOR)
+  {
+    SET_BIT(heth.Instance->MACFFR, ETH_MACFFR_BFD);
+    BcastBlocked    = 1U;
+    BcastBlockUntil = sys_now() + ETH_BCAST_BLOCK_MS;
+    EthStats.rx_bcast_blocks++;
+  }
+
+  return 0U;
+}
+
+/**
+  * @brief Broadcast window roll-over and end of a MAC broadcast block.
+  *
+  * Runs on every ethernetif_input() call, i.e. at least every lwIP tick.
+  */
+APP_ITCM static void rx_filter_tick(void)
+{
+  u32_t now = sys_now();
+
+  if (BcastBlocked && (s32_t)(now - BcastBlockUntil) >= 0)
+  {
+    /* Single MACFFR write: the back-to-back write delay of the HAL
+       setter is not needed */
+    CLEAR_BIT(heth.Instance->MACFFR, ETH_MACFFR_BFD);
+    BcastBlocked = 0U;
+  }
+
+  if ((u32_t)(now - BcastWindowStart) >= ETH_BCAST_WINDOW_MS)
+  {
+    BcastWindowStart = now;
+    BcastPassed      = 0U;
+    BcastDropped     = 0U;
+  }
+}
+
+APP_ITCM void ethernetif_input(struct netif *netif)
 {
   struct pbuf *p = NULL;
+  u16_t n = 0U;
+
+  /* Release frames the DMA has sent since the last pass */
+  if (TxPending)
+  {
+    TxPending = 0U;
+    HAL_ETH_ReleaseTxPacket(&heth);
+  }
+
+  rx_filter_tick();
+
+  /* Clear before draining: a frame completing while we read re-arms it */
+  RxPending = 0U;
 
   do
   {
+    /* Per-pass cap: leave the rest for the next main loop pass so CAN, I2C
+       and USB are serviced in between */
+    if (EthFilter.rx_budget != 0U && n == EthFilter.rx_budget)
+    {
+      RxPending = 1U;
+      EthStats.rx_budget_hits++;
+      break;
+    }
+
     p = low_level_input(netif);
     if (p != NULL)
     {
+      n++;
+
+      if (!rx_admit(netif, p))
+      {
+        pbuf_free(p);
+        continue;
+      }
+
+      EthStats.rx_frames++;
       if (netif->input(p, netif) != ERR_OK)
       {
         pbuf_free(p);
@@ -242,7 +485,14 @@ void pbuf_free_custom(struct pbuf *p)
   LWIP_MEMPOOL_FREE(RX_POOL, custom_pbuf);
 
   if (RxAllocStatus == RX_ALLOC_ERROR)
+  {
     RxAllocStatus = RX_ALLOC_OK;
+
+    /* Descriptors left without a buffer are only refilled by
+       HAL_ETH_ReadData(); the DMA is suspended on them and raises no RX
+       interrupt, so schedule a drain from here */
+    RxPending = 1U;
+  }
 }
 
 /* USER CODE BEGIN 6 */
@@ -250,6 +500,220 @@ u32_t sys_now(void)
 {
   return HAL_GetTick();
 }
+
+/**
+ * @brief Received frames, freed RX buffers or sent TX frames are waiting
+ *        for ethernetif_input().
+ */
+u8_t ethernetif_pending(void)
+{
+  return (u8_t)(RxPending | TxPending);
+}
+
+/**
+ * @brief Milliseconds until ethernetif_input() has work: 0 when frames are
+ *        flagged, else the end of a MAC broadcast block.
+ */
+u32_t ethernetif_sleeptime(void)
+{
+  s32_t left;
+
+  if (RxPending | TxPending)
+    return 0U;
+
+  if (!BcastBlocked)
+    return ETHERNETIF_SLEEPTIME_INFINITE;
+
+  left = (s32_t)(BcastBlockUntil - sys_now());
+  return (left > 0) ? (u32_t)left : 0U;
+}
+
+/**
+  * @brief Statistics snapshot.
+  *
+  * The DMA missed-frame register clears on read, so its counts are
+  * accumulated here; a set overflow bit adds the saturated counter.
+  * The MMC error counters run freely and are copied as they are.
+  */
+/**
+  * @brief Submission count of the newest TX frame (see ethernetif_tx_released()).
+  */
+u32_t ethernetif_tx_mark(void)
+{
+  return EthStats.tx_frames;
+}
+
+/**
+  * @brief Non-zero once every frame submitted up to mark has been released
+  *        by HAL_ETH_ReleaseTxPacket() (wrap-safe).
+  */
+u8_t ethernetif_tx_released(u32_t mark)
+{
+  return (u8_t)((s32_t)(EthStats.tx_released - mark) >= 0);
+}
+
+void ethernetif_get_stats(ethernetif_stats_t *out)
+{
+  uint32_t mfbocr = heth.Instance->DMAMFBOCR;
+
+  EthStats.rx_missed += (mfbocr & ETH_DMAMFBOCR_MFC) >> ETH_DMAMFBOCR_MFC_Pos;
+  if ((mfbocr & ETH_DMAMFBOCR_OMFC) != 0U)
+    EthStats.rx_missed += ETH_DMAMFBOCR_MFC >> ETH_DMAMFBOCR_MFC_Pos;
+  EthStats.rx_fifo_overflow += (mfbocr & ETH_DMAMFBOCR_MFA) >> ETH_DMAMFBOCR_MFA_Pos;
+  if ((mfbocr & ETH_DMAMFBOCR_OFOC) != 0U)
+    EthStats.rx_fifo_overflow += ETH_DMAMFBOCR_MFA >> ETH_DMAMFBOCR_MFA_Pos;
+
+  EthStats.rx_crc_errors   = heth.Instance->MMCRFCECR;
+  EthStats.rx_align_errors = heth.Instance->MMCRFAECR;
+
+  if (out)
+  {
+    *out = EthStats;
+    out->tx_inuse = HAL_ETH_GetTxBuffersNumber(&heth);
+    out->bcast_blocked = BcastBlocked;
+    out->mcast_hash[0] = McastHash[0];
+    out->mcast_hash[1] = McastHash[1];
+  }
+}
+
+/*******************************************************************************
+                       MAC receive filter
+*******************************************************************************/
+/**
+  * @brief Program MACFFR from EthFilter (keeps an active broadcast block).
+  */
+static void eth_filter_apply(void)
+{
+  ETH_MACFilterConfigTypeDef f = {0};
+
+  f.PromiscuousMode      = EthFilter.promiscuous ? ENABLE : DISABLE;
+  f.PassAllMulticast     = EthFilter.pass_all_multicast ? ENABLE : DISABLE;
+  f.HashMulticast        = ENABLE;      /* unicast stays on the perfect filter */
+  f.BroadcastFilter      = BcastBlocked ? ENABLE : DISABLE;
+  f.ControlPacketsFilter = 0U;          /* control frames never reach lwIP     */
+
+  HAL_ETH_SetMACFilterConfig(&heth, &f);
+}
+
+/**
+  * @brief Hash bin of a destination MAC address: upper 6 bits of the
+  *        bit-reversed Ethernet CRC (RM0410, destination address filtering).
+  */
+static u8_t eth_hash_bin(const u8_t *mac)
+{
+  u32_t crc = 0xFFFFFFFFU;
+
+  for (u8_t i = 0; i < ETH_HWADDR_LEN; i++)
+  {
+    crc ^= mac[i];
+    for (u8_t b = 0; b < 8U; b++)
+      crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320U : 0U);
+  }
+
+  return (u8_t)(__RBIT(~crc) >> 26);
+}
+
+/**
+  * @brief Add or remove a multicast MAC address in the hash table.
+  *
+  * Bins are reference counted: groups sharing a bin keep it set until the
+  * last one leaves.
+  */
+err_t ethernetif_mcast_filter(const u8_t *mac, u8_t add)
+{
+  u8_t  bin, reg;
+  u32_t bit;
+
+  if (mac == NULL || (mac[0] & 0x01U) == 0U)
+    return ERR_ARG;
+
+  bin = eth_hash_bin(mac);
+  reg = (bin & 0x20U) ? 0U : 1U;        /* [0] = MACHTHR, [1] = MACHTLR */
+  bit = 1UL << (bin & 0x1FU);
+
+  if (add)
+  {
+    if (McastRefs[bin] == 0xFFU)
+      return ERR_MEM;
+    if (McastRefs[bin]++ != 0U)
+      return ERR_OK;
+    McastHash[reg] |= bit;
+  }
+  else
+  {
+    if (McastRefs[bin] == 0U || --McastRefs[bin] != 0U)
+      return ERR_OK;
+    McastHash[reg] &= ~bit;
+  }
+
+  HAL_ETH_SetHashTable(&heth, McastHash);
+  return ERR_OK;
+}
+
+#if LWIP_IGMP
+static err_t eth_igmp_mac_filter(struct netif *netif, const ip4_addr_t *group,
+                                 enum netif_mac_filter_action action)
+{
+  u8_t mac[ETH_HWADDR_LEN];
+  u32_t g = lwip_ntohl(ip4_addr_get_u32(group));
+
+  (void)netif;
+
+  /* 01:00:5e + low 23 bits of the group address */
+  mac[0] = 0x01U;
+  mac[1] = 0x00U;
+  mac[2] = 0x5EU;
+  mac[3] = (u8_t)((g >> 16) & 0x7FU);
+  mac[4] = (u8_t)(g >> 8);
+  mac[5] = (u8_t)g;
+
+  return ethernetif_mcast_filter(mac, (u8_t)(action == NETIF_ADD_MAC_FILTER));
+}
+#endif
+
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+static err_t eth_mld_mac_filter(struct netif *netif, const ip6_addr_t *group,
+                                enum netif_mac_filter_action action)
+{
+  u8_t mac[ETH_HWADDR_LEN];
+  u32_t g = lwip_ntohl(group->addr[3]);
+
+  (void)netif;
+
+  /* 33:33 + low 32 bits of the group address */
+  mac[0] = 0x33U;
+  mac[1] = 0x33U;
+  mac[2] = (u8_t)(g >> 24);
+  mac[3] = (u8_t)(g >> 16);
+  mac[4] = (u8_t)(g >> 8);
+  mac[5] = (u8_t)g;
+
+  return ethernetif_mcast_filter(mac, (u8_t)(action == NETIF_ADD_MAC_FILTER));
+}
+#endif
+
+void ethernetif_get_filter(ethernetif_filter_t *out)
+{
+  if (out)
+    *out = EthFilter;
+}
+
+/**
+  * @brief Change the receive filter and ingress limits (main loop only).
+  */
+void ethernetif_set_filter(const ethernetif_filter_t *cfg)
+{
+  if (cfg == NULL)
+    return;
+
+  EthFilter = *cfg;
+
+  /* A storm block is lifted when broadcast limiting is switched off */
+  if (EthFilter.bcast_per_sec == 0U)
+    BcastBlocked = 0U;
+
+  eth_filter_apply();
+}
 /* USER CODE END 6 */
 
 /*******************************************************************************
@@ -291,7 +755,7 @@ void ethernet_link_check_state(struct netif *netif)
 
   if (netif_is_link_up(netif) && (PHYLinkState <= LAN8742_STATUS_LINK_DOWN))
   {
-    HAL_ETH_Stop(&heth);
+    HAL_ETH_Stop_IT(&heth);
     netif_set_down(netif);
     netif_set_link_down(netif);
   }
@@ -313,14 +777,15 @@ void ethernet_link_check_state(struct netif *netif)
       MACConf.Speed = speed;
       HAL_ETH_SetMACConfig(&heth, &MACConf);
 
-      HAL_ETH_Start(&heth);
+      /* RX complete interrupt only flags the main loop (RxPending) */
+      HAL_ETH_Start_IT(&heth);
       netif_set_up(netif);
       netif_set_link_up(netif);
     }
   }
 }
 
-void HAL_ETH_RxAllocateCallback(uint8_t **buff)
+APP_ITCM void HAL_ETH_RxAllocateCallback(uint8_t **buff)
 {
   struct pbuf_custom *p = LWIP_MEMPOOL_ALLOC(RX_POOL);
   if (p)
@@ -332,11 +797,12 @@ void HAL_ETH_RxAllocateCallback(uint8_t **buff)
   else
   {
     RxAllocStatus = RX_ALLOC_ERROR;
+    EthStats.rx_pool_empty++;
     *buff = NULL;
   }
 }
 
-void HAL_ETH_RxLinkCallback(void **pStart, void **pEnd, uint8_t *buff, uint16_t Length)
+APP_ITCM void HAL_ETH_RxLinkCallback(void **pStart, void **pEnd, uint8_t *buff, uint16_t Length)
 {
   struct pbuf **ppStart = (struct pbuf **)pStart;
   struct pbuf **ppEnd = (struct pbuf **)pEnd;
@@ -357,10 +823,41 @@ void HAL_ETH_RxLinkCallback(void **pStart, void **pEnd, uint8_t *buff, uint16_t
   for (p = *ppStart; p != NULL; p = p->next)
     p->tot_len += Length;
 
-  SCB_InvalidateDCache_by_Addr((uint32_t *)buff, Length);
+  /* RX_POOL is non-cacheable: the payload needs no invalidation */
 }
 
+/* Main loop (HAL_ETH_ReleaseTxPacket): drop the reference taken in
+   low_level_output() */
 void HAL_ETH_TxFreeCallback(uint32_t * buff)
 {
   pbuf_free((struct pbuf *)buff);
+  EthStats.tx_released++;
+}
+
+/* ETH interrupt context: keep it to flagging, lwIP runs in the main loop */
+void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *handle)
+{
+  (void)handle;
+  RxPending = 1U;
+  EthStats.rx_irq++;
+}
+
+void HAL_ETH_TxCpltCallback(ETH_HandleTypeDef *handle)
+{
+  (void)handle;
+  TxPending = 1U;
+}
+
+void HAL_ETH_ErrorCallback(ETH_HandleTypeDef *handle)
+{
+  /* Receive buffer unavailable: the ring is full of unread frames */
+  if ((HAL_ETH_GetDMAError(handle) & ETH_DMASR_RBUS) != 0U)
+  {
+    RxPending = 1U;
+    EthStats.rx_buf_unavail++;
+  }
+  else
+  {
+    EthStats.dma_errors++;
+  }
 }
@@ -322,6 +322,11 @@ int App_I2C_GetTempInt(void)
   return (int)g_i2c_temp;
 }
 
+float App_I2C_GetTemp(void)
+{
+  return g_i2c_temp;
+}
+
 const char* App_I2C_GetLastErr(void)
 {
   return g_i2c_last_err;
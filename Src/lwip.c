@@ -4,13 +4,16 @@
  *
  * This file is largely CubeMX-generated and provides:
  *  - MX_LWIP_Init(): lwIP stack init + netif setup (static IPv4)
- *  - MX_LWIP_Process(): polling hook to feed RX packets + run lwIP timeouts
+ *  - MX_LWIP_Pump(): single-pass pump; RX/TX completion, lwIP timers and
+ *    link polling each run only when they have work
+ *  - MX_LWIP_SleepTime(): time until the pump has work again
  *  - Link management: periodic link check + optional link status callback
  *
  * Project-specific notes:
  *  - DHCP is intentionally disabled (static IP configuration is used).
- *  - MX_LWIP_Process() is intended to be called regularly from the main loop
- *    in NO_SYS configurations (no RTOS).
+ *  - MX_LWIP_Pump() is intended to be called on every main-loop pass in
+ *    NO_SYS configurations (no RTOS); MX_LWIP_Process() is kept as the
+ *    CubeMX entry point and runs one pass.
  */
 
 #include "lwip.h"
@@ -27,7 +30,7 @@
  * Private function prototypes
  * ============================================================================= */
 static void ethernet_link_status_updated(struct netif *netif);
-static void Ethernet_Link_Periodic_Handle(struct netif *netif);
+static uint8_t Ethernet_Link_Periodic_Handle(struct netif *netif, uint32_t now_ms);
 
 /* Provided elsewhere (CubeMX typically declares it globally) */
 void Error_Handler(void);
@@ -36,7 +39,8 @@ void Error_Handler(void);
 uint32_t DHCPfineTimer   = 0;
 uint32_t DHCPcoarseTimer = 0;
 
-/* Link polling timestamp */
+/* Link polling: period and next due time */
+#define ETH_LINK_POLL_MS  100U
 uint32_t EthernetLinkTimer;
 
 /* =============================================================================
@@ -94,37 +98,81 @@ void MX_LWIP_Init(void)
  * CubeMX approach:
  *  - Call ethernet_link_check_state() every 100ms.
  *  - This keeps netif link status up to date in NO_SYS setups.
+ *
+ * @return 1 if the link was checked on this call
  */
-static void Ethernet_Link_Periodic_Handle(struct netif *netif)
+static uint8_t Ethernet_Link_Periodic_Handle(struct netif *netif, uint32_t now_ms)
 {
-  /* Ethernet link check every 100ms */
-  if (HAL_GetTick() - EthernetLinkTimer >= 100)
-  {
-    EthernetLinkTimer = HAL_GetTick();
-    ethernet_link_check_state(netif);
-  }
+  if ((int32_t)(now_ms - EthernetLinkTimer) < 0)
+    return 0U;
+
+  EthernetLinkTimer = now_ms + ETH_LINK_POLL_MS;
+  ethernet_link_check_state(netif);
+  return 1U;
 }
 
 /**
- * @brief lwIP processing hook for NO_SYS mode.
+ * @brief One pass of the lwIP pump (NO_SYS mode).
+ *
+ * Each part runs only when it has work:
+ *  - ethernetif_input(): frames flagged by the ETH IRQ, sent frames to
+ *    release, end of a broadcast block (ethernetif_sleeptime() == 0)
+ *  - sys_check_timeouts(): the earliest lwIP timer is due
+ *    (sys_timeouts_sleeptime() == 0)
+ *  - Link poll: every ETH_LINK_POLL_MS
  *
- * Responsibilities:
- *  - Feed received Ethernet frames into lwIP (ethernetif_input)
- *  - Run lwIP timeouts (sys_check_timeouts)
- *  - Periodically update link status (Ethernet_Link_Periodic_Handle)
+ * Cheap when nothing is due; call it on every main-loop pass.
  *
- * This function must be called regularly from the main loop.
+ * @return 1 if any network work was done
  */
-void MX_LWIP_Process(void)
+uint8_t MX_LWIP_Pump(uint32_t now_ms)
 {
-  /* Read packets from ETH DMA and pass them to lwIP */
-  ethernetif_input(&gnetif);
+  uint8_t work = 0U;
+
+  if (ethernetif_sleeptime() == 0U)
+  {
+    ethernetif_input(&gnetif);
+    work = 1U;
+  }
+
+  if (sys_timeouts_sleeptime() == 0U)
+  {
+    sys_check_timeouts();
+    work = 1U;
+  }
 
-  /* Handle lwIP timers (ARP, TCP, DHCP if enabled, etc.) */
-  sys_check_timeouts();
+  work |= Ethernet_Link_Periodic_Handle(&gnetif, now_ms);
 
-  /* Keep netif link state in sync */
-  Ethernet_Link_Periodic_Handle(&gnetif);
+  return work;
+}
+
+/**
+ * @brief Milliseconds until MX_LWIP_Pump() has work (0 = now).
+ */
+uint32_t MX_LWIP_SleepTime(uint32_t now_ms)
+{
+  uint32_t t    = ethernetif_sleeptime();
+  uint32_t tmr  = sys_timeouts_sleeptime();
+  int32_t  link = (int32_t)(EthernetLinkTimer - now_ms);
+
+  if (tmr < t)
+    t = tmr;
+  if (link <= 0)
+    return 0U;
+  if ((uint32_t)link < t)
+    t = (uint32_t)link;
+
+  return t;
+}
+
+/**
+ * @brief lwIP processing hook for NO_SYS mode (CubeMX entry point).
+ *
+ * Runs one pass of MX_LWIP_Pump().
+ */
+void MX_LWIP_Process(void)
+{
+  (void)MX_LWIP_Pump(HAL_GetTick());
 }
 
 /**
@@ -34,7 +34,7 @@ int main(void)
    * Core setup
    * -------------------------------------------------------------------------- */
 
-  /* Configure MPU (memory attributes / cache regions) */
+  /* Configure MPU (memory attributes / cache regions) and enable I/D-Cache */
   MPU_Config();
 
   /* Initialize HAL (SysTick, NVIC priority grouping, HAL state) */
@@ -43,10 +43,6 @@ int main(void)
   /* Configure system clocks (PLL, bus prescalers, flash latency) */
   SystemClock_Config();
 
-  /* Cache disabled (can be re-enabled if needed) */
-  SCB_DisableDCache();
-  SCB_DisableICache();
-
   /* --------------------------------------------------------------------------
    * Basic peripherals
    * -------------------------------------------------------------------------- */
@@ -110,7 +106,7 @@ int main(void)
     /* USB CDC TX service */
     App_USB_Service();
 
-    /* CAN periodic wrapper (RX is IRQ-driven) */
+    /* CAN RX decoding (frames queued by the RX IRQ) */
     App_CAN_Service(now);
 
     /* I2C periodic polling + recovery */
@@ -126,8 +122,10 @@ int main(void)
     /* Periodic app tasks (e.g., logging) */
     App_Tick(now);
 
-    /* Sleep until next interrupt if system is idle */
-    if (App_USBLog_IsEmpty() && !TFT_IsBusy())
+    /* Sleep until next interrupt if system is idle; the 1 ms SysTick bounds
+       the sleep, so any network deadline in the future is met */
+    if (App_USBLog_IsEmpty() && !TFT_IsBusy() && CAN1_RxPending() == 0U &&
+        APP_NET_SleepTime(HAL_GetTick()) != 0U)
       __WFI();
   }
 }
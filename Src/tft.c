@@ -19,6 +19,7 @@
 #include "spi.h"
 #include "gpio.h"
 #include "stm32f7xx_hal.h"
+#include "app_platform.h"   /* APP_ITCM / APP_DTCM */
 #include <string.h>
 #include <stdint.h>
 
@@ -132,7 +133,7 @@ static uint32_t g_blit_len = 0;           /* Total bytes to send */
 static uint32_t g_blit_sent = 0;          /* Bytes already sent */
 
 /* Temporary TX buffer for chunked sending */
-static uint8_t g_txbuf[TFT_CHUNK_BYTES];
+static uint8_t g_txbuf[TFT_CHUNK_BYTES] APP_DTCM;
 
 /* =============================================================================
  * Tiny 5x7 font (ASCII 32..126)
@@ -186,7 +187,7 @@ static inline const uint8_t* glyph_for(char c)
 /* =============================================================================
  * Line buffer for text rendering: 160 x 8 pixels, RGB565 => 160*8*2 = 2560 bytes
  * ============================================================================= */
-static uint16_t g_linebuf[TFT_W * LINE_H];
+static uint16_t g_linebuf[TFT_W * LINE_H] APP_DTCM;
 
 static inline void linebuf_set(uint16_t x, uint16_t y, uint16_t c)
 {
@@ -319,7 +320,7 @@ void TFT_DrawTextLine_Async(uint16_t y, const char *text, uint16_t fg, uint16_t
  *  - Each call sends up to TFT_CHUNK_BYTES (rounded to even) over SPI.
  *  - When finished, CS is released and g_op returns to TFT_OP_NONE.
  */
-void TFT_Task(void)
+APP_ITCM void TFT_Task(void)
 {
   if (g_op == TFT_OP_NONE) return;
 
@@ -23,6 +23,7 @@
 
 /* USER CODE BEGIN INCLUDE */
 #include <string.h>
+#include "app_platform.h"   /* APP_ITCM / APP_DTCM */
 /* USER CODE END INCLUDE */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -45,14 +46,14 @@ static volatile uint8_t g_cdc_line_ready = 0;
 
 /* ---- Console TX queue (so we can echo/backspace safely) ---- */
 #define CDC_CONS_TX_SZ 512
-static uint8_t  g_cons_tx[CDC_CONS_TX_SZ];
-static volatile uint16_t g_cons_w = 0;
-static volatile uint16_t g_cons_r = 0;
+static uint8_t  g_cons_tx[CDC_CONS_TX_SZ] APP_DTCM;
+static volatile uint16_t g_cons_w APP_DTCM;
+static volatile uint16_t g_cons_r APP_DTCM;
 
 static uint8_t  g_prompt_pending = 0;
 
 /* Push bytes into console TX ring (drop on full, never block) */
-static void cons_push_bytes(const uint8_t *data, uint16_t len)
+APP_ITCM static void cons_push_bytes(const uint8_t *data, uint16_t len)
 {
   for (uint16_t i = 0; i < len; i++)
   {
@@ -77,7 +78,7 @@ uint8_t CDC_ConsoleTxIsEmpty(void)
 
 
 /* Exposed: call from main loop to transmit queued console output */
-void CDC_ConsoleTxService(void)
+APP_ITCM void CDC_ConsoleTxService(void)
 {
   /* send up to 64 bytes per call */
   static uint8_t chunk[64];
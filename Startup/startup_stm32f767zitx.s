@@ -43,6 +43,15 @@ defined in linker script */
 .word  _sbss
 /* end address for the .bss section. defined in linker script */
 .word  _ebss
+/* ITCM code and DTCM data/bss. defined in linker script */
+.word  _siitcm_text
+.word  _sitcm_text
+.word  _eitcm_text
+.word  _sidtcm_data
+.word  _sdtcm_data
+.word  _edtcm_data
+.word  _sdtcm_bss
+.word  _edtcm_bss
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
 /**
@@ -93,6 +102,58 @@ FillZerobss:
 LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
+
+/* Copy the hot code from flash to ITCM */
+  ldr r0, =_sitcm_text
+  ldr r1, =_eitcm_text
+  ldr r2, =_siitcm_text
+  movs r3, #0
+  b LoopCopyItcm
+
+CopyItcm:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyItcm:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyItcm
+
+/* Copy the DTCM data initializers from flash */
+  ldr r0, =_sdtcm_data
+  ldr r1, =_edtcm_data
+  ldr r2, =_sidtcm_data
+  movs r3, #0
+  b LoopCopyDtcmData
+
+CopyDtcmData:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyDtcmData:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyDtcmData
+
+/* Zero fill the DTCM bss */
+  ldr r2, =_sdtcm_bss
+  ldr r4, =_edtcm_bss
+  movs r3, #0
+  b LoopFillZeroDtcm
+
+FillZeroDtcm:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopFillZeroDtcm:
+  cmp r2, r4
+  bcc FillZeroDtcm
+
+/* ITCM code written through the data bus: complete before fetching it */
+  dsb
+  isb
   
 /* Call static constructors */
     bl __libc_init_array
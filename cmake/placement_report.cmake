@@ -0,0 +1,71 @@
+# cmake/placement_report.cmake
+#
+# Post-build memory placement report.
+#
+# Lists every symbol that the linker script placed in a dedicated memory:
+#  - .itcm_text  : code copied to ITCM at startup (APP_ITCM + vendor hot paths)
+#  - .dtcm_data  : initialized hot state in DTCM (APP_DTCM_DATA)
+#  - .dtcm_bss   : zero-initialized hot state in DTCM (APP_DTCM)
+#  - .dma_buffer : non-cacheable DMA buffers in RAM_NC (APP_DMA_BUFFER, ETH)
+#
+# The report is printed and written next to the ELF. Region totals come from
+# the linker itself (-Wl,--print-memory-usage).
+#
+# Usage (from a POST_BUILD step):
+#   cmake -DOBJDUMP=<arm-none-eabi-objdump> -DELF=<file.elf>
+#         -DOUT=<report.txt> -P cmake/placement_report.cmake
+#
+
+cmake_minimum_required(VERSION 3.20)
+
+if(NOT OBJDUMP OR NOT ELF)
+  message(FATAL_ERROR "placement_report: OBJDUMP and ELF must be set")
+endif()
+
+execute_process(
+  COMMAND "${OBJDUMP}" -t "${ELF}"
+  OUTPUT_VARIABLE _syms
+  RESULT_VARIABLE _rc
+)
+if(NOT _rc EQUAL 0)
+  message(FATAL_ERROR "placement_report: ${OBJDUMP} -t failed (${_rc})")
+endif()
+
+set(_sections .itcm_text .dtcm_data .dtcm_bss .dma_buffer)
+
+# objdump -t line: <addr> <flags:7> <section>\t<size> <name>
+string(REPLACE "\n" ";" _lines "${_syms}")
+
+set(_report "")
+foreach(_sec IN LISTS _sections)
+  set(_entries "")
+  set(_total 0)
+
+  foreach(_line IN LISTS _lines)
+    if(_line MATCHES "^([0-9a-fA-F]+) ....... ([^\t ]+)\t([0-9a-fA-F]+) (.+)$")
+      set(_addr "${CMAKE_MATCH_1}")
+      set(_in   "${CMAKE_MATCH_2}")
+      set(_size "${CMAKE_MATCH_3}")
+      set(_name "${CMAKE_MATCH_4}")
+
+      # Objects and functions only (section/file symbols have size 0)
+      if(_in STREQUAL _sec AND NOT _size MATCHES "^0+$")
+        math(EXPR _bytes "0x${_size}" OUTPUT_FORMAT DECIMAL)
+        math(EXPR _total "${_total} + ${_bytes}")
+        list(APPEND _entries "  0x${_addr}  ${_bytes}\t${_name}")
+      endif()
+    endif()
+  endforeach()
+
+  list(SORT _entries)
+  string(APPEND _report "${_sec}: ${_total} bytes\n")
+  foreach(_e IN LISTS _entries)
+    string(APPEND _report "${_e}\n")
+  endforeach()
+endforeach()
+
+message("Memory placement (${ELF}):\n${_report}")
+
+if(OUT)
+  file(WRITE "${OUT}" "${_report}")
+endif()
@@ -0,0 +1,52 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    sim_clock.h
+ * Brief:   Virtual clock of the host simulation
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Core clock the cycle counter runs at (SystemClock_Config()) */
+#define SIM_CLOCK_CPU_HZ  216000000UL
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * Simulated time in microseconds since boot. HAL_GetTick(), sys_now(),
+ * App_GetMicros() and App_GetCycles() are all derived from it; it only
+ * moves when the simulation loop advances it.
+ */
+uint64_t SIM_CLOCK_Now(void);
+void     SIM_CLOCK_AdvanceTo(uint64_t us);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_CLOCK_H */
@@ -0,0 +1,69 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    sim_netif.h
+ * Brief:   Simulated ETH MAC / DMA behind the ethernetif.h interface
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SIM_NETIF_H
+#define SIM_NETIF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "ethernetif.h"   /* the interface sim_netif.c implements */
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Same sizes as the firmware: HAL descriptor rings (stm32f7xx_hal_conf.h,
+   HAL default) and the RX_POOL of ethernetif.c */
+#define SIM_ETH_TX_DESC_CNT     8U
+#define SIM_ETH_RX_DESC_CNT     4U
+#define SIM_ETH_RX_BUFFER_CNT   12U
+#define SIM_ETH_RX_BUF_SIZE     1524U
+
+/* Frames per ethernetif_input() pass (ETH_RX_BUDGET_DEFAULT) */
+#define SIM_ETH_RX_BUDGET       8U
+
+/* MAC address of eth.c */
+#define SIM_ETH_MAC             { 0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U }
+
+/* Returned by SIM_NETIF_NextEvent() when no TX frame is on the way */
+#define SIM_NETIF_IDLE          UINT64_MAX
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * ETH interrupt: moves frames that arrived by now from the wire into the RX
+ * descriptors and flags sent TX frames. The simulation loop calls it after
+ * every clock advance.
+ */
+void     SIM_NETIF_Irq(void);
+
+/* next TX complete interrupt (us), SIM_NETIF_IDLE if none */
+uint64_t SIM_NETIF_NextEvent(void);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_NETIF_H */
@@ -0,0 +1,122 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    sim_peer.h
+ * Brief:   Simulated telemetry gateway (ARP, UDP sink, TCP server)
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SIM_PEER_H
+#define SIM_PEER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Gateway MAC (its IPv4 address is APP_RASPI_IP) */
+#define SIM_PEER_MAC        { 0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0x50U }
+
+/* Sample sequence numbers tracked on the TCP stream */
+#ifndef SIM_PEER_SEQ_MAX
+#define SIM_PEER_SEQ_MAX    (1UL << 20)
+#endif
+
+/* Receive window advertised by the gateway (no window scaling) */
+#define SIM_PEER_TCP_WND    65535U
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SIM_PEER_TCP_ACCEPT = 0,  /* listening on APP_TCP_PORT            */
+  SIM_PEER_TCP_REFUSE       /* service down: SYNs answered with RST */
+} SimPeerTcpMode;
+
+/*
+ * What the gateway received. 'seq_*' describe the sample sequence numbers
+ * of the binary sample frames on the TCP stream (live and replayed):
+ * 'seq_missing' are numbers between the first and the last one that never
+ * arrived, 'seq_dups' numbers that arrived more than once (replays of
+ * samples the gateway already had).
+ */
+typedef struct
+{
+  uint32_t arp_replies;
+
+  /* UDP, APP_UDP_PORT */
+  uint32_t udp_datagrams;
+  uint64_t udp_bytes;
+  uint32_t udp_samples;       /* JSON lines, binary frames, block counts */
+  uint32_t udp_netstat;       /* statistics channel lines                */
+  uint32_t udp_other;         /* CAN event frames                        */
+
+  /* TCP, APP_TCP_PORT */
+  uint32_t tcp_accepts;       /* connections established                 */
+  uint32_t tcp_refused;       /* SYNs answered with RST                  */
+  uint32_t tcp_resets_rx;     /* connections reset by the board          */
+  uint32_t tcp_resets_tx;     /* connections reset by the gateway        */
+  uint64_t tcp_bytes;         /* in-order stream bytes                   */
+  uint32_t tcp_retrans;       /* segments with data already received     */
+  uint32_t tcp_ooo;           /* segments beyond a hole                  */
+  uint32_t tcp_records;       /* frames and JSON lines on the stream     */
+  uint32_t tcp_samples;       /* binary sample frames                    */
+  uint32_t tcp_responses;     /* command responses                       */
+  uint32_t tcp_resync;        /* bytes skipped to find a frame start     */
+
+  uint32_t seq_first;
+  uint32_t seq_last;
+  uint32_t seq_unique;
+  uint32_t seq_dups;
+  uint32_t seq_missing;
+
+  /* gateway ACK lines ("ACK <seq>\n") */
+  uint32_t gw_acks;
+  uint32_t gw_acked_seq;
+} SimPeerStats;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* gw_ack: acknowledge persisted samples with "ACK <seq>\n" lines */
+void SIM_PEER_Init(bool gw_ack);
+
+/* handle the frames that reached the gateway by now */
+void SIM_PEER_Service(void);
+
+/* host reachable (true) or silently dropping everything */
+void SIM_PEER_SetOnline(bool online);
+
+/* TCP service up or refusing connections */
+void SIM_PEER_SetTcpMode(SimPeerTcpMode mode);
+
+/* gateway process restart: RST on the open connection */
+void SIM_PEER_ResetConnection(void);
+
+void SIM_PEER_GetStats(SimPeerStats *out);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_PEER_H */
@@ -0,0 +1,99 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    sim_wire.h
+ * Brief:   Simulated full-duplex Ethernet link with optional pcap capture
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* USER CODE BEGIN Includes */
+/* USER CODE END Includes */
+
+/* Exported constants --------------------------------------------------------*/
+/* Largest frame without FCS (1500 byte MTU + Ethernet header + VLAN tag) */
+#define SIM_WIRE_FRAME_MAX      1518U
+
+/* Frames on the way, per direction */
+#ifndef SIM_WIRE_QUEUE
+#define SIM_WIRE_QUEUE          256U
+#endif
+
+/* Line rate (Mbit/s) and cable + PHY latency */
+#define SIM_WIRE_MBPS_DEFAULT   100U
+#define SIM_WIRE_PROP_NS        1000U
+
+/* Returned by SIM_WIRE_NextArrival() when nothing is on the way */
+#define SIM_WIRE_IDLE           UINT64_MAX
+
+/* USER CODE BEGIN EC */
+/* USER CODE END EC */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SIM_WIRE_TO_PEER = 0,     /* board -> gateway (uplink)   */
+  SIM_WIRE_TO_BOARD,        /* gateway -> board (downlink) */
+  SIM_WIRE_DIRS
+} SimWireDir;
+
+typedef struct
+{
+  uint32_t frames;          /* frames put on the line                   */
+  uint64_t bytes;           /* frame bytes (no preamble / FCS / IFG)    */
+  uint64_t busy_ns;         /* line occupied, preamble to IFG           */
+  uint32_t lost;            /* dropped: link down or injected loss      */
+  uint32_t overflow;        /* dropped: more than SIM_WIRE_QUEUE queued */
+} SimWireStats;
+
+/* USER CODE BEGIN ET */
+/* USER CODE END ET */
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* line rate, uplink loss in 1/1000 (fixed seed: runs repeat exactly) */
+void SIM_WIRE_Init(uint32_t mbps, uint32_t loss_permille);
+
+/* put a frame on the line; returns when its last bit has left (us) */
+uint64_t SIM_WIRE_Send(SimWireDir dir, const uint8_t *frame, uint16_t len);
+
+/* next frame that has arrived by now; 0 if none */
+uint16_t SIM_WIRE_Receive(SimWireDir dir, uint8_t *out, uint16_t cap);
+
+/* earliest arrival of a queued frame (us), SIM_WIRE_IDLE if none */
+uint64_t SIM_WIRE_NextArrival(void);
+
+/* cable plugged (true) or pulled: frames in transit are lost */
+void SIM_WIRE_SetLink(bool up);
+bool SIM_WIRE_LinkUp(void);
+
+void SIM_WIRE_GetStats(SimWireDir dir, SimWireStats *out);
+
+/* capture both directions to a pcap file (Ethernet link type) */
+bool SIM_WIRE_PcapOpen(const char *path);
+void SIM_WIRE_PcapClose(void);
+
+/* USER CODE BEGIN EFP */
+/* USER CODE END EFP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_WIRE_H */
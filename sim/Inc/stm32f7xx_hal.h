@@ -0,0 +1,70 @@
+/* USER CODE BEGIN Header */
+/******************************************************************************
+ * File:    stm32f7xx_hal.h (sim)
+ * Brief:   Host stand-in for the HAL umbrella header (simulation build only)
+ *
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *****************************************************************************/
+/* USER CODE END Header */
+
+/*
+ * The firmware headers compiled by the simulation (main.h, app_platform.h,
+ * can.h, lwip.h, lwipopts.h) include the HAL. sim/Inc comes first on the
+ * include path, so they get this file instead: only the types and functions
+ * they declare or use, implemented by sim/Src. The pin macros of main.h are
+ * never expanded and need nothing here.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F7xx_HAL_H
+#define __STM32F7xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK      = 0x00U,
+  HAL_ERROR   = 0x01U,
+  HAL_BUSY    = 0x02U,
+  HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* Peripheral handles declared by can.h / lwip.h (contents unused) */
+typedef struct
+{
+  uint32_t State;
+} CAN_HandleTypeDef;
+
+typedef struct
+{
+  uint32_t State;
+} ETH_HandleTypeDef;
+
+/* Exported macro ------------------------------------------------------------*/
+#define __ALIGNED(x)  __attribute__((aligned(x)))
+
+/* The simulation loop advances the clock instead of sleeping */
+#define __WFI()       ((void)0)
+
+/* Exported functions prototypes ---------------------------------------------*/
+/* virtual clock (sim_clock.c) */
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t Delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F7xx_HAL_H */
@@ -0,0 +1,145 @@
+/**
+ * @file    sim_board.c
+ * @brief   Board stand-ins of the host simulation: sensors, CAN, cache.
+ *
+ * This module provides what app_net.c reads from the rest of the firmware:
+ *  - The I2C temperature sensor (App_I2C_*): a slow sine around 23 degC
+ *  - The CAN node (CAN1_*): heartbeat 0x101 every 100 ms and light sensor
+ *    0x120 values derived from the virtual clock, texts as can.c formats
+ *    them; raw capture (CAN push) never has frames
+ *  - Error_Handler() and the D-cache maintenance calls (no cache here)
+ *
+ * All values depend on the virtual clock only, so samples are the same in
+ * every run.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "main.h"
+#include "app_helpers.h"
+#include "app_platform.h"
+#include "can.h"
+
+/* =============================================================================
+ * Platform
+ * ============================================================================= */
+void Error_Handler(void)
+{
+  fprintf(stderr, "sim: Error_Handler()\n");
+  abort();
+}
+
+void App_DCacheClean(const void *addr, uint32_t len)
+{
+  (void)addr;
+  (void)len;
+}
+
+void App_DCacheInvalidate(void *addr, uint32_t len)
+{
+  (void)addr;
+  (void)len;
+}
+
+/* =============================================================================
+ * I2C temperature sensor
+ * ============================================================================= */
+uint8_t App_I2C_IsOk(void)
+{
+  return 1U;
+}
+
+float App_I2C_GetTemp(void)
+{
+  /* one period per simulated minute, +-1.5 degC */
+  return 23.0f + 1.5f * sinf((float)(HAL_GetTick() % 60000U) * (6.2831853f / 60000.0f));
+}
+
+int App_I2C_GetTempInt(void)
+{
+  return (int)lroundf(App_I2C_GetTemp());
+}
+
+/* =============================================================================
+ * CAN node
+ * ============================================================================= */
+static char s_101_txt[64];
+static char s_120_txt[64];
+
+uint8_t CAN1_101_IsValid(void)
+{
+  return 1U;
+}
+
+uint8_t CAN1_101_GetSeq(void)
+{
+  return (uint8_t)(HAL_GetTick() / 100U);
+}
+
+uint8_t CAN1_120_IsValid(void)
+{
+  return 1U;
+}
+
+uint32_t CAN1_120_GetLuxX100(void)
+{
+  /* changes every 500 ms */
+  return 30000U + ((HAL_GetTick() / 500U) % 64U) * 25U;
+}
+
+uint32_t CAN1_120_GetLux(void)
+{
+  return CAN1_120_GetLuxX100() / 100U;
+}
+
+uint16_t CAN1_120_GetFull(void)
+{
+  return (uint16_t)(CAN1_120_GetLuxX100() / 20U);
+}
+
+uint16_t CAN1_120_GetIR(void)
+{
+  return (uint16_t)(CAN1_120_GetLuxX100() / 90U);
+}
+
+const char *CAN1_GetText_0x101(void)
+{
+  snprintf(s_101_txt, sizeof(s_101_txt), "HB seq=%u", (unsigned)CAN1_101_GetSeq());
+  return s_101_txt;
+}
+
+const char *CAN1_GetText_0x120(void)
+{
+  snprintf(s_120_txt, sizeof(s_120_txt), "LIGHT lux=%lu full=%u ir=%u",
+           (unsigned long)CAN1_120_GetLux(), (unsigned)CAN1_120_GetFull(),
+           (unsigned)CAN1_120_GetIR());
+  return s_120_txt;
+}
+
+const char *CAN1_GetLastText(void)
+{
+  return s_120_txt;
+}
+
+void CAN1_SetRawCapture(uint8_t on)
+{
+  (void)on;
+}
+
+uint8_t CAN1_PopRaw(CAN1_RawFrame *out)
+{
+  (void)out;
+  return 0U;
+}
+
+uint16_t CAN1_RawPending(void)
+{
+  return 0U;
+}
+
+uint32_t CAN1_GetRawOverflow(void)
+{
+  return 0U;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file    sim_clock.c
+ * @brief   Virtual clock of the host simulation.
+ *
+ * This module provides:
+ *  - The simulated time base (microseconds since boot)
+ *  - The platform time functions the firmware uses, on top of it:
+ *    HAL_GetTick(), HAL_Delay(), App_GetMicros(), App_CycleCounterInit(),
+ *    App_GetCycles()
+ *
+ * Design notes:
+ *  - Time never moves on its own: the simulation loop (sim_main.c) jumps to
+ *    the next deadline, so a run is deterministic and as fast as the host
+ *  - Code between two advances takes no simulated time; cycle counts
+ *    (app_tsc.c, app_membench.c) therefore read 0 for pure computation
+ */
+
+#include "sim_clock.h"
+
+#include "stm32f7xx_hal.h"
+#include "app_platform.h"
+
+/* =============================================================================
+ * Time base
+ * ============================================================================= */
+static uint64_t s_now_us;
+
+uint64_t SIM_CLOCK_Now(void)
+{
+  return s_now_us;
+}
+
+/**
+ * @brief Move the clock forward to us (never backwards).
+ */
+void SIM_CLOCK_AdvanceTo(uint64_t us)
+{
+  if (us > s_now_us)
+    s_now_us = us;
+}
+
+/* =============================================================================
+ * Platform time functions
+ * ============================================================================= */
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(s_now_us / 1000U);
+}
+
+/**
+ * @brief Blocking delay: the clock simply moves on.
+ */
+void HAL_Delay(uint32_t Delay)
+{
+  s_now_us += (uint64_t)Delay * 1000U;
+}
+
+uint64_t App_GetMicros(void)
+{
+  return s_now_us;
+}
+
+void App_CycleCounterInit(void)
+{
+}
+
+uint32_t App_GetCycles(void)
+{
+  return (uint32_t)(s_now_us * (SIM_CLOCK_CPU_HZ / 1000000UL));
+}
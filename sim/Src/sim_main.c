@@ -0,0 +1,372 @@
+/**
+ * @file    sim_main.c
+ * @brief   Host simulation of the telemetry transport: scenario driver.
+ *
+ * This program runs the firmware's network side (lwIP, lwip.c, app_net.c
+ * and the modules below it) unchanged on a Linux host:
+ *  - Board:   app_net.c -> lwIP -> sim_netif.c (ETH DMA rings)
+ *  - Cable:   sim_wire.c (line rate, propagation, optional uplink loss,
+ *             optional pcap capture)
+ *  - Gateway: sim_peer.c (UDP sink, TCP server, gateway ACKs)
+ *
+ * Time is virtual (sim_clock.c). The loop mirrors main(): service the
+ * network, then "sleep" for APP_NET_SleepTime() - here by advancing the
+ * clock straight to the next event (timer, frame arrival, TX complete,
+ * scenario step) instead of waiting for it. CPU time of the board is not
+ * modelled: all processing is instantaneous.
+ *
+ * Scenarios (the disruption lasts from 1/3 to 2/3 of the run):
+ *  - steady:    nothing happens
+ *  - reconnect: the gateway service restarts: RST, connections refused
+ *  - outage:    the gateway drops off the network, connection stays open
+ *  - linkdown:  the cable is pulled
+ *
+ * The exit code is 1 when samples went missing on the TCP stream beyond
+ * what the board reports as dropped, or when (without loss injection or
+ * outage) UDP datagrams did not all arrive; scripts can run it as a
+ * regression check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "main.h"
+#include "lwip.h"
+#include "app_net.h"
+#include "app_netstat.h"
+#include "sim_clock.h"
+#include "sim_wire.h"
+#include "sim_netif.h"
+#include "sim_peer.h"
+
+/* =============================================================================
+ * Configuration
+ * ============================================================================= */
+
+/* Clock step while APP_NET_SleepTime() says "do not sleep" (one pass of the
+   firmware main loop, roughly) */
+#define SIM_LOOP_US         10U
+
+/* Longest single sleep (the firmware's SysTick would wake it anyway) */
+#define SIM_SLEEP_MAX_MS    1000U
+
+/* After the run: time for frames still on the cable to arrive */
+#define SIM_DRAIN_US        50000U
+
+typedef enum
+{
+  SCN_STEADY = 0,
+  SCN_RECONNECT,
+  SCN_OUTAGE,
+  SCN_LINKDOWN
+} sim_scenario_t;
+
+typedef struct
+{
+  sim_scenario_t   scenario;
+  uint32_t         duration_s;
+  uint32_t         rate_hz;
+  AppFrameEncoding enc;
+  bool             gw_ack;
+  uint32_t         loss_permille;
+  uint32_t         mbps;
+  const char      *pcap;
+  uint32_t         netstat_ms;
+} sim_cfg_t;
+
+static const char *const s_scn_names[] = { "steady", "reconnect", "outage", "linkdown" };
+static const char *const s_enc_names[] = { "json", "bin", "delta" };
+
+static sim_cfg_t s_cfg = {
+  .scenario      = SCN_STEADY,
+  .duration_s    = 10U,
+  .rate_hz       = 100U,
+  .enc           = APP_FRAME_ENC_BIN,
+  .gw_ack        = false,
+  .loss_permille = 0U,
+  .mbps          = SIM_WIRE_MBPS_DEFAULT,
+  .pcap          = NULL,
+  .netstat_ms    = 0U,
+};
+
+/* =============================================================================
+ * Command line
+ * ============================================================================= */
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --scenario steady|reconnect|outage|linkdown  (steady)\n"
+          "  --duration <s>         simulated run time          (10)\n"
+          "  --rate <hz>            sample rate                 (100)\n"
+          "  --encoding json|bin|delta                          (bin)\n"
+          "  --gw-ack               gateway acknowledges samples\n"
+          "  --loss <permille>      board -> gateway frame loss (0)\n"
+          "  --mbps <n>             line rate                   (100)\n"
+          "  --netstat <ms>         statistics channel period   (off)\n"
+          "  --pcap <file>          capture both directions\n",
+          argv0);
+}
+
+static int lookup(const char *s, const char *const *names, int n)
+{
+  for (int i = 0; i < n; i++)
+    if (strcmp(s, names[i]) == 0) return i;
+  return -1;
+}
+
+static bool parse_args(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+    int k;
+
+    if (strcmp(a, "--gw-ack") == 0) {
+      s_cfg.gw_ack = true;
+      continue;
+    }
+    if (!v) return false;
+    i++;
+
+    if (strcmp(a, "--scenario") == 0) {
+      if ((k = lookup(v, s_scn_names, 4)) < 0) return false;
+      s_cfg.scenario = (sim_scenario_t)k;
+    } else if (strcmp(a, "--encoding") == 0) {
+      if ((k = lookup(v, s_enc_names, 3)) < 0) return false;
+      s_cfg.enc = (AppFrameEncoding)k;
+    } else if (strcmp(a, "--duration") == 0) {
+      s_cfg.duration_s = (uint32_t)strtoul(v, NULL, 0);
+    } else if (strcmp(a, "--rate") == 0) {
+      s_cfg.rate_hz = (uint32_t)strtoul(v, NULL, 0);
+    } else if (strcmp(a, "--loss") == 0) {
+      s_cfg.loss_permille = (uint32_t)strtoul(v, NULL, 0);
+    } else if (strcmp(a, "--mbps") == 0) {
+      s_cfg.mbps = (uint32_t)strtoul(v, NULL, 0);
+    } else if (strcmp(a, "--netstat") == 0) {
+      s_cfg.netstat_ms = (uint32_t)strtoul(v, NULL, 0);
+    } else if (strcmp(a, "--pcap") == 0) {
+      s_cfg.pcap = v;
+    } else {
+      return false;
+    }
+  }
+
+  return s_cfg.duration_s != 0U && s_cfg.mbps != 0U && s_cfg.loss_permille <= 1000U;
+}
+
+/* =============================================================================
+ * Scenario
+ * ============================================================================= */
+static void disruption(bool begin)
+{
+  switch (s_cfg.scenario) {
+    case SCN_RECONNECT:
+      if (begin) SIM_PEER_ResetConnection();
+      SIM_PEER_SetTcpMode(begin ? SIM_PEER_TCP_REFUSE : SIM_PEER_TCP_ACCEPT);
+      break;
+    case SCN_OUTAGE:
+      SIM_PEER_SetOnline(!begin);
+      break;
+    case SCN_LINKDOWN:
+      SIM_WIRE_SetLink(!begin);
+      break;
+    default:
+      break;
+  }
+}
+
+static uint64_t min_u64(uint64_t a, uint64_t b)
+{
+  return (a < b) ? a : b;
+}
+
+/**
+ * @brief Run the board and the gateway until 'end_us' of virtual time.
+ */
+static void run(uint64_t end_us)
+{
+  const uint64_t t_begin = end_us / 3U;
+  const uint64_t t_end   = (end_us / 3U) * 2U;
+  uint8_t phase = 0;
+  uint64_t now;
+
+  while ((now = SIM_CLOCK_Now()) < end_us) {
+    if (phase == 0U && now >= t_begin) { disruption(true);  phase = 1U; }
+    if (phase == 1U && now >= t_end)   { disruption(false); phase = 2U; }
+
+    SIM_NETIF_Irq();
+    SIM_PEER_Service();
+    APP_NET_Service(HAL_GetTick());
+
+    uint32_t sleep_ms = APP_NET_SleepTime(HAL_GetTick());
+    uint64_t next;
+
+    if (sleep_ms == 0U) {
+      next = now + SIM_LOOP_US;
+    } else {
+      if (sleep_ms > SIM_SLEEP_MAX_MS) sleep_ms = SIM_SLEEP_MAX_MS;
+
+      /* Wake on the ms tick the firmware would, or on an interrupt */
+      next = ((uint64_t)HAL_GetTick() + sleep_ms) * 1000U;
+      next = min_u64(next, SIM_WIRE_NextArrival());
+      next = min_u64(next, SIM_NETIF_NextEvent());
+      next = min_u64(next, (phase == 0U) ? t_begin : (phase == 1U) ? t_end : end_us);
+      if (next <= now) next = now + 1U;
+    }
+
+    SIM_CLOCK_AdvanceTo(min_u64(next, end_us));
+  }
+
+  /* Let the last frames reach the gateway */
+  SIM_CLOCK_AdvanceTo(end_us + SIM_DRAIN_US);
+  SIM_PEER_Service();
+}
+
+/* =============================================================================
+ * Report
+ * ============================================================================= */
+static double wire_util(SimWireDir dir, double secs)
+{
+  SimWireStats w;
+  SIM_WIRE_GetStats(dir, &w);
+  return (secs > 0.0) ? (double)w.busy_ns / (secs * 1e9) * 100.0 : 0.0;
+}
+
+static int report(double wall_s)
+{
+  AppNetUdpStats     udp;
+  AppNetTcpStats     tcp;
+  AppNetBacklogStats bl;
+  AppNetstatPool     pools[16];
+  SimPeerStats       peer;
+  SimWireStats       up, down;
+  ethernetif_stats_t eth;
+  const double sim_s = (double)s_cfg.duration_s;
+  uint32_t netstat_sent = 0, netstat_err = 0;
+  int rc = 0;
+
+  APP_NET_GetUdpStats(&udp);
+  APP_NET_GetTcpStats(&tcp);
+  APP_NET_GetBacklogStats(&bl);
+  SIM_PEER_GetStats(&peer);
+  SIM_WIRE_GetStats(SIM_WIRE_TO_PEER, &up);
+  SIM_WIRE_GetStats(SIM_WIRE_TO_BOARD, &down);
+  ethernetif_get_stats(&eth);
+  APP_NET_GetNetstatCounts(&netstat_sent, &netstat_err);
+
+  printf("scenario %s, %lu s at %lu Hz, %s, gw-ack %s, loss %lu/1000, %lu Mbit/s\n",
+         s_scn_names[s_cfg.scenario], (unsigned long)s_cfg.duration_s,
+         (unsigned long)s_cfg.rate_hz, s_enc_names[s_cfg.enc],
+         s_cfg.gw_ack ? "on" : "off", (unsigned long)s_cfg.loss_permille,
+         (unsigned long)s_cfg.mbps);
+  printf("wall     %.3f s (%.0fx real time)\n", wall_s, (wall_s > 0.0) ? sim_s / wall_s : 0.0);
+
+  printf("udp      board: %lu datagrams, %lu samples, %lu dropped, %lu errors\n"
+           "         peer:  %lu datagrams, %lu samples, %lu netstat\n",
+         (unsigned long)udp.datagrams, (unsigned long)udp.samples,
+         (unsigned long)udp.dropped, (unsigned long)udp.errors,
+         (unsigned long)peer.udp_datagrams, (unsigned long)peer.udp_samples,
+         (unsigned long)peer.udp_netstat);
+
+  printf("tcp      board: %lu queued, %lu acked, %lu dropped\n"
+           "         peer:  %lu accepts, %lu refused, %lu resets rx, %lu resets tx,"
+           " %llu bytes, %lu records, %lu retrans, %lu ooo\n",
+         (unsigned long)tcp.total_queued, (unsigned long)tcp.total_acked,
+         (unsigned long)tcp.total_dropped,
+         (unsigned long)peer.tcp_accepts, (unsigned long)peer.tcp_refused,
+         (unsigned long)peer.tcp_resets_rx, (unsigned long)peer.tcp_resets_tx,
+         (unsigned long long)peer.tcp_bytes, (unsigned long)peer.tcp_records,
+         (unsigned long)peer.tcp_retrans, (unsigned long)peer.tcp_ooo);
+
+  printf("backlog  %lu stored, %lu replayed, %lu evicted, %u unsent, gw acked %lu\n",
+         (unsigned long)bl.stored, (unsigned long)bl.replayed,
+         (unsigned long)bl.evicted, (unsigned)bl.unsent,
+         (unsigned long)bl.gw_acked_seq);
+
+  if (s_cfg.enc != APP_FRAME_ENC_JSON) {
+    printf("samples  seq %lu..%lu: %lu unique, %lu duplicate, %lu missing\n",
+           (unsigned long)peer.seq_first, (unsigned long)peer.seq_last,
+           (unsigned long)peer.seq_unique, (unsigned long)peer.seq_dups,
+           (unsigned long)peer.seq_missing);
+  }
+
+  printf("wire     up %lu frames %.2f%%, %lu lost; down %lu frames %.2f%%\n",
+         (unsigned long)up.frames, wire_util(SIM_WIRE_TO_PEER, sim_s),
+         (unsigned long)up.lost, (unsigned long)down.frames,
+         wire_util(SIM_WIRE_TO_BOARD, sim_s));
+  printf("eth      tx %lu busy %lu max-inuse %lu; rx %lu missed %lu pool-empty %lu\n",
+         (unsigned long)eth.tx_frames, (unsigned long)eth.tx_busy,
+         (unsigned long)eth.tx_inuse_max, (unsigned long)eth.rx_frames,
+         (unsigned long)eth.rx_missed, (unsigned long)eth.rx_pool_empty);
+
+  uint8_t n = APP_NETSTAT_GetPools(pools, (uint8_t)(sizeof(pools) / sizeof(pools[0])));
+  printf("pools   ");
+  for (uint8_t i = 0; i < n; i++) {
+    if (pools[i].peak == 0U && pools[i].fail == 0U) continue;
+    printf(" %s %lu/%lu%s", pools[i].name, (unsigned long)pools[i].peak,
+           (unsigned long)pools[i].avail, pools[i].fail ? "!" : "");
+  }
+  printf("\n");
+
+  /* Samples lost on the stream must be accounted for by the board */
+  if (s_cfg.enc != APP_FRAME_ENC_JSON) {
+    uint32_t explained = tcp.total_dropped + bl.evicted + bl.unsent;
+    if (peer.seq_missing > explained) {
+      printf("FAIL     %lu samples missing, board accounts for %lu\n",
+             (unsigned long)peer.seq_missing, (unsigned long)explained);
+      rc = 1;
+    }
+  }
+
+  /* Without loss and with the gateway online, every datagram arrives */
+  if (s_cfg.loss_permille == 0U &&
+      (s_cfg.scenario == SCN_STEADY || s_cfg.scenario == SCN_RECONNECT) &&
+      peer.udp_datagrams != udp.datagrams + netstat_sent) {
+    printf("FAIL     %lu datagrams sent, %lu received\n",
+           (unsigned long)(udp.datagrams + netstat_sent),
+           (unsigned long)peer.udp_datagrams);
+    rc = 1;
+  }
+
+  if (rc == 0) printf("PASS\n");
+  return rc;
+}
+
+/* =============================================================================
+ * Entry point
+ * ============================================================================= */
+int main(int argc, char **argv)
+{
+  struct timespec t0, t1;
+
+  if (!parse_args(argc, argv)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  SIM_WIRE_Init(s_cfg.mbps, s_cfg.loss_permille);
+  if (s_cfg.pcap && !SIM_WIRE_PcapOpen(s_cfg.pcap)) {
+    fprintf(stderr, "sim: cannot open %s\n", s_cfg.pcap);
+    return 2;
+  }
+  SIM_PEER_Init(s_cfg.gw_ack);
+
+  /* Same order as main() */
+  MX_LWIP_Init();
+  APP_NET_Init();
+
+  APP_NET_SetEncoding(s_cfg.enc);
+  APP_NET_SetSampleRate(s_cfg.rate_hz);
+  APP_NET_SetNetstatPeriod(s_cfg.netstat_ms);
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  run((uint64_t)s_cfg.duration_s * 1000000U);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  SIM_WIRE_PcapClose();
+
+  return report((double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9);
+}
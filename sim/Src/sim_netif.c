@@ -0,0 +1,463 @@
+/**
+ * @file    sim_netif.c
+ * @brief   Simulated ETH MAC / DMA behind the ethernetif.h interface.
+ *
+ * This module replaces ethernetif.c in the host simulation and keeps the
+ * parts of it that shape the telemetry transport:
+ *  - RX: four descriptors armed with RX_POOL buffers; a frame arriving on a
+ *    descriptor without a buffer is missed (rx_missed), a failed refill
+ *    stops reading until a buffer comes back (rx_pool_empty), exactly as
+ *    HAL_ETH_ReadData() and pbuf_free_custom() behave on the board
+ *  - TX: the eight-descriptor ring; frames stay referenced (TLM_POOL
+ *    buffers, no-copy TCP data) until their last bit is on the wire, a full
+ *    ring returns ERR_MEM (tx_busy), long chains are linearized
+ *  - The interrupt-flag protocol of ethernetif_input() /
+ *    ethernetif_pending() / ethernetif_sleeptime(), the per-pass RX budget
+ *    and the statistics of ethernetif_get_stats()
+ *  - Link state from the simulated cable (sim_wire.c)
+ *
+ * Not modelled: the broadcast budget and storm blocking (the simulated
+ * gateway sends no broadcast load), the multicast hash (filter requests are
+ * accepted), MMC error counters (the wire has no bit errors).
+ */
+
+#include "sim_netif.h"
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+#include "netif/etharp.h"
+
+#include "sim_clock.h"
+#include "sim_wire.h"
+
+/* Private define ------------------------------------------------------------*/
+#define IFNAME0 's'
+#define IFNAME1 't'
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+  RX_ALLOC_OK    = 0x00,
+  RX_ALLOC_ERROR = 0x01
+} RxAllocStatusTypeDef;
+
+typedef struct
+{
+  struct pbuf_custom pbuf_custom;
+  uint8_t buff[(SIM_ETH_RX_BUF_SIZE + 31) & ~31] __attribute__((aligned(32)));
+} RxBuff_t;
+
+/* Same pool name as ethernetif.c: "netstat" lists it */
+LWIP_MEMPOOL_DECLARE(RX_POOL, SIM_ETH_RX_BUFFER_CNT, sizeof(RxBuff_t), "Zero-copy RX PBUF pool");
+
+/* RX descriptor: no buffer, owned by the DMA with a buffer, holding a frame */
+typedef enum
+{
+  RX_DESC_EMPTY = 0,
+  RX_DESC_ARMED,
+  RX_DESC_FULL
+} rx_desc_state_t;
+
+typedef struct
+{
+  RxBuff_t *buf;
+  uint16_t  len;
+  uint8_t   state;
+} rx_desc_t;
+
+/* Frame in the TX ring until its last bit has left */
+typedef struct
+{
+  struct pbuf *p;
+  uint64_t     done_us;
+  uint8_t      ndesc;
+} tx_rec_t;
+
+/* Private variables ---------------------------------------------------------*/
+static rx_desc_t s_rx[SIM_ETH_RX_DESC_CNT];
+static uint8_t   s_rx_dma;          /* next descriptor the DMA writes   */
+static uint8_t   s_rx_app;          /* next descriptor the driver reads */
+static uint8_t   s_rx_suspended;    /* DMA stopped on an empty one      */
+
+static tx_rec_t  s_tx[SIM_ETH_TX_DESC_CNT];
+static uint8_t   s_tx_head;
+static uint8_t   s_tx_count;
+static uint8_t   s_tx_inuse;        /* descriptors of the queued frames */
+
+static uint8_t RxAllocStatus;
+static uint8_t RxPending;
+static uint8_t TxPending;
+
+static ethernetif_stats_t EthStats;
+
+static ethernetif_filter_t EthFilter = {
+  .promiscuous        = 0U,
+  .pass_all_multicast = 0U,
+  .bcast_per_sec      = 0U,
+  .rx_budget          = SIM_ETH_RX_BUDGET,
+};
+
+static const uint8_t s_mac[ETH_HWADDR_LEN] = SIM_ETH_MAC;
+
+void pbuf_free_custom(struct pbuf *p);
+
+/* =============================================================================
+ * RX DMA
+ * ============================================================================= */
+
+/**
+ * @brief Give every descriptor without a buffer a new one from RX_POOL
+ *        (ETH_UpdateDescriptor() via HAL_ETH_RxAllocateCallback()).
+ */
+static void rx_refill(void)
+{
+  for (uint32_t i = 0; i < SIM_ETH_RX_DESC_CNT; i++) {
+    rx_desc_t *d = &s_rx[(s_rx_app + i) % SIM_ETH_RX_DESC_CNT];
+
+    if (d->state != RX_DESC_EMPTY)
+      continue;
+
+    d->buf = (RxBuff_t *)LWIP_MEMPOOL_ALLOC(RX_POOL);
+    if (!d->buf) {
+      RxAllocStatus = RX_ALLOC_ERROR;
+      EthStats.rx_pool_empty++;
+      return;
+    }
+    d->state = RX_DESC_ARMED;
+  }
+}
+
+/**
+ * @brief MAC address filter: own unicast address, broadcast, multicast
+ *        only when passed wholesale.
+ */
+static uint8_t rx_mac_match(const uint8_t *f)
+{
+  if (EthFilter.promiscuous)
+    return 1U;
+
+  if ((f[0] & 0x01U) == 0U)
+    return (uint8_t)(memcmp(f, s_mac, ETH_HWADDR_LEN) == 0);
+
+  if ((f[0] & f[1] & f[2] & f[3] & f[4] & f[5]) == 0xFFU)
+    return 1U;
+
+  return EthFilter.pass_all_multicast;
+}
+
+/**
+ * @brief DMA side of reception: frames that arrived by now go into the
+ *        armed descriptors in ring order.
+ */
+static void rx_dma(void)
+{
+  uint8_t  frame[SIM_WIRE_FRAME_MAX];
+  uint16_t n;
+
+  while ((n = SIM_WIRE_Receive(SIM_WIRE_TO_BOARD, frame, sizeof(frame))) != 0U) {
+    rx_desc_t *d = &s_rx[s_rx_dma];
+
+    if (n < SIZEOF_ETH_HDR || !rx_mac_match(frame))
+      continue;
+
+    if (d->state != RX_DESC_ARMED) {
+      EthStats.rx_missed++;
+      if (!s_rx_suspended) {
+        s_rx_suspended = 1U;
+        EthStats.rx_buf_unavail++;
+      }
+      continue;
+    }
+
+    s_rx_suspended = 0U;
+    memcpy(d->buf->buff, frame, n);
+    d->len   = n;
+    d->state = RX_DESC_FULL;
+    s_rx_dma = (uint8_t)((s_rx_dma + 1U) % SIM_ETH_RX_DESC_CNT);
+
+    EthStats.rx_irq++;
+    RxPending = 1U;
+  }
+}
+
+/**
+ * @brief Driver side (HAL_ETH_ReadData()): next received frame as a
+ *        zero-copy RX_POOL pbuf, then refill.
+ */
+static struct pbuf *low_level_input(struct netif *netif)
+{
+  (void)netif;
+
+  struct pbuf *p = NULL;
+  rx_desc_t *d = &s_rx[s_rx_app];
+
+  if (RxAllocStatus != RX_ALLOC_OK)
+    return NULL;
+
+  if (d->state == RX_DESC_FULL) {
+    RxBuff_t *b = d->buf;
+
+    b->pbuf_custom.custom_free_function = pbuf_free_custom;
+    p = pbuf_alloced_custom(PBUF_RAW, d->len, PBUF_REF, &b->pbuf_custom,
+                            b->buff, SIM_ETH_RX_BUF_SIZE);
+
+    d->buf   = NULL;
+    d->state = RX_DESC_EMPTY;
+    s_rx_app = (uint8_t)((s_rx_app + 1U) % SIM_ETH_RX_DESC_CNT);
+  }
+
+  rx_refill();
+  return p;
+}
+
+void pbuf_free_custom(struct pbuf *p)
+{
+  struct pbuf_custom *custom_pbuf = (struct pbuf_custom *)p;
+  LWIP_MEMPOOL_FREE(RX_POOL, custom_pbuf);
+
+  if (RxAllocStatus == RX_ALLOC_ERROR) {
+    RxAllocStatus = RX_ALLOC_OK;
+    RxPending = 1U;
+  }
+}
+
+/* =============================================================================
+ * TX DMA
+ * ============================================================================= */
+
+/**
+ * @brief Drop the references of frames whose last bit has left
+ *        (HAL_ETH_ReleaseTxPacket()).
+ */
+static void tx_release(void)
+{
+  uint64_t now = SIM_CLOCK_Now();
+
+  while (s_tx_count != 0U && s_tx[s_tx_head].done_us <= now) {
+    tx_rec_t *r = &s_tx[s_tx_head];
+
+    pbuf_free(r->p);
+    r->p = NULL;
+    s_tx_inuse = (uint8_t)(s_tx_inuse - r->ndesc);
+    EthStats.tx_released++;
+
+    s_tx_head = (uint8_t)((s_tx_head + 1U) % SIM_ETH_TX_DESC_CNT);
+    s_tx_count--;
+  }
+}
+
+static err_t low_level_output(struct netif *netif, struct pbuf *p)
+{
+  (void)netif;
+
+  uint8_t  frame[SIM_WIRE_FRAME_MAX];
+  uint32_t clen;
+  uint8_t  linearize;
+  tx_rec_t *r;
+
+  /* Reclaim descriptors of frames already on the wire */
+  tx_release();
+
+  clen = pbuf_clen(p);
+  linearize = (clen > SIM_ETH_TX_DESC_CNT);
+  if (linearize)
+    clen = 1U;
+
+  /* Ring full: lwIP keeps the frame */
+  if (clen > SIM_ETH_TX_DESC_CNT - s_tx_inuse) {
+    EthStats.tx_busy++;
+    return ERR_MEM;
+  }
+
+  if (linearize) {
+    p = pbuf_clone(PBUF_RAW, PBUF_RAM, p);
+    if (p == NULL) {
+      EthStats.tx_busy++;
+      return ERR_MEM;
+    }
+    EthStats.tx_linearized++;
+  } else {
+    /* Held until the DMA is done with it, as on the board */
+    pbuf_ref(p);
+  }
+
+  r = &s_tx[(s_tx_head + s_tx_count) % SIM_ETH_TX_DESC_CNT];
+  r->p       = p;
+  r->ndesc   = (uint8_t)clen;
+  r->done_us = SIM_WIRE_Send(SIM_WIRE_TO_PEER, frame,
+                             pbuf_copy_partial(p, frame, sizeof(frame), 0));
+
+  s_tx_count++;
+  s_tx_inuse = (uint8_t)(s_tx_inuse + clen);
+
+  EthStats.tx_frames++;
+  if (s_tx_inuse > EthStats.tx_inuse_max)
+    EthStats.tx_inuse_max = s_tx_inuse;
+
+  return ERR_OK;
+}
+
+/* =============================================================================
+ * Interrupt and pump interface
+ * ============================================================================= */
+void SIM_NETIF_Irq(void)
+{
+  rx_dma();
+
+  if (s_tx_count != 0U && s_tx[s_tx_head].done_us <= SIM_CLOCK_Now())
+    TxPending = 1U;
+}
+
+uint64_t SIM_NETIF_NextEvent(void)
+{
+  uint64_t now = SIM_CLOCK_Now();
+
+  for (uint32_t i = 0; i < s_tx_count; i++) {
+    const tx_rec_t *r = &s_tx[(s_tx_head + i) % SIM_ETH_TX_DESC_CNT];
+    if (r->done_us > now)
+      return r->done_us;
+  }
+  return SIM_NETIF_IDLE;
+}
+
+void ethernetif_input(struct netif *netif)
+{
+  struct pbuf *p = NULL;
+  u16_t n = 0U;
+
+  if (TxPending) {
+    TxPending = 0U;
+    tx_release();
+  }
+
+  RxPending = 0U;
+
+  do {
+    if (EthFilter.rx_budget != 0U && n == EthFilter.rx_budget) {
+      RxPending = 1U;
+      EthStats.rx_budget_hits++;
+      break;
+    }
+
+    p = low_level_input(netif);
+    if (p != NULL) {
+      const u8_t *f = (const u8_t *)p->payload;
+
+      n++;
+      if (f[0] & 0x01U) {
+        if ((f[0] & f[1] & f[2] & f[3] & f[4] & f[5]) == 0xFFU)
+          EthStats.rx_bcast++;
+        else
+          EthStats.rx_mcast++;
+      }
+
+      EthStats.rx_frames++;
+      if (netif->input(p, netif) != ERR_OK)
+        pbuf_free(p);
+    }
+  } while (p != NULL);
+}
+
+static void low_level_init(struct netif *netif)
+{
+  LWIP_MEMPOOL_INIT(RX_POOL);
+
+  netif->hwaddr_len = ETH_HWADDR_LEN;
+  memcpy(netif->hwaddr, s_mac, ETH_HWADDR_LEN);
+  netif->mtu   = 1500U;
+  netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+
+  /* HAL_ETH_Start_IT(): all descriptors get a buffer */
+  rx_refill();
+
+  ethernet_link_check_state(netif);
+}
+
+err_t ethernetif_init(struct netif *netif)
+{
+  LWIP_ASSERT("netif != NULL", (netif != NULL));
+
+  netif->name[0] = IFNAME0;
+  netif->name[1] = IFNAME1;
+
+  netif->output     = etharp_output;
+  netif->linkoutput = low_level_output;
+
+  low_level_init(netif);
+
+  return ERR_OK;
+}
+
+/**
+ * @brief Link state follows the simulated cable.
+ */
+void ethernet_link_check_state(struct netif *netif)
+{
+  bool up = SIM_WIRE_LinkUp();
+
+  if (netif_is_link_up(netif) && !up) {
+    netif_set_down(netif);
+    netif_set_link_down(netif);
+  } else if (!netif_is_link_up(netif) && up) {
+    netif_set_up(netif);
+    netif_set_link_up(netif);
+  }
+}
+
+/* =============================================================================
+ * ethernetif.h services
+ * ============================================================================= */
+u32_t sys_now(void)
+{
+  return HAL_GetTick();
+}
+
+u8_t ethernetif_pending(void)
+{
+  return (u8_t)(RxPending | TxPending);
+}
+
+u32_t ethernetif_sleeptime(void)
+{
+  return (RxPending | TxPending) ? 0U : ETHERNETIF_SLEEPTIME_INFINITE;
+}
+
+void ethernetif_get_stats(ethernetif_stats_t *out)
+{
+  if (out) {
+    *out = EthStats;
+    out->tx_inuse = s_tx_inuse;
+  }
+}
+
+u32_t ethernetif_tx_mark(void)
+{
+  return EthStats.tx_frames;
+}
+
+u8_t ethernetif_tx_released(u32_t mark)
+{
+  return (u8_t)((s32_t)(EthStats.tx_released - mark) >= 0);
+}
+
+void ethernetif_get_filter(ethernetif_filter_t *out)
+{
+  if (out) *out = EthFilter;
+}
+
+void ethernetif_set_filter(const ethernetif_filter_t *cfg)
+{
+  if (cfg) EthFilter = *cfg;
+}
+
+err_t ethernetif_mcast_filter(const u8_t *mac, u8_t add)
+{
+  (void)mac;
+  (void)add;
+  return ERR_OK;
+}
@@ -0,0 +1,733 @@
+/**
+ * @file    sim_peer.c
+ * @brief   Simulated telemetry gateway: ARP, UDP sink, minimal TCP server.
+ *
+ * This module stands in for the Raspberry Pi at APP_RASPI_IP on the other
+ * end of the simulated cable (sim_wire.c):
+ *  - Answers ARP requests for its address, learns the board's MAC
+ *  - Counts the UDP telemetry (JSON lines, binary frames, delta blocks,
+ *    statistics lines) arriving on APP_UDP_PORT
+ *  - Accepts the telemetry connection on APP_TCP_PORT with just enough TCP
+ *    for a lossless downlink: SYN / SYN-ACK, one ACK per segment, segments
+ *    beyond a hole kept (up to SIM_PEER_OOO_SEGS) and answered with a
+ *    duplicate ACK until lwIP retransmits the missing one, FIN and RST
+ *  - Decodes the stream into records and tracks the sample sequence numbers
+ *    of binary frames: what arrived, twice, or never
+ *  - Optional gateway ACK: "ACK <seq>\n" for the highest sample up to which
+ *    everything has arrived (app_net.c then keeps the backlog until then)
+ *  - Fault injection for the scenarios: refuse connections, reset the open
+ *    one, drop off the network
+ *
+ * Design notes:
+ *  - A separate minimal stack instead of a second lwIP instance: one lwIP
+ *    build cannot host both ends, and the gateway's own behaviour
+ *    (processing time, window) should not hide the board's
+ *  - The gateway processes instantly and always advertises the full window
+ *  - Its frames carry valid checksums so captures decode cleanly; frames
+ *    from the board are not checked (hardware offload on the board)
+ */
+
+#include "sim_peer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim_wire.h"
+#include "app_net.h"       /* APP_RASPI_IP, ports, APP_NET_BACKLOG_FRAMES */
+#include "app_frame.h"
+
+/* =============================================================================
+ * Protocol constants
+ * ============================================================================= */
+#define ETH_HDR_LEN       14U
+#define IP_HDR_LEN        20U
+#define TCP_HDR_LEN       20U
+#define L4_OFF            (ETH_HDR_LEN + IP_HDR_LEN)
+
+#define ETHTYPE_IPV4      0x0800U
+#define ETHTYPE_ARP       0x0806U
+#define PROTO_TCP         6U
+#define PROTO_UDP         17U
+
+#define TCPF_FIN          0x01U
+#define TCPF_SYN          0x02U
+#define TCPF_RST          0x04U
+#define TCPF_PSH          0x08U
+#define TCPF_ACK          0x10U
+
+#define PEER_TCP_MSS      1460U
+
+/* Holes this far behind the newest sample are given up by the gateway ACK:
+   the board's backlog ring no longer holds them */
+#define ACK_HORIZON       APP_NET_BACKLOG_FRAMES
+
+/* Stream reassembly: longest frame or JSON line */
+#define STREAM_BUF        512U
+
+/* Out-of-order segments kept until the hole before them is filled */
+#define SIM_PEER_OOO_SEGS 16U
+
+/* =============================================================================
+ * State
+ * ============================================================================= */
+typedef enum
+{
+  CONN_CLOSED = 0,
+  CONN_SYN_RCVD,
+  CONN_ESTABLISHED,
+  CONN_LAST_ACK
+} conn_state_t;
+
+typedef struct
+{
+  uint8_t  state;
+  uint16_t port;              /* board's port */
+  uint32_t iss;
+  uint32_t snd_nxt;
+  uint32_t rcv_nxt;
+} conn_t;
+
+static const uint8_t s_mac[6] = SIM_PEER_MAC;
+static uint8_t  s_ip[4];
+static uint8_t  s_board_mac[6];
+static uint8_t  s_board_ip[4];
+static uint16_t s_ip_id;
+
+static bool           s_online = true;
+static SimPeerTcpMode s_tcp_mode = SIM_PEER_TCP_ACCEPT;
+static bool           s_gw_ack;
+static conn_t         s_conn;
+static uint32_t       s_iss_next;
+
+static uint8_t  s_stream[STREAM_BUF];
+static uint16_t s_stream_len;
+
+static uint8_t  s_seen[SIM_PEER_SEQ_MAX / 8U];
+static bool     s_seq_any;
+static uint32_t s_contig_next;   /* lowest sample not yet acknowledgeable */
+static uint32_t s_acked_next;    /* s_contig_next at the last ACK line    */
+
+typedef struct
+{
+  bool     used;
+  uint32_t seq;
+  uint16_t len;
+  uint8_t  data[PEER_TCP_MSS];
+} ooo_seg_t;
+
+static ooo_seg_t s_ooo[SIM_PEER_OOO_SEGS];
+
+static SimPeerStats s_st;
+
+static uint8_t s_tx[SIM_WIRE_FRAME_MAX];
+
+/* =============================================================================
+ * Byte order and checksums
+ * ============================================================================= */
+static uint16_t get16(const uint8_t *p)
+{
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+       | ((uint32_t)p[2] << 8)  |  (uint32_t)p[3];
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static uint32_t get32le(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+       | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t csum_add(uint32_t sum, const uint8_t *p, uint16_t len)
+{
+  for (uint16_t i = 0; i + 1U < len; i += 2U)
+    sum += get16(&p[i]);
+  if (len & 1U)
+    sum += (uint32_t)p[len - 1U] << 8;
+  return sum;
+}
+
+static uint16_t csum_fold(uint32_t sum)
+{
+  while (sum >> 16)
+    sum = (sum & 0xFFFFU) + (sum >> 16);
+  return (uint16_t)~sum;
+}
+
+/* =============================================================================
+ * Output
+ * ============================================================================= */
+
+/**
+ * @brief Wrap the L4 payload at s_tx + L4_OFF into IPv4 and Ethernet and
+ *        put it on the downlink.
+ */
+static void ip_send(uint8_t proto, uint16_t l4len)
+{
+  uint8_t *ip = &s_tx[ETH_HDR_LEN];
+
+  memcpy(&s_tx[0], s_board_mac, 6);
+  memcpy(&s_tx[6], s_mac, 6);
+  put16(&s_tx[12], ETHTYPE_IPV4);
+
+  ip[0] = 0x45U;
+  ip[1] = 0U;
+  put16(&ip[2], (uint16_t)(IP_HDR_LEN + l4len));
+  put16(&ip[4], s_ip_id++);
+  put16(&ip[6], 0x4000U);                /* DF */
+  ip[8] = 64U;
+  ip[9] = proto;
+  put16(&ip[10], 0U);
+  memcpy(&ip[12], s_ip, 4);
+  memcpy(&ip[16], s_board_ip, 4);
+  put16(&ip[10], csum_fold(csum_add(0U, ip, IP_HDR_LEN)));
+
+  (void)SIM_WIRE_Send(SIM_WIRE_TO_BOARD, s_tx, (uint16_t)(L4_OFF + l4len));
+}
+
+static void tcp_send(uint16_t sport, uint16_t dport, uint32_t seq, uint32_t ack,
+                     uint8_t flags, const uint8_t *data, uint16_t len)
+{
+  uint8_t *t = &s_tx[L4_OFF];
+  uint16_t hlen = (flags & TCPF_SYN) ? (uint16_t)(TCP_HDR_LEN + 4U) : (uint16_t)TCP_HDR_LEN;
+  uint16_t tlen = (uint16_t)(hlen + len);
+  uint32_t sum;
+
+  put16(&t[0], sport);
+  put16(&t[2], dport);
+  put32(&t[4], seq);
+  put32(&t[8], ack);
+  t[12] = (uint8_t)((hlen / 4U) << 4);
+  t[13] = flags;
+  put16(&t[14], SIM_PEER_TCP_WND);
+  put16(&t[16], 0U);
+  put16(&t[18], 0U);
+
+  if (flags & TCPF_SYN) {
+    t[20] = 2U;                          /* MSS option */
+    t[21] = 4U;
+    put16(&t[22], PEER_TCP_MSS);
+  }
+  if (len)
+    memcpy(&t[hlen], data, len);
+
+  /* pseudo header + segment */
+  sum = csum_add(0U, s_ip, 4);
+  sum = csum_add(sum, s_board_ip, 4);
+  sum += PROTO_TCP + tlen;
+  put16(&t[16], csum_fold(csum_add(sum, t, tlen)));
+
+  ip_send(PROTO_TCP, tlen);
+}
+
+/**
+ * @brief RST for a segment that belongs to no connection (RFC 793).
+ */
+static void tcp_send_reset(const uint8_t *t, uint16_t dlen)
+{
+  uint8_t flags = t[13];
+
+  if (flags & TCPF_ACK) {
+    tcp_send(get16(&t[2]), get16(&t[0]), get32(&t[8]), 0U, TCPF_RST, NULL, 0);
+  } else {
+    uint32_t ack = get32(&t[4]) + dlen + ((flags & TCPF_SYN) ? 1U : 0U)
+                 + ((flags & TCPF_FIN) ? 1U : 0U);
+    tcp_send(get16(&t[2]), get16(&t[0]), 0U, ack, TCPF_RST | TCPF_ACK, NULL, 0);
+  }
+}
+
+/* =============================================================================
+ * Sample sequence tracking
+ * ============================================================================= */
+static bool seq_seen(uint32_t seq)
+{
+  return (s_seen[seq >> 3] & (1U << (seq & 7U))) != 0U;
+}
+
+static void seq_record(uint32_t seq)
+{
+  if (seq >= SIM_PEER_SEQ_MAX) return;
+
+  if (seq_seen(seq)) {
+    s_st.seq_dups++;
+    return;
+  }
+
+  s_seen[seq >> 3] |= (uint8_t)(1U << (seq & 7U));
+  s_st.seq_unique++;
+
+  if (!s_seq_any || seq < s_st.seq_first) s_st.seq_first = seq;
+  if (!s_seq_any || seq > s_st.seq_last)  s_st.seq_last  = seq;
+  s_seq_any = true;
+
+  /* Everything below s_contig_next has arrived (or is given up) */
+  while (s_contig_next < SIM_PEER_SEQ_MAX) {
+    if (seq_seen(s_contig_next) || s_st.seq_last >= s_contig_next + ACK_HORIZON)
+      s_contig_next++;
+    else
+      break;
+  }
+}
+
+/* =============================================================================
+ * Stream decoding
+ * ============================================================================= */
+static void tcp_record(const uint8_t *f, uint16_t len)
+{
+  s_st.tcp_records++;
+
+  if (f[0] != APP_FRAME_MAGIC || len < APP_FRAME_HDR_LEN)
+    return;
+
+  if (f[2] == APP_FRAME_TYPE_SAMPLE) {
+    s_st.tcp_samples++;
+    seq_record(get32le(&f[6]));
+  } else if (f[2] == APP_FRAME_TYPE_RSP) {
+    s_st.tcp_responses++;
+  }
+}
+
+/**
+ * @brief Split the buffered stream into binary frames (length in the
+ *        header) and JSON lines; keep an incomplete tail.
+ */
+static void stream_parse(void)
+{
+  uint16_t pos = 0;
+
+  while (pos < s_stream_len) {
+    const uint8_t *p = &s_stream[pos];
+    uint16_t left = (uint16_t)(s_stream_len - pos);
+
+    if (p[0] == APP_FRAME_MAGIC) {
+      if (left < 6U) break;
+
+      uint16_t flen = (uint16_t)(p[4] | (p[5] << 8));
+      if (flen < APP_FRAME_HDR_LEN || flen > STREAM_BUF) {
+        s_st.tcp_resync++;
+        pos++;
+        continue;
+      }
+      if (left < flen) break;
+
+      tcp_record(p, flen);
+      pos = (uint16_t)(pos + flen);
+    } else if (p[0] == '{') {
+      const uint8_t *nl = memchr(p, '\n', left);
+      if (nl) {
+        tcp_record(p, (uint16_t)(nl - p + 1));
+        pos = (uint16_t)(pos + (nl - p + 1));
+      } else if (left == STREAM_BUF) {
+        s_st.tcp_resync++;
+        pos++;
+      } else {
+        break;
+      }
+    } else {
+      s_st.tcp_resync++;
+      pos++;
+    }
+  }
+
+  memmove(s_stream, &s_stream[pos], (size_t)(s_stream_len - pos));
+  s_stream_len = (uint16_t)(s_stream_len - pos);
+}
+
+static void stream_feed(const uint8_t *data, uint16_t len)
+{
+  s_st.tcp_bytes += len;
+
+  while (len) {
+    uint16_t n = (uint16_t)(STREAM_BUF - s_stream_len);
+    if (n > len) n = len;
+
+    memcpy(&s_stream[s_stream_len], data, n);
+    s_stream_len = (uint16_t)(s_stream_len + n);
+    data += n;
+    len  = (uint16_t)(len - n);
+
+    stream_parse();
+  }
+}
+
+/* =============================================================================
+ * TCP
+ * ============================================================================= */
+
+/**
+ * @brief Keep a segment that arrived beyond a hole.
+ */
+static void ooo_store(uint32_t seq, const uint8_t *data, uint16_t len)
+{
+  ooo_seg_t *free_seg = NULL;
+
+  if (len > PEER_TCP_MSS) return;
+
+  for (uint32_t i = 0; i < SIM_PEER_OOO_SEGS; i++) {
+    if (!s_ooo[i].used) {
+      if (!free_seg) free_seg = &s_ooo[i];
+    } else if (s_ooo[i].seq == seq && s_ooo[i].len >= len) {
+      return;                            /* already have it */
+    }
+  }
+  if (!free_seg) return;                 /* full: lwIP sends it again */
+
+  free_seg->used = true;
+  free_seg->seq  = seq;
+  free_seg->len  = len;
+  memcpy(free_seg->data, data, len);
+}
+
+/**
+ * @brief Deliver the stored segments the stream has caught up with.
+ */
+static void ooo_drain(void)
+{
+  bool progress = true;
+
+  while (progress) {
+    progress = false;
+
+    for (uint32_t i = 0; i < SIM_PEER_OOO_SEGS; i++) {
+      ooo_seg_t *o = &s_ooo[i];
+      if (!o->used) continue;
+
+      int32_t d = (int32_t)(o->seq - s_conn.rcv_nxt);
+      if (d > 0) continue;
+
+      if ((int32_t)o->len + d > 0) {
+        uint16_t skip = (uint16_t)(-d);
+        stream_feed(&o->data[skip], (uint16_t)(o->len - skip));
+        s_conn.rcv_nxt += (uint32_t)(o->len - skip);
+        progress = true;
+      }
+      o->used = false;
+    }
+  }
+}
+
+/**
+ * @brief ACK the received data; with gateway ACK on, a new "ACK <seq>"
+ *        line rides on it.
+ */
+static void conn_ack(void)
+{
+  char line[24] = "";
+  int n = 0;
+
+  if (s_gw_ack && s_contig_next != s_acked_next && s_contig_next != 0U) {
+    n = snprintf(line, sizeof(line), "ACK %lu\n", (unsigned long)(s_contig_next - 1U));
+    s_acked_next = s_contig_next;
+    s_st.gw_acks++;
+    s_st.gw_acked_seq = s_contig_next - 1U;
+  }
+
+  tcp_send(APP_TCP_PORT, s_conn.port, s_conn.snd_nxt, s_conn.rcv_nxt,
+           (uint8_t)(TCPF_ACK | (n > 0 ? TCPF_PSH : 0U)),
+           (n > 0) ? (const uint8_t *)line : NULL, (uint16_t)((n > 0) ? n : 0));
+  if (n > 0)
+    s_conn.snd_nxt += (uint32_t)n;
+}
+
+static void tcp_input(const uint8_t *t, uint16_t tlen)
+{
+  if (tlen < TCP_HDR_LEN) return;
+
+  uint16_t sport = get16(&t[0]);
+  uint16_t dport = get16(&t[2]);
+  uint32_t seq   = get32(&t[4]);
+  uint32_t ack   = get32(&t[8]);
+  uint16_t off   = (uint16_t)((t[12] >> 4) * 4U);
+  uint8_t  flags = t[13];
+
+  if (off < TCP_HDR_LEN || off > tlen) return;
+
+  const uint8_t *data = &t[off];
+  uint16_t dlen = (uint16_t)(tlen - off);
+
+  /* Closed port (MQTT, iperf client, ...) */
+  if (dport != APP_TCP_PORT) {
+    if (!(flags & TCPF_RST)) tcp_send_reset(t, dlen);
+    return;
+  }
+
+  if (flags & TCPF_RST) {
+    if (s_conn.state != CONN_CLOSED && sport == s_conn.port) {
+      s_conn.state = CONN_CLOSED;
+      s_st.tcp_resets_rx++;
+    }
+    return;
+  }
+
+  /* New connection (replaces one the board has given up on) */
+  if ((flags & TCPF_SYN) && !(flags & TCPF_ACK)) {
+    if (s_tcp_mode == SIM_PEER_TCP_REFUSE) {
+      tcp_send_reset(t, dlen);
+      s_st.tcp_refused++;
+      return;
+    }
+
+    if (!(s_conn.state == CONN_SYN_RCVD && sport == s_conn.port)) {
+      s_conn.state   = CONN_SYN_RCVD;
+      s_conn.port    = sport;
+      s_conn.iss     = s_iss_next;
+      s_conn.snd_nxt = s_iss_next + 1U;
+      s_conn.rcv_nxt = seq + 1U;
+      s_iss_next    += 0x01000000UL;
+      s_stream_len   = 0;
+      memset(s_ooo, 0, sizeof(s_ooo));
+    }
+    /* SYN-ACK (again, for a retransmitted SYN) */
+    tcp_send(APP_TCP_PORT, sport, s_conn.iss, s_conn.rcv_nxt,
+             TCPF_SYN | TCPF_ACK, NULL, 0);
+    return;
+  }
+
+  if (s_conn.state == CONN_CLOSED || sport != s_conn.port) {
+    tcp_send_reset(t, dlen);
+    return;
+  }
+
+  if (!(flags & TCPF_ACK)) return;
+
+  if (s_conn.state == CONN_SYN_RCVD) {
+    if (ack != s_conn.snd_nxt) return;
+    s_conn.state = CONN_ESTABLISHED;
+    s_st.tcp_accepts++;
+  }
+
+  if (s_conn.state == CONN_LAST_ACK) {
+    if (ack == s_conn.snd_nxt) s_conn.state = CONN_CLOSED;
+    return;
+  }
+
+  if (dlen == 0U && !(flags & TCPF_FIN))
+    return;
+
+  int32_t d = (int32_t)(seq - s_conn.rcv_nxt);
+
+  if (d > 0) {
+    /* Beyond a hole: keep, duplicate ACK */
+    s_st.tcp_ooo++;
+    ooo_store(seq, data, dlen);
+    conn_ack();
+    return;
+  }
+
+  if ((int32_t)dlen + d <= 0 && !(flags & TCPF_FIN)) {
+    s_st.tcp_retrans++;
+    conn_ack();
+    return;
+  }
+
+  if (dlen != 0U && (int32_t)dlen + d > 0) {
+    uint16_t skip = (uint16_t)(-d);
+    if (skip) s_st.tcp_retrans++;
+    stream_feed(&data[skip], (uint16_t)(dlen - skip));
+    s_conn.rcv_nxt += (uint32_t)(dlen - skip);
+    ooo_drain();
+  }
+
+  if (flags & TCPF_FIN) {
+    /* Board closed: close our side as well */
+    s_conn.rcv_nxt++;
+    tcp_send(APP_TCP_PORT, s_conn.port, s_conn.snd_nxt, s_conn.rcv_nxt,
+             TCPF_FIN | TCPF_ACK, NULL, 0);
+    s_conn.snd_nxt++;
+    s_conn.state = CONN_LAST_ACK;
+    return;
+  }
+
+  conn_ack();
+}
+
+/* =============================================================================
+ * UDP, ARP, IPv4
+ * ============================================================================= */
+
+/**
+ * @brief Count the records of one telemetry datagram.
+ */
+static void udp_input(const uint8_t *p, uint16_t len)
+{
+  uint16_t pos = 0;
+
+  s_st.udp_datagrams++;
+  s_st.udp_bytes += len;
+
+  while (pos < len) {
+    const uint8_t *r = &p[pos];
+    uint16_t left = (uint16_t)(len - pos);
+
+    if (r[0] == APP_FRAME_MAGIC && left >= APP_FRAME_HDR_LEN) {
+      uint16_t flen = (uint16_t)(r[4] | (r[5] << 8));
+      if (flen < APP_FRAME_HDR_LEN || flen > left) break;
+
+      if (r[2] == APP_FRAME_TYPE_SAMPLE)
+        s_st.udp_samples++;
+      else if (r[2] == APP_FRAME_TYPE_BLOCK && flen >= APP_FRAME_HDR_LEN + 2U)
+        s_st.udp_samples += (uint32_t)(r[18] | (r[19] << 8));
+      else
+        s_st.udp_other++;
+
+      pos = (uint16_t)(pos + flen);
+    } else if (r[0] == '{') {
+      const uint8_t *nl = memchr(r, '\n', left);
+      if (!nl) break;
+
+      if (left > 10U && memcmp(r, "{\"netstat\"", 10) == 0)
+        s_st.udp_netstat++;
+      else
+        s_st.udp_samples++;
+
+      pos = (uint16_t)(pos + (nl - r + 1));
+    } else {
+      break;
+    }
+  }
+}
+
+static void arp_input(const uint8_t *f, uint16_t len)
+{
+  uint8_t *a = &s_tx[ETH_HDR_LEN];
+
+  if (len < ETH_HDR_LEN + 28U) return;
+  if (get16(&f[20]) != 1U || memcmp(&f[38], s_ip, 4) != 0) return;
+
+  memcpy(s_board_mac, &f[22], 6);
+  memcpy(s_board_ip, &f[28], 4);
+
+  memcpy(&s_tx[0], s_board_mac, 6);
+  memcpy(&s_tx[6], s_mac, 6);
+  put16(&s_tx[12], ETHTYPE_ARP);
+
+  put16(&a[0], 1U);                       /* Ethernet */
+  put16(&a[2], ETHTYPE_IPV4);
+  a[4] = 6U;
+  a[5] = 4U;
+  put16(&a[6], 2U);                       /* reply    */
+  memcpy(&a[8], s_mac, 6);
+  memcpy(&a[14], s_ip, 4);
+  memcpy(&a[18], s_board_mac, 6);
+  memcpy(&a[24], s_board_ip, 4);
+
+  (void)SIM_WIRE_Send(SIM_WIRE_TO_BOARD, s_tx, ETH_HDR_LEN + 28U);
+  s_st.arp_replies++;
+}
+
+static void ip_input(const uint8_t *f, uint16_t len)
+{
+  const uint8_t *ip = &f[ETH_HDR_LEN];
+
+  if (len < L4_OFF || (ip[0] >> 4) != 4U) return;
+
+  uint16_t ihl  = (uint16_t)((ip[0] & 0x0FU) * 4U);
+  uint16_t tot  = get16(&ip[2]);
+
+  if (ihl < IP_HDR_LEN || tot < ihl || ETH_HDR_LEN + tot > len) return;
+  if (memcmp(&ip[16], s_ip, 4) != 0) return;
+
+  memcpy(s_board_mac, &f[6], 6);
+  memcpy(s_board_ip, &ip[12], 4);
+
+  const uint8_t *l4 = &ip[ihl];
+  uint16_t l4len = (uint16_t)(tot - ihl);
+
+  if (ip[9] == PROTO_UDP && l4len >= 8U) {
+    if (get16(&l4[2]) == APP_UDP_PORT)
+      udp_input(&l4[8], (uint16_t)(l4len - 8U));
+  } else if (ip[9] == PROTO_TCP) {
+    tcp_input(l4, l4len);
+  }
+}
+
+/* =============================================================================
+ * Public interface
+ * ============================================================================= */
+void SIM_PEER_Init(bool gw_ack)
+{
+  unsigned a = 0, b = 0, c = 0, d = 0;
+
+  (void)sscanf(APP_RASPI_IP, "%u.%u.%u.%u", &a, &b, &c, &d);
+  s_ip[0] = (uint8_t)a;
+  s_ip[1] = (uint8_t)b;
+  s_ip[2] = (uint8_t)c;
+  s_ip[3] = (uint8_t)d;
+
+  memset(&s_st, 0, sizeof(s_st));
+  memset(&s_conn, 0, sizeof(s_conn));
+  memset(s_seen, 0, sizeof(s_seen));
+  memset(s_ooo, 0, sizeof(s_ooo));
+
+  s_gw_ack      = gw_ack;
+  s_online      = true;
+  s_tcp_mode    = SIM_PEER_TCP_ACCEPT;
+  s_iss_next    = 0x10000000UL;
+  s_stream_len  = 0;
+  s_seq_any     = false;
+  s_contig_next = 0;
+  s_acked_next  = 0;
+}
+
+void SIM_PEER_Service(void)
+{
+  uint8_t  f[SIM_WIRE_FRAME_MAX];
+  uint16_t n;
+
+  while ((n = SIM_WIRE_Receive(SIM_WIRE_TO_PEER, f, sizeof(f))) != 0U) {
+    if (!s_online || n < ETH_HDR_LEN) continue;
+
+    switch (get16(&f[12])) {
+      case ETHTYPE_ARP:  arp_input(f, n); break;
+      case ETHTYPE_IPV4: ip_input(f, n);  break;
+      default: break;
+    }
+  }
+}
+
+void SIM_PEER_SetOnline(bool online)
+{
+  s_online = online;
+}
+
+void SIM_PEER_SetTcpMode(SimPeerTcpMode mode)
+{
+  s_tcp_mode = mode;
+}
+
+void SIM_PEER_ResetConnection(void)
+{
+  if (s_conn.state == CONN_CLOSED) return;
+
+  tcp_send(APP_TCP_PORT, s_conn.port, s_conn.snd_nxt, s_conn.rcv_nxt,
+           TCPF_RST | TCPF_ACK, NULL, 0);
+  s_conn.state = CONN_CLOSED;
+  s_st.tcp_resets_tx++;
+}
+
+void SIM_PEER_GetStats(SimPeerStats *out)
+{
+  if (!out) return;
+
+  *out = s_st;
+  out->seq_missing = s_seq_any
+                   ? (s_st.seq_last - s_st.seq_first + 1U) - s_st.seq_unique
+                   : 0U;
+}
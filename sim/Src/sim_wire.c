@@ -0,0 +1,245 @@
+/**
+ * @file    sim_wire.c
+ * @brief   Simulated full-duplex Ethernet link with optional pcap capture.
+ *
+ * This module provides:
+ *  - One queue per direction between the simulated netif (sim_netif.c) and
+ *    the gateway (sim_peer.c)
+ *  - Line-rate timing: every frame occupies its direction for preamble,
+ *    frame, FCS and inter-frame gap; frames queue behind each other and
+ *    arrive after the last bit plus SIM_WIRE_PROP_NS
+ *  - Cable pull (SIM_WIRE_SetLink) and uplink frame loss
+ *  - A pcap capture of both directions, stamped with the virtual clock
+ *
+ * Design notes:
+ *  - Loss is injected on the uplink only: lwIP recovers it (TCP
+ *    retransmission), the gateway model does not retransmit its own data
+ *  - Frames from the board carry zero IP / UDP / TCP checksums (hardware
+ *    offload, CHECKSUM_GEN_* = 0); capture tools report them as invalid
+ */
+
+#include "sim_wire.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim_clock.h"
+
+/* =============================================================================
+ * Queues
+ * ============================================================================= */
+
+/* Preamble + SFD, FCS, inter-frame gap, minimum frame without FCS */
+#define WIRE_PREAMBLE   8U
+#define WIRE_FCS        4U
+#define WIRE_IFG        12U
+#define WIRE_MIN_FRAME  60U
+
+#define LOSS_SEED       0x9E3779B9UL
+
+typedef struct
+{
+  uint64_t arrive_us;
+  uint16_t len;
+  uint8_t  data[SIM_WIRE_FRAME_MAX];
+} wire_frame_t;
+
+typedef struct
+{
+  wire_frame_t q[SIM_WIRE_QUEUE];
+  uint16_t     head;
+  uint16_t     count;
+  uint64_t     line_free_ns;
+  SimWireStats st;
+} wire_dir_t;
+
+static wire_dir_t s_dir[SIM_WIRE_DIRS];
+static uint32_t   s_mbps = SIM_WIRE_MBPS_DEFAULT;
+static uint32_t   s_loss_permille;
+static uint32_t   s_rng = LOSS_SEED;
+static bool       s_link_up = true;
+static FILE      *s_pcap;
+
+static uint32_t rng_next(void)
+{
+  /* xorshift32 */
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return s_rng;
+}
+
+void SIM_WIRE_Init(uint32_t mbps, uint32_t loss_permille)
+{
+  memset(s_dir, 0, sizeof(s_dir));
+  s_mbps          = (mbps != 0U) ? mbps : SIM_WIRE_MBPS_DEFAULT;
+  s_loss_permille = (loss_permille > 1000U) ? 1000U : loss_permille;
+  s_rng           = LOSS_SEED;
+  s_link_up       = true;
+}
+
+/* =============================================================================
+ * pcap capture
+ * ============================================================================= */
+static void pcap_put32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief Start a capture: classic pcap, microsecond stamps, LINKTYPE_ETHERNET.
+ */
+bool SIM_WIRE_PcapOpen(const char *path)
+{
+  uint8_t hdr[24];
+
+  SIM_WIRE_PcapClose();
+
+  s_pcap = fopen(path, "wb");
+  if (!s_pcap) return false;
+
+  pcap_put32(&hdr[0], 0xA1B2C3D4UL);          /* magic               */
+  hdr[4] = 2U;  hdr[5] = 0U;                  /* version 2.4         */
+  hdr[6] = 4U;  hdr[7] = 0U;
+  pcap_put32(&hdr[8], 0U);                    /* thiszone            */
+  pcap_put32(&hdr[12], 0U);                   /* sigfigs             */
+  pcap_put32(&hdr[16], SIM_WIRE_FRAME_MAX);   /* snaplen             */
+  pcap_put32(&hdr[20], 1U);                   /* LINKTYPE_ETHERNET   */
+
+  if (fwrite(hdr, sizeof(hdr), 1U, s_pcap) != 1U) {
+    SIM_WIRE_PcapClose();
+    return false;
+  }
+  return true;
+}
+
+void SIM_WIRE_PcapClose(void)
+{
+  if (s_pcap) {
+    fclose(s_pcap);
+    s_pcap = NULL;
+  }
+}
+
+static void pcap_record(uint64_t ts_us, const uint8_t *frame, uint16_t len)
+{
+  uint8_t rec[16];
+
+  if (!s_pcap) return;
+
+  pcap_put32(&rec[0], (uint32_t)(ts_us / 1000000U));
+  pcap_put32(&rec[4], (uint32_t)(ts_us % 1000000U));
+  pcap_put32(&rec[8], len);
+  pcap_put32(&rec[12], len);
+
+  (void)fwrite(rec, sizeof(rec), 1U, s_pcap);
+  (void)fwrite(frame, len, 1U, s_pcap);
+}
+
+/* =============================================================================
+ * Transfer
+ * ============================================================================= */
+
+/**
+ * @brief Serialize a frame on its direction.
+ *
+ * The frame starts when the line is free (back to back with the previous
+ * one) and is captured at that moment, even if it is lost afterwards.
+ *
+ * @return Time its last bit has left the sender (us): the TX DMA is done.
+ */
+uint64_t SIM_WIRE_Send(SimWireDir dir, const uint8_t *frame, uint16_t len)
+{
+  wire_dir_t *d = &s_dir[dir];
+
+  if (len > SIM_WIRE_FRAME_MAX)
+    len = SIM_WIRE_FRAME_MAX;
+
+  uint64_t now_ns = SIM_CLOCK_Now() * 1000U;
+  uint64_t start_ns = (d->line_free_ns > now_ns) ? d->line_free_ns : now_ns;
+  uint32_t on_wire = ((len < WIRE_MIN_FRAME) ? WIRE_MIN_FRAME : len)
+                   + WIRE_PREAMBLE + WIRE_FCS + WIRE_IFG;
+  uint64_t dur_ns = (uint64_t)on_wire * 8U * 1000U / s_mbps;
+  uint64_t end_ns = start_ns + dur_ns;
+
+  d->line_free_ns = end_ns;
+  d->st.frames++;
+  d->st.bytes   += len;
+  d->st.busy_ns += dur_ns;
+
+  pcap_record(start_ns / 1000U, frame, len);
+
+  if (!s_link_up ||
+      (dir == SIM_WIRE_TO_PEER && s_loss_permille != 0U &&
+       rng_next() % 1000U < s_loss_permille)) {
+    d->st.lost++;
+  } else if (d->count == SIM_WIRE_QUEUE) {
+    d->st.overflow++;
+  } else {
+    wire_frame_t *f = &d->q[(d->head + d->count) % SIM_WIRE_QUEUE];
+    f->arrive_us = (end_ns + SIM_WIRE_PROP_NS + 999U) / 1000U;
+    f->len       = len;
+    memcpy(f->data, frame, len);
+    d->count++;
+  }
+
+  return (end_ns + 999U) / 1000U;
+}
+
+uint16_t SIM_WIRE_Receive(SimWireDir dir, uint8_t *out, uint16_t cap)
+{
+  wire_dir_t *d = &s_dir[dir];
+  wire_frame_t *f;
+  uint16_t n;
+
+  if (d->count == 0U) return 0;
+
+  f = &d->q[d->head];
+  if (f->arrive_us > SIM_CLOCK_Now()) return 0;
+
+  n = (f->len < cap) ? f->len : cap;
+  memcpy(out, f->data, n);
+
+  d->head = (uint16_t)((d->head + 1U) % SIM_WIRE_QUEUE);
+  d->count--;
+  return n;
+}
+
+uint64_t SIM_WIRE_NextArrival(void)
+{
+  uint64_t t = SIM_WIRE_IDLE;
+
+  for (uint32_t i = 0; i < (uint32_t)SIM_WIRE_DIRS; i++) {
+    const wire_dir_t *d = &s_dir[i];
+    if (d->count != 0U && d->q[d->head].arrive_us < t)
+      t = d->q[d->head].arrive_us;
+  }
+  return t;
+}
+
+/**
+ * @brief Plug or pull the cable. Pulling it loses whatever is in transit.
+ */
+void SIM_WIRE_SetLink(bool up)
+{
+  if (!up) {
+    for (uint32_t i = 0; i < (uint32_t)SIM_WIRE_DIRS; i++) {
+      s_dir[i].st.lost += s_dir[i].count;
+      s_dir[i].count = 0;
+    }
+  }
+  s_link_up = up;
+}
+
+bool SIM_WIRE_LinkUp(void)
+{
+  return s_link_up;
+}
+
+void SIM_WIRE_GetStats(SimWireDir dir, SimWireStats *out)
+{
+  if (out) *out = s_dir[dir].st;
+}